@@ -1,27 +1,79 @@
 #pragma once
 
+#if defined(_WIN32)
 #include <d3d11.h>
 #include <wrl.h>
 #include <Windows.h>
 #include <windowsx.h>
+#include <d3dcompiler.h>
+#endif
 #include <iostream>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <chrono>
+#include <ctime>
 #include <vector>
 #include <string>
+#include <string_view>
+#include <charconv>
 #include <unordered_map>
-#include <d3dcompiler.h>
+#include <unordered_set>
 #include <fstream>
-
+#include <atomic>
+#include <thread>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <initializer_list>
+#include <bitset>
+#include <filesystem>
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#include <emmintrin.h>
+#define MINT_USE_SSE2
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#endif
+
+#if defined(_WIN32)
 #pragma comment(lib, "d3d11.lib")
 #pragma comment(lib, "d3dcompiler.lib")
+#endif
+
+// Everything that does not touch Win32 or D3D11 also compiles on other platforms,
+// so the platform-independent parts can be driven from host-side tools.
+#if !defined(_MSC_VER)
+#define __noop ((void)0)
+#endif
 
 namespace SimpleRenderer
 {
-#define MINT_LOG_ERROR(content) { std::cout << content; ::DebugBreak(); }
+#if defined(_WIN32)
+#define MINT_DEBUG_BREAK() ::DebugBreak()
+#else
+#define MINT_DEBUG_BREAK() __builtin_trap()
+#endif
+#define MINT_LOG_ERROR(content) { std::cout << content; MINT_DEBUG_BREAK(); }
 #define MINT_ASSERT(condition, content) if (!(condition)) { MINT_LOG_ERROR(content); }
 
 #pragma region Aliases
+#if defined(_WIN32)
 	using Microsoft::WRL::ComPtr;
+#else
+	using byte = unsigned char;
+#endif
 	using int8 = int8_t;
 	using uint8 = uint8_t;
 	using int16 = int16_t;
@@ -37,6 +89,8 @@ namespace SimpleRenderer
 	struct quaternion;
 	class Renderer;
 	struct Shader;
+	struct ShaderInputLayout;
+	class Resource;
 #pragma endregion
 
 #pragma region Constants
@@ -118,6 +172,35 @@ namespace SimpleRenderer
 		0b01000000, 0b00000100, 0b00000000, 0b00000000, 0b00000000, 0b00000000, 0b00000000, 0b00000000, 0b00000000, 0b01110000, 0b00000000, 0b00000000, 0b00000000, 0b00000000, 0b00000000, 0b11111110,
 		0b00000000, 0b00000000, 0b00000000, 0b00000000, 0b00000000, 0b00000000, 0b00000000, 0b00000000, 0b00000000, 0b00000000, 0b00000000, 0b00000000, 0b00000000, 0b00000000, 0b00000000, 0b00000000,
 	};
+	static constexpr uint32 kFontTextureGlyphRowCount = kFontTextureHeight / kFontTextureGlyphHeight;
+	// Characters in the order of their glyphs in the texture. A character listed twice keeps its first glyph.
+	static constexpr const byte kFontTextureGlyphRows[kFontTextureGlyphRowCount][kFontTextureGlyphCountInRow]
+	{
+		{ ' ','!','\"','$','#','%','&','\'','(',')','*','+',',','-','.','/' },
+		{ '0','1','2','3','4','5','6','7','8','9',':',';','<','=','>','?' },
+		{ '@','A','B','C','D','E','F','G','H','I','J','K','L','M','N','O' },
+		{ 'P','Q','R','S','T','U','V','W','X','Y','Z','[','\\',']','^','_' },
+		{ '`','a','b','c','d','e','f','g','h','i','j','k','l','m','n','o' },
+		{ 'p','q','r','s','t','u','v','w','x','y','z','(','|',')','~', 0 },
+	};
+
+	// kFontTextureRawBitData expanded to one byte per texel at compile time.
+	struct DefaultFontTexture
+	{
+		byte _texels[kFontTextureByteCount];
+	};
+	constexpr DefaultFontTexture make_DefaultFontTexture()
+	{
+		DefaultFontTexture result{};
+		for (uint32 iter = 0; iter < kFontTextureByteCount; ++iter)
+		{
+			const uint32 bitAt = iter % 8;
+			const uint32 byteAt = iter / 8;
+			result._texels[iter] = static_cast<byte>(((kFontTextureRawBitData[byteAt] >> (7 - bitAt)) & 1) * 255);
+		}
+		return result;
+	}
+	static constexpr DefaultFontTexture kDefaultFontTexture = make_DefaultFontTexture();
 #pragma endregion
 
 	struct float2
@@ -461,7 +544,42 @@ namespace SimpleRenderer
 	{
 		R8_UNORM,
 		R8G8B8A8_UNORM,
+		BC1_UNORM, // RGB, 8 bytes per 4x4 block
+		BC3_UNORM, // RGBA, 16 bytes per 4x4 block
+		BC4_UNORM, // R, 8 bytes per 4x4 block
+		BC7_UNORM, // RGBA, 16 bytes per 4x4 block
 	};
+	bool is_block_compressed(const TextureFormat& format);
+	// Only for uncompressed formats.
+	uint32 compute_texel_stride(const TextureFormat& format);
+	uint32 compute_row_pitch(const TextureFormat& format, const uint32 width);
+	uint32 compute_texture_byte_size(const TextureFormat& format, const uint32 width, const uint32 height);
+
+	struct TextureMipLevel
+	{
+		uint32 _width = 0;
+		uint32 _height = 0;
+		std::vector<byte> _bytes; // Rows are compute_row_pitch() bytes apart
+	};
+
+	struct TextureData
+	{
+		TextureFormat _format = TextureFormat::R8G8B8A8_UNORM;
+		std::vector<TextureMipLevel> _mipLevels;
+	};
+
+	enum class MipFilter
+	{
+		Box,
+		Kaiser, // Sharper than Box, at the cost of 6 taps per axis instead of 2
+	};
+
+	// Replaces mip levels 1 and up with a full chain filtered down from level 0. Only R8_UNORM and R8G8B8A8_UNORM are supported.
+	// When is_sRGB is true, color channels are filtered in linear space and alpha as is.
+	bool generate_mipmaps(TextureData& textureData, const MipFilter& filter, const bool is_sRGB);
+	// Compresses every mip level into blockFormat. The source must be R8G8B8A8_UNORM, or R8_UNORM for BC4.
+	bool compress_texture(const TextureData& source, const TextureFormat& blockFormat, TextureData& outCompressed);
+
 	enum class ResourceType
 	{
 		VertexBuffer,
@@ -483,6 +601,23 @@ namespace SimpleRenderer
 		float4x4 _projectionMatrix;
 	};
 
+	// One character of draw_text(). The vertex shader expands it into a quad and looks the UVs up in DEFAULT_FONT_CB_GLYPHS.
+	struct DEFAULT_FONT_GLYPH_INSTANCE
+	{
+		float2 _position; // Top-left, in pixels
+		uint32 _glyph; // The character
+		uint32 _color; // RGBA8, see pack_color_RGBA8()
+	};
+
+	struct DEFAULT_FONT_CB_GLYPHS
+	{
+		float4 _glyphUVs[256]; // u0, v0, u1, v1 for every character
+		float4 _glyphSize; // xy: in pixels
+	};
+
+	// R in the lowest byte, matching R8G8B8A8_UNORM.
+	uint32 pack_color_RGBA8(const Color& color);
+
 	const char kDefaultFontShaderHeaderCode[] =
 		R"(
         struct DEFAULT_FONT_VS_INPUT
@@ -519,6 +654,43 @@ namespace SimpleRenderer
         }
     )";
 
+	const char kDefaultFontGlyphVertexShaderCode[] =
+		R"(
+        #include "DefaultFontShaderHeader"
+    
+        cbuffer DEFAULT_CB_MATRICES : register(b0)
+        {
+            float4x4 g_cbProjectionMatrix;
+        };
+        cbuffer DEFAULT_FONT_CB_GLYPHS : register(b1)
+        {
+            float4 g_cbGlyphUVs[256];
+            float4 g_cbGlyphSize;
+        };
+
+        struct DEFAULT_FONT_GLYPH_INSTANCE
+        {
+            float2 position : POSITION0;
+            uint glyph : BLENDINDICES0;
+            float4 color : COLOR0;
+        };
+
+        static const float2 kCorners[6] = { float2(0, 0), float2(0, 1), float2(1, 1), float2(0, 0), float2(1, 1), float2(1, 0) };
+
+        VS_OUTPUT main(DEFAULT_FONT_GLYPH_INSTANCE input, uint vertexID : SV_VertexID)
+        {
+            const float2 corner = kCorners[vertexID];
+            const float4 uv = g_cbGlyphUVs[input.glyph & 255];
+
+            VS_OUTPUT output;
+            output.screenPosition = mul(float4(input.position + corner * g_cbGlyphSize.xy, 0.0, 1.0), g_cbProjectionMatrix);
+            output.screenPosition /= output.screenPosition.w;
+            output.color = input.color;
+            output.texcoord = float4(lerp(uv.xy, uv.zw, corner), 0.0, 0.0);
+            return output;
+        }
+    )";
+
 	const char kDefaultFontPixelShaderCode[] =
 		R"(
         #include "DefaultFontShaderHeader"
@@ -536,8 +708,8 @@ namespace SimpleRenderer
 
 	struct DefaultFontGlyphMeta
 	{
-		DefaultFontGlyphMeta() :DefaultFontGlyphMeta(0, 0, 0, 1, 1) { __noop; }
-		DefaultFontGlyphMeta(byte ch, float u0, float v0, float u1, float v1) : _ch{ ch }, _u0{ u0 }, _v0{ v0 }, _u1{ u1 }, _v1{ v1 } { __noop; }
+		constexpr DefaultFontGlyphMeta() :DefaultFontGlyphMeta(0, 0, 0, 1, 1) { __noop; }
+		constexpr DefaultFontGlyphMeta(byte ch, float u0, float v0, float u1, float v1) : _ch{ ch }, _u0{ u0 }, _v0{ v0 }, _u1{ u1 }, _v1{ v1 } { __noop; }
 
 		byte _ch;
 		float _u0;
@@ -546,18 +718,220 @@ namespace SimpleRenderer
 		float _v1;
 	};
 
+	// Glyphs of all 256 byte values, built at compile time so a lookup is one indexed load.
+	// Bytes without a glyph in the texture use the glyph of 0.
 	class DefaultFontData
 	{
 	public:
-		void push_glyph(const DefaultFontGlyphMeta& glyphMeta);
-		const DefaultFontGlyphMeta& get_GlyphMeta(const byte& ch) const;
+		constexpr DefaultFontData() : _glyphMetas{}
+		{
+			constexpr float glyphTextureUnit_U = static_cast<float>(kFontTextureGlyphWidth) / kFontTextureWidth;
+			constexpr float glyphTextureUnit_V = static_cast<float>(kFontTextureGlyphHeight) / kFontTextureHeight;
+			bool is_assigned[256]{};
+			for (uint32 rowIndex = 0; rowIndex < kFontTextureGlyphRowCount; ++rowIndex)
+			{
+				const float v0 = glyphTextureUnit_V * rowIndex;
+				const float v1 = v0 + glyphTextureUnit_V;
+				for (uint32 iter = 0; iter < kFontTextureGlyphCountInRow; ++iter)
+				{
+					const byte ch = kFontTextureGlyphRows[rowIndex][iter];
+					if (is_assigned[ch] == false)
+					{
+						_glyphMetas[ch] = DefaultFontGlyphMeta(ch, glyphTextureUnit_U * iter, v0, glyphTextureUnit_U * (iter + 1), v1);
+						is_assigned[ch] = true;
+					}
+				}
+			}
+			for (uint32 ch = 0; ch < 256; ++ch)
+			{
+				if (is_assigned[ch] == false)
+				{
+					_glyphMetas[ch] = _glyphMetas[0];
+				}
+			}
+		}
+
+	public:
+		constexpr const DefaultFontGlyphMeta& get_GlyphMeta(const byte ch) const { return _glyphMetas[ch]; }
+
+	private:
+		DefaultFontGlyphMeta _glyphMetas[256];
+	};
+	static constexpr DefaultFontData kDefaultFontData;
+
+	// Writes 4 vertices per character, in the same layout as MeshGenerator::push_2D_rectangle().
+	void write_default_font_quads(const Color& color, const char* const text, const uint32 textLength, const float2& position, const float2& scale, DEFAULT_FONT_VS_INPUT* const outVertices);
+
+	// Builds a label in a fixed stack buffer, so per-frame text like "fps: 60" costs no heap allocation.
+	// Text beyond kCapacity characters is dropped.
+	class TextFormatter
+	{
+	public:
+		static constexpr uint32 kCapacity = 255;
+
+	public:
+		TextFormatter() { _buffer[0] = 0; }
+
+	public:
+		TextFormatter& append(const std::string_view text)
+		{
+			const uint32 copyLength = (std::min)(static_cast<uint32>(text.size()), kCapacity - _length);
+			::memcpy(_buffer + _length, text.data(), copyLength);
+			_length += copyLength;
+			_buffer[_length] = 0;
+			return *this;
+		}
+		TextFormatter& append(const char ch) { return append(std::string_view(&ch, 1)); }
+		TextFormatter& append(const int64 value) { return __append_chars(std::to_chars(_buffer + _length, _buffer + kCapacity, value)); }
+		TextFormatter& append(const uint64 value) { return __append_chars(std::to_chars(_buffer + _length, _buffer + kCapacity, value)); }
+		TextFormatter& append(const int32 value) { return append(static_cast<int64>(value)); }
+		TextFormatter& append(const uint32 value) { return append(static_cast<uint64>(value)); }
+		TextFormatter& append(const double value, const int32 precision = 3) { return __append_chars(std::to_chars(_buffer + _length, _buffer + kCapacity, value, std::chars_format::fixed, precision)); }
+		template<typename T>
+		TextFormatter& operator<<(const T& value) { return append(value); }
+		void clear() { _length = 0; _buffer[0] = 0; }
+
+	public:
+		std::string_view get_view() const { return std::string_view(_buffer, _length); }
+		const char* c_str() const { return _buffer; }
+		uint32 length() const { return _length; }
+
+	private:
+		TextFormatter& __append_chars(const std::to_chars_result result)
+		{
+			if (result.ec == std::errc())
+			{
+				_length = static_cast<uint32>(result.ptr - _buffer);
+			}
+			_buffer[_length] = 0;
+			return *this;
+		}
+
+	private:
+		char _buffer[kCapacity + 1];
+		uint32 _length = 0;
+	};
+
+	enum class TextAlignment
+	{
+		Left,
+		Center,
+		Right,
+	};
+
+	// Where and how draw_text() lays a text out. Sizes are in pixels and y grows downwards.
+	struct TextLayout
+	{
+		float2 _position; // Top-left of the first line, or its top-center / top-right depending on _alignment
+		float _wrapWidth = 0.0f; // Lines are word-wrapped to this width; 0 breaks only at '\n'
+		TextAlignment _alignment = TextAlignment::Left; // Within _wrapWidth when wrapping, around _position.x otherwise
+		float _lineSpacing = 0.0f; // Added between lines
+		bool _is_clipped = false;
+		float2 _clipMin; // Glyphs entirely outside [_clipMin, _clipMax) are culled; glyphs crossing the edge are kept whole
+		float2 _clipMax;
+	};
+
+	struct TextLine
+	{
+		uint32 _offset = 0;
+		uint32 _length = 0;
+	};
+
+	// Splits monospaced text into lines at '\n' and, when maxCharCount is not 0, at the last space that keeps a line
+	// within maxCharCount characters. Words longer than a line are broken. Spaces at wrap points are dropped, including
+	// spaces at the start of a line that wraps before its first word.
+	class TextLineBreaker
+	{
+	public:
+		TextLineBreaker(const std::string_view text, const uint32 maxCharCount) : _text{ text }, _maxCharCount{ maxCharCount } { __noop; }
+
+	public:
+		bool next(TextLine& outLine);
+
+	private:
+		std::string_view _text;
+		uint32 _maxCharCount = 0;
+		uint32 _at = 0;
+	};
+
+	// Size of the laid out text in pixels, for a monospaced font with glyphs of glyphSize.
+	float2 measure_text(const std::string_view text, const float2& glyphSize, const float wrapWidth = 0.0f, const float lineSpacing = 0.0f);
+	// Appends one glyph instance per visible, non-space character. Lines below the clip rectangle end the layout,
+	// so only the visible part of a long text costs anything beyond finding line breaks.
+	void layout_text(const std::string_view text, const TextLayout& layout, const float2& glyphSize, const uint32 packedColor, std::vector<DEFAULT_FONT_GLYPH_INSTANCE>& outGlyphInstances);
+
+	// Handle of a retained text, see TextRunBuffer.
+	struct TextRun
+	{
+		bool is_valid() const { return _id != UINT32_MAX; }
+
+		uint32 _id = UINT32_MAX;
+	};
+
+	struct TextRunUpdateRange
+	{
+		uint32 _vertexOffset = 0;
+		uint32 _vertexCount = 0;
+	};
+
+	// Changes of a TextRunBuffer since the last collect_updates(), ready to be applied to the GPU copy.
+	struct TextRunUpdate
+	{
+		void clear() { _ranges.clear(); _vertices.clear(); }
+
+		uint32 _vertexCapacity = 0; // The GPU buffer must hold at least this many vertices; it is fully rewritten when this grows
+		uint32 _drawVertexCount = 0;
+		std::vector<TextRunUpdateRange> _ranges;
+		std::vector<DEFAULT_FONT_VS_INPUT> _vertices; // The vertices of all ranges, back to back
+	};
+
+	// Retained text. Each TextRun owns a region of one persistent vertex stream and its quads are rebuilt only when
+	// its text, color or position changes, so per-frame cost is proportional to the text that changed.
+	// Unused characters of a region are degenerate quads, which lets the whole stream be drawn with one call.
+	class TextRunBuffer
+	{
+	public:
+		TextRun create(const uint32 maxCharCount);
+		void destroy(TextRun& textRun);
+		// Returns true if the quads were rebuilt. Text longer than the region moves the run to a bigger region.
+		bool update(const TextRun& textRun, const Color& color, const std::string_view text, const float2& position, const float2& scale);
+		void collect_updates(TextRunUpdate& outUpdate);
+
+	private:
+		struct Region
+		{
+			uint32 _vertexOffset = 0;
+			uint32 _charCapacity = 0;
+		};
+		struct Entry
+		{
+			Region _region;
+			uint32 _charCount = 0;
+			std::string _text;
+			Color _color;
+			float2 _position;
+			float2 _scale;
+			bool _is_alive = false;
+		};
 
 	private:
-		std::vector<DefaultFontGlyphMeta> _glyphMetas;
-		std::unordered_map<byte, uint64> _glyphMap;
+		Region allocate_region(const uint32 charCapacity);
+		void release_region(const Region& region);
+		void mark_dirty(const uint32 vertexOffset, const uint32 vertexCount);
+
+	private:
+		std::vector<Entry> _entries;
+		std::vector<uint32> _freeEntryIDs;
+		std::vector<Region> _freeRegions;
+		std::vector<DEFAULT_FONT_VS_INPUT> _vertices;
+		std::vector<TextRunUpdateRange> _dirtyRanges;
+		uint32 _uploadedVertexCapacity = 0;
 	};
 
-	struct ShaderHeaderSet : public ID3DInclude
+	struct ShaderHeaderSet
+#if defined(_WIN32)
+		: public ID3DInclude
+#endif
 	{
 	public:
 		ShaderHeaderSet() = default;
@@ -565,16 +939,227 @@ namespace SimpleRenderer
 
 	public:
 		void push_shader_header(const std::string& headerName, const std::string& headerCode);
+		const std::string* find_shader_header(const char* const headerName) const;
 
+#if defined(_WIN32)
 	public:
 		virtual HRESULT WINAPI Open(D3D_INCLUDE_TYPE IncludeType, LPCSTR pFileName, LPCVOID pParentData, LPCVOID* ppData, UINT* pBytes) override final;
 		virtual HRESULT WINAPI Close(LPCVOID pData) override final { return S_OK; }
+#endif
 
 	public:
 		std::vector<std::string> _headerNames;
 		std::vector<std::string> _headerCodes;
+
+	private:
+		std::unordered_map<uint64, uint32> _headerIndexMap; // hash of the name -> index
+	};
+
+	// Feature keywords of one shader source. A variant key has bit i set when the i-th keyword is enabled,
+	// and its source is the original source prefixed with '#define <keyword> 1' for each enabled keyword.
+	class ShaderKeywordSet
+	{
+	public:
+		static constexpr uint32 kMaxKeywordCount = 64;
+
+	public:
+		bool push_keyword(const char* const keyword);
+		uint64 get_keyword_mask(const char* const keyword) const;
+		uint64 make_key(const std::initializer_list<const char*>& enabledKeywords) const;
+		std::string make_variant_source(const char* const sourceCode, const uint64 key) const;
+		uint32 get_keyword_count() const { return static_cast<uint32>(_keywords.size()); }
+
+	private:
+		std::vector<std::string> _keywords;
+	};
+
+	struct ShaderCompileRequest
+	{
+		const char* _sourceCode = nullptr;
+		const char* _identifier = nullptr;
+		const char* _entryPoint = nullptr;
+		const char* _target = nullptr;
+		uint32 _flags = 0;
+		const ShaderHeaderSet* _shaderHeaderSet = nullptr;
+	};
+
+	struct ShaderCompileResult
+	{
+		std::vector<byte> _bytecode;
+		std::string _errorMessage;
+		bool _is_succeeded = false;
+		bool _is_from_cache = false;
+	};
+
+	// Turns HLSL into bytecode. D3DShaderCompiler on Windows; anything else (e.g. a mock) elsewhere.
+	class ShaderCompiler
+	{
+	public:
+		virtual ~ShaderCompiler() = default;
+
+	public:
+		// Must be safe to call from several threads at once.
+		virtual bool compile(const ShaderCompileRequest& request, std::vector<byte>& outBytecode, std::string& outErrorMessage) = 0;
+	};
+
+	// On-disk shader bytecode, one file per content hash of everything that affects the compiled output.
+	class ShaderCache
+	{
+	public:
+		static constexpr uint32 kFileMagic = 0x43535253; // "SRSC"
+		static constexpr uint32 kFileVersion = 1;
+
+	private:
+		struct FileHeader
+		{
+			uint32 _magic = kFileMagic;
+			uint32 _version = kFileVersion;
+			uint64 _key = 0;
+			uint64 _byteSize = 0;
+		};
+
+	public:
+		ShaderCache() = default;
+		explicit ShaderCache(const std::string& directory) : _directory{ directory } { __noop; }
+		ShaderCache(const ShaderCache&) = delete;
+
+	public:
+		// Hashes the source, every header it includes (recursively, as resolved by the ShaderHeaderSet), the entry point, the target and the flags.
+		static uint64 compute_key(const ShaderCompileRequest& request);
+
+	public:
+		void set_directory(const std::string& directory) { _directory = directory; }
+		const std::string& get_directory() const { return _directory; }
+		bool load(const uint64 key, std::vector<byte>& outBytecode) const;
+		bool store(const uint64 key, const std::vector<byte>& bytecode) const;
+		uint64 get_hit_count() const { return _hitCount.load(std::memory_order_relaxed); }
+		uint64 get_miss_count() const { return _missCount.load(std::memory_order_relaxed); }
+
+	private:
+		std::string make_file_path(const uint64 key) const;
+		static void hash_includes(const std::string& code, const ShaderHeaderSet* const shaderHeaderSet, std::vector<const std::string*>& visitedHeaders, uint64& hash);
+
+	private:
+		std::string _directory;
+		mutable std::atomic<uint64> _hitCount{ 0 };
+		mutable std::atomic<uint64> _missCount{ 0 };
+	};
+
+	uint64 compute_hash_FNV1a(const void* const data, const size_t byteSize, const uint64 seed = 14695981039346656037ull);
+	inline uint64 compute_hash_FNV1a(const char* const string) { return compute_hash_FNV1a(string, ::strlen(string)); }
+
+	// value must not be 0.
+	inline uint32 count_trailing_zeros(const uint64 value)
+	{
+#if defined(_MSC_VER) && defined(_M_X64)
+		unsigned long index = 0;
+		_BitScanForward64(&index, value);
+		return static_cast<uint32>(index);
+#elif defined(_MSC_VER)
+		unsigned long index = 0;
+		if (_BitScanForward(&index, static_cast<unsigned long>(value)) != 0)
+		{
+			return static_cast<uint32>(index);
+		}
+		_BitScanForward(&index, static_cast<unsigned long>(value >> 32));
+		return static_cast<uint32>(index) + 32;
+#else
+		return static_cast<uint32>(__builtin_ctzll(value));
+#endif
+	}
+
+	// Calls function(index) for every index in [0, count) on all hardware threads, the calling thread included.
+	// The other threads belong to ParallelForPool, so a call wakes them instead of creating and joining threads.
+	void parallel_for(const uint32 count, const std::function<void(const uint32 index)>& function);
+
+	// The threads behind parallel_for(), started on first use. A job is queued once per helper it wants; the caller runs
+	// the job too and takes back the copies no helper picked up, so nested and concurrent parallel_for() calls cannot
+	// deadlock.
+	class ParallelForPool
+	{
+	public:
+		struct Job
+		{
+			const std::function<void(const uint32 index)>* _function = nullptr;
+			uint32 _count = 0;
+			std::atomic<uint32> _nextIndex{ 0 };
+			uint32 _runningHelperCount = 0; // Guarded by the pool mutex.
+
+			void run()
+			{
+				for (uint32 index = _nextIndex.fetch_add(1); index < _count; index = _nextIndex.fetch_add(1))
+				{
+					(*_function)(index);
+				}
+			}
+		};
+
+	public:
+		static ParallelForPool& get_instance();
+
+	public:
+		ParallelForPool(const ParallelForPool&) = delete;
+		~ParallelForPool();
+
+	public:
+		uint32 get_helper_count() const { return static_cast<uint32>(_threads.size()); }
+		// Runs job on the calling thread and up to helperCount pool threads, and returns once all of them are done with it.
+		void run(Job& job, const uint32 helperCount);
+
+	private:
+		ParallelForPool();
+		void run_helper();
+
+	private:
+		std::vector<std::thread> _threads;
+		std::mutex _mutex;
+		std::condition_variable _jobCondition;
+		std::condition_variable _doneCondition;
+		std::deque<Job*> _jobs;
+		bool _is_stopping = false;
+	};
+
+	// Compiles all requests in parallel, going through the cache first when one is given. results must hold count elements.
+	void compile_shaders(ShaderCompiler& compiler, const ShaderCache* const shaderCache, const ShaderCompileRequest* const requests, ShaderCompileResult* const results, const uint32 count);
+
+	struct ShaderVariantCompileResult
+	{
+		uint64 _key = 0;
+		ShaderCompileResult _result;
+	};
+
+	// The platform-independent bookkeeping of ShaderVariantSet: makes the source of each variant, compiles it to bytecode
+	// and remembers which variants compiled and which failed, so a failed variant is reported and compiled only once.
+	class ShaderVariantTable
+	{
+	public:
+		void create(const char* sourceCode, const char* shaderIdentifier, const char* entryPoint, const char* target, const uint32 flags, const ShaderHeaderSet* const shaderHeaderSet, const std::initializer_list<const char*>& keywords);
+		uint64 make_key(const std::initializer_list<const char*>& enabledKeywords) const { return _keywordSet.make_key(enabledKeywords); }
+		// Compiles every key that neither compiled nor failed before, in parallel, and appends one result per key compiled now.
+		// Returns false if any of keys failed, now or before.
+		bool compile_variants(ShaderCompiler& compiler, const ShaderCache* const shaderCache, const uint64* const keys, const uint32 keyCount, std::vector<ShaderVariantCompileResult>& outResults);
+		// For a variant whose bytecode could not be used, e.g. because the device rejected it.
+		void mark_failed(const uint64 key) { _compiledKeys.erase(key); _failedKeys.insert(key); }
+
+	public:
+		bool is_compiled(const uint64 key) const { return _compiledKeys.find(key) != _compiledKeys.end(); }
+		bool is_failed(const uint64 key) const { return _failedKeys.find(key) != _failedKeys.end(); }
+		const ShaderKeywordSet& get_keyword_set() const { return _keywordSet; }
+
+	private:
+		std::string _sourceCode;
+		std::string _identifier;
+		std::string _entryPoint;
+		std::string _target;
+		uint32 _flags = 0;
+		const ShaderHeaderSet* _shaderHeaderSet = nullptr;
+		ShaderKeywordSet _keywordSet;
+		std::unordered_set<uint64> _compiledKeys;
+		std::unordered_set<uint64> _failedKeys;
 	};
 
+#if defined(_WIN32)
+
 	struct ShaderInputLayout
 	{
 		struct InputElement
@@ -591,6 +1176,16 @@ namespace SimpleRenderer
 		static InputElement create_InputElement_float3(const char* const semanticName, const uint32 semanticIndex) { return __create_InputElement_common(DXGI_FORMAT_R32G32B32_FLOAT, semanticName, semanticIndex); }
 		static InputElement create_InputElement_float2(const char* const semanticName, const uint32 semanticIndex) { return __create_InputElement_common(DXGI_FORMAT_R32G32_FLOAT, semanticName, semanticIndex); }
 		static InputElement create_InputElement_float(const char* const semanticName, const uint32 semanticIndex) { return __create_InputElement_common(DXGI_FORMAT_R32_FLOAT, semanticName, semanticIndex); }
+		static InputElement create_InputElement_uint(const char* const semanticName, const uint32 semanticIndex) { return __create_InputElement_common(DXGI_FORMAT_R32_UINT, semanticName, semanticIndex); }
+		// 4 bytes in memory, read as float4 in [0, 1] by the shader.
+		static InputElement create_InputElement_unorm4x8(const char* const semanticName, const uint32 semanticIndex) { return __create_InputElement_common(DXGI_FORMAT_R8G8B8A8_UNORM, semanticName, semanticIndex); }
+		// Makes the element advance once per instance instead of once per vertex.
+		static InputElement make_per_instance(InputElement inputElement, const uint32 instanceStepRate = 1)
+		{
+			inputElement._inputSlotClass = D3D11_INPUT_CLASSIFICATION::D3D11_INPUT_PER_INSTANCE_DATA;
+			inputElement._instanceStepRate = instanceStepRate;
+			return inputElement;
+		}
 
 		void clear_InputElements();
 		void push_InputElement(const InputElement& newInputElement);
@@ -618,6 +1213,8 @@ namespace SimpleRenderer
 			case DXGI_FORMAT_R32G32_FLOAT:
 				return 8;
 			case DXGI_FORMAT_R32_FLOAT:
+			case DXGI_FORMAT_R32_UINT:
+			case DXGI_FORMAT_R8G8B8A8_UNORM:
 				return 4;
 			default:
 				break;
@@ -634,9 +1231,23 @@ namespace SimpleRenderer
 		uint32 _inputTotalByteSize = 0;
 	};
 
+#if defined(_DEBUG)
+	constexpr uint32 kShaderCompileFlags = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
+#else
+	constexpr uint32 kShaderCompileFlags = D3DCOMPILE_OPTIMIZATION_LEVEL3;
+#endif
+
+	class D3DShaderCompiler final : public ShaderCompiler
+	{
+	public:
+		virtual bool compile(const ShaderCompileRequest& request, std::vector<byte>& outBytecode, std::string& outErrorMessage) override final;
+	};
+
 	struct Shader
 	{
+		// Compiles through the Renderer's ShaderCache. Use ShaderCompileBatch to compile several shaders in parallel.
 		bool create(Renderer& renderer, const char* sourceCode, const ShaderType& shaderType, const char* shaderIdentifier, const char* entryPoint, const char* target, ShaderHeaderSet* const shaderHeaderSet = nullptr);
+		bool create_from_bytecode(Renderer& renderer, const ShaderType& shaderType, const std::vector<byte>& bytecode);
 
 		ShaderType _type = ShaderType::VertexShader;
 		ComPtr<ID3D10Blob> _shaderBlob;
@@ -644,6 +1255,36 @@ namespace SimpleRenderer
 		ComPtr<ID3D11DeviceChild> _shader;
 	};
 
+	class ShaderCompileBatch
+	{
+	public:
+		void push(Shader& shader, const char* sourceCode, const ShaderType& shaderType, const char* shaderIdentifier, const char* entryPoint, const char* target, ShaderHeaderSet* const shaderHeaderSet = nullptr);
+		// Compiles every pushed shader in parallel (cache hits skip compilation), then creates them on the device.
+		bool compile(Renderer& renderer);
+
+	private:
+		std::vector<Shader*> _shaders;
+		std::vector<ShaderType> _shaderTypes;
+		std::vector<ShaderCompileRequest> _requests;
+	};
+
+	// All variants of one shader source. Variants compile on first use, or ahead of time with compile_variants().
+	class ShaderVariantSet
+	{
+	public:
+		void create(const char* sourceCode, const ShaderType& shaderType, const char* shaderIdentifier, const char* entryPoint, const char* target, ShaderHeaderSet* const shaderHeaderSet, const std::initializer_list<const char*>& keywords);
+		uint64 make_key(const std::initializer_list<const char*>& enabledKeywords) const { return _variantTable.make_key(enabledKeywords); }
+		// Returns nullptr if the variant fails to compile. A failure is remembered, so it is reported and compiled only once.
+		Shader* get_variant(Renderer& renderer, const uint64 key);
+		// Compiles every variant that does not exist yet, in parallel. Returns false if any of keys failed, now or before.
+		bool compile_variants(Renderer& renderer, const std::initializer_list<uint64>& keys);
+
+	private:
+		ShaderType _shaderType = ShaderType::VertexShader;
+		ShaderVariantTable _variantTable;
+		std::unordered_map<uint64, Shader> _variants;
+	};
+
 	// Buffer or Texture
 	class Resource
 	{
@@ -656,9 +1297,16 @@ namespace SimpleRenderer
 		~Resource() = default;
 
 	public:
+		// resourceContent may be nullptr to leave the texture uninitialized.
 		bool create_texture2D(Renderer& renderer, const TextureFormat& format, const void* const resourceContent, const uint32 width, const uint32 height);
-		bool create_buffer(Renderer& renderer, const ResourceType& type, const void* const content, const uint32 elementStride, const uint32 elementCount);
+		// Creates a texture with every mip level of textureData. Block-compressed textures need a width and height that are multiples of 4.
+		bool create_texture2D(Renderer& renderer, const TextureData& textureData);
+		// Uploads a sub-rectangle of a texture created by create_texture2D(). rowPitch is the byte count between rows of content.
+		bool update_texture2D(Renderer& renderer, const void* const content, const uint32 rowPitch, const uint32 x, const uint32 y, const uint32 width, const uint32 height);
+		// Buffers that are not CPU writable live in GPU memory and can only be changed with update_region().
+		bool create_buffer(Renderer& renderer, const ResourceType& type, const void* const content, const uint32 elementStride, const uint32 elementCount, const bool is_CPU_writable = true);
 		bool update(Renderer& renderer, const void* const content, const uint32 elementStride, const uint32 elementCount);
+		bool update_region(Renderer& renderer, const void* const content, const uint32 elementOffset, const uint32 elementCount);
 
 	private:
 		static DXGI_FORMAT __convert_to_DXGI_FORMAT(const TextureFormat& format);
@@ -675,23 +1323,407 @@ namespace SimpleRenderer
 		uint32 _elementStride;
 		uint32 _elementMaxCount;
 		uint32 _width;
+		bool _is_CPU_writable = true;
 
 	private:
 		ComPtr<ID3D11Resource> _resource;
 		ComPtr<ID3D11View> _view; // Only used for Texture and StructuredBuffer
 	};
 
-	template<typename Vertex>
-	class MeshGenerator
+#endif
+
+	struct AtlasRect
+	{
+		uint32 _x = 0;
+		uint32 _y = 0;
+		uint32 _width = 0;
+		uint32 _height = 0;
+	};
+
+	struct AtlasRegion
+	{
+		bool is_valid() const { return _rect._width > 0 && _rect._height > 0; }
+
+		AtlasRect _rect; // In texels, without padding
+		float2 _uvMin;
+		float2 _uvMax;
+	};
+
+	// Skyline bottom-left packer. Released rectangles go to a free list which is searched (best area fit) before the skyline,
+	// and the unused part of a reused rectangle is split guillotine-style back into the free list.
+	// Gaps left under a rectangle resting on an uneven skyline go to the free list too. Free rectangles sharing a whole edge
+	// are merged, and a free rectangle right under the skyline lowers the skyline instead, so churn does not fragment the
+	// atlas for good. Releasing everything resets the packer.
+	class SkylinePacker
 	{
 	public:
-		static void push_3D_triangle(const Color& color, const float4& a, const float4& b, const float4& c, std::vector<Vertex>& vertices, std::vector<uint32>& indices)
-		{
-			const uint64 vertexBase = vertices.size();
-			vertices.resize(vertexBase + 3);
+		void init(const uint32 width, const uint32 height);
+		bool allocate(const uint32 width, const uint32 height, AtlasRect& outRect);
+		// Allocates exactly rect, which must not overlap any allocated rectangle.
+		bool allocate_at(const AtlasRect& rect);
+		void release(const AtlasRect& rect);
+		uint32 get_width() const { return _width; }
+		uint32 get_height() const { return _height; }
+		uint64 get_used_area() const { return _usedArea; }
 
-			const uint64 indexBase = indices.size();
-			indices.reserve(indexBase + 3);
+	private:
+		bool allocate_from_free_rects(const uint32 width, const uint32 height, AtlasRect& outRect);
+		bool allocate_from_skyline(const uint32 width, const uint32 height, AtlasRect& outRect);
+		// Returns the y at which a width-wide rectangle rests when placed at the start of the node, or false if it does not fit.
+		bool fit_skyline(const uint32 nodeIndex, const uint32 width, const uint32 height, uint32& outY) const;
+		// Merges rect into the free list, or into the skyline if it lies right under it.
+		void add_free_rect(const AtlasRect& rect);
+		// Lowers the skyline over a free rectangle whose top edge lies on the skyline, or returns false.
+		bool return_to_skyline(const AtlasRect& rect);
+		void split_skyline_at(const uint32 x);
+		void merge_skyline();
+		// Grows inoutRect by rect if the two share a whole edge.
+		static bool merge_rects(AtlasRect& inoutRect, const AtlasRect& rect);
+
+	private:
+		struct SkylineNode
+		{
+			uint32 _x;
+			uint32 _y;
+			uint32 _width;
+		};
+
+	private:
+		uint32 _width = 0;
+		uint32 _height = 0;
+		uint64 _usedArea = 0;
+		std::vector<SkylineNode> _skyline;
+		std::vector<AtlasRect> _freeRects;
+		std::vector<AtlasRect> _gapRects;
+	};
+
+	// Texture updates recorded on the game thread and applied by the render thread, e.g. in execute_FramePacket(). The texels
+	// are copies, so the game thread may keep changing its atlas while the batch is in flight.
+	struct TextureUploadBatch
+	{
+		struct Upload
+		{
+			Resource* _texture = nullptr;
+			AtlasRect _rect;
+			uint32 _rowPitch = 0;
+			size_t _texelOffset = 0;
+		};
+
+		void clear() { _uploads.clear(); _texels.clear(); }
+
+		std::vector<Upload> _uploads;
+		std::vector<byte> _texels;
+	};
+
+	// A texture shared by many small images. Texels are written into a CPU-side mirror first and only the dirty rectangles
+	// are uploaded on flush(), so the atlas also works without a device (software/headless path).
+	class TextureAtlas
+	{
+	public:
+		static constexpr uint32 kMaxDirtyRectCount = 32;
+
+	public:
+		void init(const TextureFormat& format, const uint32 width, const uint32 height, const uint32 padding = 1);
+		// Returns an invalid region if the atlas is full.
+		AtlasRegion allocate(const uint32 width, const uint32 height);
+		// Allocates exactly rect (without padding); rect and its padding must be free. Returns an invalid region otherwise.
+		AtlasRegion allocate_at(const AtlasRect& rect);
+		void release(const AtlasRegion& region);
+		// content is tightly packed unless rowPitch is given.
+		void write(const AtlasRegion& region, const void* const content, uint32 rowPitch = 0);
+		void clear();
+
+	public:
+		const std::vector<byte>& get_texels() const { return _texels; }
+		const std::vector<AtlasRect>& get_dirty_rects() const { return _dirtyRects; }
+		void clear_dirty_rects() { _dirtyRects.clear(); }
+		const SkylinePacker& get_packer() const { return _packer; }
+		TextureFormat get_format() const { return _format; }
+		uint32 get_texel_stride() const { return _texelStride; }
+		uint32 get_padding() const { return _padding; }
+		uint32 get_width() const { return _packer.get_width(); }
+		uint32 get_height() const { return _packer.get_height(); }
+
+#if defined(_WIN32)
+	public:
+		bool create_texture(Renderer& renderer);
+		// Uploads dirty rectangles of the mirror to the texture.
+		bool flush(Renderer& renderer);
+		// Render thread mode: copies dirty rectangles into outUploads instead of touching the device context, which belongs
+		// to the render thread. Only the first call creates the texture, which the device allows from any thread.
+		bool flush(Renderer& renderer, TextureUploadBatch& outUploads);
+		Resource& get_texture() { return _texture; }
+#endif
+
+	private:
+		AtlasRegion make_region(const AtlasRect& paddedRect) const;
+		void mark_dirty(const AtlasRect& rect);
+
+	private:
+		SkylinePacker _packer;
+		TextureFormat _format = TextureFormat::R8G8B8A8_UNORM;
+		uint32 _texelStride = 0;
+		uint32 _padding = 0;
+		std::vector<byte> _texels;
+		std::vector<AtlasRect> _dirtyRects;
+#if defined(_WIN32)
+		Resource _texture;
+#endif
+	};
+
+	enum class BlendMode
+	{
+		Alpha,
+		Additive,
+		Opaque,
+	};
+	constexpr uint32 kBlendModeCount = 3;
+
+	struct Sprite
+	{
+		void set_AtlasRegion(const AtlasRegion& region) { _uvMin = region._uvMin; _uvMax = region._uvMax; }
+
+		float2 _position; // Center, in pixels
+		float2 _size = float2(1, 1);
+		float _rotationAngle = 0.0f;
+		Color _color = Color(1, 1, 1, 1);
+		float2 _uvMin = float2(0, 0);
+		float2 _uvMax = float2(1, 1);
+	};
+
+	// One sprite as the vertex shader reads it. The quad corners are generated from SV_VertexID, so there is no per-vertex data.
+	struct alignas(float) SPRITE_INSTANCE
+	{
+		float4 _positionAndSize;
+		float4 _uvRect;
+		float4 _color;
+		float2 _rotation; // cos, sin
+	};
+
+	struct SpriteBatchRun
+	{
+		const Resource* _texture = nullptr;
+		BlendMode _blendMode = BlendMode::Alpha;
+		uint32 _instanceOffset = 0;
+		uint32 _instanceCount = 0;
+	};
+
+	// Collects sprites into one instance stream. Consecutive sprites sharing a texture and a blend mode form one run,
+	// and each run is one instanced draw call, so submitting sprites grouped by state keeps the draw call count low.
+	class SpriteBatch
+	{
+	public:
+		void push(const Resource* const texture, const BlendMode blendMode, const Sprite* const sprites, const uint32 spriteCount);
+		void clear() { _instances.clear(); _runs.clear(); }
+		bool is_empty() const { return _instances.empty(); }
+		const std::vector<SPRITE_INSTANCE>& get_instances() const { return _instances; }
+		const std::vector<SpriteBatchRun>& get_runs() const { return _runs; }
+
+	private:
+		std::vector<SPRITE_INSTANCE> _instances;
+		std::vector<SpriteBatchRun> _runs;
+	};
+
+	// Returns the code point at 'at' and advances it; malformed sequences yield U+FFFD and skip one byte.
+	uint32 decode_UTF8(const char*& at, const char* const end);
+
+	// Coverage of one glyph, one byte per texel.
+	struct GlyphBitmap
+	{
+		uint32 _width = 0;
+		uint32 _height = 0;
+		float2 _offset; // From the pen position to the top-left of the bitmap, in texels
+		float _advance = 0.0f; // In texels
+		std::vector<byte> _coverage;
+	};
+
+	// Fills outBitmap for codepoint, or returns false if the font has no such glyph.
+	using GlyphRasterizer = std::function<bool(const uint32 codepoint, GlyphBitmap& outBitmap)>;
+
+	// Rasterizes the ASCII glyphs of the default font.
+	bool rasterize_default_font_glyph(const uint32 codepoint, GlyphBitmap& outBitmap);
+
+	// A loaded bitmap font laid out as a grid of equal cells, in code point order starting at _firstCodepoint.
+	class BitmapFontSource
+	{
+	public:
+		// coverage is width * height bytes and is copied.
+		void init(const byte* const coverage, const uint32 width, const uint32 height, const uint32 cellWidth, const uint32 cellHeight, const uint32 firstCodepoint);
+		bool rasterize(const uint32 codepoint, GlyphBitmap& outBitmap) const;
+		GlyphRasterizer make_rasterizer() const { return [this](const uint32 codepoint, GlyphBitmap& outBitmap) { return rasterize(codepoint, outBitmap); }; }
+
+	private:
+		std::vector<byte> _coverage;
+		uint32 _width = 0;
+		uint32 _height = 0;
+		uint32 _cellWidth = 0;
+		uint32 _cellHeight = 0;
+		uint32 _firstCodepoint = 0;
+	};
+
+	struct CachedGlyph
+	{
+		AtlasRegion _region;
+		float2 _size; // In texels
+		float2 _offset;
+		float _advance = 0.0f;
+	};
+
+	struct GlyphCacheStatistics
+	{
+		float get_hit_rate() const { const uint64 total = _hitCount + _missCount; return (total == 0 ? 1.0f : static_cast<float>(_hitCount) / static_cast<float>(total)); }
+
+		uint64 _hitCount = 0;
+		uint64 _missCount = 0;
+		uint64 _evictionCount = 0;
+		uint64 _failureCount = 0; // Missing glyphs, and glyphs there was no room for even after evicting the unpinned ones
+		uint32 _glyphCount = 0;
+	};
+
+	// Glyphs rasterized on demand into one fixed-size atlas, so memory stays bounded by the atlas no matter how
+	// many distinct characters are drawn. When the atlas is full the least recently used glyphs in the way of the new one
+	// are evicted, except glyphs used since the last flush(), whose texels may still be referenced by queued draws.
+	// Texels are RGBA8 white with coverage in alpha, so glyphs can be drawn through the sprite batch.
+	class GlyphCache
+	{
+	public:
+		void init(const uint32 atlasWidth, const uint32 atlasHeight, const GlyphRasterizer& rasterizer, const uint32 fallbackCodepoint = '?');
+		// Returns nullptr if neither the glyph nor the fallback glyph can be cached.
+		const CachedGlyph* find_or_add(const uint32 codepoint);
+		// Appends one sprite per visible character of UTF-8 text and returns the pen position after the text.
+		float2 write_sprites(const Color& color, const std::string_view text, const float2& position, const float scale, std::vector<Sprite>& outSprites);
+		void reset_statistics() { _statistics = GlyphCacheStatistics(); _statistics._glyphCount = static_cast<uint32>(_entryIndexMap.size()); }
+		// Glyphs used before this call become evictable. flush() does this after uploading.
+		void advance_frame() { ++_frameIndex; _pinnedFrame = _frameIndex; }
+
+	public:
+		const GlyphCacheStatistics& get_statistics() const { return _statistics; }
+		const TextureAtlas& get_atlas() const { return _atlas; }
+		// Texels of the atlas plus the bookkeeping of every cached glyph.
+		size_t get_memory_byte_size() const { return _atlas.get_texels().size() + _entries.capacity() * sizeof(Entry) + (_texelRanks.capacity() + _rowMaxima.capacity()) * sizeof(uint32); }
+
+#if defined(_WIN32)
+	public:
+		// Uploads the glyphs rasterized since the last flush in one batch and starts a new frame. Call before the sprites are drawn.
+		// Immediate mode only: the upload goes through the device context of the calling thread.
+		bool flush(Renderer& renderer);
+		// Render thread mode, once per FramePacket: the glyphs rasterized since the last flush go into the packet's uploads,
+		// and glyphs stay pinned until the pendingPacketCount packets not executed yet, and this one, are done with them.
+		// Write the sprites into the packet's SpriteBatch with write_sprites().
+		bool flush(Renderer& renderer, TextureUploadBatch& outUploads, const uint32 pendingPacketCount);
+		Resource& get_texture() { return _atlas.get_texture(); }
+#endif
+
+	private:
+		static constexpr uint32 kInvalidEntryIndex = UINT32_MAX;
+		struct Entry
+		{
+			uint32 _codepoint = 0;
+			CachedGlyph _glyph;
+			uint64 _lastUsedFrame = 0;
+			uint32 _prev = kInvalidEntryIndex; // Towards the most recently used
+			uint32 _next = kInvalidEntryIndex; // Towards the least recently used
+		};
+
+	private:
+		const CachedGlyph* add(const uint32 codepoint);
+		// Finds the region whose most recently used glyph is the least recently used one, evicts the glyphs in it and
+		// allocates it. Returns an invalid region if every region of that size holds a pinned glyph, without evicting.
+		AtlasRegion make_room(const uint32 width, const uint32 height);
+		// outMaxima[i * outStride] is the maximum of the windowSize values from values[i * stride].
+		void compute_sliding_maxima(const uint32* const values, const size_t stride, const uint32 count, const uint32 windowSize, uint32* const outMaxima, const size_t outStride);
+		void evict(const uint32 entryIndex);
+		void link_front(const uint32 entryIndex);
+		void unlink(const uint32 entryIndex);
+
+	private:
+		TextureAtlas _atlas;
+		GlyphRasterizer _rasterizer;
+		uint32 _fallbackCodepoint = '?';
+		std::vector<Entry> _entries;
+		std::vector<uint32> _freeEntryIndices;
+		std::unordered_map<uint32, uint32> _entryIndexMap;
+		uint32 _head = kInvalidEntryIndex;
+		uint32 _tail = kInvalidEntryIndex;
+		uint64 _frameIndex = 1;
+		uint64 _pinnedFrame = 1; // Glyphs used in this frame or later are not evictable.
+		GlyphBitmap _bitmap;
+		std::vector<byte> _texels;
+		std::vector<uint32> _texelRanks;
+		std::vector<uint32> _rowMaxima;
+		std::vector<uint32> _columnMaxima;
+		std::vector<uint32> _slidingQueue;
+		GlyphCacheStatistics _statistics;
+	};
+
+	const char kSpriteShaderHeaderCode[] =
+		R"(
+        struct SPRITE_INSTANCE
+        {
+            float4 positionAndSize : POSITION0;
+            float4 uvRect : TEXCOORD0;
+            float4 color : COLOR0;
+            float2 rotation : TEXCOORD1;
+        };
+        struct VS_OUTPUT
+        {
+            float4 screenPosition : SV_POSITION;
+            float4 color : COLOR0;
+            float2 texcoord : TEXCOORD0;
+        };
+    )";
+
+	const char kSpriteVertexShaderCode[] =
+		R"(
+        #include "SpriteShaderHeader"
+    
+        cbuffer DEFAULT_CB_MATRICES
+        {
+            float4x4 g_cbProjectionMatrix;
+        };
+    
+        static const float2 kCorners[6] = { float2(-0.5, -0.5), float2(-0.5, 0.5), float2(0.5, 0.5), float2(-0.5, -0.5), float2(0.5, 0.5), float2(0.5, -0.5) };
+
+        VS_OUTPUT main(SPRITE_INSTANCE input, uint vertexID : SV_VertexID)
+        {
+            const float2 corner = kCorners[vertexID];
+            const float2 offset = corner * input.positionAndSize.zw;
+            const float2 rotatedX = float2(input.rotation.x, -input.rotation.y);
+            const float2 rotatedY = float2(input.rotation.y, input.rotation.x);
+            const float2 position = input.positionAndSize.xy + rotatedX * offset.x + rotatedY * offset.y;
+
+            VS_OUTPUT output;
+            output.screenPosition = mul(float4(position, 0.0, 1.0), g_cbProjectionMatrix);
+            output.screenPosition /= output.screenPosition.w;
+            output.color = input.color;
+            output.texcoord = lerp(input.uvRect.xy, input.uvRect.zw, corner + 0.5);
+            return output;
+        }
+    )";
+
+	const char kSpritePixelShaderCode[] =
+		R"(
+        #include "SpriteShaderHeader"
+    
+        sampler g_sampler0;
+        Texture2D<float4> g_texture0;
+        float4 main(VS_OUTPUT input) : SV_Target
+        {
+            return g_texture0.Sample(g_sampler0, input.texcoord) * input.color;
+        }
+    )";
+
+	template<typename Vertex>
+	class MeshGenerator
+	{
+	public:
+		static void push_3D_triangle(const Color& color, const float4& a, const float4& b, const float4& c, std::vector<Vertex>& vertices, std::vector<uint32>& indices)
+		{
+			const uint64 vertexBase = vertices.size();
+			vertices.resize(vertexBase + 3);
+
+			const uint64 indexBase = indices.size();
+			indices.reserve(indexBase + 3);
 
 			vertices[vertexBase + 0]._position = a;
 			vertices[vertexBase + 0]._color = color;
@@ -758,8 +1790,8 @@ namespace SimpleRenderer
 
 		static void push_2D_circle(const Color& color, const float2& centerPosition, float radius, uint32 sideCount, std::vector<Vertex>& vertices, std::vector<uint32>& indices)
 		{
-			radius = max(radius, 1.0f);
-			sideCount = max(sideCount, 4);
+			radius = (std::max)(radius, 1.0f);
+			sideCount = (std::max)(sideCount, 4u);
 
 			const uint64 vertexBase = vertices.size();
 			vertices.resize(vertexBase + sideCount + 1);
@@ -785,7 +1817,7 @@ namespace SimpleRenderer
 
 		static void push_2D_lineSegment(const Color& color, const float2& a, const float2& b, float thickness, std::vector<Vertex>& vertices, std::vector<uint32>& indices)
 		{
-			thickness = max(thickness, 1.0f);
+			thickness = (std::max)(thickness, 1.0f);
 
 			const float2 ab = b - a;
 			const float l = ab.length();
@@ -802,7 +1834,7 @@ namespace SimpleRenderer
 
 		static void push_2D_arrow(const Color& color, const float2& a, const float2& b, float thickness, float head_length_ratio, float head_width_scale, std::vector<Vertex>& vertices, std::vector<uint32>& indices)
 		{
-			thickness = max(thickness, 1.0f);
+			thickness = (std::max)(thickness, 1.0f);
 
 			const float2 ab = b - a;
 			const float l = ab.length();
@@ -848,15 +1880,89 @@ namespace SimpleRenderer
 		}
 	};
 
-	class Renderer final
+	enum class InputKey
 	{
-	public:
-		enum class Key
+		NONE,
+		Enter
+	};
+
+	struct InputEvent
+	{
+		enum class Type : uint8
 		{
-			NONE,
-			Enter
+			None,
+			MouseMove,
+			MouseLButtonDown,
+			MouseLButtonUp,
+			MouseRButtonUp,
+			KeyUp,
+			Char,
+			Redraw,
+			Quit,
 		};
 
+		Type _type = Type::None;
+		InputKey _key = InputKey::NONE;
+		char _char = 0;
+		float2 _position;
+		uint64 _timestamp = 0; // microseconds, see get_time_us()
+	};
+
+	// Fixed-capacity ring of InputEvents. Pushing into a full queue drops the new event and counts it.
+	class InputEventQueue
+	{
+	public:
+		static constexpr uint32 kCapacity = 256;
+
+	public:
+		bool push(const InputEvent& event);
+		bool pop(InputEvent& outEvent);
+		void clear() { _head = 0; _count = 0; }
+		bool is_empty() const { return _count == 0; }
+		bool is_full() const { return _count == kCapacity; }
+		uint32 size() const { return _count; }
+		InputEvent& front() { return _events[_head]; }
+		InputEvent& back() { return _events[(_head + _count - 1) % kCapacity]; }
+		uint64 get_dropped_event_count() const { return _droppedEventCount; }
+
+	private:
+		InputEvent _events[kCapacity];
+		uint32 _head = 0;
+		uint32 _count = 0;
+		uint64 _droppedEventCount = 0;
+	};
+
+	// Anything that produces InputEvents: the Win32 message pump, or a scripted source in tests.
+	class InputEventSource
+	{
+	public:
+		virtual ~InputEventSource() = default;
+
+	public:
+		// Returns false once no more events are pending.
+		virtual bool poll_event(InputEvent& outEvent) = 0;
+		// Blocks until an event may be pending or the timeout elapses.
+		virtual void wait_for_event(const uint64 timeoutUs) { std::this_thread::sleep_for(std::chrono::microseconds(timeoutUs)); }
+	};
+
+	struct InputStatistics
+	{
+		float get_average_latency_ms() const { return (_processedEventCount == 0 ? 0.0f : static_cast<float>(_totalLatencyUs) / _processedEventCount * 0.001f); }
+
+		uint64 _processedEventCount = 0;
+		uint64 _droppedEventCount = 0;
+		uint64 _coalescedEventCount = 0;
+		uint64 _totalLatencyUs = 0;
+		uint64 _maxLatencyUs = 0;
+		uint64 _lastFrameMaxLatencyUs = 0;
+		uint32 _lastFrameEventCount = 0;
+	};
+
+	class InputSystem
+	{
+	public:
+		static constexpr uint32 kMaxCharCountPerFrame = 64;
+
 	private:
 		struct MouseState
 		{
@@ -866,11 +1972,6 @@ namespace SimpleRenderer
 				_is_L_button_released = false;
 				_is_R_button_released = false;
 			}
-			void update_position(const MSG& msg)
-			{
-				_position.x = static_cast<float>(GET_X_LPARAM(msg.lParam));
-				_position.y = static_cast<float>(GET_Y_LPARAM(msg.lParam));
-			}
 			bool _is_L_button_pressed = false;
 			bool _is_L_button_released = false;
 			bool _is_R_button_released = false;
@@ -883,1125 +1984,7173 @@ namespace SimpleRenderer
 		{
 			void clear()
 			{
-				_char = 0;
-				_up_key = Key::NONE;
+				_chars[0] = 0;
+				_charCount = 0;
+				_up_key = InputKey::NONE;
+			}
+			void push_char(const char ch)
+			{
+				if (_charCount < kMaxCharCountPerFrame)
+				{
+					_chars[_charCount] = ch;
+					++_charCount;
+					_chars[_charCount] = 0;
+				}
 			}
-			char _char = 0;
-			Key _up_key = Key::NONE;
+			char _chars[kMaxCharCountPerFrame + 1]{};
+			uint32 _charCount = 0;
+			InputKey _up_key = InputKey::NONE;
 		};
 
 	public:
-		Renderer(const float2& windowSize, const Color& clearColor) : _windowSize{ windowSize }, _clearColor{ clearColor } { if (create_window()) create_device(); }
-		~Renderer() { destroy_window(); }
-
-	public:
-		bool is_running();
-
-	public:
-		void bind_ShaderInputLayout(ShaderInputLayout& shaderInputLayout);
-		void bind_Shader(Shader& shader);
-		void bind_input(Resource& resource, const uint32 slot);
-		void bind_ShaderResource(const ShaderType shaderType, Resource& resource, const uint32 slot);
-		void use_triangle_primitive();
-
-	public:
-		void begin_rendering();
-		void draw(const uint32 vertexCount);
-		void draw_indexed(const uint32 indexCount);
-		void draw_text(const Color& color, const std::string& text, const float2& position);
-		void end_rendering();
-
-	public:
-		ID3D11Device* get_device() const { return _device.Get(); }
-		ID3D11DeviceContext* get_device_context() const { return _deviceContext.Get(); }
+		// Drains pending events of the source, then derives this frame's state from them in order. Polling stops while the
+		// queue is full, and an event this frame's state cannot hold (a second key up, too many chars) waits for the next
+		// frame, so nothing taken from the source is lost. has_pending_events() is then true.
+		void pump(InputEventSource& source);
+		bool has_pending_events() const { return _eventQueue.is_empty() == false || _is_source_backlogged == true; }
 
 	public:
+		bool is_quit_requested() const { return _is_quit_requested; }
 		bool is_mouse_L_button_down() const { return _mouseState._is_L_button_down; }
 		bool is_mouse_L_button_pressed() const { return _mouseState._is_L_button_pressed; }
 		bool is_mouse_L_button_released() const { return _mouseState._is_L_button_released; }
 		bool is_mouse_R_button_released() const { return _mouseState._is_R_button_released; }
+		float2 get_mouse_position() const { return _mouseState._position; }
 		float2 get_mouse_move_delta() const { return _mouseState._position - _mouseState._L_pressed_position; }
-		char get_keyboard_char() const { return _keyboardState._char; }
-		Key get_keyboard_up_key() const { return _keyboardState._up_key; }
+		char get_keyboard_char() const { return _keyboardState._chars[0]; }
+		const char* get_keyboard_chars() const { return _keyboardState._chars; }
+		uint32 get_keyboard_char_count() const { return _keyboardState._charCount; }
+		InputKey get_keyboard_up_key() const { return _keyboardState._up_key; }
+		uint32 get_frame_event_count() const { return _frameEventCount; }
+		const InputEvent& get_frame_event(const uint32 index) const { return _frameEvents[index]; }
+		const InputStatistics& get_statistics() const { return _statistics; }
 
 	private:
-		bool create_window();
-		void destroy_window();
-		void create_device();
-		void create_device_create_default_FontData();
-		void create_device_create_default_FontData_push_glyphRow(const uint32 rowIndex, const byte(&ch)[kFontTextureGlyphCountInRow]);
-		void bind_default_FontData();
+		void apply_event(const InputEvent& event);
 
 	private:
-		HINSTANCE _hInstance = nullptr;
-		HWND _hWnd = nullptr;
-		float2 _windowSize;
-		Color _clearColor;
+		InputEventQueue _eventQueue;
+		InputEvent _frameEvents[InputEventQueue::kCapacity];
+		uint32 _frameEventCount = 0;
+		InputStatistics _statistics;
+		MouseState _mouseState;
+		KeyboardState _keyboardState;
+		bool _is_quit_requested = false;
+		bool _is_source_backlogged = false;
+	};
 
-	private:
-		ComPtr<IDXGISwapChain> _swapChain;
-		ComPtr<ID3D11Device> _device;
-		ComPtr<ID3D11DeviceContext> _deviceContext;
-		ComPtr<ID3D11RenderTargetView> _backBufferRtv;
-		ComPtr<ID3D11Texture2D> _depthStencilResource;
-		ComPtr<ID3D11DepthStencilView> _depthStencilView;
-		ComPtr<ID3D11RasterizerState> _defaultRasterizerState;
-		ComPtr<ID3D11DepthStencilState> _defaultDepthStencilState;
-		ComPtr<ID3D11SamplerState> _defaultSamplerState;
-		ComPtr<ID3D11BlendState> _defaultBlendState;
+	struct FrameSchedulerStatistics
+	{
+		uint64 _renderedFrameCount = 0;
+		uint64 _skippedFrameCount = 0;
+		uint64 _idleWaitUs = 0; // total time spent blocked waiting for something to happen
+		float _lastIntervalCpuUsage = 0.0f; // process CPU time over wall time, refreshed every kStatisticsIntervalUs
+		float _lastIntervalFrameRate = 0.0f;
+	};
+
+	// Decides whether a frame has to be drawn. Without on-demand mode every frame is drawn. In on-demand
+	// mode a frame is only drawn on input, invalidate(), a requested deadline or after the max idle interval.
+	class FrameScheduler
+	{
+	public:
+		static constexpr uint64 kStatisticsIntervalUs = 1000000;
+
+	public:
+		void set_on_demand(const bool is_on_demand) { _is_on_demand = is_on_demand; }
+		bool is_on_demand() const { return _is_on_demand; }
+		void set_max_idle_interval_us(const uint64 maxIdleIntervalUs) { _maxIdleIntervalUs = maxIdleIntervalUs; }
+		// Safe to call from any thread.
+		void invalidate() { _is_invalidated.store(true, std::memory_order_release); }
+		// Requests a frame no later than timeUs (see get_time_us()), e.g. the next step of an animation.
+		void request_frame_at(const uint64 timeUs) { _nextDeadlineUs = (std::min)(_nextDeadlineUs, timeUs); }
+
+	public:
+		// How long the loop may block before the next frame is due. 0 means a frame is due now.
+		uint64 compute_wait_timeout_us(const uint64 now) const;
+		// Consumes the pending reasons to draw and reports whether this frame must be drawn.
+		bool decide(const uint64 now, const bool has_input);
+		void add_idle_wait_us(const uint64 waitedUs) { _statistics._idleWaitUs += waitedUs; }
+		const FrameSchedulerStatistics& get_statistics() const { return _statistics; }
 
 	private:
-		bool _is_InputLayout_bound = false;
-		bool _is_VS_bound = false;
-		bool _is_PS_bound = false;
-		bool _is_VertexBuffer_bound = false;
-		bool _is_IndexBuffer_bound = false;
+		void update_interval_statistics(const uint64 now);
 
 	private:
-		ShaderHeaderSet _defaultFontShaderHeaderSet;
-		Shader _defaultFontVertexShader;
-		ShaderInputLayout _defaultFontShaderInputLayout;
-		Shader _defaultFontPixelShader;
-		Resource _defaultFontCBMatrices;
-		Resource _defaultFontTexture;
-		Resource _defaultFontVertexBuffer;
-		Resource _defaultFontIndexBuffer;
-		DefaultFontData _defaultFontData;
-		std::vector<DEFAULT_FONT_VS_INPUT> _defaultFontVertices;
-		std::vector<uint32> _defaultFontIndices;
-		float2 _defaultFontScale = float2(1.25f, 2.25f);
+		bool _is_on_demand = false;
+		uint64 _maxIdleIntervalUs = 1000000;
+		std::atomic<bool> _is_invalidated{ true };
+		uint64 _nextDeadlineUs = UINT64_MAX;
+		uint64 _lastRenderedTimeUs = 0;
 
 	private:
-		MouseState _mouseState;
-		KeyboardState _keyboardState;
+		FrameSchedulerStatistics _statistics;
+		uint64 _intervalBeginTimeUs = 0;
+		uint64 _intervalBeginCpuTimeUs = 0;
+		uint64 _intervalBeginRenderedFrameCount = 0;
 	};
 
-
-#pragma region Function Definitions
-	void DefaultFontData::push_glyph(const DefaultFontGlyphMeta& glyphMeta)
+	// Bounded lock-free queue for exactly one producer thread and one consumer thread.
+	template<typename T, uint32 Capacity>
+	class SpscQueue
 	{
-		auto found = _glyphMap.find(glyphMeta._ch);
-		if (found != _glyphMap.end())
-		{
-			return;
-		}
-
-		_glyphMetas.push_back(glyphMeta);
-		_glyphMap.insert(std::pair<byte, uint64>(glyphMeta._ch, _glyphMetas.size() - 1));
-	}
+		static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two!");
 
-	const DefaultFontGlyphMeta& DefaultFontData::get_GlyphMeta(const byte& ch) const
-	{
-		auto found = _glyphMap.find(ch);
-		if (found == _glyphMap.end())
+	public:
+		bool push(const T& value)
 		{
-			return _glyphMetas[_glyphMap.find(0)->second];
+			const uint32 tail = _tail.load(std::memory_order_relaxed);
+			if (tail - _head.load(std::memory_order_acquire) == Capacity)
+			{
+				return false;
+			}
+			_items[tail & (Capacity - 1)] = value;
+			_tail.store(tail + 1, std::memory_order_release);
+			return true;
 		}
-		return _glyphMetas[found->second];
-	}
-
-	void ShaderHeaderSet::push_shader_header(const std::string& headerName, const std::string& headerCode)
-	{
-		_headerNames.push_back(headerName);
-		_headerCodes.push_back(headerCode);
-	}
-
-	HRESULT ShaderHeaderSet::Open(D3D_INCLUDE_TYPE IncludeType, LPCSTR pFileName, LPCVOID pParentData, LPCVOID* ppData, UINT* pBytes)
-	{
-		const uint32 headerCount = (uint32)_headerNames.size();
-		for (uint32 headerIndex = 0; headerIndex < headerCount; ++headerIndex)
+		bool pop(T& outValue)
 		{
-			if (_headerNames[headerIndex] == pFileName)
+			const uint32 head = _head.load(std::memory_order_relaxed);
+			if (head == _tail.load(std::memory_order_acquire))
 			{
-				*ppData = _headerCodes[headerIndex].c_str();
-				*pBytes = static_cast<UINT>(_headerCodes[headerIndex].length());
-				return S_OK;
+				return false;
 			}
+			outValue = _items[head & (Capacity - 1)];
+			_head.store(head + 1, std::memory_order_release);
+			return true;
 		}
-		return E_FAIL;
-	}
+		uint32 size() const { return _tail.load(std::memory_order_acquire) - _head.load(std::memory_order_acquire); }
 
-	void ShaderInputLayout::clear_InputElements()
+	private:
+		alignas(64) std::atomic<uint32> _head{ 0 };
+		alignas(64) std::atomic<uint32> _tail{ 0 };
+		T _items[Capacity];
+	};
+
+	// Everything the render thread needs to draw one frame. It only refers to GPU objects that stay
+	// untouched while packets are in flight (shaders, input layouts, constant buffers).
+	struct FrameDrawCommand
 	{
-		_inputElements.clear();
-		_inputTotalByteSize = 0;
+		ShaderInputLayout* _shaderInputLayout = nullptr;
+		Shader* _vertexShader = nullptr;
+		Shader* _pixelShader = nullptr;
+		Resource* _vsConstantBuffer = nullptr;
+		uint32 _indexOffset = 0;
+		uint32 _indexCount = 0;
+		int32 _vertexOffset = 0;
+	};
+
+	template<typename Vertex>
+	struct FramePacket
+	{
+		void clear()
+		{
+			_vertices.clear();
+			_indices.clear();
+			_drawCommands.clear();
+			_glyphInstances.clear();
+			_spriteBatch.clear();
+			_textRunUpdate.clear();
+			_textureUploads.clear();
+		}
+		void push_draw(ShaderInputLayout& shaderInputLayout, Shader& vertexShader, Shader& pixelShader, Resource* const vsConstantBuffer)
+		{
+			const uint32 indexOffset = (_drawCommands.empty() ? 0 : _drawCommands.back()._indexOffset + _drawCommands.back()._indexCount);
+			FrameDrawCommand drawCommand;
+			drawCommand._shaderInputLayout = &shaderInputLayout;
+			drawCommand._vertexShader = &vertexShader;
+			drawCommand._pixelShader = &pixelShader;
+			drawCommand._vsConstantBuffer = vsConstantBuffer;
+			drawCommand._indexOffset = indexOffset;
+			drawCommand._indexCount = static_cast<uint32>(_indices.size()) - indexOffset;
+			if (drawCommand._indexCount > 0)
+			{
+				_drawCommands.push_back(drawCommand);
+			}
+		}
+
+		std::vector<Vertex> _vertices;
+		std::vector<uint32> _indices;
+		std::vector<FrameDrawCommand> _drawCommands;
+		std::vector<DEFAULT_FONT_GLYPH_INSTANCE> _glyphInstances;
+		SpriteBatch _spriteBatch;
+		TextRunUpdate _textRunUpdate;
+		TextureUploadBatch _textureUploads; // Applied before anything of the packet is drawn.
+		uint64 _frameIndex = 0;
+	};
+
+	struct FramePipelineStatistics
+	{
+		uint64 _submittedPacketCount = 0;
+		uint64 _executedPacketCount = 0;
+		uint32 _queueDepth = 0;
+		uint32 _maxQueueDepth = 0;
+		uint64 _gameThreadWaitUs = 0; // total time the game thread waited for a free packet
+		uint64 _renderThreadWaitUs = 0; // total time the render thread waited for a ready packet
+		uint64 _lastGameThreadWaitUs = 0;
+		uint64 _lastRenderThreadWaitUs = 0;
+	};
+
+	uint64 get_time_us();
+	uint64 get_process_cpu_time_us();
+	// Backs off the longer the other side of a queue is idle, so an idle thread does not burn a core.
+	void wait_with_backoff(const uint32 spinCount);
+
+	// Hands FramePackets from the game thread to a render thread. Only kMaxQueueDepth packets exist
+	// (queued, being executed or being built), so the game thread runs at most that many frames ahead.
+	template<typename Vertex, uint32 kMaxQueueDepth = 3>
+	class FramePacketPipeline
+	{
+	public:
+		using Packet = FramePacket<Vertex>;
+		using ExecuteFunction = std::function<void(const Packet&)>;
+
+	private:
+		static constexpr uint32 kPacketCount = kMaxQueueDepth;
+		static constexpr uint32 kQueueCapacity = 16;
+		// After spinning this long the render thread blocks until a packet is submitted, so an idle renderer costs no CPU.
+		static constexpr uint32 kSpinCountBeforeBlocking = 1024;
+		static_assert(kPacketCount >= 2, "At least two packets are needed to overlap game and render threads!");
+		static_assert(kPacketCount <= kQueueCapacity, "kMaxQueueDepth is too big!");
+
+	public:
+		FramePacketPipeline() = default;
+		FramePacketPipeline(const FramePacketPipeline&) = delete;
+		~FramePacketPipeline() { stop(); }
+
+	public:
+		void start(ExecuteFunction executeFunction)
+		{
+			if (_thread.joinable() == true)
+			{
+				return;
+			}
+
+			_executeFunction = std::move(executeFunction);
+			for (uint32 packetIndex = 0; packetIndex < kPacketCount; ++packetIndex)
+			{
+				_freePackets.push(&_packets[packetIndex]);
+			}
+			_is_running.store(true, std::memory_order_release);
+			_thread = std::thread([this]() { run_render_thread(); });
+		}
+		// Executes every packet already submitted, then joins the render thread.
+		void stop()
+		{
+			if (_thread.joinable() == false)
+			{
+				return;
+			}
+
+			_is_running.store(false, std::memory_order_release);
+			wake_render_thread();
+			_thread.join();
+
+			Packet* packet = nullptr;
+			while (_readyPackets.pop(packet) == true) { __noop; }
+			while (_freePackets.pop(packet) == true) { __noop; }
+		}
+		bool is_started() const { return _thread.joinable(); }
+		// Submitted packets the render thread has not finished executing yet.
+		uint32 get_pending_packet_count() const { return static_cast<uint32>(_submittedPacketCount.load(std::memory_order_relaxed) - _executedPacketCount.load(std::memory_order_acquire)); }
+		// Game thread: waits until the render thread has executed every submitted packet, e.g. before replacing an object
+		// that packets refer to.
+		void wait_until_idle() const
+		{
+			for (uint32 spinCount = 0; _executedPacketCount.load(std::memory_order_acquire) < _submittedPacketCount.load(std::memory_order_relaxed); ++spinCount)
+			{
+				wait_with_backoff(spinCount);
+			}
+		}
+
+	public:
+		// Game thread: waits until a packet is recycled by the render thread, and returns it cleared.
+		Packet& acquire_packet()
+		{
+			const uint64 waitBegin = get_time_us();
+			Packet* packet = nullptr;
+			for (uint32 spinCount = 0; _freePackets.pop(packet) == false; ++spinCount)
+			{
+				wait_with_backoff(spinCount);
+			}
+			const uint64 waited = get_time_us() - waitBegin;
+			_gameThreadWaitUs.fetch_add(waited, std::memory_order_relaxed);
+			_lastGameThreadWaitUs.store(waited, std::memory_order_relaxed);
+
+			packet->clear();
+			return *packet;
+		}
+		// Game thread: hands a packet obtained from acquire_packet() over to the render thread.
+		void submit_packet(Packet& packet)
+		{
+			packet._frameIndex = _submittedPacketCount.load(std::memory_order_relaxed);
+			_readyPackets.push(&packet);
+			_submittedPacketCount.fetch_add(1, std::memory_order_relaxed);
+			wake_render_thread();
+
+			const uint32 queueDepth = _readyPackets.size();
+			if (queueDepth > _maxQueueDepth.load(std::memory_order_relaxed))
+			{
+				_maxQueueDepth.store(queueDepth, std::memory_order_relaxed);
+			}
+		}
+		FramePipelineStatistics get_statistics() const
+		{
+			FramePipelineStatistics statistics;
+			statistics._submittedPacketCount = _submittedPacketCount.load(std::memory_order_relaxed);
+			statistics._executedPacketCount = _executedPacketCount.load(std::memory_order_relaxed);
+			statistics._queueDepth = _readyPackets.size();
+			statistics._maxQueueDepth = _maxQueueDepth.load(std::memory_order_relaxed);
+			statistics._gameThreadWaitUs = _gameThreadWaitUs.load(std::memory_order_relaxed);
+			statistics._renderThreadWaitUs = _renderThreadWaitUs.load(std::memory_order_relaxed);
+			statistics._lastGameThreadWaitUs = _lastGameThreadWaitUs.load(std::memory_order_relaxed);
+			statistics._lastRenderThreadWaitUs = _lastRenderThreadWaitUs.load(std::memory_order_relaxed);
+			return statistics;
+		}
+
+	private:
+		void wake_render_thread()
+		{
+			// Taking the mutex orders the change before the render thread's check of it, so the notification cannot be lost.
+			{
+				std::lock_guard<std::mutex> lock(_wakeMutex);
+			}
+			_wakeCondition.notify_one();
+		}
+		void run_render_thread()
+		{
+			while (true)
+			{
+				const uint64 waitBegin = get_time_us();
+				Packet* packet = nullptr;
+				for (uint32 spinCount = 0; _readyPackets.pop(packet) == false; ++spinCount)
+				{
+					if (_is_running.load(std::memory_order_acquire) == false)
+					{
+						return;
+					}
+					if (spinCount < kSpinCountBeforeBlocking)
+					{
+						wait_with_backoff(spinCount);
+						continue;
+					}
+
+					std::unique_lock<std::mutex> lock(_wakeMutex);
+					_wakeCondition.wait(lock, [this]() { return _readyPackets.size() > 0 || _is_running.load(std::memory_order_acquire) == false; });
+				}
+				const uint64 waited = get_time_us() - waitBegin;
+				_renderThreadWaitUs.fetch_add(waited, std::memory_order_relaxed);
+				_lastRenderThreadWaitUs.store(waited, std::memory_order_relaxed);
+
+				_executeFunction(*packet);
+				_executedPacketCount.fetch_add(1, std::memory_order_release);
+				_freePackets.push(packet);
+			}
+		}
+
+	private:
+		Packet _packets[kPacketCount];
+		SpscQueue<Packet*, kQueueCapacity> _freePackets;
+		SpscQueue<Packet*, kQueueCapacity> _readyPackets;
+		ExecuteFunction _executeFunction;
+		std::thread _thread;
+		std::atomic<bool> _is_running{ false };
+		std::mutex _wakeMutex;
+		std::condition_variable _wakeCondition;
+
+	private:
+		std::atomic<uint64> _submittedPacketCount{ 0 };
+		std::atomic<uint64> _executedPacketCount{ 0 };
+		std::atomic<uint32> _maxQueueDepth{ 0 };
+		std::atomic<uint64> _gameThreadWaitUs{ 0 };
+		std::atomic<uint64> _renderThreadWaitUs{ 0 };
+		std::atomic<uint64> _lastGameThreadWaitUs{ 0 };
+		std::atomic<uint64> _lastRenderThreadWaitUs{ 0 };
+	};
+
+#if defined(_WIN32)
+	class Win32InputEventSource final : public InputEventSource
+	{
+	public:
+		virtual bool poll_event(InputEvent& outEvent) override final;
+		virtual void wait_for_event(const uint64 timeoutUs) override final;
+
+	private:
+		static bool convert_message(const MSG& msg, InputEvent& outEvent);
+	};
+
+	class Renderer final
+	{
+	public:
+		using Key = InputKey;
+
+	public:
+		Renderer(const float2& windowSize, const Color& clearColor) : _windowSize{ windowSize }, _clearColor{ clearColor } { if (create_window()) create_device(); }
+		~Renderer() { destroy_window(); }
+
+	public:
+		bool is_running();
+		// Whether the current iteration has to draw. Always true unless on-demand rendering is enabled.
+		bool is_frame_needed() const { return _is_frame_needed; }
+
+	public:
+		void set_on_demand_rendering(const bool is_on_demand) { _frameScheduler.set_on_demand(is_on_demand); }
+		void set_max_idle_interval_us(const uint64 maxIdleIntervalUs) { _frameScheduler.set_max_idle_interval_us(maxIdleIntervalUs); }
+		// Safe to call from any thread; wakes up the loop if it is blocked.
+		void invalidate();
+		void request_frame_at(const uint64 timeUs) { _frameScheduler.request_frame_at(timeUs); }
+		const FrameSchedulerStatistics& get_FrameScheduler_statistics() const { return _frameScheduler.get_statistics(); }
+
+	public:
+		void bind_ShaderInputLayout(ShaderInputLayout& shaderInputLayout);
+		void bind_Shader(Shader& shader);
+		// Binds the variant of the given key, compiling it first if it was never used.
+		void bind_Shader(ShaderVariantSet& shaderVariantSet, const uint64 variantKey);
+		void bind_input(Resource& resource, const uint32 slot);
+		void bind_ShaderResource(const ShaderType shaderType, Resource& resource, const uint32 slot);
+		void use_triangle_primitive();
+
+	public:
+		void begin_rendering();
+		void draw(const uint32 vertexCount);
+		void draw_indexed(const uint32 indexCount, const uint32 indexOffset = 0, const int32 vertexOffset = 0);
+		void draw_instanced(const uint32 vertexCount, const uint32 instanceCount, const uint32 instanceOffset = 0);
+		void draw_text(const Color& color, const std::string_view text, const float2& position) { draw_text(color, text.data(), static_cast<uint32>(text.size()), position); }
+		void draw_text(const Color& color, const char* const text, const uint32 textLength, const float2& position);
+		// Formats the arguments with TextFormatter on the stack, e.g. draw_text_format(color, position, "step: ", step).
+		template<typename... Args>
+		void draw_text_format(const Color& color, const float2& position, const Args&... args);
+		void draw_text(const Color& color, const std::string_view text, const TextLayout& layout);
+		float2 measure_text(const std::string_view text, const float wrapWidth = 0.0f, const float lineSpacing = 0.0f) const { return SimpleRenderer::measure_text(text, get_default_font_glyph_size(), wrapWidth, lineSpacing); }
+		float2 get_default_font_glyph_size() const { return float2(_defaultFontScale.x * kFontTextureGlyphWidth, _defaultFontScale.y * kFontTextureGlyphHeight); }
+		// UTF-8 text through a GlyphCache, drawn with the sprites. Call glyphCache.flush() before end_rendering().
+		// Immediate mode only; with a FramePacketPipeline, see GlyphCache::flush(renderer, outUploads, pendingPacketCount).
+		void draw_text(GlyphCache& glyphCache, const Color& color, const std::string_view text, const float2& position, const float scale = 1.0f);
+		// Sprites are queued and drawn before text in end_rendering() or execute_FramePacket(); texture must outlive the frame.
+		void draw_sprite(Resource& texture, const Sprite& sprite, const BlendMode blendMode = BlendMode::Alpha);
+		void draw_sprites(Resource& texture, const Sprite* const sprites, const uint32 spriteCount, const BlendMode blendMode = BlendMode::Alpha);
+		void end_rendering();
+
+	public:
+		// Retained text, drawn every frame until destroyed. Calling update_TextRun() with unchanged arguments costs only a comparison.
+		TextRun create_TextRun(const uint32 maxCharCount) { return _textRunBuffer.create(maxCharCount); }
+		void destroy_TextRun(TextRun& textRun) { _textRunBuffer.destroy(textRun); }
+		bool update_TextRun(const TextRun& textRun, const Color& color, const std::string_view text, const float2& position) { return _textRunBuffer.update(textRun, color, text, position, _defaultFontScale); }
+		template<typename... Args>
+		bool update_TextRun_format(const TextRun& textRun, const Color& color, const float2& position, const Args&... args);
+
+	public:
+		// Moves the text queued by draw_text() and the TextRun changes into the packet, so they are drawn when the packet is executed.
+		template<typename Vertex>
+		void move_text_to(FramePacket<Vertex>& packet);
+		// Moves the sprites queued by draw_sprite() and draw_sprites() into the packet.
+		template<typename Vertex>
+		void move_sprites_to(FramePacket<Vertex>& packet);
+		// Draws and presents a whole frame. In render-thread mode this is the only Renderer call made on the render thread.
+		template<typename Vertex>
+		void execute_FramePacket(const FramePacket<Vertex>& packet);
+
+	public:
+		ID3D11Device* get_device() const { return _device.Get(); }
+		ID3D11DeviceContext* get_device_context() const { return _deviceContext.Get(); }
+		ShaderCompiler& get_ShaderCompiler() { return _shaderCompiler; }
+		const ShaderCache& get_ShaderCache() const { return _shaderCache; }
+
+	public:
+		bool is_mouse_L_button_down() const { return _inputSystem.is_mouse_L_button_down(); }
+		bool is_mouse_L_button_pressed() const { return _inputSystem.is_mouse_L_button_pressed(); }
+		bool is_mouse_L_button_released() const { return _inputSystem.is_mouse_L_button_released(); }
+		bool is_mouse_R_button_released() const { return _inputSystem.is_mouse_R_button_released(); }
+		float2 get_mouse_move_delta() const { return _inputSystem.get_mouse_move_delta(); }
+		char get_keyboard_char() const { return _inputSystem.get_keyboard_char(); }
+		const char* get_keyboard_chars() const { return _inputSystem.get_keyboard_chars(); }
+		uint32 get_keyboard_char_count() const { return _inputSystem.get_keyboard_char_count(); }
+		Key get_keyboard_up_key() const { return _inputSystem.get_keyboard_up_key(); }
+		const InputSystem& get_InputSystem() const { return _inputSystem; }
+
+	private:
+		bool create_window();
+		void destroy_window();
+		void create_device();
+		void create_device_create_default_FontData();
+		void bind_default_FontData();
+		void draw_default_font_text(const std::vector<DEFAULT_FONT_GLYPH_INSTANCE>& glyphInstances);
+		void draw_TextRuns(const TextRunUpdate& textRunUpdate);
+		void create_device_create_SpriteData();
+		void draw_SpriteBatch(const SpriteBatch& spriteBatch);
+
+	private:
+		HINSTANCE _hInstance = nullptr;
+		HWND _hWnd = nullptr;
+		float2 _windowSize;
+		Color _clearColor;
+
+	private:
+		ComPtr<IDXGISwapChain> _swapChain;
+		ComPtr<ID3D11Device> _device;
+		ComPtr<ID3D11DeviceContext> _deviceContext;
+		ComPtr<ID3D11RenderTargetView> _backBufferRtv;
+		ComPtr<ID3D11Texture2D> _depthStencilResource;
+		ComPtr<ID3D11DepthStencilView> _depthStencilView;
+		ComPtr<ID3D11RasterizerState> _defaultRasterizerState;
+		ComPtr<ID3D11DepthStencilState> _defaultDepthStencilState;
+		ComPtr<ID3D11SamplerState> _defaultSamplerState;
+		ComPtr<ID3D11BlendState> _defaultBlendState;
+		ComPtr<ID3D11BlendState> _blendStates[kBlendModeCount]; // Indexed by BlendMode
+
+	private:
+		D3DShaderCompiler _shaderCompiler;
+		ShaderCache _shaderCache{ "ShaderCache" };
+
+	private:
+		bool _is_InputLayout_bound = false;
+		bool _is_VS_bound = false;
+		bool _is_PS_bound = false;
+		bool _is_VertexBuffer_bound = false;
+		bool _is_IndexBuffer_bound = false;
+
+	private:
+		ShaderHeaderSet _defaultFontShaderHeaderSet;
+		Shader _defaultFontVertexShader;
+		ShaderInputLayout _defaultFontShaderInputLayout;
+		Shader _defaultFontPixelShader;
+		Resource _defaultFontCBMatrices;
+		Resource _defaultFontTexture;
+		Shader _defaultFontGlyphVertexShader;
+		ShaderInputLayout _defaultFontGlyphShaderInputLayout;
+		Resource _defaultFontCBGlyphs;
+		Resource _defaultFontGlyphInstanceBuffer;
+		std::vector<DEFAULT_FONT_GLYPH_INSTANCE> _defaultFontGlyphInstances;
+		std::vector<Sprite> _glyphCacheSprites;
+		float2 _defaultFontScale = float2(1.25f, 2.25f);
+		TextRunBuffer _textRunBuffer;
+		TextRunUpdate _textRunUpdate;
+		Resource _textRunVertexBuffer;
+		Resource _textRunIndexBuffer;
+
+	private:
+		ShaderHeaderSet _spriteShaderHeaderSet;
+		Shader _spriteVertexShader;
+		ShaderInputLayout _spriteShaderInputLayout;
+		Shader _spritePixelShader;
+		Resource _spriteInstanceBuffer;
+		SpriteBatch _spriteBatch;
+
+	private:
+		Resource _framePacketVertexBuffer;
+		Resource _framePacketIndexBuffer;
+
+	private:
+		Win32InputEventSource _inputEventSource;
+		InputSystem _inputSystem;
+		FrameScheduler _frameScheduler;
+		bool _is_frame_needed = true;
+	};
+#endif
+
+
+#pragma region Function Definitions
+	bool TextLineBreaker::next(TextLine& outLine)
+	{
+		const uint32 textLength = static_cast<uint32>(_text.size());
+		if (_at >= textLength)
+		{
+			return false;
+		}
+
+		uint32 lineEnd = _at;
+		while (lineEnd < textLength && _text[lineEnd] != '\n')
+		{
+			++lineEnd;
+		}
+
+		if (_maxCharCount == 0 || lineEnd - _at <= _maxCharCount)
+		{
+			outLine._offset = _at;
+			outLine._length = lineEnd - _at;
+			_at = lineEnd + 1;
+			return true;
+		}
+
+		// The line is longer than _maxCharCount, so _text[_at + _maxCharCount] is still on it.
+		uint32 breakAt = _at + _maxCharCount;
+		while (breakAt > _at && _text[breakAt] != ' ')
+		{
+			--breakAt;
+		}
+		uint32 wordEnd = breakAt;
+		while (wordEnd > _at && _text[wordEnd - 1] == ' ')
+		{
+			--wordEnd;
+		}
+		if (wordEnd == _at && _text[_at] == ' ')
+		{
+			// Only spaces come before the wrap point, so they are dropped like any other spaces there instead of making an empty line.
+			while (_at < lineEnd && _text[_at] == ' ')
+			{
+				++_at;
+			}
+			if (_at == lineEnd)
+			{
+				outLine._offset = _at;
+				outLine._length = 0;
+				_at = lineEnd + 1;
+				return true;
+			}
+			return next(outLine);
+		}
+		if (breakAt == _at)
+		{
+			outLine._offset = _at;
+			outLine._length = _maxCharCount;
+			_at += _maxCharCount;
+			return true;
+		}
+
+		outLine._offset = _at;
+		outLine._length = wordEnd - _at;
+
+		_at = breakAt;
+		while (_at < lineEnd && _text[_at] == ' ')
+		{
+			++_at;
+		}
+		if (_at == lineEnd)
+		{
+			// Only spaces were left before the '\n', which must not start an empty line.
+			_at = lineEnd + 1;
+		}
+		return true;
 	}
 
-	void ShaderInputLayout::push_InputElement(const InputElement& newInputElement)
+	static uint32 compute_max_char_count_in_line(const float wrapWidth, const float glyphWidth)
 	{
-		D3D11_INPUT_ELEMENT_DESC inputElementDesc{};
-		inputElementDesc.AlignedByteOffset = _inputTotalByteSize;
-		inputElementDesc.Format = newInputElement._format;
-		inputElementDesc.InputSlot = newInputElement._inputSlot;
-		inputElementDesc.InputSlotClass = newInputElement._inputSlotClass;
-		inputElementDesc.SemanticName = newInputElement._semanticName;
-		inputElementDesc.SemanticIndex = newInputElement._semanticIndex;
-		inputElementDesc.InstanceDataStepRate = newInputElement._instanceStepRate;
-		_inputElements.push_back(inputElementDesc);
+		if (wrapWidth <= 0.0f || glyphWidth <= 0.0f)
+		{
+			return 0;
+		}
+		return (std::max)(static_cast<uint32>(wrapWidth / glyphWidth), 1u);
+	}
+
+	float2 measure_text(const std::string_view text, const float2& glyphSize, const float wrapWidth, const float lineSpacing)
+	{
+		TextLineBreaker textLineBreaker(text, compute_max_char_count_in_line(wrapWidth, glyphSize.x));
+		uint32 maxLength = 0;
+		uint32 lineCount = 0;
+		TextLine textLine;
+		while (textLineBreaker.next(textLine) == true)
+		{
+			maxLength = (std::max)(maxLength, textLine._length);
+			++lineCount;
+		}
+		if (lineCount == 0)
+		{
+			return float2(0, 0);
+		}
+		return float2(maxLength * glyphSize.x, lineCount * glyphSize.y + (lineCount - 1) * lineSpacing);
+	}
+
+	void layout_text(const std::string_view text, const TextLayout& layout, const float2& glyphSize, const uint32 packedColor, std::vector<DEFAULT_FONT_GLYPH_INSTANCE>& outGlyphInstances)
+	{
+		TextLineBreaker textLineBreaker(text, compute_max_char_count_in_line(layout._wrapWidth, glyphSize.x));
+		const float lineAdvance = glyphSize.y + layout._lineSpacing;
+		const float alignmentWidth = (layout._wrapWidth > 0.0f ? layout._wrapWidth : 0.0f);
+		float lineY = layout._position.y;
+		TextLine textLine;
+		for (; textLineBreaker.next(textLine) == true; lineY += lineAdvance)
+		{
+			if (layout._is_clipped == true)
+			{
+				if (lineY >= layout._clipMax.y)
+				{
+					break;
+				}
+				if (lineY + glyphSize.y <= layout._clipMin.y)
+				{
+					continue;
+				}
+			}
+			if (textLine._length == 0)
+			{
+				continue;
+			}
+
+			const float lineWidth = textLine._length * glyphSize.x;
+			float lineX = layout._position.x;
+			if (layout._alignment == TextAlignment::Center)
+			{
+				lineX += (alignmentWidth - lineWidth) * 0.5f;
+			}
+			else if (layout._alignment == TextAlignment::Right)
+			{
+				lineX += alignmentWidth - lineWidth;
+			}
+
+			uint32 firstCharIndex = 0;
+			uint32 lastCharIndex = textLine._length;
+			if (layout._is_clipped == true)
+			{
+				if (lineX >= layout._clipMax.x || lineX + lineWidth <= layout._clipMin.x)
+				{
+					continue;
+				}
+				if (layout._clipMin.x > lineX)
+				{
+					firstCharIndex = static_cast<uint32>((layout._clipMin.x - lineX) / glyphSize.x);
+				}
+				lastCharIndex = (std::min)(lastCharIndex, static_cast<uint32>(::ceil((layout._clipMax.x - lineX) / glyphSize.x)));
+			}
+
+			for (uint32 charIndex = firstCharIndex; charIndex < lastCharIndex; ++charIndex)
+			{
+				const char ch = text[size_t(textLine._offset) + charIndex];
+				if (ch == ' ')
+				{
+					continue;
+				}
+
+				DEFAULT_FONT_GLYPH_INSTANCE glyphInstance;
+				glyphInstance._position = float2(lineX + glyphSize.x * charIndex, lineY);
+				glyphInstance._glyph = static_cast<byte>(ch);
+				glyphInstance._color = packedColor;
+				outGlyphInstances.push_back(glyphInstance);
+			}
+		}
+	}
+
+	void write_default_font_quads(const Color& color, const char* const text, const uint32 textLength, const float2& position, const float2& scale, DEFAULT_FONT_VS_INPUT* const outVertices)
+	{
+		const float2 sizeUnit = float2(scale.x * kFontTextureGlyphWidth, scale.y * kFontTextureGlyphHeight);
+		for (uint32 charIndex = 0; charIndex < textLength; ++charIndex)
+		{
+			const DefaultFontGlyphMeta& glyphMeta = kDefaultFontData.get_GlyphMeta(static_cast<byte>(text[charIndex]));
+			const float x0 = position.x + sizeUnit.x * charIndex;
+			const float x1 = x0 + sizeUnit.x;
+			const float y0 = position.y;
+			const float y1 = y0 + sizeUnit.y;
+			DEFAULT_FONT_VS_INPUT* const vertices = &outVertices[charIndex * 4];
+			vertices[0]._position = float4(x0, y0, 0, 1);
+			vertices[0]._texcoord = float2(glyphMeta._u0, glyphMeta._v0);
+			vertices[1]._position = float4(x0, y1, 0, 1);
+			vertices[1]._texcoord = float2(glyphMeta._u0, glyphMeta._v1);
+			vertices[2]._position = float4(x1, y1, 0, 1);
+			vertices[2]._texcoord = float2(glyphMeta._u1, glyphMeta._v1);
+			vertices[3]._position = float4(x1, y0, 0, 1);
+			vertices[3]._texcoord = float2(glyphMeta._u1, glyphMeta._v0);
+			for (uint32 vertexIndex = 0; vertexIndex < 4; ++vertexIndex)
+			{
+				vertices[vertexIndex]._color = color;
+			}
+		}
+	}
+
+	TextRun TextRunBuffer::create(const uint32 maxCharCount)
+	{
+		TextRun textRun;
+		if (_freeEntryIDs.empty() == false)
+		{
+			textRun._id = _freeEntryIDs.back();
+			_freeEntryIDs.pop_back();
+		}
+		else
+		{
+			textRun._id = static_cast<uint32>(_entries.size());
+			_entries.push_back(Entry());
+		}
+
+		Entry& entry = _entries[textRun._id];
+		entry = Entry();
+		entry._region = allocate_region((std::max)(maxCharCount, 1u));
+		// Text that fits the region never reallocates the string, so updating a label costs no heap allocation.
+		entry._text.reserve(entry._region._charCapacity);
+		entry._is_alive = true;
+		return textRun;
+	}
+
+	void TextRunBuffer::destroy(TextRun& textRun)
+	{
+		if (textRun.is_valid() == false || _entries[textRun._id]._is_alive == false)
+		{
+			return;
+		}
+
+		Entry& entry = _entries[textRun._id];
+		release_region(entry._region);
+		entry = Entry();
+		_freeEntryIDs.push_back(textRun._id);
+		textRun._id = UINT32_MAX;
+	}
+
+	bool TextRunBuffer::update(const TextRun& textRun, const Color& color, const std::string_view text, const float2& position, const float2& scale)
+	{
+		if (textRun.is_valid() == false || _entries[textRun._id]._is_alive == false)
+		{
+			MINT_ASSERT(false, "Invalid TextRun!");
+			return false;
+		}
+
+		Entry& entry = _entries[textRun._id];
+		const bool is_same_color = (entry._color.x == color.x && entry._color.y == color.y && entry._color.z == color.z && entry._color.w == color.w);
+		const bool is_same_transform = (entry._position.x == position.x && entry._position.y == position.y && entry._scale.x == scale.x && entry._scale.y == scale.y);
+		if (is_same_color == true && is_same_transform == true && entry._text == text)
+		{
+			return false;
+		}
+
+		const uint32 textLength = static_cast<uint32>(text.size());
+		if (textLength > entry._region._charCapacity)
+		{
+			release_region(entry._region);
+			entry._region = allocate_region((std::max)(textLength, entry._region._charCapacity * 2));
+			entry._text.reserve(entry._region._charCapacity);
+		}
+
+		entry._text.assign(text.data(), text.size());
+		entry._color = color;
+		entry._position = position;
+		entry._scale = scale;
+
+		const uint32 vertexOffset = entry._region._vertexOffset;
+		write_default_font_quads(color, text.data(), textLength, position, scale, &_vertices[vertexOffset]);
+		// Collapse the characters the previous text had beyond the new length.
+		const uint32 previousCharCount = entry._charCount;
+		for (uint32 charIndex = textLength; charIndex < previousCharCount; ++charIndex)
+		{
+			std::fill(_vertices.begin() + vertexOffset + charIndex * 4, _vertices.begin() + vertexOffset + charIndex * 4 + 4, DEFAULT_FONT_VS_INPUT());
+		}
+		entry._charCount = textLength;
+		mark_dirty(vertexOffset, (std::max)(textLength, previousCharCount) * 4);
+		return true;
+	}
+
+	void TextRunBuffer::collect_updates(TextRunUpdate& outUpdate)
+	{
+		outUpdate.clear();
+
+		const uint32 vertexCount = static_cast<uint32>(_vertices.size());
+		if (vertexCount > _uploadedVertexCapacity)
+		{
+			_uploadedVertexCapacity = (std::max)(vertexCount, _uploadedVertexCapacity * 2);
+			_dirtyRanges.clear();
+			mark_dirty(0, vertexCount);
+		}
+		outUpdate._vertexCapacity = _uploadedVertexCapacity;
+		outUpdate._drawVertexCount = vertexCount;
+
+		for (const TextRunUpdateRange& dirtyRange : _dirtyRanges)
+		{
+			outUpdate._ranges.push_back(dirtyRange);
+			outUpdate._vertices.insert(outUpdate._vertices.end(), _vertices.begin() + dirtyRange._vertexOffset, _vertices.begin() + dirtyRange._vertexOffset + dirtyRange._vertexCount);
+		}
+		_dirtyRanges.clear();
+	}
+
+	TextRunBuffer::Region TextRunBuffer::allocate_region(const uint32 charCapacity)
+	{
+		for (size_t regionIndex = 0; regionIndex < _freeRegions.size(); ++regionIndex)
+		{
+			if (_freeRegions[regionIndex]._charCapacity >= charCapacity)
+			{
+				const Region region = _freeRegions[regionIndex];
+				_freeRegions.erase(_freeRegions.begin() + regionIndex);
+				return region;
+			}
+		}
+
+		Region region;
+		region._vertexOffset = static_cast<uint32>(_vertices.size());
+		region._charCapacity = charCapacity;
+		_vertices.resize(_vertices.size() + size_t(charCapacity) * 4, DEFAULT_FONT_VS_INPUT());
+		mark_dirty(region._vertexOffset, charCapacity * 4);
+		return region;
+	}
+
+	void TextRunBuffer::release_region(const Region& region)
+	{
+		std::fill(_vertices.begin() + region._vertexOffset, _vertices.begin() + region._vertexOffset + region._charCapacity * 4, DEFAULT_FONT_VS_INPUT());
+		mark_dirty(region._vertexOffset, region._charCapacity * 4);
+		_freeRegions.push_back(region);
+	}
+
+	void TextRunBuffer::mark_dirty(const uint32 vertexOffset, const uint32 vertexCount)
+	{
+		if (vertexCount == 0)
+		{
+			return;
+		}
+
+		// Runs are usually updated in creation order, so adjacent ranges merge.
+		if (_dirtyRanges.empty() == false)
+		{
+			TextRunUpdateRange& lastRange = _dirtyRanges.back();
+			if (lastRange._vertexOffset + lastRange._vertexCount == vertexOffset)
+			{
+				lastRange._vertexCount += vertexCount;
+				return;
+			}
+		}
+		_dirtyRanges.push_back(TextRunUpdateRange{ vertexOffset, vertexCount });
+	}
+
+	uint32 pack_color_RGBA8(const Color& color)
+	{
+		const auto to_unorm8 = [](const float value) { return static_cast<uint32>((std::min)((std::max)(value, 0.0f), 1.0f) * 255.0f + 0.5f); };
+		return to_unorm8(color.x) | (to_unorm8(color.y) << 8) | (to_unorm8(color.z) << 16) | (to_unorm8(color.w) << 24);
+	}
+
+	void wait_with_backoff(const uint32 spinCount)
+	{
+		if (spinCount < 64)
+		{
+			std::this_thread::yield();
+		}
+		else if (spinCount < 1024)
+		{
+			std::this_thread::sleep_for(std::chrono::microseconds(100));
+		}
+		else
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+
+	uint64 get_time_us()
+	{
+		return static_cast<uint64>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+	}
+
+	uint64 get_process_cpu_time_us()
+	{
+#if defined(_WIN32)
+		FILETIME creationTime{};
+		FILETIME exitTime{};
+		FILETIME kernelTime{};
+		FILETIME userTime{};
+		if (::GetProcessTimes(::GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime) == FALSE)
+		{
+			return 0;
+		}
+		const uint64 kernel100ns = (static_cast<uint64>(kernelTime.dwHighDateTime) << 32) | kernelTime.dwLowDateTime;
+		const uint64 user100ns = (static_cast<uint64>(userTime.dwHighDateTime) << 32) | userTime.dwLowDateTime;
+		return (kernel100ns + user100ns) / 10;
+#else
+		return static_cast<uint64>(std::clock()) * 1000000 / CLOCKS_PER_SEC;
+#endif
+	}
+
+	bool InputEventQueue::push(const InputEvent& event)
+	{
+		if (is_full() == true)
+		{
+			++_droppedEventCount;
+			return false;
+		}
+
+		_events[(_head + _count) % kCapacity] = event;
+		++_count;
+		return true;
+	}
+
+	bool InputEventQueue::pop(InputEvent& outEvent)
+	{
+		if (is_empty() == true)
+		{
+			return false;
+		}
+
+		outEvent = _events[_head];
+		_head = (_head + 1) % kCapacity;
+		--_count;
+		return true;
+	}
+
+	void InputSystem::pump(InputEventSource& source)
+	{
+		_mouseState.clear();
+		_keyboardState.clear();
+
+		InputEvent event;
+		_is_source_backlogged = false;
+		while (true)
+		{
+			// Events left in the source are read next frame rather than taken out of it and dropped.
+			if (_eventQueue.is_full() == true)
+			{
+				_is_source_backlogged = true;
+				break;
+			}
+			if (source.poll_event(event) == false)
+			{
+				break;
+			}
+
+			// Consecutive moves carry no information beyond the last position.
+			if (event._type == InputEvent::Type::MouseMove && _eventQueue.is_empty() == false && _eventQueue.back()._type == InputEvent::Type::MouseMove)
+			{
+				_eventQueue.back() = event;
+				++_statistics._coalescedEventCount;
+				continue;
+			}
+			_eventQueue.push(event);
+		}
+
+		const uint64 now = get_time_us();
+		_frameEventCount = 0;
+		_statistics._lastFrameMaxLatencyUs = 0;
+		while (_eventQueue.is_empty() == false)
+		{
+			const InputEvent& front = _eventQueue.front();
+			if ((front._type == InputEvent::Type::KeyUp && _keyboardState._up_key != InputKey::NONE)
+				|| (front._type == InputEvent::Type::Char && _keyboardState._charCount == kMaxCharCountPerFrame))
+			{
+				break;
+			}
+			_eventQueue.pop(event);
+
+			const uint64 latency = (now > event._timestamp ? now - event._timestamp : 0);
+			_statistics._totalLatencyUs += latency;
+			_statistics._lastFrameMaxLatencyUs = (std::max)(_statistics._lastFrameMaxLatencyUs, latency);
+			_statistics._maxLatencyUs = (std::max)(_statistics._maxLatencyUs, latency);
+			++_statistics._processedEventCount;
+
+			_frameEvents[_frameEventCount] = event;
+			++_frameEventCount;
+			apply_event(event);
+		}
+		_statistics._lastFrameEventCount = _frameEventCount;
+		_statistics._droppedEventCount = _eventQueue.get_dropped_event_count();
+	}
+
+	void InputSystem::apply_event(const InputEvent& event)
+	{
+		switch (event._type)
+		{
+		case InputEvent::Type::MouseMove:
+			_mouseState._position = event._position;
+			break;
+		case InputEvent::Type::MouseLButtonDown:
+			_mouseState._is_L_button_pressed = true;
+			_mouseState._is_L_button_down = true;
+			_mouseState._position = event._position;
+			_mouseState._L_pressed_position = event._position;
+			break;
+		case InputEvent::Type::MouseLButtonUp:
+			_mouseState._is_L_button_released = true;
+			_mouseState._is_L_button_down = false;
+			_mouseState._position = event._position;
+			break;
+		case InputEvent::Type::MouseRButtonUp:
+			_mouseState._is_R_button_released = true;
+			_mouseState._position = event._position;
+			break;
+		case InputEvent::Type::KeyUp:
+			_keyboardState._up_key = event._key;
+			break;
+		case InputEvent::Type::Char:
+			_keyboardState.push_char(event._char);
+			break;
+		case InputEvent::Type::Quit:
+			_is_quit_requested = true;
+			break;
+		default:
+			break;
+		}
+	}
+
+	uint64 FrameScheduler::compute_wait_timeout_us(const uint64 now) const
+	{
+		if (_is_on_demand == false || _is_invalidated.load(std::memory_order_acquire) == true)
+		{
+			return 0;
+		}
+
+		uint64 dueTime = _nextDeadlineUs;
+		if (_maxIdleIntervalUs > 0)
+		{
+			dueTime = (std::min)(dueTime, _lastRenderedTimeUs + _maxIdleIntervalUs);
+		}
+		return (dueTime > now ? dueTime - now : 0);
+	}
+
+	bool FrameScheduler::decide(const uint64 now, const bool has_input)
+	{
+		const bool is_invalidated = _is_invalidated.exchange(false, std::memory_order_acq_rel);
+		bool is_needed = (_is_on_demand == false) || has_input || is_invalidated;
+		if (now >= _nextDeadlineUs)
+		{
+			_nextDeadlineUs = UINT64_MAX;
+			is_needed = true;
+		}
+		if (_maxIdleIntervalUs > 0 && now >= _lastRenderedTimeUs + _maxIdleIntervalUs)
+		{
+			is_needed = true;
+		}
+
+		if (is_needed == true)
+		{
+			_lastRenderedTimeUs = now;
+			++_statistics._renderedFrameCount;
+		}
+		else
+		{
+			++_statistics._skippedFrameCount;
+		}
+		update_interval_statistics(now);
+		return is_needed;
+	}
+
+	void FrameScheduler::update_interval_statistics(const uint64 now)
+	{
+		if (_intervalBeginTimeUs == 0)
+		{
+			_intervalBeginTimeUs = now;
+			_intervalBeginCpuTimeUs = get_process_cpu_time_us();
+			return;
+		}
+
+		const uint64 elapsedUs = now - _intervalBeginTimeUs;
+		if (elapsedUs < kStatisticsIntervalUs)
+		{
+			return;
+		}
+
+		const uint64 cpuTimeUs = get_process_cpu_time_us();
+		_statistics._lastIntervalCpuUsage = static_cast<float>(cpuTimeUs - _intervalBeginCpuTimeUs) / elapsedUs;
+		_statistics._lastIntervalFrameRate = static_cast<float>(_statistics._renderedFrameCount - _intervalBeginRenderedFrameCount) * 1000000.0f / elapsedUs;
+		_intervalBeginTimeUs = now;
+		_intervalBeginCpuTimeUs = cpuTimeUs;
+		_intervalBeginRenderedFrameCount = _statistics._renderedFrameCount;
+	}
+
+	void ShaderHeaderSet::push_shader_header(const std::string& headerName, const std::string& headerCode)
+	{
+		const uint64 nameHash = compute_hash_FNV1a(headerName.c_str());
+		auto found = _headerIndexMap.find(nameHash);
+		if (found != _headerIndexMap.end())
+		{
+			MINT_ASSERT(_headerNames[found->second] == headerName, "Shader header name hash collision!");
+			_headerCodes[found->second] = headerCode;
+			return;
+		}
+
+		_headerIndexMap.insert(std::pair<uint64, uint32>(nameHash, static_cast<uint32>(_headerNames.size())));
+		_headerNames.push_back(headerName);
+		_headerCodes.push_back(headerCode);
+	}
+
+	const std::string* ShaderHeaderSet::find_shader_header(const char* const headerName) const
+	{
+		auto found = _headerIndexMap.find(compute_hash_FNV1a(headerName));
+		if (found == _headerIndexMap.end() || _headerNames[found->second] != headerName)
+		{
+			return nullptr;
+		}
+		return &_headerCodes[found->second];
+	}
+
+	bool ShaderKeywordSet::push_keyword(const char* const keyword)
+	{
+		if (_keywords.size() >= kMaxKeywordCount)
+		{
+			MINT_LOG_ERROR("Too many shader keywords!");
+			return false;
+		}
+		if (get_keyword_mask(keyword) != 0)
+		{
+			return true;
+		}
+		_keywords.push_back(keyword);
+		return true;
+	}
+
+	uint64 ShaderKeywordSet::get_keyword_mask(const char* const keyword) const
+	{
+		const uint32 keywordCount = get_keyword_count();
+		for (uint32 keywordIndex = 0; keywordIndex < keywordCount; ++keywordIndex)
+		{
+			if (_keywords[keywordIndex] == keyword)
+			{
+				return uint64(1) << keywordIndex;
+			}
+		}
+		return 0;
+	}
+
+	uint64 ShaderKeywordSet::make_key(const std::initializer_list<const char*>& enabledKeywords) const
+	{
+		uint64 key = 0;
+		for (const char* const keyword : enabledKeywords)
+		{
+			const uint64 mask = get_keyword_mask(keyword);
+			MINT_ASSERT(mask != 0, "Unknown shader keyword!");
+			key |= mask;
+		}
+		return key;
+	}
+
+	std::string ShaderKeywordSet::make_variant_source(const char* const sourceCode, const uint64 key) const
+	{
+		std::string variantSource;
+		const uint32 keywordCount = get_keyword_count();
+		for (uint32 keywordIndex = 0; keywordIndex < keywordCount; ++keywordIndex)
+		{
+			if ((key >> keywordIndex) & 1)
+			{
+				variantSource += "#define ";
+				variantSource += _keywords[keywordIndex];
+				variantSource += " 1\n";
+			}
+		}
+		if (variantSource.empty() == false)
+		{
+			// Keep line numbers in error messages matching the original source.
+			variantSource += "#line 1\n";
+		}
+		variantSource += sourceCode;
+		return variantSource;
+	}
+
+	uint32 compute_texel_stride(const TextureFormat& format)
+	{
+		switch (format)
+		{
+		case TextureFormat::R8_UNORM:
+			return 1;
+		case TextureFormat::R8G8B8A8_UNORM:
+			return 4;
+		default:
+			break;
+		}
+		MINT_ASSERT(false, "This texture format is not supported yet!");
+		return 4;
+	}
+
+	bool is_block_compressed(const TextureFormat& format)
+	{
+		return format == TextureFormat::BC1_UNORM || format == TextureFormat::BC3_UNORM || format == TextureFormat::BC4_UNORM || format == TextureFormat::BC7_UNORM;
+	}
+
+	uint32 compute_row_pitch(const TextureFormat& format, const uint32 width)
+	{
+		switch (format)
+		{
+		case TextureFormat::BC1_UNORM:
+		case TextureFormat::BC4_UNORM:
+			return ((width + 3) / 4) * 8;
+		case TextureFormat::BC3_UNORM:
+		case TextureFormat::BC7_UNORM:
+			return ((width + 3) / 4) * 16;
+		default:
+			break;
+		}
+		return width * compute_texel_stride(format);
+	}
+
+	uint32 compute_texture_byte_size(const TextureFormat& format, const uint32 width, const uint32 height)
+	{
+		const uint32 rowCount = (is_block_compressed(format) == true ? (height + 3) / 4 : height);
+		return compute_row_pitch(format, width) * rowCount;
+	}
+
+	static const float* get_sRGB_to_linear_table()
+	{
+		static const std::vector<float> table = []()
+		{
+			std::vector<float> result(256);
+			for (uint32 value = 0; value < 256; ++value)
+			{
+				const float encoded = value / 255.0f;
+				result[value] = (encoded <= 0.04045f ? encoded / 12.92f : ::powf((encoded + 0.055f) / 1.055f, 2.4f));
+			}
+			return result;
+		}();
+		return table.data();
+	}
+
+	static byte convert_linear_to_sRGB(const float linear)
+	{
+		static constexpr uint32 kTableSize = 4096;
+		static const std::vector<byte> table = []()
+		{
+			std::vector<byte> result(kTableSize);
+			for (uint32 index = 0; index < kTableSize; ++index)
+			{
+				const float value = index / float(kTableSize - 1);
+				const float encoded = (value <= 0.0031308f ? value * 12.92f : 1.055f * ::powf(value, 1.0f / 2.4f) - 0.055f);
+				result[index] = static_cast<byte>(encoded * 255.0f + 0.5f);
+			}
+			return result;
+		}();
+		const float clamped = (std::min)((std::max)(linear, 0.0f), 1.0f);
+		return table[static_cast<uint32>(clamped * (kTableSize - 1) + 0.5f)];
+	}
+
+	// Weights of the source texels 2x + _firstTap ... 2x + _firstTap + _tapCount - 1 for destination texel x.
+	struct MipKernel
+	{
+		int32 _firstTap = 0;
+		uint32 _tapCount = 0;
+		float _weights[6]{};
+	};
+
+	static MipKernel make_MipKernel(const MipFilter& filter)
+	{
+		MipKernel kernel;
+		if (filter == MipFilter::Box)
+		{
+			kernel._firstTap = 0;
+			kernel._tapCount = 2;
+			kernel._weights[0] = 0.5f;
+			kernel._weights[1] = 0.5f;
+			return kernel;
+		}
+
+		// Kaiser-windowed sinc (alpha = 4, half width = 3 source texels).
+		const auto besselI0 = [](const float x)
+		{
+			float sum = 1.0f;
+			float term = 1.0f;
+			for (uint32 k = 1; k < 16; ++k)
+			{
+				term *= (x * 0.5f / k) * (x * 0.5f / k);
+				sum += term;
+			}
+			return sum;
+		};
+		constexpr float kAlpha = 4.0f;
+		constexpr float kHalfWidth = 3.0f;
+		kernel._firstTap = -2;
+		kernel._tapCount = 6;
+		float weightSum = 0.0f;
+		for (uint32 tap = 0; tap < kernel._tapCount; ++tap)
+		{
+			// Distance from the destination texel center, in source texels.
+			const float distance = (kernel._firstTap + static_cast<int32>(tap)) - 0.5f;
+			const float x = distance * 0.5f;
+			const float sinc = (x == 0.0f ? 1.0f : ::sinf(kPi * x) / (kPi * x));
+			const float ratio = distance / kHalfWidth;
+			const float window = besselI0(kAlpha * ::sqrtf((std::max)(1.0f - ratio * ratio, 0.0f))) / besselI0(kAlpha);
+			kernel._weights[tap] = sinc * window;
+			weightSum += kernel._weights[tap];
+		}
+		for (uint32 tap = 0; tap < kernel._tapCount; ++tap)
+		{
+			kernel._weights[tap] /= weightSum;
+		}
+		return kernel;
+	}
+
+	// The kernel of each destination texel along an axis. A box over an odd size n covers n / (n / 2) source texels per
+	// destination texel with 3 taps, weighted so every source texel counts the same and the last row or column is kept.
+	static void make_axis_MipKernels(const MipFilter& filter, const MipKernel& kernel, const uint32 sourceSize, const uint32 destinationSize, std::vector<MipKernel>& outKernels)
+	{
+		outKernels.assign(destinationSize, kernel);
+		if (filter != MipFilter::Box || sourceSize % 2 == 0 || sourceSize == 1)
+		{
+			return;
+		}
+
+		const float inverseSourceSize = 1.0f / sourceSize;
+		for (uint32 x = 0; x < destinationSize; ++x)
+		{
+			MipKernel& axisKernel = outKernels[x];
+			axisKernel._firstTap = 0;
+			axisKernel._tapCount = 3;
+			axisKernel._weights[0] = (destinationSize - x) * inverseSourceSize;
+			axisKernel._weights[1] = destinationSize * inverseSourceSize;
+			axisKernel._weights[2] = (x + 1) * inverseSourceSize;
+		}
+	}
+
+	// Separable 2:1 downsample of float texels, with one kernel per destination column and row. Rows are independent and
+	// run in parallel; the inner loops are plain float arithmetic over contiguous channels so the compiler can vectorize them.
+	static void downsample_texels(const std::vector<MipKernel>& columnKernels, const std::vector<MipKernel>& rowKernels, const uint32 channelCount, const std::vector<float>& source, const uint32 width, const uint32 height, std::vector<float>& destination, const uint32 destinationWidth, const uint32 destinationHeight)
+	{
+		std::vector<float> horizontal(size_t(destinationWidth) * height * channelCount);
+		parallel_for(height, [&](const uint32 y)
+			{
+				const float* const sourceRow = &source[size_t(y) * width * channelCount];
+				float* const destinationRow = &horizontal[size_t(y) * destinationWidth * channelCount];
+				for (uint32 x = 0; x < destinationWidth; ++x)
+				{
+					const MipKernel& kernel = columnKernels[x];
+					float* const texel = &destinationRow[size_t(x) * channelCount];
+					for (uint32 tap = 0; tap < kernel._tapCount; ++tap)
+					{
+						const int32 sourceX = (std::min)((std::max)(static_cast<int32>(x * 2) + kernel._firstTap + static_cast<int32>(tap), 0), static_cast<int32>(width) - 1);
+						const float* const sourceTexel = &sourceRow[size_t(sourceX) * channelCount];
+						for (uint32 channel = 0; channel < channelCount; ++channel)
+						{
+							texel[channel] += sourceTexel[channel] * kernel._weights[tap];
+						}
+					}
+				}
+			});
+
+		destination.clear();
+		destination.resize(size_t(destinationWidth) * destinationHeight * channelCount);
+		const size_t rowFloatCount = size_t(destinationWidth) * channelCount;
+		parallel_for(destinationHeight, [&](const uint32 y)
+			{
+				const MipKernel& kernel = rowKernels[y];
+				float* const destinationRow = &destination[y * rowFloatCount];
+				for (uint32 tap = 0; tap < kernel._tapCount; ++tap)
+				{
+					const int32 sourceY = (std::min)((std::max)(static_cast<int32>(y * 2) + kernel._firstTap + static_cast<int32>(tap), 0), static_cast<int32>(height) - 1);
+					const float* const sourceRow = &horizontal[sourceY * rowFloatCount];
+					const float weight = kernel._weights[tap];
+					for (size_t index = 0; index < rowFloatCount; ++index)
+					{
+						destinationRow[index] += sourceRow[index] * weight;
+					}
+				}
+			});
+	}
+
+	bool generate_mipmaps(TextureData& textureData, const MipFilter& filter, const bool is_sRGB)
+	{
+		if (textureData._format != TextureFormat::R8_UNORM && textureData._format != TextureFormat::R8G8B8A8_UNORM)
+		{
+			MINT_LOG_ERROR("Mipmaps can only be generated for uncompressed textures!");
+			return false;
+		}
+		if (textureData._mipLevels.empty() == true)
+		{
+			return false;
+		}
+
+		textureData._mipLevels.resize(1);
+		const TextureMipLevel& baseLevel = textureData._mipLevels[0];
+		const uint32 channelCount = compute_texel_stride(textureData._format);
+		const float* const sRGBToLinear = get_sRGB_to_linear_table();
+		// Alpha is never gamma encoded.
+		const auto is_color_channel = [&](const uint32 channel) { return is_sRGB == true && channel < 3; };
+
+		uint32 width = baseLevel._width;
+		uint32 height = baseLevel._height;
+		std::vector<float> texels(baseLevel._bytes.size());
+		for (size_t index = 0; index < texels.size(); ++index)
+		{
+			const byte value = baseLevel._bytes[index];
+			texels[index] = (is_color_channel(static_cast<uint32>(index % channelCount)) == true ? sRGBToLinear[value] : value / 255.0f);
+		}
+
+		const MipKernel kernel = make_MipKernel(filter);
+		std::vector<MipKernel> columnKernels;
+		std::vector<MipKernel> rowKernels;
+		std::vector<float> nextTexels;
+		while (width > 1 || height > 1)
+		{
+			const uint32 nextWidth = (std::max)(width / 2, 1u);
+			const uint32 nextHeight = (std::max)(height / 2, 1u);
+			make_axis_MipKernels(filter, kernel, width, nextWidth, columnKernels);
+			make_axis_MipKernels(filter, kernel, height, nextHeight, rowKernels);
+			downsample_texels(columnKernels, rowKernels, channelCount, texels, width, height, nextTexels, nextWidth, nextHeight);
+			std::swap(texels, nextTexels);
+			width = nextWidth;
+			height = nextHeight;
+
+			TextureMipLevel mipLevel;
+			mipLevel._width = width;
+			mipLevel._height = height;
+			mipLevel._bytes.resize(texels.size());
+			for (size_t index = 0; index < texels.size(); ++index)
+			{
+				const float value = texels[index];
+				mipLevel._bytes[index] = (is_color_channel(static_cast<uint32>(index % channelCount)) == true ? convert_linear_to_sRGB(value) : static_cast<byte>((std::min)((std::max)(value, 0.0f), 1.0f) * 255.0f + 0.5f));
+			}
+			textureData._mipLevels.push_back(std::move(mipLevel));
+		}
+		return true;
+	}
+
+	// 4x4 texels in RGBA, with edge texels repeated for blocks that cross the border.
+	static void fetch_texel_block(const TextureMipLevel& level, const TextureFormat& format, const uint32 blockX, const uint32 blockY, byte(&outTexels)[16][4])
+	{
+		const uint32 stride = compute_texel_stride(format);
+		for (uint32 row = 0; row < 4; ++row)
+		{
+			const uint32 y = (std::min)(blockY * 4 + row, level._height - 1);
+			for (uint32 column = 0; column < 4; ++column)
+			{
+				const uint32 x = (std::min)(blockX * 4 + column, level._width - 1);
+				const byte* const texel = &level._bytes[(size_t(y) * level._width + x) * stride];
+				byte(&outTexel)[4] = outTexels[row * 4 + column];
+				outTexel[0] = texel[0];
+				outTexel[1] = (stride == 4 ? texel[1] : texel[0]);
+				outTexel[2] = (stride == 4 ? texel[2] : texel[0]);
+				outTexel[3] = (stride == 4 ? texel[3] : 255);
+			}
+		}
+	}
+
+	static uint32 compute_color_distance_sq(const byte* const a, const byte* const b, const uint32 channelCount)
+	{
+		uint32 result = 0;
+		for (uint32 channel = 0; channel < channelCount; ++channel)
+		{
+			const int32 difference = static_cast<int32>(a[channel]) - static_cast<int32>(b[channel]);
+			result += static_cast<uint32>(difference * difference);
+		}
+		return result;
+	}
+
+	// Swaps the bounds of every channel that falls while the widest channel rises, so the endpoints follow the block's
+	// gradient instead of the main diagonal of its bounding box.
+	static void select_box_diagonal(const byte(&texels)[16][4], const uint32 channelCount, byte* const minColor, byte* const maxColor)
+	{
+		uint32 widestChannel = 0;
+		int32 sums[4]{};
+		for (uint32 channel = 0; channel < channelCount; ++channel)
+		{
+			if (maxColor[channel] - minColor[channel] > maxColor[widestChannel] - minColor[widestChannel])
+			{
+				widestChannel = channel;
+			}
+			for (uint32 texelIndex = 0; texelIndex < 16; ++texelIndex)
+			{
+				sums[channel] += texels[texelIndex][channel];
+			}
+		}
+
+		// Covariances with the widest channel, times 16 * 16 to stay in integers.
+		for (uint32 channel = 0; channel < channelCount; ++channel)
+		{
+			int64 covariance = 0;
+			for (uint32 texelIndex = 0; texelIndex < 16; ++texelIndex)
+			{
+				covariance += int64(texels[texelIndex][widestChannel] * 16 - sums[widestChannel]) * (texels[texelIndex][channel] * 16 - sums[channel]);
+			}
+			if (covariance < 0)
+			{
+				std::swap(minColor[channel], maxColor[channel]);
+			}
+		}
+	}
+
+	// BC1 color block; always in the 4-color mode, which is also how BC3 reads it.
+	static void encode_BC1_block(const byte(&texels)[16][4], byte* const outBlock)
+	{
+		byte minColor[3]{ 255, 255, 255 };
+		byte maxColor[3]{ 0, 0, 0 };
+		for (uint32 texelIndex = 0; texelIndex < 16; ++texelIndex)
+		{
+			for (uint32 channel = 0; channel < 3; ++channel)
+			{
+				minColor[channel] = (std::min)(minColor[channel], texels[texelIndex][channel]);
+				maxColor[channel] = (std::max)(maxColor[channel], texels[texelIndex][channel]);
+			}
+		}
+		// Inset the bounding box slightly; the extremes are rarely the best endpoints.
+		for (uint32 channel = 0; channel < 3; ++channel)
+		{
+			const byte inset = static_cast<byte>((maxColor[channel] - minColor[channel]) / 16);
+			minColor[channel] = static_cast<byte>(minColor[channel] + inset);
+			maxColor[channel] = static_cast<byte>(maxColor[channel] - inset);
+		}
+		select_box_diagonal(texels, 3, minColor, maxColor);
+
+		// Rounded to the nearest 5- and 6-bit values; truncating loses up to a whole step.
+		const auto to_565 = [](const byte(&color)[3]) { return static_cast<uint16_t>((((color[0] * 31 + 127) / 255) << 11) | (((color[1] * 63 + 127) / 255) << 5) | ((color[2] * 31 + 127) / 255)); };
+		uint16_t color0 = to_565(maxColor);
+		uint16_t color1 = to_565(minColor);
+		if (color0 < color1)
+		{
+			std::swap(color0, color1);
+		}
+
+		byte palette[4][3]{};
+		const auto from_565 = [](const uint16_t color, byte(&outColor)[3])
+		{
+			outColor[0] = static_cast<byte>(((color >> 11) & 31) * 255 / 31);
+			outColor[1] = static_cast<byte>(((color >> 5) & 63) * 255 / 63);
+			outColor[2] = static_cast<byte>((color & 31) * 255 / 31);
+		};
+		from_565(color0, palette[0]);
+		from_565(color1, palette[1]);
+		for (uint32 channel = 0; channel < 3; ++channel)
+		{
+			palette[2][channel] = static_cast<byte>((2 * palette[0][channel] + palette[1][channel]) / 3);
+			palette[3][channel] = static_cast<byte>((palette[0][channel] + 2 * palette[1][channel]) / 3);
+		}
+
+		uint32 indices = 0;
+		if (color0 != color1)
+		{
+			for (uint32 texelIndex = 0; texelIndex < 16; ++texelIndex)
+			{
+				uint32 bestIndex = 0;
+				uint32 bestDistance = UINT32_MAX;
+				for (uint32 paletteIndex = 0; paletteIndex < 4; ++paletteIndex)
+				{
+					const uint32 distance = compute_color_distance_sq(texels[texelIndex], palette[paletteIndex], 3);
+					if (distance < bestDistance)
+					{
+						bestDistance = distance;
+						bestIndex = paletteIndex;
+					}
+				}
+				indices |= bestIndex << (texelIndex * 2);
+			}
+		}
+
+		outBlock[0] = static_cast<byte>(color0 & 0xFF);
+		outBlock[1] = static_cast<byte>(color0 >> 8);
+		outBlock[2] = static_cast<byte>(color1 & 0xFF);
+		outBlock[3] = static_cast<byte>(color1 >> 8);
+		::memcpy(&outBlock[4], &indices, 4);
+	}
+
+	// BC4 block of one channel; BC3 uses the same layout for alpha.
+	static void encode_BC4_block(const byte(&texels)[16][4], const uint32 channel, byte* const outBlock)
+	{
+		byte minValue = 255;
+		byte maxValue = 0;
+		for (uint32 texelIndex = 0; texelIndex < 16; ++texelIndex)
+		{
+			minValue = (std::min)(minValue, texels[texelIndex][channel]);
+			maxValue = (std::max)(maxValue, texels[texelIndex][channel]);
+		}
+
+		// value0 > value1 selects the 8-value mode: codes 2..7 interpolate from value0 towards value1.
+		byte palette[8]{ maxValue, minValue };
+		for (uint32 code = 2; code < 8; ++code)
+		{
+			palette[code] = static_cast<byte>(((8 - code) * maxValue + (code - 1) * minValue + 3) / 7);
+		}
+
+		uint64 indices = 0;
+		if (maxValue != minValue)
+		{
+			for (uint32 texelIndex = 0; texelIndex < 16; ++texelIndex)
+			{
+				uint32 bestCode = 0;
+				int32 bestDistance = INT32_MAX;
+				for (uint32 code = 0; code < 8; ++code)
+				{
+					const int32 distance = std::abs(static_cast<int32>(texels[texelIndex][channel]) - static_cast<int32>(palette[code]));
+					if (distance < bestDistance)
+					{
+						bestDistance = distance;
+						bestCode = code;
+					}
+				}
+				indices |= uint64(bestCode) << (texelIndex * 3);
+			}
+		}
+
+		outBlock[0] = maxValue;
+		outBlock[1] = minValue;
+		for (uint32 byteIndex = 0; byteIndex < 6; ++byteIndex)
+		{
+			outBlock[2 + byteIndex] = static_cast<byte>(indices >> (byteIndex * 8));
+		}
+	}
+
+	// BC7 mode 6 only: one subset, RGBA endpoints of 7 bits plus a p-bit each, and 4-bit indices.
+	// This covers every block with a single color gradient, which is what most UI and sprite art is.
+	static void encode_BC7_block(const byte(&texels)[16][4], byte* const outBlock)
+	{
+		byte endpoints[2][4]{ { 255, 255, 255, 255 }, { 0, 0, 0, 0 } };
+		for (uint32 texelIndex = 0; texelIndex < 16; ++texelIndex)
+		{
+			for (uint32 channel = 0; channel < 4; ++channel)
+			{
+				endpoints[0][channel] = (std::min)(endpoints[0][channel], texels[texelIndex][channel]);
+				endpoints[1][channel] = (std::max)(endpoints[1][channel], texels[texelIndex][channel]);
+			}
+		}
+		select_box_diagonal(texels, 4, endpoints[0], endpoints[1]);
+
+		// Quantize each endpoint to 7 bits with the p-bit that loses the least.
+		byte quantized[2][4]{};
+		uint32 pBits[2]{};
+		byte reconstructed[2][4]{};
+		for (uint32 endpointIndex = 0; endpointIndex < 2; ++endpointIndex)
+		{
+			uint32 bestError = UINT32_MAX;
+			for (uint32 pBit = 0; pBit < 2; ++pBit)
+			{
+				byte candidate[4]{};
+				byte candidateReconstructed[4]{};
+				for (uint32 channel = 0; channel < 4; ++channel)
+				{
+					const int32 value = (static_cast<int32>(endpoints[endpointIndex][channel]) - static_cast<int32>(pBit) + 1) / 2;
+					candidate[channel] = static_cast<byte>((std::min)((std::max)(value, 0), 127));
+					candidateReconstructed[channel] = static_cast<byte>((candidate[channel] << 1) | pBit);
+				}
+				const uint32 error = compute_color_distance_sq(endpoints[endpointIndex], candidateReconstructed, 4);
+				if (error < bestError)
+				{
+					bestError = error;
+					pBits[endpointIndex] = pBit;
+					::memcpy(quantized[endpointIndex], candidate, 4);
+					::memcpy(reconstructed[endpointIndex], candidateReconstructed, 4);
+				}
+			}
+		}
+
+		static constexpr uint32 kWeights[16]{ 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+		byte palette[16][4]{};
+		for (uint32 paletteIndex = 0; paletteIndex < 16; ++paletteIndex)
+		{
+			for (uint32 channel = 0; channel < 4; ++channel)
+			{
+				palette[paletteIndex][channel] = static_cast<byte>(((64 - kWeights[paletteIndex]) * reconstructed[0][channel] + kWeights[paletteIndex] * reconstructed[1][channel] + 32) >> 6);
+			}
+		}
+
+		uint32 indices[16]{};
+		for (uint32 texelIndex = 0; texelIndex < 16; ++texelIndex)
+		{
+			uint32 bestDistance = UINT32_MAX;
+			for (uint32 paletteIndex = 0; paletteIndex < 16; ++paletteIndex)
+			{
+				const uint32 distance = compute_color_distance_sq(texels[texelIndex], palette[paletteIndex], 4);
+				if (distance < bestDistance)
+				{
+					bestDistance = distance;
+					indices[texelIndex] = paletteIndex;
+				}
+			}
+		}
+
+		// The first index is stored without its top bit, so it must be below 8.
+		if (indices[0] >= 8)
+		{
+			std::swap(quantized[0], quantized[1]);
+			std::swap(pBits[0], pBits[1]);
+			for (uint32 texelIndex = 0; texelIndex < 16; ++texelIndex)
+			{
+				indices[texelIndex] = 15 - indices[texelIndex];
+			}
+		}
+
+		uint64 bits[2]{};
+		uint32 bitOffset = 0;
+		const auto write_bits = [&](const uint64 value, const uint32 bitCount)
+		{
+			for (uint32 bit = 0; bit < bitCount; ++bit, ++bitOffset)
+			{
+				bits[bitOffset / 64] |= ((value >> bit) & 1) << (bitOffset % 64);
+			}
+		};
+		write_bits(1 << 6, 7); // Mode 6
+		for (uint32 channel = 0; channel < 4; ++channel)
+		{
+			write_bits(quantized[0][channel], 7);
+			write_bits(quantized[1][channel], 7);
+		}
+		write_bits(pBits[0], 1);
+		write_bits(pBits[1], 1);
+		write_bits(indices[0], 3);
+		for (uint32 texelIndex = 1; texelIndex < 16; ++texelIndex)
+		{
+			write_bits(indices[texelIndex], 4);
+		}
+		for (uint32 byteIndex = 0; byteIndex < 16; ++byteIndex)
+		{
+			outBlock[byteIndex] = static_cast<byte>(bits[byteIndex / 8] >> ((byteIndex % 8) * 8));
+		}
+	}
+
+	bool compress_texture(const TextureData& source, const TextureFormat& blockFormat, TextureData& outCompressed)
+	{
+		if (is_block_compressed(blockFormat) == false)
+		{
+			MINT_LOG_ERROR("The target format must be block compressed!");
+			return false;
+		}
+		if (source._format != TextureFormat::R8G8B8A8_UNORM && (source._format != TextureFormat::R8_UNORM || blockFormat != TextureFormat::BC4_UNORM))
+		{
+			MINT_LOG_ERROR("This source format can't be compressed into the target format!");
+			return false;
+		}
+
+		outCompressed._format = blockFormat;
+		outCompressed._mipLevels.resize(source._mipLevels.size());
+		const uint32 blockByteSize = compute_row_pitch(blockFormat, 4);
+		for (size_t levelIndex = 0; levelIndex < source._mipLevels.size(); ++levelIndex)
+		{
+			const TextureMipLevel& sourceLevel = source._mipLevels[levelIndex];
+			TextureMipLevel& compressedLevel = outCompressed._mipLevels[levelIndex];
+			compressedLevel._width = sourceLevel._width;
+			compressedLevel._height = sourceLevel._height;
+			compressedLevel._bytes.clear();
+			compressedLevel._bytes.resize(compute_texture_byte_size(blockFormat, sourceLevel._width, sourceLevel._height));
+			if (compressedLevel._bytes.empty() == true)
+			{
+				continue;
+			}
+
+			const uint32 blockCountX = (sourceLevel._width + 3) / 4;
+			const uint32 blockCountY = (sourceLevel._height + 3) / 4;
+			parallel_for(blockCountY, [&](const uint32 blockY)
+				{
+					byte texels[16][4]{};
+					for (uint32 blockX = 0; blockX < blockCountX; ++blockX)
+					{
+						fetch_texel_block(sourceLevel, source._format, blockX, blockY, texels);
+						byte* const block = &compressedLevel._bytes[(size_t(blockY) * blockCountX + blockX) * blockByteSize];
+						switch (blockFormat)
+						{
+						case TextureFormat::BC1_UNORM:
+							encode_BC1_block(texels, block);
+							break;
+						case TextureFormat::BC3_UNORM:
+							encode_BC4_block(texels, 3, block);
+							encode_BC1_block(texels, block + 8);
+							break;
+						case TextureFormat::BC4_UNORM:
+							encode_BC4_block(texels, 0, block);
+							break;
+						case TextureFormat::BC7_UNORM:
+							encode_BC7_block(texels, block);
+							break;
+						default:
+							break;
+						}
+					}
+				});
+		}
+		return true;
+	}
+
+	void SkylinePacker::init(const uint32 width, const uint32 height)
+	{
+		_width = width;
+		_height = height;
+		_usedArea = 0;
+		_skyline.clear();
+		_skyline.push_back(SkylineNode{ 0, 0, width });
+		_freeRects.clear();
+	}
+
+	bool SkylinePacker::allocate(const uint32 width, const uint32 height, AtlasRect& outRect)
+	{
+		if (width == 0 || height == 0 || width > _width || height > _height)
+		{
+			return false;
+		}
+
+		if (allocate_from_free_rects(width, height, outRect) == false && allocate_from_skyline(width, height, outRect) == false)
+		{
+			return false;
+		}
+		_usedArea += uint64(width) * height;
+		return true;
+	}
+
+	bool SkylinePacker::allocate_at(const AtlasRect& rect)
+	{
+		const uint32 right = rect._x + rect._width;
+		const uint32 bottom = rect._y + rect._height;
+		if (rect._width == 0 || rect._height == 0 || right > _width || bottom > _height)
+		{
+			return false;
+		}
+
+		// Cut rect out of the free rectangles it overlaps, keeping the parts around it.
+		const uint32 freeRectCount = static_cast<uint32>(_freeRects.size());
+		for (uint32 freeRectIndex = 0; freeRectIndex < freeRectCount; ++freeRectIndex)
+		{
+			const AtlasRect freeRect = _freeRects[freeRectIndex];
+			const uint32 freeRight = freeRect._x + freeRect._width;
+			const uint32 freeBottom = freeRect._y + freeRect._height;
+			if (freeRect._x >= right || rect._x >= freeRight || freeRect._y >= bottom || rect._y >= freeBottom)
+			{
+				continue;
+			}
+
+			const uint32 top = (std::max)(freeRect._y, rect._y);
+			const uint32 middleBottom = (std::min)(freeBottom, bottom);
+			_freeRects[freeRectIndex]._width = 0;
+			if (freeRect._y < rect._y)
+			{
+				_freeRects.push_back(AtlasRect{ freeRect._x, freeRect._y, freeRect._width, rect._y - freeRect._y });
+			}
+			if (bottom < freeBottom)
+			{
+				_freeRects.push_back(AtlasRect{ freeRect._x, bottom, freeRect._width, freeBottom - bottom });
+			}
+			if (freeRect._x < rect._x)
+			{
+				_freeRects.push_back(AtlasRect{ freeRect._x, top, rect._x - freeRect._x, middleBottom - top });
+			}
+			if (right < freeRight)
+			{
+				_freeRects.push_back(AtlasRect{ right, top, freeRight - right, middleBottom - top });
+			}
+		}
+		_freeRects.erase(std::remove_if(_freeRects.begin(), _freeRects.end(), [](const AtlasRect& freeRect) { return freeRect._width == 0; }), _freeRects.end());
+
+		// Raise the skyline over the part of rect above it; a gap between the skyline and rect becomes a free rectangle.
+		split_skyline_at(rect._x);
+		split_skyline_at(right);
+		_gapRects.clear();
+		for (SkylineNode& node : _skyline)
+		{
+			if (node._x < rect._x || node._x >= right || node._y >= bottom)
+			{
+				continue;
+			}
+
+			if (node._y < rect._y)
+			{
+				_gapRects.push_back(AtlasRect{ node._x, node._y, node._width, rect._y - node._y });
+			}
+			node._y = bottom;
+		}
+		merge_skyline();
+
+		for (const AtlasRect& gapRect : _gapRects)
+		{
+			add_free_rect(gapRect);
+		}
+		_usedArea += uint64(rect._width) * rect._height;
+		return true;
+	}
+
+	void SkylinePacker::release(const AtlasRect& rect)
+	{
+		if (rect._width == 0 || rect._height == 0)
+		{
+			return;
+		}
+
+		_usedArea -= uint64(rect._width) * rect._height;
+		if (_usedArea == 0)
+		{
+			init(_width, _height);
+			return;
+		}
+
+		add_free_rect(rect);
+	}
+
+	void SkylinePacker::add_free_rect(const AtlasRect& rect)
+	{
+		AtlasRect freeRect = rect;
+		for (uint32 freeRectIndex = 0; freeRectIndex < _freeRects.size(); )
+		{
+			if (merge_rects(freeRect, _freeRects[freeRectIndex]) == true)
+			{
+				// The grown rectangle may now share an edge with a free rectangle that was checked already.
+				_freeRects[freeRectIndex] = _freeRects.back();
+				_freeRects.pop_back();
+				freeRectIndex = 0;
+				continue;
+			}
+			++freeRectIndex;
+		}
+		if (return_to_skyline(freeRect) == false)
+		{
+			_freeRects.push_back(freeRect);
+			return;
+		}
+
+		// A lowered skyline may reach the top edge of other free rectangles.
+		for (uint32 freeRectIndex = 0; freeRectIndex < _freeRects.size(); )
+		{
+			if (return_to_skyline(_freeRects[freeRectIndex]) == true)
+			{
+				_freeRects[freeRectIndex] = _freeRects.back();
+				_freeRects.pop_back();
+				freeRectIndex = 0;
+				continue;
+			}
+			++freeRectIndex;
+		}
+	}
+
+	bool SkylinePacker::merge_rects(AtlasRect& inoutRect, const AtlasRect& rect)
+	{
+		if (inoutRect._x == rect._x && inoutRect._width == rect._width)
+		{
+			if (rect._y + rect._height == inoutRect._y)
+			{
+				inoutRect._y = rect._y;
+				inoutRect._height += rect._height;
+				return true;
+			}
+			if (inoutRect._y + inoutRect._height == rect._y)
+			{
+				inoutRect._height += rect._height;
+				return true;
+			}
+		}
+		if (inoutRect._y == rect._y && inoutRect._height == rect._height)
+		{
+			if (rect._x + rect._width == inoutRect._x)
+			{
+				inoutRect._x = rect._x;
+				inoutRect._width += rect._width;
+				return true;
+			}
+			if (inoutRect._x + inoutRect._width == rect._x)
+			{
+				inoutRect._width += rect._width;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool SkylinePacker::return_to_skyline(const AtlasRect& rect)
+	{
+		const uint32 right = rect._x + rect._width;
+		const uint32 top = rect._y + rect._height;
+		for (const SkylineNode& node : _skyline)
+		{
+			if (node._x < right && node._x + node._width > rect._x && node._y != top)
+			{
+				return false;
+			}
+		}
+
+		split_skyline_at(rect._x);
+		split_skyline_at(right);
+		for (SkylineNode& node : _skyline)
+		{
+			if (node._x >= rect._x && node._x < right)
+			{
+				node._y = rect._y;
+			}
+		}
+		merge_skyline();
+		return true;
+	}
+
+	void SkylinePacker::split_skyline_at(const uint32 x)
+	{
+		const uint32 nodeCount = static_cast<uint32>(_skyline.size());
+		for (uint32 nodeIndex = 0; nodeIndex < nodeCount; ++nodeIndex)
+		{
+			SkylineNode& node = _skyline[nodeIndex];
+			if (node._x < x && x < node._x + node._width)
+			{
+				const SkylineNode rightNode{ x, node._y, node._x + node._width - x };
+				node._width = x - node._x;
+				_skyline.insert(_skyline.begin() + nodeIndex + 1, rightNode);
+				return;
+			}
+		}
+	}
+
+	void SkylinePacker::merge_skyline()
+	{
+		for (uint32 i = 0; i + 1 < _skyline.size(); )
+		{
+			if (_skyline[i]._y == _skyline[i + 1]._y)
+			{
+				_skyline[i]._width += _skyline[i + 1]._width;
+				_skyline.erase(_skyline.begin() + i + 1);
+				continue;
+			}
+			++i;
+		}
+	}
+
+	bool SkylinePacker::allocate_from_free_rects(const uint32 width, const uint32 height, AtlasRect& outRect)
+	{
+		uint32 bestIndex = UINT32_MAX;
+		uint64 bestArea = UINT64_MAX;
+		const uint32 freeRectCount = static_cast<uint32>(_freeRects.size());
+		for (uint32 freeRectIndex = 0; freeRectIndex < freeRectCount; ++freeRectIndex)
+		{
+			const AtlasRect& freeRect = _freeRects[freeRectIndex];
+			if (freeRect._width < width || freeRect._height < height)
+			{
+				continue;
+			}
+
+			const uint64 area = uint64(freeRect._width) * freeRect._height;
+			if (area < bestArea)
+			{
+				bestArea = area;
+				bestIndex = freeRectIndex;
+			}
+		}
+		if (bestIndex == UINT32_MAX)
+		{
+			return false;
+		}
+
+		const AtlasRect freeRect = _freeRects[bestIndex];
+		_freeRects[bestIndex] = _freeRects.back();
+		_freeRects.pop_back();
+
+		outRect = AtlasRect{ freeRect._x, freeRect._y, width, height };
+
+		// Split along the shorter leftover axis so the bigger leftover stays in one piece.
+		const uint32 leftoverWidth = freeRect._width - width;
+		const uint32 leftoverHeight = freeRect._height - height;
+		AtlasRect right{ freeRect._x + width, freeRect._y, leftoverWidth, height };
+		AtlasRect bottom{ freeRect._x, freeRect._y + height, freeRect._width, leftoverHeight };
+		if (leftoverWidth > leftoverHeight)
+		{
+			right._height = freeRect._height;
+			bottom._width = width;
+		}
+		if (right._width > 0 && right._height > 0)
+		{
+			_freeRects.push_back(right);
+		}
+		if (bottom._width > 0 && bottom._height > 0)
+		{
+			_freeRects.push_back(bottom);
+		}
+		return true;
+	}
+
+	bool SkylinePacker::fit_skyline(const uint32 nodeIndex, const uint32 width, const uint32 height, uint32& outY) const
+	{
+		const uint32 x = _skyline[nodeIndex]._x;
+		if (x + width > _width)
+		{
+			return false;
+		}
+
+		uint32 y = 0;
+		uint32 remainingWidth = width;
+		const uint32 nodeCount = static_cast<uint32>(_skyline.size());
+		for (uint32 i = nodeIndex; i < nodeCount && remainingWidth > 0; ++i)
+		{
+			y = (std::max)(y, _skyline[i]._y);
+			if (y + height > _height)
+			{
+				return false;
+			}
+			remainingWidth -= (std::min)(remainingWidth, _skyline[i]._width);
+		}
+		outY = y;
+		return true;
+	}
+
+	bool SkylinePacker::allocate_from_skyline(const uint32 width, const uint32 height, AtlasRect& outRect)
+	{
+		uint32 bestIndex = UINT32_MAX;
+		uint32 bestBottom = UINT32_MAX;
+		uint32 bestWidth = UINT32_MAX;
+		uint32 bestY = 0;
+		const uint32 nodeCount = static_cast<uint32>(_skyline.size());
+		for (uint32 nodeIndex = 0; nodeIndex < nodeCount; ++nodeIndex)
+		{
+			uint32 y = 0;
+			if (fit_skyline(nodeIndex, width, height, y) == false)
+			{
+				continue;
+			}
+
+			const uint32 bottom = y + height;
+			if (bottom < bestBottom || (bottom == bestBottom && _skyline[nodeIndex]._width < bestWidth))
+			{
+				bestIndex = nodeIndex;
+				bestBottom = bottom;
+				bestWidth = _skyline[nodeIndex]._width;
+				bestY = y;
+			}
+		}
+		if (bestIndex == UINT32_MAX)
+		{
+			return false;
+		}
+
+		outRect = AtlasRect{ _skyline[bestIndex]._x, bestY, width, height };
+
+		// The new rectangle rests on the highest node it spans; the gaps under it over lower nodes become free rectangles.
+		const uint32 newRight = outRect._x + width;
+		_gapRects.clear();
+		for (uint32 i = bestIndex; i < nodeCount && _skyline[i]._x < newRight; ++i)
+		{
+			const SkylineNode& node = _skyline[i];
+			if (node._y < bestY)
+			{
+				_gapRects.push_back(AtlasRect{ node._x, node._y, (std::min)(node._x + node._width, newRight) - node._x, bestY - node._y });
+			}
+		}
+
+		_skyline.insert(_skyline.begin() + bestIndex, SkylineNode{ outRect._x, bestY + height, width });
+
+		// Shrink or remove the nodes now covered by the new one.
+		for (uint32 i = bestIndex + 1; i < _skyline.size(); )
+		{
+			SkylineNode& node = _skyline[i];
+			if (node._x >= newRight)
+			{
+				break;
+			}
+
+			const uint32 nodeRight = node._x + node._width;
+			if (nodeRight <= newRight)
+			{
+				_skyline.erase(_skyline.begin() + i);
+				continue;
+			}
+			node._width = nodeRight - newRight;
+			node._x = newRight;
+			break;
+		}
+
+		merge_skyline();
+
+		for (const AtlasRect& gapRect : _gapRects)
+		{
+			add_free_rect(gapRect);
+		}
+		return true;
+	}
+
+	void TextureAtlas::init(const TextureFormat& format, const uint32 width, const uint32 height, const uint32 padding)
+	{
+		_packer.init(width, height);
+		_format = format;
+		_texelStride = compute_texel_stride(format);
+		_padding = padding;
+		_texels.clear();
+		_texels.resize(size_t(width) * height * _texelStride);
+		_dirtyRects.clear();
+		mark_dirty(AtlasRect{ 0, 0, width, height });
+	}
+
+	AtlasRegion TextureAtlas::allocate(const uint32 width, const uint32 height)
+	{
+		AtlasRect paddedRect;
+		if (_packer.allocate(width + _padding * 2, height + _padding * 2, paddedRect) == false)
+		{
+			return AtlasRegion();
+		}
+		return make_region(paddedRect);
+	}
+
+	AtlasRegion TextureAtlas::allocate_at(const AtlasRect& rect)
+	{
+		if (rect._x < _padding || rect._y < _padding)
+		{
+			return AtlasRegion();
+		}
+
+		const AtlasRect paddedRect{ rect._x - _padding, rect._y - _padding, rect._width + _padding * 2, rect._height + _padding * 2 };
+		if (_packer.allocate_at(paddedRect) == false)
+		{
+			return AtlasRegion();
+		}
+		return make_region(paddedRect);
+	}
+
+	AtlasRegion TextureAtlas::make_region(const AtlasRect& paddedRect) const
+	{
+		AtlasRegion region;
+		region._rect = AtlasRect{ paddedRect._x + _padding, paddedRect._y + _padding, paddedRect._width - _padding * 2, paddedRect._height - _padding * 2 };
+		const float atlasWidth = static_cast<float>(get_width());
+		const float atlasHeight = static_cast<float>(get_height());
+		region._uvMin = float2(region._rect._x / atlasWidth, region._rect._y / atlasHeight);
+		region._uvMax = float2((region._rect._x + region._rect._width) / atlasWidth, (region._rect._y + region._rect._height) / atlasHeight);
+		return region;
+	}
+
+	void TextureAtlas::release(const AtlasRegion& region)
+	{
+		if (region.is_valid() == false)
+		{
+			return;
+		}
+
+		const AtlasRect& rect = region._rect;
+		_packer.release(AtlasRect{ rect._x - _padding, rect._y - _padding, rect._width + _padding * 2, rect._height + _padding * 2 });
+	}
+
+	void TextureAtlas::write(const AtlasRegion& region, const void* const content, uint32 rowPitch)
+	{
+		if (region.is_valid() == false || content == nullptr)
+		{
+			return;
+		}
+
+		const AtlasRect& rect = region._rect;
+		const uint32 rowByteCount = rect._width * _texelStride;
+		if (rowPitch == 0)
+		{
+			rowPitch = rowByteCount;
+		}
+
+		const byte* const source = static_cast<const byte*>(content);
+		const size_t atlasRowPitch = size_t(get_width()) * _texelStride;
+		for (uint32 row = 0; row < rect._height; ++row)
+		{
+			byte* const destination = &_texels[(rect._y + row) * atlasRowPitch + size_t(rect._x) * _texelStride];
+			::memcpy(destination, source + size_t(row) * rowPitch, rowByteCount);
+			// The padding repeats the edge texels, so bilinear sampling at the edge never blends in a previous occupant.
+			for (uint32 paddingIndex = 1; paddingIndex <= _padding; ++paddingIndex)
+			{
+				::memcpy(destination - size_t(paddingIndex) * _texelStride, destination, _texelStride);
+				::memcpy(destination + rowByteCount + size_t(paddingIndex - 1) * _texelStride, destination + rowByteCount - _texelStride, _texelStride);
+			}
+		}
+
+		const AtlasRect paddedRect{ rect._x - _padding, rect._y - _padding, rect._width + _padding * 2, rect._height + _padding * 2 };
+		const size_t paddedRowByteCount = size_t(paddedRect._width) * _texelStride;
+		const byte* const topRow = &_texels[rect._y * atlasRowPitch + size_t(paddedRect._x) * _texelStride];
+		const byte* const bottomRow = &_texels[(rect._y + rect._height - 1) * atlasRowPitch + size_t(paddedRect._x) * _texelStride];
+		for (uint32 paddingIndex = 1; paddingIndex <= _padding; ++paddingIndex)
+		{
+			::memcpy(&_texels[(rect._y - paddingIndex) * atlasRowPitch + size_t(paddedRect._x) * _texelStride], topRow, paddedRowByteCount);
+			::memcpy(&_texels[(rect._y + rect._height - 1 + paddingIndex) * atlasRowPitch + size_t(paddedRect._x) * _texelStride], bottomRow, paddedRowByteCount);
+		}
+		mark_dirty(paddedRect);
+	}
+
+	void TextureAtlas::clear()
+	{
+		init(_format, get_width(), get_height(), _padding);
+	}
+
+	void TextureAtlas::mark_dirty(const AtlasRect& rect)
+	{
+		if (_dirtyRects.size() < kMaxDirtyRectCount)
+		{
+			_dirtyRects.push_back(rect);
+			return;
+		}
+
+		// Too many small uploads: collapse into one bounding rectangle.
+		uint32 left = rect._x;
+		uint32 top = rect._y;
+		uint32 right = rect._x + rect._width;
+		uint32 bottom = rect._y + rect._height;
+		for (const AtlasRect& dirtyRect : _dirtyRects)
+		{
+			left = (std::min)(left, dirtyRect._x);
+			top = (std::min)(top, dirtyRect._y);
+			right = (std::max)(right, dirtyRect._x + dirtyRect._width);
+			bottom = (std::max)(bottom, dirtyRect._y + dirtyRect._height);
+		}
+		_dirtyRects.clear();
+		_dirtyRects.push_back(AtlasRect{ left, top, right - left, bottom - top });
+	}
+
+	uint32 decode_UTF8(const char*& at, const char* const end)
+	{
+		const byte lead = static_cast<byte>(*at);
+		++at;
+		if (lead < 0x80)
+		{
+			return lead;
+		}
+
+		uint32 continuationCount = 0;
+		uint32 codepoint = 0;
+		uint32 minCodepoint = 0;
+		if ((lead & 0xE0) == 0xC0)
+		{
+			continuationCount = 1;
+			codepoint = lead & 0x1F;
+			minCodepoint = 0x80;
+		}
+		else if ((lead & 0xF0) == 0xE0)
+		{
+			continuationCount = 2;
+			codepoint = lead & 0x0F;
+			minCodepoint = 0x800;
+		}
+		else if ((lead & 0xF8) == 0xF0)
+		{
+			continuationCount = 3;
+			codepoint = lead & 0x07;
+			minCodepoint = 0x10000;
+		}
+		else
+		{
+			return 0xFFFD;
+		}
+
+		if (end - at < static_cast<ptrdiff_t>(continuationCount))
+		{
+			return 0xFFFD;
+		}
+		for (uint32 i = 0; i < continuationCount; ++i)
+		{
+			const byte continuation = static_cast<byte>(at[i]);
+			if ((continuation & 0xC0) != 0x80)
+			{
+				return 0xFFFD;
+			}
+			codepoint = (codepoint << 6) | (continuation & 0x3F);
+		}
+		if (codepoint < minCodepoint || codepoint > 0x10FFFF || (codepoint >= 0xD800 && codepoint <= 0xDFFF))
+		{
+			return 0xFFFD;
+		}
+		at += continuationCount;
+		return codepoint;
+	}
+
+	bool rasterize_default_font_glyph(const uint32 codepoint, GlyphBitmap& outBitmap)
+	{
+		if (codepoint > 0xFF)
+		{
+			return false;
+		}
+
+		const DefaultFontGlyphMeta& glyphMeta = kDefaultFontData.get_GlyphMeta(static_cast<byte>(codepoint));
+		if (glyphMeta._ch != codepoint)
+		{
+			return false;
+		}
+
+		const uint32 x0 = static_cast<uint32>(glyphMeta._u0 * kFontTextureWidth + 0.5f);
+		const uint32 y0 = static_cast<uint32>(glyphMeta._v0 * kFontTextureHeight + 0.5f);
+		outBitmap._width = kFontTextureGlyphWidth;
+		outBitmap._height = kFontTextureGlyphHeight;
+		outBitmap._offset = float2(0, 0);
+		outBitmap._advance = static_cast<float>(kFontTextureGlyphWidth);
+		outBitmap._coverage.resize(size_t(kFontTextureGlyphWidth) * kFontTextureGlyphHeight);
+		for (uint32 y = 0; y < kFontTextureGlyphHeight; ++y)
+		{
+			::memcpy(&outBitmap._coverage[size_t(y) * kFontTextureGlyphWidth], &kDefaultFontTexture._texels[size_t(y0 + y) * kFontTextureWidth + x0], kFontTextureGlyphWidth);
+		}
+		return true;
+	}
+
+	void BitmapFontSource::init(const byte* const coverage, const uint32 width, const uint32 height, const uint32 cellWidth, const uint32 cellHeight, const uint32 firstCodepoint)
+	{
+		MINT_ASSERT(cellWidth > 0 && cellHeight > 0, "Cell size must not be zero!");
+		_coverage.assign(coverage, coverage + size_t(width) * height);
+		_width = width;
+		_height = height;
+		_cellWidth = cellWidth;
+		_cellHeight = cellHeight;
+		_firstCodepoint = firstCodepoint;
+	}
+
+	bool BitmapFontSource::rasterize(const uint32 codepoint, GlyphBitmap& outBitmap) const
+	{
+		if (codepoint < _firstCodepoint || _cellWidth == 0 || _cellHeight == 0)
+		{
+			return false;
+		}
+
+		const uint32 cellCountInRow = _width / _cellWidth;
+		const uint32 cellIndex = codepoint - _firstCodepoint;
+		if (cellCountInRow == 0 || cellIndex >= cellCountInRow * (_height / _cellHeight))
+		{
+			return false;
+		}
+
+		const uint32 x0 = (cellIndex % cellCountInRow) * _cellWidth;
+		const uint32 y0 = (cellIndex / cellCountInRow) * _cellHeight;
+		outBitmap._width = _cellWidth;
+		outBitmap._height = _cellHeight;
+		outBitmap._offset = float2(0, 0);
+		outBitmap._advance = static_cast<float>(_cellWidth);
+		outBitmap._coverage.resize(size_t(_cellWidth) * _cellHeight);
+		for (uint32 y = 0; y < _cellHeight; ++y)
+		{
+			::memcpy(&outBitmap._coverage[size_t(y) * _cellWidth], &_coverage[size_t(y0 + y) * _width + x0], _cellWidth);
+		}
+		return true;
+	}
+
+	void GlyphCache::init(const uint32 atlasWidth, const uint32 atlasHeight, const GlyphRasterizer& rasterizer, const uint32 fallbackCodepoint)
+	{
+		_atlas.init(TextureFormat::R8G8B8A8_UNORM, atlasWidth, atlasHeight);
+		_rasterizer = rasterizer;
+		_fallbackCodepoint = fallbackCodepoint;
+		_entries.clear();
+		_freeEntryIndices.clear();
+		_entryIndexMap.clear();
+		_head = kInvalidEntryIndex;
+		_tail = kInvalidEntryIndex;
+		_frameIndex = 1;
+		_pinnedFrame = 1;
+		_statistics = GlyphCacheStatistics();
+	}
+
+	const CachedGlyph* GlyphCache::find_or_add(const uint32 codepoint)
+	{
+		auto found = _entryIndexMap.find(codepoint);
+		if (found != _entryIndexMap.end())
+		{
+			++_statistics._hitCount;
+			const uint32 entryIndex = found->second;
+			_entries[entryIndex]._lastUsedFrame = _frameIndex;
+			if (_head != entryIndex)
+			{
+				unlink(entryIndex);
+				link_front(entryIndex);
+			}
+			return &_entries[entryIndex]._glyph;
+		}
+
+		++_statistics._missCount;
+		const CachedGlyph* const glyph = add(codepoint);
+		if (glyph != nullptr)
+		{
+			return glyph;
+		}
+
+		++_statistics._failureCount;
+		if (codepoint == _fallbackCodepoint)
+		{
+			return nullptr;
+		}
+		return find_or_add(_fallbackCodepoint);
+	}
+
+	float2 GlyphCache::write_sprites(const Color& color, const std::string_view text, const float2& position, const float scale, std::vector<Sprite>& outSprites)
+	{
+		float2 pen = position;
+		const char* at = text.data();
+		const char* const end = at + text.size();
+		while (at < end)
+		{
+			const CachedGlyph* const glyph = find_or_add(decode_UTF8(at, end));
+			if (glyph == nullptr)
+			{
+				continue;
+			}
+
+			if (glyph->_region.is_valid() == true)
+			{
+				Sprite sprite;
+				sprite._size = float2(glyph->_size.x * scale, glyph->_size.y * scale);
+				sprite._position = float2(pen.x + glyph->_offset.x * scale + sprite._size.x * 0.5f, pen.y + glyph->_offset.y * scale + sprite._size.y * 0.5f);
+				sprite._color = color;
+				sprite.set_AtlasRegion(glyph->_region);
+				outSprites.push_back(sprite);
+			}
+			pen.x += glyph->_advance * scale;
+		}
+		return pen;
+	}
+
+	const CachedGlyph* GlyphCache::add(const uint32 codepoint)
+	{
+		if (_rasterizer == nullptr || _rasterizer(codepoint, _bitmap) == false)
+		{
+			return nullptr;
+		}
+
+		CachedGlyph glyph;
+		glyph._size = float2(static_cast<float>(_bitmap._width), static_cast<float>(_bitmap._height));
+		glyph._offset = _bitmap._offset;
+		glyph._advance = _bitmap._advance;
+		// Blank glyphs such as spaces take no atlas space.
+		const bool is_blank = std::all_of(_bitmap._coverage.begin(), _bitmap._coverage.end(), [](const byte coverage) { return coverage == 0; });
+		if (is_blank == false)
+		{
+			glyph._region = _atlas.allocate(_bitmap._width, _bitmap._height);
+			if (glyph._region.is_valid() == false)
+			{
+				glyph._region = make_room(_bitmap._width, _bitmap._height);
+				if (glyph._region.is_valid() == false)
+				{
+					return nullptr;
+				}
+			}
+
+			_texels.resize(_bitmap._coverage.size() * 4);
+			for (size_t texelIndex = 0; texelIndex < _bitmap._coverage.size(); ++texelIndex)
+			{
+				_texels[texelIndex * 4 + 0] = 255;
+				_texels[texelIndex * 4 + 1] = 255;
+				_texels[texelIndex * 4 + 2] = 255;
+				_texels[texelIndex * 4 + 3] = _bitmap._coverage[texelIndex];
+			}
+			_atlas.write(glyph._region, _texels.data());
+		}
+
+		uint32 entryIndex = kInvalidEntryIndex;
+		if (_freeEntryIndices.empty() == false)
+		{
+			entryIndex = _freeEntryIndices.back();
+			_freeEntryIndices.pop_back();
+		}
+		else
+		{
+			entryIndex = static_cast<uint32>(_entries.size());
+			_entries.push_back(Entry());
+		}
+
+		Entry& entry = _entries[entryIndex];
+		entry._codepoint = codepoint;
+		entry._glyph = glyph;
+		entry._lastUsedFrame = _frameIndex;
+		link_front(entryIndex);
+		_entryIndexMap[codepoint] = entryIndex;
+		_statistics._glyphCount = static_cast<uint32>(_entryIndexMap.size());
+		return &entry._glyph;
+	}
+
+	AtlasRegion GlyphCache::make_room(const uint32 width, const uint32 height)
+	{
+		const uint32 padding = _atlas.get_padding();
+		const uint32 paddedWidth = width + padding * 2;
+		const uint32 paddedHeight = height + padding * 2;
+		const uint32 atlasWidth = _atlas.get_width();
+		const uint32 atlasHeight = _atlas.get_height();
+		if (paddedWidth > atlasWidth || paddedHeight > atlasHeight)
+		{
+			return AtlasRegion();
+		}
+
+		// Rank every texel by the glyph on it: 0 if free, then 1 for the least recently used glyph upwards, UINT32_MAX if pinned.
+		constexpr uint32 kPinnedRank = UINT32_MAX;
+		_texelRanks.assign(size_t(atlasWidth) * atlasHeight, 0);
+		uint32 rank = 1;
+		for (uint32 entryIndex = _tail; entryIndex != kInvalidEntryIndex; entryIndex = _entries[entryIndex]._prev, ++rank)
+		{
+			const Entry& entry = _entries[entryIndex];
+			if (entry._glyph._region.is_valid() == false)
+			{
+				continue;
+			}
+
+			const uint32 entryRank = (entry._lastUsedFrame >= _pinnedFrame ? kPinnedRank : rank);
+			const AtlasRect& rect = entry._glyph._region._rect;
+			for (uint32 y = rect._y - padding; y < rect._y + rect._height + padding; ++y)
+			{
+				std::fill_n(&_texelRanks[size_t(y) * atlasWidth + rect._x - padding], rect._width + padding * 2, entryRank);
+			}
+		}
+
+		// Maximum rank of every window of the padded size: over rows first, then over the columns of the row maxima.
+		const uint32 windowColumnCount = atlasWidth - paddedWidth + 1;
+		const uint32 windowRowCount = atlasHeight - paddedHeight + 1;
+		_rowMaxima.resize(size_t(windowColumnCount) * atlasHeight);
+		for (uint32 y = 0; y < atlasHeight; ++y)
+		{
+			compute_sliding_maxima(&_texelRanks[size_t(y) * atlasWidth], 1, atlasWidth, paddedWidth, &_rowMaxima[size_t(y) * windowColumnCount], 1);
+		}
+
+		uint32 bestRank = kPinnedRank;
+		AtlasRect paddedRect{ 0, 0, paddedWidth, paddedHeight };
+		_columnMaxima.resize(windowRowCount);
+		for (uint32 x = 0; x < windowColumnCount; ++x)
+		{
+			compute_sliding_maxima(&_rowMaxima[x], windowColumnCount, atlasHeight, paddedHeight, _columnMaxima.data(), 1);
+			for (uint32 y = 0; y < windowRowCount; ++y)
+			{
+				if (_columnMaxima[y] < bestRank)
+				{
+					bestRank = _columnMaxima[y];
+					paddedRect._x = x;
+					paddedRect._y = y;
+				}
+			}
+		}
+		if (bestRank == kPinnedRank)
+		{
+			return AtlasRegion();
+		}
+
+		for (uint32 entryIndex = _tail; entryIndex != kInvalidEntryIndex; )
+		{
+			const uint32 prevEntryIndex = _entries[entryIndex]._prev;
+			const AtlasRect& rect = _entries[entryIndex]._glyph._region._rect;
+			const bool overlaps = rect._width > 0 && rect._x - padding < paddedRect._x + paddedWidth && paddedRect._x < rect._x + rect._width + padding
+				&& rect._y - padding < paddedRect._y + paddedHeight && paddedRect._y < rect._y + rect._height + padding;
+			if (overlaps == true)
+			{
+				evict(entryIndex);
+			}
+			entryIndex = prevEntryIndex;
+		}
+		return _atlas.allocate_at(AtlasRect{ paddedRect._x + padding, paddedRect._y + padding, width, height });
+	}
+
+	void GlyphCache::compute_sliding_maxima(const uint32* const values, const size_t stride, const uint32 count, const uint32 windowSize, uint32* const outMaxima, const size_t outStride)
+	{
+		// Indices of the current window whose values decrease from front to back; the front is the maximum.
+		_slidingQueue.resize(count);
+		uint32 front = 0;
+		uint32 back = 0;
+		for (uint32 i = 0; i < count; ++i)
+		{
+			const uint32 value = values[i * stride];
+			while (back > front && values[_slidingQueue[back - 1] * stride] <= value)
+			{
+				--back;
+			}
+			_slidingQueue[back++] = i;
+			if (_slidingQueue[front] + windowSize <= i)
+			{
+				++front;
+			}
+			if (i + 1 >= windowSize)
+			{
+				outMaxima[(i + 1 - windowSize) * outStride] = values[_slidingQueue[front] * stride];
+			}
+		}
+	}
+
+	void GlyphCache::evict(const uint32 entryIndex)
+	{
+		Entry& entry = _entries[entryIndex];
+		_atlas.release(entry._glyph._region);
+		_entryIndexMap.erase(entry._codepoint);
+		unlink(entryIndex);
+		_freeEntryIndices.push_back(entryIndex);
+		++_statistics._evictionCount;
+		_statistics._glyphCount = static_cast<uint32>(_entryIndexMap.size());
+	}
+
+	void GlyphCache::link_front(const uint32 entryIndex)
+	{
+		Entry& entry = _entries[entryIndex];
+		entry._prev = kInvalidEntryIndex;
+		entry._next = _head;
+		if (_head != kInvalidEntryIndex)
+		{
+			_entries[_head]._prev = entryIndex;
+		}
+		_head = entryIndex;
+		if (_tail == kInvalidEntryIndex)
+		{
+			_tail = entryIndex;
+		}
+	}
+
+	void GlyphCache::unlink(const uint32 entryIndex)
+	{
+		Entry& entry = _entries[entryIndex];
+		if (entry._prev != kInvalidEntryIndex)
+		{
+			_entries[entry._prev]._next = entry._next;
+		}
+		else
+		{
+			_head = entry._next;
+		}
+		if (entry._next != kInvalidEntryIndex)
+		{
+			_entries[entry._next]._prev = entry._prev;
+		}
+		else
+		{
+			_tail = entry._prev;
+		}
+		entry._prev = kInvalidEntryIndex;
+		entry._next = kInvalidEntryIndex;
+	}
+
+	void SpriteBatch::push(const Resource* const texture, const BlendMode blendMode, const Sprite* const sprites, const uint32 spriteCount)
+	{
+		if (sprites == nullptr || spriteCount == 0)
+		{
+			return;
+		}
+
+		const uint32 instanceOffset = static_cast<uint32>(_instances.size());
+		if (_runs.empty() == false && _runs.back()._texture == texture && _runs.back()._blendMode == blendMode)
+		{
+			_runs.back()._instanceCount += spriteCount;
+		}
+		else
+		{
+			SpriteBatchRun run;
+			run._texture = texture;
+			run._blendMode = blendMode;
+			run._instanceOffset = instanceOffset;
+			run._instanceCount = spriteCount;
+			_runs.push_back(run);
+		}
+
+		_instances.resize(size_t(instanceOffset) + spriteCount);
+		SPRITE_INSTANCE* const instances = &_instances[instanceOffset];
+		for (uint32 spriteIndex = 0; spriteIndex < spriteCount; ++spriteIndex)
+		{
+			const Sprite& sprite = sprites[spriteIndex];
+			SPRITE_INSTANCE& instance = instances[spriteIndex];
+			instance._positionAndSize = float4(sprite._position.x, sprite._position.y, sprite._size.x, sprite._size.y);
+			instance._uvRect = float4(sprite._uvMin.x, sprite._uvMin.y, sprite._uvMax.x, sprite._uvMax.y);
+			instance._color = sprite._color;
+			instance._rotation = (sprite._rotationAngle == 0.0f ? float2(1, 0) : float2(::cos(sprite._rotationAngle), ::sin(sprite._rotationAngle)));
+		}
+	}
+
+	uint64 compute_hash_FNV1a(const void* const data, const size_t byteSize, const uint64 seed)
+	{
+		constexpr uint64 kPrime = 1099511628211ull;
+		const byte* const bytes = static_cast<const byte*>(data);
+		uint64 hash = seed;
+		for (size_t at = 0; at < byteSize; ++at)
+		{
+			hash ^= bytes[at];
+			hash *= kPrime;
+		}
+		return hash;
+	}
+
+	uint64 ShaderCache::compute_key(const ShaderCompileRequest& request)
+	{
+		const auto hash_string = [](const char* const string, const uint64 hash)
+		{
+			// The terminating null separates adjacent fields.
+			return (string == nullptr ? compute_hash_FNV1a("", 1, hash) : compute_hash_FNV1a(string, ::strlen(string) + 1, hash));
+		};
+
+		uint64 hash = compute_hash_FNV1a(&kFileVersion, sizeof(kFileVersion));
+		hash = hash_string(request._sourceCode, hash);
+		hash = hash_string(request._entryPoint, hash);
+		hash = hash_string(request._target, hash);
+		hash = compute_hash_FNV1a(&request._flags, sizeof(request._flags), hash);
+		if (request._sourceCode != nullptr)
+		{
+			std::vector<const std::string*> visitedHeaders;
+			hash_includes(request._sourceCode, request._shaderHeaderSet, visitedHeaders, hash);
+		}
+		return hash;
+	}
+
+	void ShaderCache::hash_includes(const std::string& code, const ShaderHeaderSet* const shaderHeaderSet, std::vector<const std::string*>& visitedHeaders, uint64& hash)
+	{
+		static constexpr char kIncludeDirective[] = "#include";
+		for (size_t at = code.find(kIncludeDirective); at != std::string::npos; at = code.find(kIncludeDirective, at + 1))
+		{
+			const size_t nameBegin = code.find_first_of("\"<", at + sizeof(kIncludeDirective) - 1);
+			const size_t nameEnd = (nameBegin == std::string::npos ? std::string::npos : code.find_first_of("\">", nameBegin + 1));
+			if (nameEnd == std::string::npos)
+			{
+				return;
+			}
+
+			const std::string headerName = code.substr(nameBegin + 1, nameEnd - nameBegin - 1);
+			hash = compute_hash_FNV1a(headerName.c_str(), headerName.length() + 1, hash);
+
+			const std::string* const headerCode = (shaderHeaderSet == nullptr ? nullptr : shaderHeaderSet->find_shader_header(headerName.c_str()));
+			if (headerCode == nullptr || std::find(visitedHeaders.begin(), visitedHeaders.end(), headerCode) != visitedHeaders.end())
+			{
+				continue;
+			}
+
+			visitedHeaders.push_back(headerCode);
+			hash = compute_hash_FNV1a(headerCode->c_str(), headerCode->length() + 1, hash);
+			hash_includes(*headerCode, shaderHeaderSet, visitedHeaders, hash);
+		}
+	}
+
+	std::string ShaderCache::make_file_path(const uint64 key) const
+	{
+		static constexpr char kHexDigits[] = "0123456789abcdef";
+		char fileName[16 + 4 + 1]{};
+		for (uint32 digitIndex = 0; digitIndex < 16; ++digitIndex)
+		{
+			fileName[digitIndex] = kHexDigits[(key >> ((15 - digitIndex) * 4)) & 0xF];
+		}
+		::memcpy(&fileName[16], ".cso", 4);
+		return (std::filesystem::path(_directory) / fileName).string();
+	}
+
+	bool ShaderCache::load(const uint64 key, std::vector<byte>& outBytecode) const
+	{
+		outBytecode.clear();
+		if (_directory.empty() == true)
+		{
+			return false;
+		}
+
+		std::ifstream ifs(make_file_path(key), std::ios_base::binary);
+		FileHeader fileHeader;
+		if (ifs.is_open() == false || ifs.read(reinterpret_cast<char*>(&fileHeader), sizeof(fileHeader)).good() == false
+			|| fileHeader._magic != kFileMagic || fileHeader._version != kFileVersion || fileHeader._key != key || fileHeader._byteSize == 0)
+		{
+			_missCount.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		outBytecode.resize(static_cast<size_t>(fileHeader._byteSize));
+		if (ifs.read(reinterpret_cast<char*>(&outBytecode[0]), static_cast<std::streamsize>(outBytecode.size())).good() == false)
+		{
+			outBytecode.clear();
+			_missCount.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+		_hitCount.fetch_add(1, std::memory_order_relaxed);
+		return true;
+	}
+
+	bool ShaderCache::store(const uint64 key, const std::vector<byte>& bytecode) const
+	{
+		if (_directory.empty() == true || bytecode.empty() == true)
+		{
+			return false;
+		}
+
+		std::error_code errorCode;
+		std::filesystem::create_directories(_directory, errorCode);
+
+		// Write aside and rename, so a concurrent or interrupted writer never leaves a torn file behind.
+		const std::string filePath = make_file_path(key);
+		const std::string temporaryFilePath = filePath + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+		{
+			std::ofstream ofs(temporaryFilePath, std::ios_base::binary | std::ios_base::trunc);
+			if (ofs.is_open() == false)
+			{
+				return false;
+			}
+
+			FileHeader fileHeader;
+			fileHeader._key = key;
+			fileHeader._byteSize = bytecode.size();
+			ofs.write(reinterpret_cast<const char*>(&fileHeader), sizeof(fileHeader));
+			ofs.write(reinterpret_cast<const char*>(&bytecode[0]), static_cast<std::streamsize>(bytecode.size()));
+			if (ofs.good() == false)
+			{
+				ofs.close();
+				std::filesystem::remove(temporaryFilePath, errorCode);
+				return false;
+			}
+		}
+		std::filesystem::rename(temporaryFilePath, filePath, errorCode);
+		if (errorCode)
+		{
+			std::filesystem::remove(temporaryFilePath, errorCode);
+			return false;
+		}
+		return true;
+	}
+
+	ParallelForPool& ParallelForPool::get_instance()
+	{
+		static ParallelForPool instance;
+		return instance;
+	}
+
+	ParallelForPool::ParallelForPool()
+	{
+		const uint32 threadCount = (std::max)(std::thread::hardware_concurrency(), 1u);
+		for (uint32 threadIndex = 1; threadIndex < threadCount; ++threadIndex)
+		{
+			_threads.emplace_back([this]() { run_helper(); });
+		}
+	}
+
+	ParallelForPool::~ParallelForPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_is_stopping = true;
+		}
+		_jobCondition.notify_all();
+		for (std::thread& thread : _threads)
+		{
+			thread.join();
+		}
+	}
+
+	void ParallelForPool::run(Job& job, const uint32 helperCount)
+	{
+		if (helperCount > 0)
+		{
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_jobs.insert(_jobs.end(), helperCount, &job);
+			}
+			if (helperCount == 1)
+			{
+				_jobCondition.notify_one();
+			}
+			else
+			{
+				_jobCondition.notify_all();
+			}
+		}
+
+		job.run();
+
+		if (helperCount > 0)
+		{
+			// Every index has been claimed, so copies still queued would only find nothing to do.
+			std::unique_lock<std::mutex> lock(_mutex);
+			_jobs.erase(std::remove(_jobs.begin(), _jobs.end(), &job), _jobs.end());
+			_doneCondition.wait(lock, [&job]() { return job._runningHelperCount == 0; });
+		}
+	}
+
+	void ParallelForPool::run_helper()
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		while (true)
+		{
+			_jobCondition.wait(lock, [this]() { return _is_stopping == true || _jobs.empty() == false; });
+			if (_jobs.empty() == true)
+			{
+				return;
+			}
+
+			Job* const job = _jobs.front();
+			_jobs.pop_front();
+			++job->_runningHelperCount;
+			lock.unlock();
+			job->run();
+			lock.lock();
+			if (--job->_runningHelperCount == 0)
+			{
+				_doneCondition.notify_all();
+			}
+		}
+	}
+
+	void parallel_for(const uint32 count, const std::function<void(const uint32 index)>& function)
+	{
+		if (count == 0)
+		{
+			return;
+		}
+
+		ParallelForPool& pool = ParallelForPool::get_instance();
+		ParallelForPool::Job job;
+		job._function = &function;
+		job._count = count;
+		pool.run(job, (std::min)(count - 1, pool.get_helper_count()));
+	}
+
+	void compile_shaders(ShaderCompiler& compiler, const ShaderCache* const shaderCache, const ShaderCompileRequest* const requests, ShaderCompileResult* const results, const uint32 count)
+	{
+		parallel_for(count, [&](const uint32 index)
+			{
+				ShaderCompileResult& result = results[index];
+				const uint64 key = (shaderCache == nullptr ? 0 : ShaderCache::compute_key(requests[index]));
+				if (shaderCache != nullptr && shaderCache->load(key, result._bytecode) == true)
+				{
+					result._is_succeeded = true;
+					result._is_from_cache = true;
+					return;
+				}
+
+				result._is_from_cache = false;
+				result._is_succeeded = compiler.compile(requests[index], result._bytecode, result._errorMessage);
+				if (result._is_succeeded == true && shaderCache != nullptr)
+				{
+					shaderCache->store(key, result._bytecode);
+				}
+			});
+	}
+
+	void ShaderVariantTable::create(const char* sourceCode, const char* shaderIdentifier, const char* entryPoint, const char* target, const uint32 flags, const ShaderHeaderSet* const shaderHeaderSet, const std::initializer_list<const char*>& keywords)
+	{
+		_sourceCode = (sourceCode == nullptr ? "" : sourceCode);
+		_identifier = (shaderIdentifier == nullptr ? "" : shaderIdentifier);
+		_entryPoint = (entryPoint == nullptr ? "" : entryPoint);
+		_target = (target == nullptr ? "" : target);
+		_flags = flags;
+		_shaderHeaderSet = shaderHeaderSet;
+		_keywordSet = ShaderKeywordSet();
+		for (const char* const keyword : keywords)
+		{
+			_keywordSet.push_keyword(keyword);
+		}
+		_compiledKeys.clear();
+		_failedKeys.clear();
+	}
+
+	bool ShaderVariantTable::compile_variants(ShaderCompiler& compiler, const ShaderCache* const shaderCache, const uint64* const keys, const uint32 keyCount, std::vector<ShaderVariantCompileResult>& outResults)
+	{
+		std::vector<uint64> compilingKeys;
+		bool is_any_failed = false;
+		for (uint32 keyIndex = 0; keyIndex < keyCount; ++keyIndex)
+		{
+			const uint64 key = keys[keyIndex];
+			if (is_failed(key) == true)
+			{
+				is_any_failed = true;
+				continue;
+			}
+			if (is_compiled(key) == true || std::find(compilingKeys.begin(), compilingKeys.end(), key) != compilingKeys.end())
+			{
+				continue;
+			}
+			compilingKeys.push_back(key);
+		}
+		if (compilingKeys.empty() == true)
+		{
+			return (is_any_failed == false);
+		}
+
+		// The requests point into the variant sources, which only need to live until compile_shaders() returns.
+		const uint32 compilingKeyCount = static_cast<uint32>(compilingKeys.size());
+		std::vector<std::string> variantSources(compilingKeyCount);
+		std::vector<ShaderCompileRequest> requests(compilingKeyCount);
+		for (uint32 index = 0; index < compilingKeyCount; ++index)
+		{
+			variantSources[index] = _keywordSet.make_variant_source(_sourceCode.c_str(), compilingKeys[index]);
+			ShaderCompileRequest& request = requests[index];
+			request._sourceCode = variantSources[index].c_str();
+			request._identifier = _identifier.c_str();
+			request._entryPoint = _entryPoint.c_str();
+			request._target = _target.c_str();
+			request._flags = _flags;
+			request._shaderHeaderSet = _shaderHeaderSet;
+		}
+		std::vector<ShaderCompileResult> results(compilingKeyCount);
+		compile_shaders(compiler, shaderCache, requests.data(), results.data(), compilingKeyCount);
+
+		for (uint32 index = 0; index < compilingKeyCount; ++index)
+		{
+			const uint64 key = compilingKeys[index];
+			if (results[index]._is_succeeded == true)
+			{
+				_compiledKeys.insert(key);
+			}
+			else
+			{
+				_failedKeys.insert(key);
+				is_any_failed = true;
+			}
+			ShaderVariantCompileResult& result = outResults.emplace_back();
+			result._key = key;
+			result._result = std::move(results[index]);
+		}
+		return (is_any_failed == false);
+	}
+
+#if defined(_WIN32)
+	HRESULT ShaderHeaderSet::Open(D3D_INCLUDE_TYPE IncludeType, LPCSTR pFileName, LPCVOID pParentData, LPCVOID* ppData, UINT* pBytes)
+	{
+		const std::string* const headerCode = find_shader_header(pFileName);
+		if (headerCode == nullptr)
+		{
+			return E_FAIL;
+		}
+
+		*ppData = headerCode->c_str();
+		*pBytes = static_cast<UINT>(headerCode->length());
+		return S_OK;
+	}
+
+	void ShaderInputLayout::clear_InputElements()
+	{
+		_inputElements.clear();
+		_inputTotalByteSize = 0;
+	}
+
+	void ShaderInputLayout::push_InputElement(const InputElement& newInputElement)
+	{
+		D3D11_INPUT_ELEMENT_DESC inputElementDesc{};
+		inputElementDesc.AlignedByteOffset = _inputTotalByteSize;
+		inputElementDesc.Format = newInputElement._format;
+		inputElementDesc.InputSlot = newInputElement._inputSlot;
+		inputElementDesc.InputSlotClass = newInputElement._inputSlotClass;
+		inputElementDesc.SemanticName = newInputElement._semanticName;
+		inputElementDesc.SemanticIndex = newInputElement._semanticIndex;
+		inputElementDesc.InstanceDataStepRate = newInputElement._instanceStepRate;
+		_inputElements.push_back(inputElementDesc);
+
+		_inputTotalByteSize += compute_InputElement_byte_size(inputElementDesc);
+	}
+
+	bool ShaderInputLayout::create(Renderer& renderer, const Shader& vertexShader)
+	{
+		if (_inputElements.empty())
+		{
+			MINT_LOG_ERROR("Push input elements before creating ShaderInputLayout!");
+			return false;
+		}
+
+		if (FAILED(renderer.get_device()->CreateInputLayout(&_inputElements[0], static_cast<UINT>(_inputElements.size()),
+			vertexShader._shaderBlob->GetBufferPointer(), vertexShader._shaderBlob->GetBufferSize(), _inputLayout.ReleaseAndGetAddressOf())))
+		{
+			MINT_LOG_ERROR("Failed to create ShaderInputLayout");
+			return false;
+		}
+		return true;
+	}
+
+	bool D3DShaderCompiler::compile(const ShaderCompileRequest& request, std::vector<byte>& outBytecode, std::string& outErrorMessage)
+	{
+		ComPtr<ID3D10Blob> shaderBlob;
+		ComPtr<ID3D10Blob> errorMessageBlob;
+		ShaderHeaderSet* const shaderHeaderSet = const_cast<ShaderHeaderSet*>(request._shaderHeaderSet);
+		const HRESULT result = D3DCompile(request._sourceCode, ::strlen(request._sourceCode), request._identifier, nullptr, shaderHeaderSet, request._entryPoint, request._target, request._flags, 0, shaderBlob.ReleaseAndGetAddressOf(), errorMessageBlob.ReleaseAndGetAddressOf());
+		if (FAILED(result))
+		{
+			outErrorMessage = (errorMessageBlob.Get() == nullptr ? std::string() : std::string(reinterpret_cast<const char*>(errorMessageBlob->GetBufferPointer()), errorMessageBlob->GetBufferSize()));
+			return false;
+		}
+
+		const byte* const bytecode = static_cast<const byte*>(shaderBlob->GetBufferPointer());
+		outBytecode.assign(bytecode, bytecode + shaderBlob->GetBufferSize());
+		return true;
+	}
+
+	bool Shader::create(Renderer& renderer, const char* sourceCode, const ShaderType& shaderType, const char* shaderIdentifier, const char* entryPoint, const char* target, ShaderHeaderSet* const shaderHeaderSet)
+	{
+		ShaderCompileBatch shaderCompileBatch;
+		shaderCompileBatch.push(*this, sourceCode, shaderType, shaderIdentifier, entryPoint, target, shaderHeaderSet);
+		return shaderCompileBatch.compile(renderer);
+	}
+
+	bool Shader::create_from_bytecode(Renderer& renderer, const ShaderType& shaderType, const std::vector<byte>& bytecode)
+	{
+		if (bytecode.empty() == true)
+		{
+			MINT_LOG_ERROR("Bytecode is empty!");
+			return false;
+		}
+
+		_type = shaderType;
+
+		// ShaderInputLayout::create() reads the bytecode from the blob.
+		if (FAILED(::D3DCreateBlob(bytecode.size(), _shaderBlob.ReleaseAndGetAddressOf())))
+		{
+			return false;
+		}
+		::memcpy(_shaderBlob->GetBufferPointer(), &bytecode[0], bytecode.size());
+
+		if (shaderType == ShaderType::VertexShader)
+		{
+			if (FAILED(renderer.get_device()->CreateVertexShader(_shaderBlob->GetBufferPointer(), _shaderBlob->GetBufferSize(), NULL, reinterpret_cast<ID3D11VertexShader**>(_shader.ReleaseAndGetAddressOf()))))
+			{
+				return false;
+			}
+			return true;
+		}
+		else if (shaderType == ShaderType::PixelShader)
+		{
+			if (FAILED(renderer.get_device()->CreatePixelShader(_shaderBlob->GetBufferPointer(), _shaderBlob->GetBufferSize(), NULL, reinterpret_cast<ID3D11PixelShader**>(_shader.ReleaseAndGetAddressOf()))))
+			{
+				return false;
+			}
+			return true;
+		}
+		return false;
+	}
+
+	void ShaderCompileBatch::push(Shader& shader, const char* sourceCode, const ShaderType& shaderType, const char* shaderIdentifier, const char* entryPoint, const char* target, ShaderHeaderSet* const shaderHeaderSet)
+	{
+		ShaderCompileRequest request;
+		request._sourceCode = sourceCode;
+		request._identifier = shaderIdentifier;
+		request._entryPoint = entryPoint;
+		request._target = target;
+		request._flags = kShaderCompileFlags;
+		request._shaderHeaderSet = shaderHeaderSet;
+		_shaders.push_back(&shader);
+		_shaderTypes.push_back(shaderType);
+		_requests.push_back(request);
+	}
+
+	bool ShaderCompileBatch::compile(Renderer& renderer)
+	{
+		for (const ShaderCompileRequest& request : _requests)
+		{
+			if (request._sourceCode == nullptr)
+			{
+				MINT_LOG_ERROR("Must exist source code!");
+				return false;
+			}
+
+			if (request._entryPoint == nullptr)
+			{
+				MINT_LOG_ERROR("Must specify entry point!");
+				return false;
+			}
+
+			if (request._target == nullptr)
+			{
+				MINT_LOG_ERROR("Must specify target!");
+				return false;
+			}
+		}
+
+		const uint32 count = static_cast<uint32>(_requests.size());
+		std::vector<ShaderCompileResult> results(count);
+		compile_shaders(renderer.get_ShaderCompiler(), &renderer.get_ShaderCache(), _requests.data(), results.data(), count);
+
+		bool is_all_succeeded = true;
+		for (uint32 index = 0; index < count; ++index)
+		{
+			if (results[index]._is_succeeded == false)
+			{
+				MINT_LOG_ERROR("Shader compile failed: " << (_requests[index]._identifier == nullptr ? "" : _requests[index]._identifier) << std::endl << results[index]._errorMessage);
+				is_all_succeeded = false;
+				continue;
+			}
+
+			if (_shaders[index]->create_from_bytecode(renderer, _shaderTypes[index], results[index]._bytecode) == false)
+			{
+				is_all_succeeded = false;
+			}
+		}
+		return is_all_succeeded;
+	}
+
+	void ShaderVariantSet::create(const char* sourceCode, const ShaderType& shaderType, const char* shaderIdentifier, const char* entryPoint, const char* target, ShaderHeaderSet* const shaderHeaderSet, const std::initializer_list<const char*>& keywords)
+	{
+		_shaderType = shaderType;
+		_variantTable.create(sourceCode, shaderIdentifier, entryPoint, target, kShaderCompileFlags, shaderHeaderSet, keywords);
+		_variants.clear();
+	}
+
+	Shader* ShaderVariantSet::get_variant(Renderer& renderer, const uint64 key)
+	{
+		auto found = _variants.find(key);
+		if (found != _variants.end())
+		{
+			return &found->second;
+		}
+
+		if (_variantTable.is_failed(key) == true || compile_variants(renderer, { key }) == false)
+		{
+			return nullptr;
+		}
+		return &_variants[key];
+	}
+
+	bool ShaderVariantSet::compile_variants(Renderer& renderer, const std::initializer_list<uint64>& keys)
+	{
+		std::vector<ShaderVariantCompileResult> results;
+		bool is_all_succeeded = _variantTable.compile_variants(renderer.get_ShaderCompiler(), &renderer.get_ShaderCache(), keys.begin(), static_cast<uint32>(keys.size()), results);
+		for (const ShaderVariantCompileResult& result : results)
+		{
+			if (result._result._is_succeeded == false)
+			{
+				MINT_LOG_ERROR("Shader variant compile failed: " << result._key << std::endl << result._result._errorMessage);
+				continue;
+			}
+
+			if (_variants[result._key].create_from_bytecode(renderer, _shaderType, result._result._bytecode) == false)
+			{
+				_variants.erase(result._key);
+				_variantTable.mark_failed(result._key);
+				is_all_succeeded = false;
+			}
+		}
+		return is_all_succeeded;
+	}
+
+	bool Resource::create_texture2D(Renderer& renderer, const TextureFormat& format, const void* const resourceContent, const uint32 width, const uint32 height)
+	{
+		ComPtr<ID3D11Resource> newResource;
+		D3D11_TEXTURE2D_DESC texture2DDescriptor{};
+		texture2DDescriptor.Width = width;
+		texture2DDescriptor.Height = height;
+		texture2DDescriptor.MipLevels = 1;
+		texture2DDescriptor.ArraySize = 1;
+		texture2DDescriptor.Format = __convert_to_DXGI_FORMAT(format);
+		texture2DDescriptor.SampleDesc.Count = 1;
+		texture2DDescriptor.Usage = D3D11_USAGE::D3D11_USAGE_DEFAULT;
+		texture2DDescriptor.BindFlags = D3D11_BIND_FLAG::D3D11_BIND_SHADER_RESOURCE;
+		texture2DDescriptor.CPUAccessFlags = 0;
+		const uint32 elementStride = (is_block_compressed(format) == true ? 0 : __compute_element_stride(format));
+		D3D11_SUBRESOURCE_DATA subResource{};
+		subResource.pSysMem = resourceContent;
+		subResource.SysMemPitch = compute_row_pitch(format, width);
+		subResource.SysMemSlicePitch = 0;
+		if (SUCCEEDED(renderer.get_device()->CreateTexture2D(&texture2DDescriptor, (resourceContent == nullptr ? nullptr : &subResource), reinterpret_cast<ID3D11Texture2D**>(newResource.ReleaseAndGetAddressOf()))))
+		{
+			D3D11_SHADER_RESOURCE_VIEW_DESC shaderResourceViewDescriptor{};
+			shaderResourceViewDescriptor.Format = texture2DDescriptor.Format;
+			shaderResourceViewDescriptor.ViewDimension = D3D11_SRV_DIMENSION::D3D11_SRV_DIMENSION_TEXTURE2D;
+			shaderResourceViewDescriptor.Texture2D.MipLevels = texture2DDescriptor.MipLevels;
+			shaderResourceViewDescriptor.Texture2D.MostDetailedMip = 0;
+			if (SUCCEEDED(renderer.get_device()->CreateShaderResourceView(newResource.Get(), &shaderResourceViewDescriptor, reinterpret_cast<ID3D11ShaderResourceView**>(_view.ReleaseAndGetAddressOf()))))
+			{
+				_type = ResourceType::Teture2D;
+				_format = format;
+
+				_elementStride = elementStride;
+				_elementMaxCount = texture2DDescriptor.Width * texture2DDescriptor.Height;
+				//_resourceCapacity = _elementStride * _elementMaxCount;
+
+				_width = width;
+				//_height = _width / _elementMaxCount;
+
+				std::swap(_resource, newResource);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool Resource::create_texture2D(Renderer& renderer, const TextureData& textureData)
+	{
+		if (textureData._mipLevels.empty() == true)
+		{
+			MINT_LOG_ERROR("TextureData has no mip level!");
+			return false;
+		}
+
+		const TextureMipLevel& baseLevel = textureData._mipLevels[0];
+		if (is_block_compressed(textureData._format) == true && (baseLevel._width % 4 != 0 || baseLevel._height % 4 != 0))
+		{
+			MINT_LOG_ERROR("Block-compressed textures need a size that is a multiple of 4!");
+			return false;
+		}
+
+		ComPtr<ID3D11Resource> newResource;
+		D3D11_TEXTURE2D_DESC texture2DDescriptor{};
+		texture2DDescriptor.Width = baseLevel._width;
+		texture2DDescriptor.Height = baseLevel._height;
+		texture2DDescriptor.MipLevels = static_cast<UINT>(textureData._mipLevels.size());
+		texture2DDescriptor.ArraySize = 1;
+		texture2DDescriptor.Format = __convert_to_DXGI_FORMAT(textureData._format);
+		texture2DDescriptor.SampleDesc.Count = 1;
+		texture2DDescriptor.Usage = D3D11_USAGE::D3D11_USAGE_DEFAULT;
+		texture2DDescriptor.BindFlags = D3D11_BIND_FLAG::D3D11_BIND_SHADER_RESOURCE;
+		texture2DDescriptor.CPUAccessFlags = 0;
+		std::vector<D3D11_SUBRESOURCE_DATA> subResources(textureData._mipLevels.size());
+		for (size_t levelIndex = 0; levelIndex < textureData._mipLevels.size(); ++levelIndex)
+		{
+			const TextureMipLevel& mipLevel = textureData._mipLevels[levelIndex];
+			subResources[levelIndex].pSysMem = mipLevel._bytes.data();
+			subResources[levelIndex].SysMemPitch = compute_row_pitch(textureData._format, mipLevel._width);
+			subResources[levelIndex].SysMemSlicePitch = 0;
+		}
+		if (FAILED(renderer.get_device()->CreateTexture2D(&texture2DDescriptor, subResources.data(), reinterpret_cast<ID3D11Texture2D**>(newResource.ReleaseAndGetAddressOf()))))
+		{
+			MINT_LOG_ERROR("Failed to create the texture!");
+			return false;
+		}
+
+		D3D11_SHADER_RESOURCE_VIEW_DESC shaderResourceViewDescriptor{};
+		shaderResourceViewDescriptor.Format = texture2DDescriptor.Format;
+		shaderResourceViewDescriptor.ViewDimension = D3D11_SRV_DIMENSION::D3D11_SRV_DIMENSION_TEXTURE2D;
+		shaderResourceViewDescriptor.Texture2D.MipLevels = texture2DDescriptor.MipLevels;
+		shaderResourceViewDescriptor.Texture2D.MostDetailedMip = 0;
+		if (FAILED(renderer.get_device()->CreateShaderResourceView(newResource.Get(), &shaderResourceViewDescriptor, reinterpret_cast<ID3D11ShaderResourceView**>(_view.ReleaseAndGetAddressOf()))))
+		{
+			MINT_LOG_ERROR("Failed to create the shader resource view!");
+			return false;
+		}
+
+		_type = ResourceType::Teture2D;
+		_format = textureData._format;
+		_elementStride = (is_block_compressed(textureData._format) == true ? 0 : __compute_element_stride(textureData._format));
+		_elementMaxCount = baseLevel._width * baseLevel._height;
+		_width = baseLevel._width;
+		std::swap(_resource, newResource);
+		return true;
+	}
+
+	bool Resource::update_texture2D(Renderer& renderer, const void* const content, const uint32 rowPitch, const uint32 x, const uint32 y, const uint32 width, const uint32 height)
+	{
+		if (_type != ResourceType::Teture2D || _resource.Get() == nullptr)
+		{
+			MINT_ASSERT(false, "Use create_texture2D() first!");
+			return false;
+		}
+
+		D3D11_BOX box{};
+		box.left = x;
+		box.top = y;
+		box.front = 0;
+		box.right = x + width;
+		box.bottom = y + height;
+		box.back = 1;
+		renderer.get_device_context()->UpdateSubresource(_resource.Get(), 0, &box, content, rowPitch, 0);
+		return true;
+	}
+
+	bool Resource::create_buffer(Renderer& renderer, const ResourceType& type, const void* const content, const uint32 elementStride, const uint32 elementCount, const bool is_CPU_writable)
+	{
+		if (type == ResourceType::Teture2D)
+		{
+			MINT_ASSERT(false, "Use create_texture2D() instead!");
+			return false;
+		}
+
+		ComPtr<ID3D11Resource> newResource;
+		D3D11_BUFFER_DESC bufferDescriptor{};
+		bufferDescriptor.Usage = (is_CPU_writable == true ? D3D11_USAGE::D3D11_USAGE_DYNAMIC : D3D11_USAGE::D3D11_USAGE_DEFAULT);
+		bufferDescriptor.ByteWidth = elementStride * elementCount;
+		bufferDescriptor.BindFlags = D3D11_BIND_FLAG(1 << (uint32)type); // !!! CAUTION !!!
+		bufferDescriptor.CPUAccessFlags = (is_CPU_writable == true ? D3D11_CPU_ACCESS_FLAG::D3D11_CPU_ACCESS_WRITE : 0);
+		bufferDescriptor.MiscFlags = 0;
+		bufferDescriptor.StructureByteStride = 0;
+		D3D11_SUBRESOURCE_DATA subresourceData{};
+		subresourceData.pSysMem = content;
+		if (SUCCEEDED(renderer.get_device()->CreateBuffer(&bufferDescriptor, (content != nullptr) ? &subresourceData : nullptr, reinterpret_cast<ID3D11Buffer**>(newResource.ReleaseAndGetAddressOf()))))
+		{
+			_type = type;
+			_byteSize = bufferDescriptor.ByteWidth;
+			_elementStride = elementStride;
+			_elementMaxCount = elementCount;
+			_is_CPU_writable = is_CPU_writable;
+
+			std::swap(_resource, newResource);
+			return true;
+		}
+		return false;
+	}
+
+	bool Resource::update_region(Renderer& renderer, const void* const content, const uint32 elementOffset, const uint32 elementCount)
+	{
+		if (_is_CPU_writable == true || _type == ResourceType::Teture2D || elementOffset + elementCount > _elementMaxCount)
+		{
+			MINT_ASSERT(false, "update_region() needs a buffer that is not CPU writable and big enough!");
+			return false;
+		}
+
+		D3D11_BOX box{};
+		box.left = elementOffset * _elementStride;
+		box.right = (elementOffset + elementCount) * _elementStride;
+		box.top = 0;
+		box.bottom = 1;
+		box.front = 0;
+		box.back = 1;
+		renderer.get_device_context()->UpdateSubresource(_resource.Get(), 0, &box, content, 0, 0);
+		return true;
+	}
+
+	bool Resource::update(Renderer& renderer, const void* const content, const uint32 elementStride, const uint32 elementCount)
+	{
+		if (_is_CPU_writable == false)
+		{
+			MINT_ASSERT(false, "Use update_region() instead!");
+			return false;
+		}
+
+		if (elementCount > _elementMaxCount)
+		{
+			return create_buffer(renderer, _type, content, elementStride, elementCount);
+		}
+
+		class SafeResourceMapper
+		{
+		public:
+			SafeResourceMapper(Renderer& renderer, ID3D11Resource* const resource, const uint32 subresource)
+				: _renderer{ renderer }
+				, _resource{ resource }
+				, _subresource{ subresource }
+				, _mappedSubresource{}
+			{
+				if (FAILED(_renderer.get_device_context()->Map(_resource, _subresource, D3D11_MAP::D3D11_MAP_WRITE_DISCARD, 0, &_mappedSubresource)))
+				{
+					_mappedSubresource.pData = nullptr;
+					_mappedSubresource.DepthPitch = 0;
+					_mappedSubresource.RowPitch = 0;
+				}
+			}
+			~SafeResourceMapper()
+			{
+				if (isValid() == true)
+				{
+					_renderer.get_device_context()->Unmap(_resource, _subresource);
+				}
+			}
+			bool isValid() const noexcept
+			{
+				return _mappedSubresource.pData != nullptr;
+			}
+			void set(const void* const data, const uint32 size) noexcept
+			{
+				::memcpy(_mappedSubresource.pData, data, size);
+			}
+
+		private:
+			Renderer& _renderer;
+			ID3D11Resource* const _resource;
+			const uint32 _subresource;
+			D3D11_MAPPED_SUBRESOURCE _mappedSubresource;
+		};
+
+		SafeResourceMapper safeResourceMapper(renderer, _resource.Get(), 0);
+		if (safeResourceMapper.isValid())
+		{
+			safeResourceMapper.set(content, elementStride * elementCount);
+			return true;
+		}
+		return false;
+	}
+
+	DXGI_FORMAT Resource::__convert_to_DXGI_FORMAT(const TextureFormat& format)
+	{
+		switch (format)
+		{
+		case TextureFormat::R8_UNORM:
+			return DXGI_FORMAT::DXGI_FORMAT_R8_UNORM;
+		case TextureFormat::R8G8B8A8_UNORM:
+			return DXGI_FORMAT::DXGI_FORMAT_R8G8B8A8_UNORM;
+		case TextureFormat::BC1_UNORM:
+			return DXGI_FORMAT::DXGI_FORMAT_BC1_UNORM;
+		case TextureFormat::BC3_UNORM:
+			return DXGI_FORMAT::DXGI_FORMAT_BC3_UNORM;
+		case TextureFormat::BC4_UNORM:
+			return DXGI_FORMAT::DXGI_FORMAT_BC4_UNORM;
+		case TextureFormat::BC7_UNORM:
+			return DXGI_FORMAT::DXGI_FORMAT_BC7_UNORM;
+		default:
+			break;
+		}
+		MINT_ASSERT(false, "This texture format is not supported yet!");
+		return DXGI_FORMAT::DXGI_FORMAT_R8G8B8A8_UNORM;
+	}
+
+	uint32 Resource::__compute_element_stride(const TextureFormat& format)
+	{
+		return compute_texel_stride(format);
+	}
+
+	bool TextureAtlas::create_texture(Renderer& renderer)
+	{
+		if (_texture.create_texture2D(renderer, _format, _texels.data(), get_width(), get_height()) == false)
+		{
+			MINT_LOG_ERROR("Failed to create the atlas texture!");
+			return false;
+		}
+		_dirtyRects.clear();
+		return true;
+	}
+
+	bool TextureAtlas::flush(Renderer& renderer)
+	{
+		if (_texture.get_resource() == nullptr)
+		{
+			return create_texture(renderer);
+		}
+
+		const uint32 atlasRowPitch = get_width() * _texelStride;
+		for (const AtlasRect& dirtyRect : _dirtyRects)
+		{
+			const byte* const content = &_texels[size_t(dirtyRect._y) * atlasRowPitch + size_t(dirtyRect._x) * _texelStride];
+			if (_texture.update_texture2D(renderer, content, atlasRowPitch, dirtyRect._x, dirtyRect._y, dirtyRect._width, dirtyRect._height) == false)
+			{
+				return false;
+			}
+		}
+		_dirtyRects.clear();
+		return true;
+	}
+
+	bool TextureAtlas::flush(Renderer& renderer, TextureUploadBatch& outUploads)
+	{
+		if (_texture.get_resource() == nullptr)
+		{
+			return create_texture(renderer);
+		}
+
+		const uint32 atlasRowPitch = get_width() * _texelStride;
+		for (const AtlasRect& dirtyRect : _dirtyRects)
+		{
+			TextureUploadBatch::Upload upload;
+			upload._texture = &_texture;
+			upload._rect = dirtyRect;
+			upload._rowPitch = dirtyRect._width * _texelStride;
+			upload._texelOffset = outUploads._texels.size();
+			outUploads._texels.resize(upload._texelOffset + size_t(upload._rowPitch) * dirtyRect._height);
+			for (uint32 y = 0; y < dirtyRect._height; ++y)
+			{
+				::memcpy(&outUploads._texels[upload._texelOffset + size_t(y) * upload._rowPitch], &_texels[size_t(dirtyRect._y + y) * atlasRowPitch + size_t(dirtyRect._x) * _texelStride], upload._rowPitch);
+			}
+			outUploads._uploads.push_back(upload);
+		}
+		_dirtyRects.clear();
+		return true;
+	}
+
+	bool GlyphCache::flush(Renderer& renderer)
+	{
+		advance_frame();
+		return _atlas.flush(renderer);
+	}
+
+	bool GlyphCache::flush(Renderer& renderer, TextureUploadBatch& outUploads, const uint32 pendingPacketCount)
+	{
+		// The frame ending here belongs to the packet about to be submitted; the pending packets used the frames before it.
+		const uint64 oldestPendingFrame = (_frameIndex > pendingPacketCount ? _frameIndex - pendingPacketCount : 1);
+		advance_frame();
+		_pinnedFrame = oldestPendingFrame;
+		return _atlas.flush(renderer, outUploads);
+	}
+
+	static LRESULT WINAPI windowProcedure(HWND hWnd, UINT Msg, WPARAM wParam, LPARAM lParam)
+	{
+		switch (Msg)
+		{
+		case WM_DESTROY:
+			::PostQuitMessage(0);
+			return 0;
+		}
+		return ::DefWindowProc(hWnd, Msg, wParam, lParam);
+	}
+
+	bool Win32InputEventSource::poll_event(InputEvent& outEvent)
+	{
+		MSG msg{};
+		while (::PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE) == TRUE)
+		{
+			if (msg.message != WM_QUIT)
+			{
+				::TranslateMessage(&msg);
+				::DispatchMessage(&msg);
+			}
+
+			if (convert_message(msg, outEvent) == true)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void Win32InputEventSource::wait_for_event(const uint64 timeoutUs)
+	{
+		const uint64 timeoutMs = (timeoutUs + 999) / 1000;
+		const DWORD waitMs = (timeoutMs >= INFINITE ? INFINITE - 1 : static_cast<DWORD>(timeoutMs));
+		::MsgWaitForMultipleObjectsEx(0, nullptr, waitMs, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+	}
+
+	bool Win32InputEventSource::convert_message(const MSG& msg, InputEvent& outEvent)
+	{
+		outEvent = InputEvent();
+		switch (msg.message)
+		{
+		case WM_KEYUP:
+			if (msg.wParam != VK_RETURN)
+			{
+				return false;
+			}
+			outEvent._type = InputEvent::Type::KeyUp;
+			outEvent._key = InputKey::Enter;
+			break;
+		case WM_CHAR:
+			outEvent._type = InputEvent::Type::Char;
+			outEvent._char = (char)msg.wParam;
+			break;
+		case WM_MOUSEMOVE:
+			outEvent._type = InputEvent::Type::MouseMove;
+			break;
+		case WM_LBUTTONDOWN:
+			outEvent._type = InputEvent::Type::MouseLButtonDown;
+			break;
+		case WM_LBUTTONUP:
+			outEvent._type = InputEvent::Type::MouseLButtonUp;
+			break;
+		case WM_RBUTTONUP:
+			outEvent._type = InputEvent::Type::MouseRButtonUp;
+			break;
+		case WM_PAINT:
+			outEvent._type = InputEvent::Type::Redraw;
+			break;
+		case WM_QUIT:
+			outEvent._type = InputEvent::Type::Quit;
+			break;
+		default:
+			return false;
+		}
+
+		if (msg.message >= WM_MOUSEMOVE && msg.message <= WM_RBUTTONUP)
+		{
+			outEvent._position.x = static_cast<float>(GET_X_LPARAM(msg.lParam));
+			outEvent._position.y = static_cast<float>(GET_Y_LPARAM(msg.lParam));
+		}
+
+		// msg.time is in GetTickCount() milliseconds; rebase it onto get_time_us() to measure latency.
+		const DWORD age_ms = ::GetTickCount() - msg.time;
+		const uint64 now = get_time_us();
+		const uint64 age_us = static_cast<uint64>(age_ms) * 1000;
+		outEvent._timestamp = (now > age_us ? now - age_us : 0);
+		return true;
+	}
+
+	bool Renderer::is_running()
+	{
+		if (!_hWnd) return false;
+
+		const uint64 waitTimeoutUs = _frameScheduler.compute_wait_timeout_us(get_time_us());
+		if (waitTimeoutUs > 0)
+		{
+			const uint64 waitBegin = get_time_us();
+			_inputEventSource.wait_for_event(waitTimeoutUs);
+			_frameScheduler.add_idle_wait_us(get_time_us() - waitBegin);
+		}
+
+		_inputSystem.pump(_inputEventSource);
+		if (_inputSystem.is_quit_requested() == true)
+		{
+			destroy_window();
+			return false;
+		}
+
+		_is_frame_needed = _frameScheduler.decide(get_time_us(), _inputSystem.get_frame_event_count() > 0);
+		if (_inputSystem.has_pending_events() == true)
+		{
+			// The next frame must not wait for new input before handling the deferred events.
+			_frameScheduler.invalidate();
+		}
+		return true;
+	}
+
+	void Renderer::invalidate()
+	{
+		_frameScheduler.invalidate();
+		if (_hWnd)
+		{
+			::PostMessage(_hWnd, WM_NULL, 0, 0);
+		}
+	}
+
+	void Renderer::bind_ShaderInputLayout(ShaderInputLayout& shaderInputLayout)
+	{
+		_is_InputLayout_bound = true;
+
+		if (shaderInputLayout._inputLayout.Get() != nullptr)
+			_deviceContext->IASetInputLayout(shaderInputLayout._inputLayout.Get());
+	}
+
+	void Renderer::bind_Shader(Shader& shader)
+	{
+		if (shader._type == ShaderType::VertexShader)
+		{
+			_is_VS_bound = true;
+			_deviceContext->VSSetShader(static_cast<ID3D11VertexShader*>(shader._shader.Get()), nullptr, 0);
+		}
+		else if (shader._type == ShaderType::PixelShader)
+		{
+			_is_PS_bound = true;
+			_deviceContext->PSSetShader(static_cast<ID3D11PixelShader*>(shader._shader.Get()), nullptr, 0);
+		}
+	}
+
+	void Renderer::bind_Shader(ShaderVariantSet& shaderVariantSet, const uint64 variantKey)
+	{
+		Shader* const shader = shaderVariantSet.get_variant(*this, variantKey);
+		if (shader == nullptr)
+		{
+			MINT_LOG_ERROR("Failed to get the shader variant!");
+			return;
+		}
+		bind_Shader(*shader);
+	}
+
+	void Renderer::bind_input(Resource& resource, const uint32 slot)
+	{
+		if (resource._type == ResourceType::VertexBuffer)
+		{
+			_is_VertexBuffer_bound = true;
+
+			ID3D11Buffer* buffers[1]{ static_cast<ID3D11Buffer*>(resource.get_resource()) };
+			uint32 strides[1]{ resource._elementStride };
+			uint32 offsets[1]{ 0 };
+			_deviceContext->IASetVertexBuffers(slot, 1, buffers, strides, offsets);
+		}
+		else if (resource._type == ResourceType::IndexBuffer)
+		{
+			_is_IndexBuffer_bound = true;
+
+			_deviceContext->IASetIndexBuffer(static_cast<ID3D11Buffer*>(resource.get_resource()), Resource::kIndexBufferFormat, 0);
+		}
+		else
+		{
+			MINT_LOG_ERROR("!!!");
+		}
+	}
+
+	void Renderer::bind_ShaderResource(const ShaderType shaderType, Resource& resource, const uint32 slot)
+	{
+		if (resource._type == ResourceType::ConstantBuffer)
+		{
+			ID3D11Buffer* buffers[1]{ static_cast<ID3D11Buffer*>(resource.get_resource()) };
+			if (shaderType == ShaderType::VertexShader)
+			{
+				_deviceContext->VSSetConstantBuffers(slot, 1, buffers);
+			}
+			else if (shaderType == ShaderType::PixelShader)
+			{
+				_deviceContext->PSSetConstantBuffers(slot, 1, buffers);
+			}
+			else
+			{
+				MINT_LOG_ERROR("This shader type is not supported yet!");
+			}
+		}
+		else if (resource._type == ResourceType::Teture2D)
+		{
+			ID3D11ShaderResourceView* views[1]{ static_cast<ID3D11ShaderResourceView*>(resource.get_view()) };
+			if (shaderType == ShaderType::VertexShader)
+			{
+				_deviceContext->VSSetShaderResources(slot, 1, views);
+			}
+			else if (shaderType == ShaderType::PixelShader)
+			{
+				_deviceContext->PSSetShaderResources(slot, 1, views);
+			}
+			else
+			{
+				MINT_LOG_ERROR("This shader type is not supported yet!");
+			}
+		}
+		else
+		{
+			MINT_LOG_ERROR("This resource type is not supported yet!");
+		}
+	}
+
+	void Renderer::use_triangle_primitive()
+	{
+		_deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY::D3D10_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+	}
+
+	void Renderer::begin_rendering()
+	{
+		_deviceContext->ClearRenderTargetView(_backBufferRtv.Get(), _clearColor.f);
+		_deviceContext->ClearDepthStencilView(_depthStencilView.Get(), D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
+		use_triangle_primitive();
+	}
+
+	void Renderer::draw_indexed(const uint32 indexCount, const uint32 indexOffset, const int32 vertexOffset)
+	{
+		if (_is_InputLayout_bound == false)
+		{
+			MINT_LOG_ERROR("You must bind ShaderInputLayout first!");
+			return;
+		}
+		if (_is_VS_bound == false || _is_PS_bound == false)
+		{
+			MINT_LOG_ERROR("You must at least bind VertexShader and PixelShader first!");
+			return;
+		}
+		if (_is_VertexBuffer_bound == false)
+		{
+			MINT_LOG_ERROR("You must bind VertexBuffer first!");
+			return;
+		}
+		if (_is_IndexBuffer_bound == false)
+		{
+			MINT_LOG_ERROR("You must bind IndexBuffer first!");
+			return;
+		}
+
+		_deviceContext->DrawIndexed(indexCount, indexOffset, vertexOffset);
+	}
+
+	void Renderer::draw_text(const Color& color, const char* const text, const uint32 textLength, const float2& position)
+	{
+		if (textLength == 0)
+		{
+			return;
+		}
+
+		const size_t instanceBase = _defaultFontGlyphInstances.size();
+		_defaultFontGlyphInstances.resize(instanceBase + textLength);
+		DEFAULT_FONT_GLYPH_INSTANCE* const glyphInstances = &_defaultFontGlyphInstances[instanceBase];
+		const float glyphWidth = _defaultFontScale.x * kFontTextureGlyphWidth;
+		const uint32 packedColor = pack_color_RGBA8(color);
+		for (uint32 charIndex = 0; charIndex < textLength; ++charIndex)
+		{
+			glyphInstances[charIndex]._position = float2(position.x + glyphWidth * charIndex, position.y);
+			glyphInstances[charIndex]._glyph = static_cast<byte>(text[charIndex]);
+			glyphInstances[charIndex]._color = packedColor;
+		}
+	}
+
+	void Renderer::draw_instanced(const uint32 vertexCount, const uint32 instanceCount, const uint32 instanceOffset)
+	{
+		if (_is_VertexBuffer_bound == false)
+		{
+			MINT_LOG_ERROR("You must bind VertexBuffer first!");
+			return;
+		}
+
+		_deviceContext->DrawInstanced(vertexCount, instanceCount, 0, instanceOffset);
+	}
+
+	void Renderer::draw_sprite(Resource& texture, const Sprite& sprite, const BlendMode blendMode)
+	{
+		_spriteBatch.push(&texture, blendMode, &sprite, 1);
+	}
+
+	void Renderer::draw_sprites(Resource& texture, const Sprite* const sprites, const uint32 spriteCount, const BlendMode blendMode)
+	{
+		_spriteBatch.push(&texture, blendMode, sprites, spriteCount);
+	}
+
+	void Renderer::draw_text(const Color& color, const std::string_view text, const TextLayout& layout)
+	{
+		layout_text(text, layout, get_default_font_glyph_size(), pack_color_RGBA8(color), _defaultFontGlyphInstances);
+	}
+
+	void Renderer::draw_text(GlyphCache& glyphCache, const Color& color, const std::string_view text, const float2& position, const float scale)
+	{
+		_glyphCacheSprites.clear();
+		glyphCache.write_sprites(color, text, position, scale, _glyphCacheSprites);
+		if (_glyphCacheSprites.empty() == false)
+		{
+			draw_sprites(glyphCache.get_texture(), _glyphCacheSprites.data(), static_cast<uint32>(_glyphCacheSprites.size()));
+		}
+	}
+
+	void Renderer::draw(const uint32 vertexCount)
+	{
+		if (_is_VertexBuffer_bound == false)
+		{
+			MINT_LOG_ERROR("You must bind VertexBuffer first!");
+			return;
+		}
+
+		_deviceContext->Draw(vertexCount, 0);
+	}
+
+	void Renderer::end_rendering()
+	{
+		draw_SpriteBatch(_spriteBatch);
+		_spriteBatch.clear();
+
+		_textRunBuffer.collect_updates(_textRunUpdate);
+		draw_TextRuns(_textRunUpdate);
+
+		draw_default_font_text(_defaultFontGlyphInstances);
+		_defaultFontGlyphInstances.clear();
+
+		_swapChain->Present(0, 0);
+	}
+
+	template<typename... Args>
+	void Renderer::draw_text_format(const Color& color, const float2& position, const Args&... args)
+	{
+		TextFormatter textFormatter;
+		(textFormatter << ... << args);
+		draw_text(color, textFormatter.get_view(), position);
+	}
+
+	template<typename... Args>
+	bool Renderer::update_TextRun_format(const TextRun& textRun, const Color& color, const float2& position, const Args&... args)
+	{
+		TextFormatter textFormatter;
+		(textFormatter << ... << args);
+		return update_TextRun(textRun, color, textFormatter.get_view(), position);
+	}
+
+	template<typename Vertex>
+	void Renderer::move_text_to(FramePacket<Vertex>& packet)
+	{
+		// Swapping keeps the capacity of both sides, so neither thread reallocates in steady state.
+		std::swap(packet._glyphInstances, _defaultFontGlyphInstances);
+		_defaultFontGlyphInstances.clear();
+
+		_textRunBuffer.collect_updates(packet._textRunUpdate);
+	}
+
+	template<typename Vertex>
+	void Renderer::move_sprites_to(FramePacket<Vertex>& packet)
+	{
+		std::swap(packet._spriteBatch, _spriteBatch);
+		_spriteBatch.clear();
+	}
+
+	template<typename Vertex>
+	void Renderer::execute_FramePacket(const FramePacket<Vertex>& packet)
+	{
+		begin_rendering();
+
+		for (const TextureUploadBatch::Upload& upload : packet._textureUploads._uploads)
+		{
+			upload._texture->update_texture2D(*this, &packet._textureUploads._texels[upload._texelOffset], upload._rowPitch, upload._rect._x, upload._rect._y, upload._rect._width, upload._rect._height);
+		}
+
+		if (packet._vertices.empty() == false && packet._indices.empty() == false)
+		{
+			_framePacketVertexBuffer.update(*this, &packet._vertices[0], sizeof(Vertex), (uint32)packet._vertices.size());
+			_framePacketIndexBuffer.update(*this, &packet._indices[0], sizeof(uint32), (uint32)packet._indices.size());
+			for (const FrameDrawCommand& drawCommand : packet._drawCommands)
+			{
+				bind_Shader(*drawCommand._vertexShader);
+				bind_Shader(*drawCommand._pixelShader);
+				bind_ShaderInputLayout(*drawCommand._shaderInputLayout);
+				if (drawCommand._vsConstantBuffer != nullptr)
+				{
+					bind_ShaderResource(ShaderType::VertexShader, *drawCommand._vsConstantBuffer, 0);
+				}
+				bind_input(_framePacketVertexBuffer, 0);
+				bind_input(_framePacketIndexBuffer, 0);
+				draw_indexed(drawCommand._indexCount, drawCommand._indexOffset, drawCommand._vertexOffset);
+			}
+		}
+
+		draw_SpriteBatch(packet._spriteBatch);
+
+		draw_TextRuns(packet._textRunUpdate);
+
+		draw_default_font_text(packet._glyphInstances);
+
+		_swapChain->Present(0, 0);
+	}
+
+	bool Renderer::create_window()
+	{
+		_hInstance = ::GetModuleHandle(nullptr);
+		WNDCLASSEX wndClassEx{};
+		wndClassEx.cbSize = sizeof(wndClassEx);
+		wndClassEx.hInstance = _hInstance;
+		wndClassEx.lpszClassName = TEXT("SimpleRenderer Window");
+		wndClassEx.hbrBackground = ::CreateSolidBrush(RGB(255, 255, 255));
+		wndClassEx.style = CS_HREDRAW | CS_VREDRAW | CS_DBLCLKS;
+		wndClassEx.lpfnWndProc = windowProcedure;
+		::RegisterClassEx(&wndClassEx);
+		_hWnd = ::CreateWindowEx(0, wndClassEx.lpszClassName, TEXT("TEST"), WS_OVERLAPPEDWINDOW, CW_USEDEFAULT, CW_USEDEFAULT, (int)_windowSize.x, (int)_windowSize.y, nullptr, nullptr, _hInstance, nullptr);
+		if (_hWnd) ::ShowWindow(_hWnd, SW_SHOWDEFAULT);
+		return (_hWnd != nullptr);
+	}
+
+	void Renderer::destroy_window()
+	{
+		if (!_hWnd) return;
+		::DestroyWindow(_hWnd);
+		_hWnd = nullptr;
+	}
+
+	void Renderer::create_device()
+	{
+		DXGI_SWAP_CHAIN_DESC swapChainDescriptor{};
+		swapChainDescriptor.BufferCount = 1;
+		swapChainDescriptor.BufferDesc.Format = DXGI_FORMAT::DXGI_FORMAT_R8G8B8A8_UNORM;
+		swapChainDescriptor.BufferDesc.Width = static_cast<UINT>(_windowSize.x);
+		swapChainDescriptor.BufferDesc.Height = static_cast<UINT>(_windowSize.y);
+		swapChainDescriptor.BufferDesc.RefreshRate.Denominator = 1;
+		swapChainDescriptor.BufferDesc.RefreshRate.Numerator = 60;
+		swapChainDescriptor.BufferDesc.Scaling = DXGI_MODE_SCALING::DXGI_MODE_SCALING_UNSPECIFIED;
+		swapChainDescriptor.BufferDesc.ScanlineOrdering = DXGI_MODE_SCANLINE_ORDER::DXGI_MODE_SCANLINE_ORDER_UNSPECIFIED;
+		swapChainDescriptor.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
+		swapChainDescriptor.Flags = 0;
+		swapChainDescriptor.OutputWindow = _hWnd;
+		swapChainDescriptor.SampleDesc.Count = 1;
+		swapChainDescriptor.SampleDesc.Quality = 0;
+		swapChainDescriptor.SwapEffect = DXGI_SWAP_EFFECT::DXGI_SWAP_EFFECT_DISCARD;
+		swapChainDescriptor.Windowed = TRUE;
+		if (FAILED(::D3D11CreateDeviceAndSwapChain(nullptr, D3D_DRIVER_TYPE::D3D_DRIVER_TYPE_HARDWARE, nullptr, 0, nullptr, 0, D3D11_SDK_VERSION,
+			&swapChainDescriptor, _swapChain.ReleaseAndGetAddressOf(), _device.ReleaseAndGetAddressOf(), nullptr, _deviceContext.ReleaseAndGetAddressOf())))
+		{
+			MINT_LOG_ERROR("Failed to create Device and SwapChain.");
+			return;
+		}
+
+		ComPtr<ID3D11Texture2D> backBuffer;
+		_swapChain->GetBuffer(0, __uuidof(ID3D11Texture2D), reinterpret_cast<void**>(backBuffer.ReleaseAndGetAddressOf()));
+		if (FAILED(_device->CreateRenderTargetView(backBuffer.Get(), nullptr, _backBufferRtv.ReleaseAndGetAddressOf())))
+		{
+			MINT_LOG_ERROR("Failed to get BackBuffer.");
+			return;
+		}
+
+		D3D11_TEXTURE2D_DESC depthStencilResourceDescriptor{};
+		depthStencilResourceDescriptor.Width = static_cast<UINT>(_windowSize.x);
+		depthStencilResourceDescriptor.Height = static_cast<UINT>(_windowSize.y);
+		depthStencilResourceDescriptor.MipLevels = 1;
+		depthStencilResourceDescriptor.ArraySize = 1;
+		depthStencilResourceDescriptor.Format = DXGI_FORMAT_D24_UNORM_S8_UINT;
+		depthStencilResourceDescriptor.SampleDesc.Count = swapChainDescriptor.SampleDesc.Count;
+		depthStencilResourceDescriptor.SampleDesc.Quality = swapChainDescriptor.SampleDesc.Quality;
+		depthStencilResourceDescriptor.Usage = D3D11_USAGE_DEFAULT;
+		depthStencilResourceDescriptor.BindFlags = D3D11_BIND_DEPTH_STENCIL;
+		depthStencilResourceDescriptor.CPUAccessFlags = 0;
+		depthStencilResourceDescriptor.MiscFlags = 0;
+		if (FAILED(_device->CreateTexture2D(&depthStencilResourceDescriptor, nullptr, _depthStencilResource.ReleaseAndGetAddressOf())))
+		{
+			MINT_LOG_ERROR("Failed to create Depth-Stencil texture.");
+			return;
+		}
+		if (FAILED(_device->CreateDepthStencilView(_depthStencilResource.Get(), nullptr, _depthStencilView.ReleaseAndGetAddressOf())))
+		{
+			MINT_LOG_ERROR("Failed to create Depth-Stencil view.");
+			return;
+		}
+
+		{
+			D3D11_RASTERIZER_DESC rasterizerDescriptor{};
+			rasterizerDescriptor.AntialiasedLineEnable = FALSE;
+			rasterizerDescriptor.CullMode = D3D11_CULL_MODE::D3D11_CULL_BACK;
+			rasterizerDescriptor.DepthBias = 0;
+			rasterizerDescriptor.DepthBiasClamp = 0.0f;
+			rasterizerDescriptor.DepthClipEnable = TRUE;
+			rasterizerDescriptor.FillMode = D3D11_FILL_MODE::D3D11_FILL_SOLID;
+			rasterizerDescriptor.FrontCounterClockwise = TRUE;
+			rasterizerDescriptor.MultisampleEnable = TRUE;
+			rasterizerDescriptor.ScissorEnable = FALSE;
+			rasterizerDescriptor.SlopeScaledDepthBias = 0.0f;
+			_device->CreateRasterizerState(&rasterizerDescriptor, _defaultRasterizerState.ReleaseAndGetAddressOf());
+			_deviceContext->RSSetState(_defaultRasterizerState.Get());
+		}
+
+		{
+			D3D11_DEPTH_STENCIL_DESC depthStencilDescriptor{};
+			depthStencilDescriptor.DepthEnable = TRUE;
+			depthStencilDescriptor.DepthFunc = D3D11_COMPARISON_FUNC::D3D11_COMPARISON_LESS_EQUAL;
+			depthStencilDescriptor.DepthWriteMask = D3D11_DEPTH_WRITE_MASK::D3D11_DEPTH_WRITE_MASK_ALL;
+			depthStencilDescriptor.StencilEnable = FALSE;
+			if (FAILED(_device->CreateDepthStencilState(&depthStencilDescriptor, _defaultDepthStencilState.ReleaseAndGetAddressOf())))
+			{
+				MINT_LOG_ERROR("Failed to create Depth-Stencil state.");
+				return;
+			}
+		}
+
+		{
+			D3D11_VIEWPORT viewport{};
+			viewport.Width = _windowSize.x;
+			viewport.Height = _windowSize.y;
+			viewport.MinDepth = 0.0f;
+			viewport.MaxDepth = 1.0f;
+			_deviceContext->RSSetViewports(1, &viewport);
+		}
+
+		{
+			D3D11_SAMPLER_DESC samplerDescriptor{};
+			samplerDescriptor.Filter = D3D11_FILTER::D3D11_FILTER_MIN_MAG_MIP_POINT;
+			samplerDescriptor.AddressU = D3D11_TEXTURE_ADDRESS_MODE::D3D11_TEXTURE_ADDRESS_CLAMP;
+			samplerDescriptor.AddressV = D3D11_TEXTURE_ADDRESS_MODE::D3D11_TEXTURE_ADDRESS_CLAMP;
+			samplerDescriptor.AddressW = D3D11_TEXTURE_ADDRESS_MODE::D3D11_TEXTURE_ADDRESS_CLAMP;
+			samplerDescriptor.MipLODBias = 0.0f;
+			samplerDescriptor.ComparisonFunc = D3D11_COMPARISON_FUNC::D3D11_COMPARISON_ALWAYS;
+			samplerDescriptor.MinLOD = 0.0f;
+			samplerDescriptor.MaxLOD = D3D11_FLOAT32_MAX; // Let mipmapped textures use their whole chain
+			_device->CreateSamplerState(&samplerDescriptor, _defaultSamplerState.ReleaseAndGetAddressOf());
+			_deviceContext->PSSetSamplers(0, 1, _defaultSamplerState.GetAddressOf());
+		}
+
+		{
+			D3D11_BLEND_DESC blendDescriptor{};
+			blendDescriptor.AlphaToCoverageEnable = false;
+			blendDescriptor.RenderTarget[0].BlendEnable = true;
+			blendDescriptor.RenderTarget[0].SrcBlend = D3D11_BLEND::D3D11_BLEND_SRC_ALPHA;
+			blendDescriptor.RenderTarget[0].DestBlend = D3D11_BLEND::D3D11_BLEND_INV_SRC_ALPHA;
+			blendDescriptor.RenderTarget[0].BlendOp = D3D11_BLEND_OP::D3D11_BLEND_OP_ADD;
+			blendDescriptor.RenderTarget[0].SrcBlendAlpha = D3D11_BLEND::D3D11_BLEND_INV_SRC_ALPHA;
+			blendDescriptor.RenderTarget[0].DestBlendAlpha = D3D11_BLEND::D3D11_BLEND_ZERO;
+			blendDescriptor.RenderTarget[0].BlendOpAlpha = D3D11_BLEND_OP::D3D11_BLEND_OP_ADD;
+			blendDescriptor.RenderTarget[0].RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE::D3D11_COLOR_WRITE_ENABLE_ALL;
+			_device->CreateBlendState(&blendDescriptor, _defaultBlendState.ReleaseAndGetAddressOf());
+
+			const float kBlendFactor[4]{ 0, 0, 0, 0 };
+			_deviceContext->OMSetBlendState(_defaultBlendState.Get(), kBlendFactor, 0xFFFFFFFF);
+
+			_blendStates[static_cast<uint32>(BlendMode::Alpha)] = _defaultBlendState;
+
+			blendDescriptor.RenderTarget[0].DestBlend = D3D11_BLEND::D3D11_BLEND_ONE;
+			_device->CreateBlendState(&blendDescriptor, _blendStates[static_cast<uint32>(BlendMode::Additive)].ReleaseAndGetAddressOf());
+
+			blendDescriptor.RenderTarget[0].BlendEnable = false;
+			_device->CreateBlendState(&blendDescriptor, _blendStates[static_cast<uint32>(BlendMode::Opaque)].ReleaseAndGetAddressOf());
+		}
+
+		_deviceContext->OMSetRenderTargets(1, _backBufferRtv.GetAddressOf(), _depthStencilView.Get());
+		_deviceContext->OMSetDepthStencilState(_defaultDepthStencilState.Get(), 0);
+
+		_framePacketVertexBuffer._type = ResourceType::VertexBuffer;
+		_framePacketIndexBuffer._type = ResourceType::IndexBuffer;
+
+		create_device_create_default_FontData();
+		create_device_create_SpriteData();
+	}
+
+	void Renderer::create_device_create_default_FontData()
+	{
+		Renderer& renderer = *this;
+
+		_defaultFontShaderHeaderSet.push_shader_header("DefaultFontShaderHeader", kDefaultFontShaderHeaderCode);
+
+		ShaderCompileBatch shaderCompileBatch;
+		shaderCompileBatch.push(_defaultFontVertexShader, kDefaultFontVertexShaderCode, ShaderType::VertexShader, "DefaultFontVertexShader", "main", "vs_5_0", &_defaultFontShaderHeaderSet);
+		shaderCompileBatch.push(_defaultFontGlyphVertexShader, kDefaultFontGlyphVertexShaderCode, ShaderType::VertexShader, "DefaultFontGlyphVertexShader", "main", "vs_5_0", &_defaultFontShaderHeaderSet);
+		shaderCompileBatch.push(_defaultFontPixelShader, kDefaultFontPixelShaderCode, ShaderType::PixelShader, "DefaultFontPixelShader", "main", "ps_5_0", &_defaultFontShaderHeaderSet);
+		shaderCompileBatch.compile(renderer);
+
+		_defaultFontShaderInputLayout.push_InputElement(ShaderInputLayout::create_InputElement_float4("POSITION", 0));
+		_defaultFontShaderInputLayout.push_InputElement(ShaderInputLayout::create_InputElement_float4("COLOR", 0));
+		_defaultFontShaderInputLayout.push_InputElement(ShaderInputLayout::create_InputElement_float2("TEXCOORD", 0));
+		_defaultFontShaderInputLayout.create(renderer, _defaultFontVertexShader);
+
+		_defaultFontGlyphShaderInputLayout.push_InputElement(ShaderInputLayout::make_per_instance(ShaderInputLayout::create_InputElement_float2("POSITION", 0)));
+		_defaultFontGlyphShaderInputLayout.push_InputElement(ShaderInputLayout::make_per_instance(ShaderInputLayout::create_InputElement_uint("BLENDINDICES", 0)));
+		_defaultFontGlyphShaderInputLayout.push_InputElement(ShaderInputLayout::make_per_instance(ShaderInputLayout::create_InputElement_unorm4x8("COLOR", 0)));
+		_defaultFontGlyphShaderInputLayout.create(renderer, _defaultFontGlyphVertexShader);
+
+		DEFAULT_FONT_CB_MATRICES default_font_cb_matrices;
+		default_font_cb_matrices._projectionMatrix.make_pixel_coordinates_projection_matrix(_windowSize);
+		_defaultFontCBMatrices.create_buffer(renderer, ResourceType::ConstantBuffer, &default_font_cb_matrices, sizeof(default_font_cb_matrices), 1);
+
+		DEFAULT_FONT_CB_GLYPHS default_font_cb_glyphs;
+		for (uint32 ch = 0; ch < 256; ++ch)
+		{
+			const DefaultFontGlyphMeta& glyphMeta = kDefaultFontData.get_GlyphMeta(static_cast<byte>(ch));
+			default_font_cb_glyphs._glyphUVs[ch] = float4(glyphMeta._u0, glyphMeta._v0, glyphMeta._u1, glyphMeta._v1);
+		}
+		default_font_cb_glyphs._glyphSize = float4(_defaultFontScale.x * kFontTextureGlyphWidth, _defaultFontScale.y * kFontTextureGlyphHeight, 0, 0);
+		_defaultFontCBGlyphs.create_buffer(renderer, ResourceType::ConstantBuffer, &default_font_cb_glyphs, sizeof(default_font_cb_glyphs), 1);
+
+		_defaultFontTexture.create_texture2D(renderer, TextureFormat::R8_UNORM, kDefaultFontTexture._texels, kFontTextureWidth, kFontTextureHeight);
+
+		_defaultFontGlyphInstanceBuffer._type = ResourceType::VertexBuffer;
+	}
+
+	void Renderer::draw_default_font_text(const std::vector<DEFAULT_FONT_GLYPH_INSTANCE>& glyphInstances)
+	{
+		if (glyphInstances.empty() == true)
+		{
+			return;
+		}
+
+		_defaultFontGlyphInstanceBuffer.update(*this, &glyphInstances[0], sizeof(DEFAULT_FONT_GLYPH_INSTANCE), (uint32)glyphInstances.size());
+
+		bind_default_FontData();
+		bind_Shader(_defaultFontGlyphVertexShader);
+		bind_ShaderInputLayout(_defaultFontGlyphShaderInputLayout);
+		bind_ShaderResource(ShaderType::VertexShader, _defaultFontCBGlyphs, 1);
+		bind_input(_defaultFontGlyphInstanceBuffer, 0);
+
+		draw_instanced(6, (uint32)glyphInstances.size());
+	}
+
+	void Renderer::create_device_create_SpriteData()
+	{
+		Renderer& renderer = *this;
+
+		_spriteShaderHeaderSet.push_shader_header("SpriteShaderHeader", kSpriteShaderHeaderCode);
+
+		ShaderCompileBatch shaderCompileBatch;
+		shaderCompileBatch.push(_spriteVertexShader, kSpriteVertexShaderCode, ShaderType::VertexShader, "SpriteVertexShader", "main", "vs_5_0", &_spriteShaderHeaderSet);
+		shaderCompileBatch.push(_spritePixelShader, kSpritePixelShaderCode, ShaderType::PixelShader, "SpritePixelShader", "main", "ps_5_0", &_spriteShaderHeaderSet);
+		shaderCompileBatch.compile(renderer);
+
+		_spriteShaderInputLayout.push_InputElement(ShaderInputLayout::make_per_instance(ShaderInputLayout::create_InputElement_float4("POSITION", 0)));
+		_spriteShaderInputLayout.push_InputElement(ShaderInputLayout::make_per_instance(ShaderInputLayout::create_InputElement_float4("TEXCOORD", 0)));
+		_spriteShaderInputLayout.push_InputElement(ShaderInputLayout::make_per_instance(ShaderInputLayout::create_InputElement_float4("COLOR", 0)));
+		_spriteShaderInputLayout.push_InputElement(ShaderInputLayout::make_per_instance(ShaderInputLayout::create_InputElement_float2("TEXCOORD", 1)));
+		_spriteShaderInputLayout.create(renderer, _spriteVertexShader);
+
+		_spriteInstanceBuffer._type = ResourceType::VertexBuffer;
+	}
+
+	void Renderer::draw_SpriteBatch(const SpriteBatch& spriteBatch)
+	{
+		if (spriteBatch.is_empty() == true)
+		{
+			return;
+		}
+
+		const std::vector<SPRITE_INSTANCE>& instances = spriteBatch.get_instances();
+		_spriteInstanceBuffer.update(*this, &instances[0], sizeof(SPRITE_INSTANCE), (uint32)instances.size());
+
+		bind_Shader(_spriteVertexShader);
+		bind_Shader(_spritePixelShader);
+		bind_ShaderInputLayout(_spriteShaderInputLayout);
+		bind_ShaderResource(ShaderType::VertexShader, _defaultFontCBMatrices, 0);
+		bind_input(_spriteInstanceBuffer, 0);
+
+		const float kBlendFactor[4]{ 0, 0, 0, 0 };
+		const Resource* boundTexture = nullptr;
+		BlendMode boundBlendMode = BlendMode::Alpha;
+		for (const SpriteBatchRun& run : spriteBatch.get_runs())
+		{
+			if (run._texture != boundTexture)
+			{
+				bind_ShaderResource(ShaderType::PixelShader, *const_cast<Resource*>(run._texture), 0);
+				boundTexture = run._texture;
+			}
+			if (run._blendMode != boundBlendMode)
+			{
+				_deviceContext->OMSetBlendState(_blendStates[static_cast<uint32>(run._blendMode)].Get(), kBlendFactor, 0xFFFFFFFF);
+				boundBlendMode = run._blendMode;
+			}
+			draw_instanced(6, run._instanceCount, run._instanceOffset);
+		}
+
+		if (boundBlendMode != BlendMode::Alpha)
+		{
+			_deviceContext->OMSetBlendState(_defaultBlendState.Get(), kBlendFactor, 0xFFFFFFFF);
+		}
+	}
+
+	void Renderer::draw_TextRuns(const TextRunUpdate& textRunUpdate)
+	{
+		if (textRunUpdate._vertexCapacity == 0)
+		{
+			return;
+		}
+
+		if (_textRunVertexBuffer._elementMaxCount < textRunUpdate._vertexCapacity)
+		{
+			// The update holds every vertex whenever the capacity grows, so the new buffer starts empty.
+			_textRunVertexBuffer.create_buffer(*this, ResourceType::VertexBuffer, nullptr, sizeof(DEFAULT_FONT_VS_INPUT), textRunUpdate._vertexCapacity, false);
+
+			const uint32 quadCount = textRunUpdate._vertexCapacity / 4;
+			std::vector<uint32> indices(size_t(quadCount) * 6);
+			for (uint32 quadIndex = 0; quadIndex < quadCount; ++quadIndex)
+			{
+				uint32* const quadIndices = &indices[size_t(quadIndex) * 6];
+				quadIndices[0] = quadIndex * 4 + 0;
+				quadIndices[1] = quadIndex * 4 + 1;
+				quadIndices[2] = quadIndex * 4 + 2;
+				quadIndices[3] = quadIndex * 4 + 0;
+				quadIndices[4] = quadIndex * 4 + 2;
+				quadIndices[5] = quadIndex * 4 + 3;
+			}
+			_textRunIndexBuffer.create_buffer(*this, ResourceType::IndexBuffer, &indices[0], sizeof(uint32), (uint32)indices.size(), false);
+		}
+
+		uint32 vertexOffset = 0;
+		for (const TextRunUpdateRange& range : textRunUpdate._ranges)
+		{
+			_textRunVertexBuffer.update_region(*this, &textRunUpdate._vertices[vertexOffset], range._vertexOffset, range._vertexCount);
+			vertexOffset += range._vertexCount;
+		}
+
+		if (textRunUpdate._drawVertexCount == 0)
+		{
+			return;
+		}
+
+		bind_default_FontData();
+		bind_input(_textRunVertexBuffer, 0);
+		bind_input(_textRunIndexBuffer, 0);
+		draw_indexed(textRunUpdate._drawVertexCount / 4 * 6);
+	}
+
+	void Renderer::bind_default_FontData()
+	{
+		bind_Shader(_defaultFontVertexShader);
+		bind_Shader(_defaultFontPixelShader);
+		bind_ShaderInputLayout(_defaultFontShaderInputLayout);
+		bind_ShaderResource(ShaderType::VertexShader, _defaultFontCBMatrices, 0);
+		bind_ShaderResource(ShaderType::PixelShader, _defaultFontTexture, 0);
+	}
+
+#endif
+
+
+	// Parses a decimal float without allocating; the whole text must be consumed. Unlike std::stof this ignores the locale.
+	bool parse_float(const std::string_view text, float& outValue)
+	{
+		const char* const end = text.data() + text.size();
+		const std::from_chars_result result = std::from_chars(text.data(), end, outValue);
+		return result.ec == std::errc() && result.ptr == end;
+	}
+
+	bool parse_int32(const std::string_view text, int32& outValue)
+	{
+		const char* const end = text.data() + text.size();
+		const std::from_chars_result result = std::from_chars(text.data(), end, outValue);
+		return result.ec == std::errc() && result.ptr == end;
+	}
+
+	// Two floats separated by ',' and/or whitespace, e.g. "1.5, -2".
+	bool parse_float2(const std::string_view text, float2& outValue)
+	{
+		const auto is_separator = [](const char ch) { return ch == ',' || ch == ' ' || ch == '\t'; };
+		size_t xEnd = 0;
+		while (xEnd < text.size() && is_separator(text[xEnd]) == false)
+		{
+			++xEnd;
+		}
+		size_t yAt = xEnd;
+		while (yAt < text.size() && is_separator(text[yAt]) == true)
+		{
+			++yAt;
+		}
+		return parse_float(text.substr(0, xEnd), outValue.x) == true && parse_float(text.substr(yAt), outValue.y) == true;
+	}
+
+	// resize() leaves new elements unconstructed, so several threads can construct (and fault in) parts of a large array
+	// with placement new. Every element must be constructed that way before it is used.
+	template <typename T>
+	struct NoInitAllocator : std::allocator<T>
+	{
+		template <typename U>
+		struct rebind { using other = NoInitAllocator<U>; };
+
+		NoInitAllocator() = default;
+		template <typename U>
+		NoInitAllocator(const NoInitAllocator<U>&) noexcept { __noop; }
+
+		template <typename U>
+		void construct(U* const) noexcept { __noop; }
+		template <typename U, typename... Args>
+		void construct(U* const pointer, Args&&... args) { ::new (static_cast<void*>(pointer)) U(std::forward<Args>(args)...); }
+	};
+
+	struct XML
+	{
+		struct Attribute;
+		struct Node;
+		static constexpr uint32 INVALID_ID = UINT32_MAX;
+
+		// Offsets are 32-bit, so a document is limited to 4 GB.
+		struct Attribute
+		{
+			friend XML;
+
+			uint32 _ID = INVALID_ID;
+			uint32 _node_ID = INVALID_ID;
+			uint32 _index_in_node = 0;
+			uint32 _name_at = 0;
+			uint32 _name_length = 0;
+			uint32 _value_at = 0;
+			uint32 _value_length = 0;
+			uint32 _name_atom = INVALID_ID;
+
+			//std::string _debug_name;
+			//std::string _debug_value;
+
+			bool is_valid() const { return _name_length > 0; }
+			std::string_view get_name() const { return (_XML == nullptr ? std::string_view() : _XML->_view.substr(_name_at, _name_length)); }
+			uint32 get_name_atom() const { return _name_atom; }
+			std::string_view get_value() const { return (_XML == nullptr ? std::string_view() : _XML->_view.substr(_value_at, _value_length)); }
+			// Typed values are parsed in place; defaultValue is returned if the attribute is invalid or malformed.
+			float get_float(const float defaultValue = 0.0f) const { float value = defaultValue; return (is_valid() == true && parse_float(get_value(), value) == true ? value : defaultValue); }
+			int32 get_int(const int32 defaultValue = 0) const { int32 value = defaultValue; return (is_valid() == true && parse_int32(get_value(), value) == true ? value : defaultValue); }
+			float2 get_float2(const float2& defaultValue = float2(0, 0)) const { float2 value = defaultValue; return (is_valid() == true && parse_float2(get_value(), value) == true ? value : defaultValue); }
+			const Attribute& get_next_attribute() const { return (_XML == nullptr ? *this : get_node().get_attribute(_index_in_node + 1)); }
+
+		private:
+			const Node& get_node() const { return _XML->get_node(_node_ID); }
+			const XML* _XML = nullptr;
+		};
+		// The attributes of a node are contiguous in the attribute array; children are a first-child/next-sibling list.
+		struct Node
+		{
+			friend XML;
+
+			uint32 _ID = INVALID_ID;
+			uint32 _parent_ID = INVALID_ID;
+			uint32 _index_in_parent_node = 0;
+			uint32 _name_at = 0;
+			uint32 _name_length = 0;
+			uint32 _first_attribute_ID = INVALID_ID;
+			uint32 _attribute_count = 0;
+			uint32 _first_child_ID = INVALID_ID;
+			uint32 _last_child_ID = INVALID_ID;
+			uint32 _next_sibling_ID = INVALID_ID;
+			uint32 _child_count = 0;
+			uint32 _name_atom = INVALID_ID;
+
+			//std::string _debug_name;
+
+			bool is_valid() const { return _name_length > 0; }
+			std::string_view get_name() const { return (_XML == nullptr ? std::string_view() : _XML->_view.substr(_name_at, _name_length)); }
+			uint32 get_name_atom() const { return _name_atom; }
+			uint32 get_attribute_count() const { return _attribute_count; }
+			const Attribute& get_attribute(const uint32 index) const
+			{
+				static const Attribute kInvalidAttribute;
+				return (_XML == nullptr ? kInvalidAttribute : _XML->get_attribute((index >= _attribute_count ? INVALID_ID : _first_attribute_ID + index)));
+			}
+			// Compares atoms over the node's contiguous attributes, which are few, so no string is touched.
+			const Attribute& find_attribute(const uint32 nameAtom) const
+			{
+				for (uint32 index = 0; index < _attribute_count; ++index)
+				{
+					const Attribute& attribute = get_attribute(index);
+					if (attribute._name_atom == nameAtom)
+					{
+						return attribute;
+					}
+				}
+				return get_attribute(INVALID_ID);
+			}
+			uint32 get_child_count() const { return _child_count; }
+			const Node& get_first_child_node() const { return (_XML == nullptr ? *this : _XML->get_node(_first_child_ID)); }
+			// Walks the sibling list; prefer get_first_child_node() and get_next_sibling() to visit all children.
+			const Node& get_child_node(const uint32 index) const
+			{
+				const Node* node = &get_first_child_node();
+				for (uint32 i = 0; i < index && node->is_valid() == true; ++i)
+				{
+					node = &node->get_next_sibling();
+				}
+				return *node;
+			}
+			const Node& get_next_sibling() const { return (_XML == nullptr ? *this : _XML->get_node(_next_sibling_ID)); }
+			const Node& get_parent_node() const { return (_XML == nullptr ? *this : _XML->get_node(_parent_ID)); }
+
+		private:
+			bool has_name() const { return _name_length > 0; }
+			const XML* _XML = nullptr;
+		};
+		// Parses a copy of text.
+		bool parse(const std::string& text)
+		{
+			_text = text;
+			return parse_borrowed(_text);
+		}
+		// Parses text in place without copying it; text must outlive this XML and every name and value taken from it.
+		bool parse_borrowed(const std::string_view text)
+		{
+			reset(text);
+			if (_view.length() > UINT32_MAX)
+			{
+				report_error("text is too long!");
+				return false;
+			}
+			if (build_structural_index(0, _end) == false)
+			{
+				return false;
+			}
+
+			_structuralCursor = 0;
+			uint32 parent_node_ID = INVALID_ID;
+			uint32 last_top_level_node_ID = INVALID_ID;
+			return parse_nodes(parent_node_ID, last_top_level_node_ID);
+		}
+		// Same result as parse_borrowed(), with the children of the root element parsed on all hardware threads.
+		// The text is cut before elements at depth 1 and every range is parsed into its own node and attribute arrays,
+		// which are then concatenated in document order with their IDs and atoms fixed up. A range that does not parse into
+		// whole elements means a cut was guessed wrong, so this falls back to parse_borrowed(), which also reports errors.
+		// rangeCount overrides the number of ranges aimed at, four per hardware thread by default; with an override the text
+		// is split even on a single hardware thread, so the split and merge can be tested anywhere.
+		bool parse_borrowed_parallel(const std::string_view text, const uint32 minimumRangeByteSize = 1 << 20, const uint32 rangeCount = 0)
+		{
+			const uint32 threadCount = (std::max)(std::thread::hardware_concurrency(), 1u);
+			if ((threadCount == 1 && rangeCount == 0) || text.length() > UINT32_MAX || text.length() < size_t(minimumRangeByteSize) * 2)
+			{
+				return parse_borrowed(text);
+			}
+
+			reset(text);
+			// Several ranges per thread, so uneven ranges still balance out.
+			const size_t targetRangeCount = (rangeCount == 0 ? size_t(threadCount) * 4 : rangeCount);
+			const size_t rangeByteSize = (std::max)({ size_t(minimumRangeByteSize), _view.length() / targetRangeCount, size_t(1) });
+			std::vector<uint32> range_begins;
+			find_depth1_split_positions(static_cast<uint32>(_view.length() / rangeByteSize), range_begins);
+			// The root's end tag; it and anything after it are parsed after merging.
+			const size_t root_end_tag_at = _view.rfind("</");
+			if (root_end_tag_at == std::string_view::npos)
+			{
+				return parse_borrowed(text);
+			}
+			range_begins.erase(std::remove_if(range_begins.begin(), range_begins.end(), [&](const uint32 at) { return at == 0 || at >= root_end_tag_at; }), range_begins.end());
+			range_begins.insert(range_begins.begin(), 0);
+			const uint32 range_count = static_cast<uint32>(range_begins.size());
+			if (range_count < 2)
+			{
+				return parse_borrowed(text);
+			}
+
+			std::vector<XML> range_XMLs(range_count);
+			std::vector<uint32> range_parent_node_IDs(range_count, INVALID_ID);
+			std::vector<uint32> range_last_top_level_node_IDs(range_count, INVALID_ID);
+			std::vector<uint8> range_results(range_count, 0);
+			parallel_for(range_count, [&](const uint32 range_index)
+				{
+					XML& range_XML = range_XMLs[range_index];
+					range_XML._view = _view;
+					range_XML._end = (range_index + 1 < range_count ? range_begins[range_index + 1] : static_cast<uint32>(root_end_tag_at));
+					if (range_XML.build_structural_index(range_begins[range_index], range_XML._end) == true)
+					{
+						range_XML._at = range_begins[range_index];
+						range_XML._structuralCursor = 0;
+						range_results[range_index] = range_XML.parse_nodes(range_parent_node_IDs[range_index], range_last_top_level_node_IDs[range_index]);
+					}
+					// The index is as large as the text, so it goes before the merge doubles the node memory.
+					range_XML._structurals = std::vector<uint32>();
+				});
+
+			// The first range must leave exactly the root open and every other range must hold whole elements, starting with one.
+			const uint32 root_node_ID = range_parent_node_IDs[0];
+			bool is_split_valid = (range_results[0] != 0 && root_node_ID != INVALID_ID && range_XMLs[0]._nodes[root_node_ID]._parent_ID == INVALID_ID && range_last_top_level_node_IDs[0] == root_node_ID);
+			for (uint32 range_index = 1; range_index < range_count && is_split_valid == true; ++range_index)
+			{
+				const XML& range_XML = range_XMLs[range_index];
+				is_split_valid = (range_results[range_index] != 0 && range_parent_node_IDs[range_index] == INVALID_ID && range_XML._nodes.empty() == false && range_XML._nodes[0]._parent_ID == INVALID_ID);
+			}
+			if (is_split_valid == false)
+			{
+				return parse_borrowed(text);
+			}
+
+			merge_ranges(range_XMLs, range_last_top_level_node_IDs, root_node_ID);
+			range_XMLs.clear();
+
+			_end = static_cast<uint32>(_view.length());
+			if (build_structural_index(root_end_tag_at, _end) == false)
+			{
+				return parse_borrowed(text);
+			}
+			_at = root_end_tag_at;
+			_structuralCursor = 0;
+			uint32 parent_node_ID = root_node_ID;
+			uint32 last_top_level_node_ID = root_node_ID;
+			if (parse_nodes(parent_node_ID, last_top_level_node_ID) == false)
+			{
+				return parse_borrowed(text);
+			}
+			return true;
+		}
+		const Node& get_root_node() const { return get_node(0); }
+		const Node& get_node(const uint32 ID) const { return (ID >= _nodes.size() ? INVALID_NODE : _nodes[ID]); }
+		const Attribute& get_attribute(const uint32 ID) const { return (ID >= _attributes.size() ? INVALID_ATTRIBUTE : _attributes[ID]); }
+		uint32 get_node_count() const { return static_cast<uint32>(_nodes.size()); }
+		uint32 get_attribute_count() const { return static_cast<uint32>(_attributes.size()); }
+		const std::string& get_error() const { return _error; }
+		// Element and attribute names are interned into atoms while parsing, so matching a name is an integer comparison.
+		// Returns INVALID_ID if no element or attribute of the document has this name.
+		uint32 find_atom(const std::string_view name) const { auto found = _atomMap.find(name); return (found == _atomMap.end() ? INVALID_ID : found->second); }
+		std::string_view get_atom_name(const uint32 atom) const { return (atom < _atomNames.size() ? _atomNames[atom] : std::string_view()); }
+		uint32 get_atom_count() const { return static_cast<uint32>(_atomNames.size()); }
+
+	private:
+		void reset(const std::string_view text)
+		{
+			_view = text;
+			_end = static_cast<uint32>((std::min)(_view.length(), size_t(UINT32_MAX)));
+			_nodes.clear();
+			_attributes.clear();
+			_atomNames.clear();
+			_atomMap.clear();
+			_error.clear();
+			_at = 0;
+		}
+		uint32 intern(const std::string_view name)
+		{
+			auto found = _atomMap.find(name);
+			if (found != _atomMap.end())
+			{
+				return found->second;
+			}
+			const uint32 atom = static_cast<uint32>(_atomNames.size());
+			_atomNames.push_back(name);
+			_atomMap.emplace(name, atom);
+			return atom;
+		}
+		static bool is_whitespace(const char ch) { return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r'; }
+		// Moves _at to the first structural character at or after it.
+		bool advance_to_structural()
+		{
+			const size_t structuralCount = _structurals.size();
+			while (_structuralCursor < structuralCount && _structurals[_structuralCursor] < _at)
+			{
+				++_structuralCursor;
+			}
+			if (_structuralCursor == structuralCount)
+			{
+				_at = _end;
+				return false;
+			}
+			_at = _structurals[_structuralCursor];
+			return true;
+		}
+		// ch must be a structural character.
+		bool advance_to_find(const char ch)
+		{
+			while (advance_to_structural() == true)
+			{
+				if (_view[_at] == ch)
+				{
+					return true;
+				}
+				++_at;
+			}
+			return false;
+		}
+		// Iterative: the open nodes form a chain through _parent_ID, so stack usage does not grow with the document.
+		// Parses from _at up to _end, continuing from and updating the open node and the last top-level node.
+		bool parse_nodes(uint32& parent_node_ID, uint32& last_top_level_node_ID)
+		{
+			const size_t length = _view.length();
+			while (advance_to_find('<') == true)
+			{
+				if (_at + 1 < length && _view[_at + 1] == '/')
+				{
+					if (parent_node_ID == INVALID_ID)
+					{
+						report_error("closing tag without an open node!");
+						return false;
+					}
+					if (advance_to_find('>') == false)
+					{
+						return false;
+					}
+
+					parent_node_ID = _nodes[parent_node_ID]._parent_ID;
+					continue;
+				}
+
+				const uint32 node_name_at = static_cast<uint32>(_at + 1);
+				const uint32 node_ID = static_cast<uint32>(_nodes.size());
+				_nodes.push_back(Node());
+				Node& node = _nodes.back();
+				node._XML = this;
+				node._ID = node_ID;
+				node._parent_ID = parent_node_ID;
+				node._name_at = node_name_at;
+				const uint32 previous_sibling_ID = (parent_node_ID != INVALID_ID ? _nodes[parent_node_ID]._last_child_ID : last_top_level_node_ID);
+				if (previous_sibling_ID != INVALID_ID)
+				{
+					_nodes[previous_sibling_ID]._next_sibling_ID = node_ID;
+					node._index_in_parent_node = _nodes[previous_sibling_ID]._index_in_parent_node + 1;
+				}
+				if (parent_node_ID != INVALID_ID)
+				{
+					Node& parent_node = _nodes[parent_node_ID];
+					if (parent_node._first_child_ID == INVALID_ID)
+					{
+						parent_node._first_child_ID = node_ID;
+					}
+					parent_node._last_child_ID = node_ID;
+					++parent_node._child_count;
+				}
+				else
+				{
+					last_top_level_node_ID = node_ID;
+				}
+
+				_at = node_name_at;
+				if (advance_to_structural() == false)
+				{
+					report_error("'>' is missing.");
+					return false;
+				}
+				node._name_length = static_cast<uint32>(_at - node_name_at);
+				if (node._name_length == 0)
+				{
+					// A nameless node would count as a child of its parent but be invalid, so the sibling walk would skip it.
+					report_error("node name is missing!");
+					return false;
+				}
+				node._name_atom = intern(_view.substr(node_name_at, node._name_length));
+				//_nodes[node_ID]._debug_name = _view.substr(node_name_at, _nodes[node_ID]._name_length);
+
+				bool is_node_closed = false;
+				while (_at < length && is_node_closed == false)
+				{
+					const char ch = _view[_at];
+					if (ch == '>')
+					{
+						_at = _at + 1;
+						parent_node_ID = node_ID;
+						is_node_closed = true;
+					}
+					else if (ch == '/')
+					{
+						if (_at + 1 >= length || _view[_at + 1] != '>')
+						{
+							report_error("'/' must be followed by '>'.");
+							return false;
+						}
+						_at = _at + 2;
+						is_node_closed = true;
+					}
+					else if (is_whitespace(ch) == true)
+					{
+						++_at;
+					}
+					else
+					{
+						// attributes
+						if (parse_attribute(node) == false)
+						{
+							return false;
+						}
+						++_at;
+					}
+				}
+				if (is_node_closed == false)
+				{
+					report_error("'>' is missing.");
+					return false;
+				}
+			}
+			return (_at == _end);
+		}
+		bool parse_attribute(Node& node)
+		{
+			_attributes.push_back(Attribute());
+
+			Attribute& attribute = _attributes.back();
+			attribute._XML = this;
+			attribute._ID = static_cast<uint32>(_attributes.size() - 1);
+			attribute._name_at = static_cast<uint32>(_at);
+
+			// A node's attributes are parsed back to back, so they stay contiguous.
+			if (node._attribute_count == 0)
+			{
+				node._first_attribute_ID = attribute._ID;
+			}
+			attribute._node_ID = node._ID;
+			attribute._index_in_node = node._attribute_count;
+			++node._attribute_count;
+
+			if (advance_to_find('=') == false)
+			{
+				report_error("invalid attribute! '=' is needed.");
+				return false;
+			}
+
+			attribute._name_length = static_cast<uint32>(_at - attribute._name_at);
+			attribute._name_atom = intern(_view.substr(attribute._name_at, attribute._name_length));
+			//attribute._debug_name = _view.substr(attribute._name_at, attribute._name_length);
+
+			if (_at + 1 >= _view.length() || _view[_at + 1] != '\"')
+			{
+				report_error("'\"' must be followed by '='.");
+				return false;
+			}
+			_at += 2;
+			attribute._value_at = static_cast<uint32>(_at);
+
+			if (advance_to_find('\"') == false)
+			{
+				report_error("closing '\"' is missing.");
+				return false;
+			}
+			attribute._value_length = static_cast<uint32>(_at - attribute._value_at);
+			//attribute._debug_value = _view.substr(attribute._value_at, attribute._value_length);
+			return true;
+		}
+
+	private:
+		// Bit i is set if block[i] == ch, for a 64-byte block.
+		static uint64 compute_byte_mask(const char* const block, const char ch)
+		{
+#if defined(MINT_USE_SSE2)
+			const __m128i pattern = _mm_set1_epi8(ch);
+			uint64 mask = 0;
+			for (uint32 lane = 0; lane < 4; ++lane)
+			{
+				const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + lane * 16));
+				mask |= static_cast<uint64>(static_cast<uint32>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, pattern)))) << (lane * 16);
+			}
+			return mask;
+#else
+			uint64 mask = 0;
+			for (uint32 i = 0; i < 64; ++i)
+			{
+				mask |= static_cast<uint64>(block[i] == ch) << i;
+			}
+			return mask;
+#endif
+		}
+		// Collects the positions of '<', '>', '=', '"', '/' and whitespace in [begin, end) 64 bytes at a time, so parsing jumps
+		// between them instead of visiting every character. Repeated ' ', '<', '>' and '/' are rejected in the same pass.
+		bool build_structural_index(const size_t begin, const size_t end)
+		{
+			constexpr uint32 kBlockSize = 64;
+			constexpr uint32 kRepeatableCount = 4;
+			constexpr char kRepeatables[kRepeatableCount] = { ' ', '<', '>', '/' };
+			const char* const text = _view.data();
+			_structurals.clear();
+			_structurals.reserve((end - begin) / 4);
+
+			uint64 carries[kRepeatableCount] = {};
+			uint64 masks[kRepeatableCount] = {};
+			for (uint32 repeatableIndex = 0; repeatableIndex < kRepeatableCount && begin > 0; ++repeatableIndex)
+			{
+				carries[repeatableIndex] = (text[begin - 1] == kRepeatables[repeatableIndex] ? 1 : 0);
+			}
+			size_t node_count = 0;
+			size_t attribute_count = 0;
+			char tail[kBlockSize];
+			for (size_t block_at = begin; block_at < end; block_at += kBlockSize)
+			{
+				const char* block = text + block_at;
+				if (end - block_at < kBlockSize)
+				{
+					::memset(tail, 0, kBlockSize);
+					::memcpy(tail, block, end - block_at);
+					block = tail;
+				}
+
+				uint64 structuralMask = 0;
+				uint64 repeatedMask = 0;
+				char repeatedChar = 0;
+				for (uint32 repeatableIndex = 0; repeatableIndex < kRepeatableCount; ++repeatableIndex)
+				{
+					const uint64 mask = compute_byte_mask(block, kRepeatables[repeatableIndex]);
+					masks[repeatableIndex] = mask;
+					// Bit i is set when block[i - 1] was the same character, block[-1] being the last one of the previous block.
+					const uint64 repeated = mask & ((mask << 1) | carries[repeatableIndex]);
+					if (repeated != 0 && (repeatedMask == 0 || count_trailing_zeros(repeated) < count_trailing_zeros(repeatedMask)))
+					{
+						repeatedMask = repeated;
+						repeatedChar = kRepeatables[repeatableIndex];
+					}
+					carries[repeatableIndex] = mask >> 63;
+					structuralMask |= mask;
+				}
+				if (repeatedMask != 0)
+				{
+					char message[] = "character[ ] is repeated!";
+					message[10] = repeatedChar;
+					report_error(message, block_at + count_trailing_zeros(repeatedMask) - 1);
+					return false;
+				}
+
+				// Counted to size the node and attribute arrays up front; "</" across blocks is missed and only over-reserves.
+				const uint64 equalMask = compute_byte_mask(block, '=');
+				node_count += std::bitset<64>(masks[1] & ~(masks[3] >> 1)).count();
+				attribute_count += std::bitset<64>(equalMask).count();
+				structuralMask |= equalMask | compute_byte_mask(block, '\"');
+				structuralMask |= compute_byte_mask(block, '\t') | compute_byte_mask(block, '\n') | compute_byte_mask(block, '\r');
+				while (structuralMask != 0)
+				{
+					_structurals.push_back(static_cast<uint32>(block_at + count_trailing_zeros(structuralMask)));
+					structuralMask &= structuralMask - 1;
+				}
+			}
+			_nodes.reserve(_nodes.size() + node_count);
+			_attributes.reserve(_attributes.size() + attribute_count);
+			return true;
+		}
+		// Finds, for each of segmentCount equal parts of the text, the first start tag of an element at depth 1 in it.
+		// Parts start at a '<' that is assumed to be outside any tag, are scanned in parallel for their depth change, and
+		// then scanned again from their actual depth up to the first split. Nothing here is trusted by the parser.
+		void find_depth1_split_positions(const uint32 segmentCount, std::vector<uint32>& outSplitPositions) const
+		{
+			const char* const text = _view.data();
+			const size_t length = _view.length();
+			std::vector<uint32> segment_begins(segmentCount + 1);
+			for (uint32 segment_index = 0; segment_index < segmentCount; ++segment_index)
+			{
+				const size_t at = length / segmentCount * segment_index;
+				const void* const found = ::memchr(text + at, '<', length - at);
+				segment_begins[segment_index] = static_cast<uint32>(found == nullptr ? length : static_cast<const char*>(found) - text);
+			}
+			segment_begins[segmentCount] = static_cast<uint32>(length);
+
+			std::vector<int32> segment_depths(segmentCount + 1, 0);
+			parallel_for(segmentCount, [&](const uint32 segment_index)
+				{
+					int32 depth = 0;
+					scan_tag_depth(segment_begins[segment_index], segment_begins[segment_index + 1], depth, false);
+					segment_depths[segment_index + 1] = depth;
+				});
+			for (uint32 segment_index = 0; segment_index < segmentCount; ++segment_index)
+			{
+				segment_depths[segment_index + 1] += segment_depths[segment_index];
+			}
+
+			std::vector<uint32> split_positions(segmentCount, UINT32_MAX);
+			parallel_for(segmentCount, [&](const uint32 segment_index)
+				{
+					int32 depth = segment_depths[segment_index];
+					split_positions[segment_index] = scan_tag_depth(segment_begins[segment_index], segment_begins[segment_index + 1], depth, true);
+				});
+			outSplitPositions.clear();
+			for (const uint32 split_position : split_positions)
+			{
+				if (split_position != UINT32_MAX && (outSplitPositions.empty() == true || outSplitPositions.back() < split_position))
+				{
+					outSplitPositions.push_back(split_position);
+				}
+			}
+		}
+		// Tracks element depth over [begin, end) with only '<', '>', '"' and '/'. With stopAtDepth1, returns the position of
+		// the first start tag opened at depth 1; otherwise returns UINT32_MAX and leaves the depth at end in depth.
+		uint32 scan_tag_depth(const size_t begin, const size_t end, int32& depth, const bool stopAtDepth1) const
+		{
+			enum class TagState : uint8 { Text, StartTag, AttributeValue, EndTag };
+			constexpr uint32 kBlockSize = 64;
+			const char* const text = _view.data();
+			const size_t length = _view.length();
+			TagState state = TagState::Text;
+			char tail[kBlockSize];
+			for (size_t block_at = begin; block_at < end; block_at += kBlockSize)
+			{
+				const char* block = text + block_at;
+				if (end - block_at < kBlockSize)
+				{
+					::memset(tail, 0, kBlockSize);
+					::memcpy(tail, block, end - block_at);
+					block = tail;
+				}
+
+				uint64 mask = compute_byte_mask(block, '<') | compute_byte_mask(block, '>') | compute_byte_mask(block, '\"') | compute_byte_mask(block, '/');
+				for (; mask != 0; mask &= mask - 1)
+				{
+					const size_t at = block_at + count_trailing_zeros(mask);
+					const char ch = text[at];
+					const char next_ch = (at + 1 < length ? text[at + 1] : 0);
+					if (state == TagState::Text)
+					{
+						if (ch != '<')
+						{
+							continue;
+						}
+						if (next_ch == '/')
+						{
+							--depth;
+							state = TagState::EndTag;
+							continue;
+						}
+						if (stopAtDepth1 == true && depth == 1)
+						{
+							return static_cast<uint32>(at);
+						}
+						++depth;
+						state = TagState::StartTag;
+					}
+					else if (state == TagState::StartTag)
+					{
+						if (ch == '\"')
+						{
+							state = TagState::AttributeValue;
+						}
+						else if (ch == '>')
+						{
+							state = TagState::Text;
+						}
+						else if (ch == '/' && next_ch == '>')
+						{
+							--depth;
+						}
+					}
+					else if (state == TagState::AttributeValue)
+					{
+						if (ch == '\"')
+						{
+							state = TagState::StartTag;
+						}
+					}
+					else if (ch == '>')
+					{
+						state = TagState::Text;
+					}
+				}
+			}
+			return UINT32_MAX;
+		}
+		// Appends the ranges' nodes and attributes in document order. Local IDs are offset, local atoms are re-interned in
+		// order of first appearance, and the top-level nodes of ranges after the first become the root's children.
+		void merge_ranges(std::vector<XML>& rangeXMLs, const std::vector<uint32>& rangeLastTopLevelNodeIDs, const uint32 rootNodeID)
+		{
+			const uint32 range_count = static_cast<uint32>(rangeXMLs.size());
+			std::vector<uint32> node_bases(range_count + 1, 0);
+			std::vector<uint32> attribute_bases(range_count + 1, 0);
+			std::vector<uint32> child_index_bases(range_count, 0);
+			std::vector<std::vector<uint32>> atom_remaps(range_count);
+			for (uint32 range_index = 0; range_index < range_count; ++range_index)
+			{
+				const XML& range_XML = rangeXMLs[range_index];
+				node_bases[range_index + 1] = node_bases[range_index] + static_cast<uint32>(range_XML._nodes.size());
+				attribute_bases[range_index + 1] = attribute_bases[range_index] + static_cast<uint32>(range_XML._attributes.size());
+				if (range_index == 1)
+				{
+					child_index_bases[1] = rangeXMLs[0]._nodes[rootNodeID]._child_count;
+				}
+				else if (range_index > 1)
+				{
+					const XML& previous_range_XML = rangeXMLs[range_index - 1];
+					child_index_bases[range_index] = child_index_bases[range_index - 1] + previous_range_XML._nodes[rangeLastTopLevelNodeIDs[range_index - 1]]._index_in_parent_node + 1;
+				}
+				atom_remaps[range_index].reserve(range_XML._atomNames.size());
+				for (const std::string_view atom_name : range_XML._atomNames)
+				{
+					atom_remaps[range_index].push_back(intern(atom_name));
+				}
+			}
+
+			// Unconstructed, so the ranges below construct their parts of the arrays in parallel.
+			_nodes.resize(node_bases[range_count]);
+			_attributes.resize(attribute_bases[range_count]);
+			parallel_for(range_count, [&](const uint32 range_index)
+				{
+					XML& range_XML = rangeXMLs[range_index];
+					const uint32 node_base = node_bases[range_index];
+					const uint32 attribute_base = attribute_bases[range_index];
+					const std::vector<uint32>& atom_remap = atom_remaps[range_index];
+					const auto offset_ID = [](const uint32 ID, const uint32 base) { return (ID == INVALID_ID ? INVALID_ID : ID + base); };
+					for (size_t local_node_ID = 0; local_node_ID < range_XML._nodes.size(); ++local_node_ID)
+					{
+						Node& node = *::new (&_nodes[node_base + local_node_ID]) Node(range_XML._nodes[local_node_ID]);
+						node._XML = this;
+						node._ID += node_base;
+						if (node._parent_ID == INVALID_ID && range_index > 0)
+						{
+							node._parent_ID = rootNodeID;
+							node._index_in_parent_node += child_index_bases[range_index];
+						}
+						else
+						{
+							node._parent_ID = offset_ID(node._parent_ID, node_base);
+						}
+						node._first_attribute_ID = offset_ID(node._first_attribute_ID, attribute_base);
+						node._first_child_ID = offset_ID(node._first_child_ID, node_base);
+						node._last_child_ID = offset_ID(node._last_child_ID, node_base);
+						node._next_sibling_ID = offset_ID(node._next_sibling_ID, node_base);
+						node._name_atom = atom_remap[node._name_atom];
+					}
+					for (size_t local_attribute_ID = 0; local_attribute_ID < range_XML._attributes.size(); ++local_attribute_ID)
+					{
+						Attribute& attribute = *::new (&_attributes[attribute_base + local_attribute_ID]) Attribute(range_XML._attributes[local_attribute_ID]);
+						attribute._XML = this;
+						attribute._ID += attribute_base;
+						attribute._node_ID += node_base;
+						attribute._name_atom = atom_remap[attribute._name_atom];
+					}
+					range_XML._nodes = std::vector<Node, NoInitAllocator<Node>>();
+					range_XML._attributes = std::vector<Attribute, NoInitAllocator<Attribute>>();
+				});
+
+			// Chains the root's children across ranges; the first node of every range after the first is a child of the root.
+			Node& root_node = _nodes[rootNodeID];
+			uint32 last_child_ID = root_node._last_child_ID;
+			for (uint32 range_index = 1; range_index < range_count; ++range_index)
+			{
+				const uint32 first_child_ID = node_bases[range_index];
+				if (last_child_ID == INVALID_ID)
+				{
+					root_node._first_child_ID = first_child_ID;
+				}
+				else
+				{
+					_nodes[last_child_ID]._next_sibling_ID = first_child_ID;
+				}
+				last_child_ID = node_bases[range_index] + rangeLastTopLevelNodeIDs[range_index];
+			}
+			root_node._last_child_ID = last_child_ID;
+			root_node._child_count = _nodes[last_child_ID]._index_in_parent_node + 1;
+		}
+		void report_error(const std::string& error) const { _error = error; __report_where(_at); }
+		void report_error(const std::string& error, const size_t at) const { _error = error; __report_where(at); }
+		void __report_where(const size_t at) const { _error += " at["; _error += std::to_string(at); _error += "] line["; _error += std::to_string(1 + std::count(_view.begin(), _view.begin() + (std::min)(at, _view.length()), '\n')); _error += "]"; }
+
+	private:
+		std::string _text; // Owned copy, used only by parse()
+		std::string_view _view;
+		std::vector<Node, NoInitAllocator<Node>> _nodes;
+		std::vector<Attribute, NoInitAllocator<Attribute>> _attributes;
+		std::vector<std::string_view> _atomNames; // Views into the parsed text
+		std::unordered_map<std::string_view, uint32> _atomMap;
+		mutable std::string _error;
+		std::vector<uint32> _structurals; // Positions of structural characters, in order
+		size_t _structuralCursor = 0;
+		size_t _at = 0;
+		uint32 _end = 0; // Parsing stops here; the text length except for the ranges of parse_borrowed_parallel()
+
+	private:
+		const Node INVALID_NODE;
+		const Attribute INVALID_ATTRIBUTE;
+	};
+
+	// Incremental XML reader. The document is fed in chunks of any size, and the handler gets start, attribute and end
+	// events as soon as each tag is complete. Names and values are views into the current chunk, or into a copy of a tag
+	// cut by a chunk boundary, and are only valid during the callback. Memory is bounded by the longest tag.
+	// Tags starting with '?' or '!' are skipped; text content is ignored, as in XML.
+	class XMLStreamReader
+	{
+	public:
+		enum class EventType
+		{
+			StartElement,
+			Attribute,
+			EndElement,
+		};
+		struct Event
+		{
+			EventType _type = EventType::StartElement;
+			std::string_view _name;
+			std::string_view _value; // Attribute only
+			uint32 _depth = 0; // Of the element, for all three event types
+		};
+		// Returns false to stop reading.
+		using EventHandler = std::function<bool(const Event& event)>;
+		static constexpr uint32 kMaxTagLength = 1 << 20;
+
+	public:
+		void begin(const EventHandler& eventHandler);
+		// Returns false on an error or when the handler stopped reading.
+		bool feed(const std::string_view chunk);
+		// Checks that the document ended outside a tag with every element closed.
+		bool finish();
+
+	public:
+		const std::string& get_error() const { return _error; }
+		uint64 get_consumed_byte_count() const { return _consumedByteCount; }
+
+	private:
+		enum class State
+		{
+			Text,
+			Tag,
+			Quote,
+		};
+
+	private:
+		bool process_tag(const std::string_view tag, const uint64 tagOffset);
+		bool emit(const EventType type, const std::string_view name, const std::string_view value);
+		bool report_error(const char* const error, const uint64 at);
+
+	private:
+		EventHandler _eventHandler;
+		State _state = State::Text;
+		std::string _pendingTag;
+		uint64 _pendingTagOffset = 0;
+		std::vector<uint64> _openNameHashes;
+		uint64 _consumedByteCount = 0;
+		std::string _error;
+		bool _is_stopped = false;
+	};
 
-		_inputTotalByteSize += compute_InputElement_byte_size(inputElementDesc);
+	// Feeds file_name to reader while a second thread reads the next chunks, so parsing overlaps with disk reads.
+	// Only a few chunks of chunkByteSize are in memory at any time.
+	bool read_XML_stream(const std::string& file_name, XMLStreamReader& reader, const uint32 chunkByteSize = 1 << 20);
+
+	void XMLStreamReader::begin(const EventHandler& eventHandler)
+	{
+		_eventHandler = eventHandler;
+		_state = State::Text;
+		_pendingTag.clear();
+		_pendingTagOffset = 0;
+		_openNameHashes.clear();
+		_consumedByteCount = 0;
+		_error.clear();
+		_is_stopped = false;
 	}
 
-	bool ShaderInputLayout::create(Renderer& renderer, const Shader& vertexShader)
+	bool XMLStreamReader::feed(const std::string_view chunk)
 	{
-		if (_inputElements.empty())
+		if (_error.empty() == false || _is_stopped == true)
 		{
-			MINT_LOG_ERROR("Push input elements before creating ShaderInputLayout!");
 			return false;
 		}
 
-		if (FAILED(renderer.get_device()->CreateInputLayout(&_inputElements[0], static_cast<UINT>(_inputElements.size()),
-			vertexShader._shaderBlob->GetBufferPointer(), vertexShader._shaderBlob->GetBufferSize(), _inputLayout.ReleaseAndGetAddressOf())))
+		const char* const chunkBegin = chunk.data();
+		const size_t length = chunk.length();
+		// A tag that started in an earlier chunk continues in _pendingTag until its '>'.
+		bool is_tag_in_chunk = false;
+		size_t tagBegin = 0;
+		size_t at = 0;
+		while (at < length)
 		{
-			MINT_LOG_ERROR("Failed to create ShaderInputLayout");
-			return false;
+			if (_state == State::Text)
+			{
+				const void* const found = ::memchr(chunkBegin + at, '<', length - at);
+				if (found == nullptr)
+				{
+					at = length;
+					break;
+				}
+				at = static_cast<const char*>(found) - chunkBegin + 1;
+				tagBegin = at;
+				is_tag_in_chunk = true;
+				_state = State::Tag;
+			}
+			else if (_state == State::Quote)
+			{
+				const void* const found = ::memchr(chunkBegin + at, '\"', length - at);
+				if (found == nullptr)
+				{
+					at = length;
+					break;
+				}
+				at = static_cast<const char*>(found) - chunkBegin + 1;
+				_state = State::Tag;
+			}
+			else
+			{
+				while (at < length && chunk[at] != '>' && chunk[at] != '\"')
+				{
+					++at;
+				}
+				if (at == length)
+				{
+					break;
+				}
+				if (chunk[at] == '\"')
+				{
+					++at;
+					_state = State::Quote;
+					continue;
+				}
+
+				std::string_view tag;
+				uint64 tagOffset = 0;
+				if (is_tag_in_chunk == true)
+				{
+					tag = chunk.substr(tagBegin, at - tagBegin);
+					tagOffset = _consumedByteCount + tagBegin;
+				}
+				else
+				{
+					_pendingTag.append(chunkBegin, at);
+					tag = _pendingTag;
+					tagOffset = _pendingTagOffset;
+				}
+				++at;
+				_state = State::Text;
+				if (process_tag(tag, tagOffset) == false)
+				{
+					return false;
+				}
+			}
+		}
+
+		if (_state != State::Text)
+		{
+			if (is_tag_in_chunk == true)
+			{
+				_pendingTag.assign(chunkBegin + tagBegin, length - tagBegin);
+				_pendingTagOffset = _consumedByteCount + tagBegin;
+			}
+			else
+			{
+				_pendingTag.append(chunkBegin, length);
+			}
+			if (_pendingTag.length() > kMaxTagLength)
+			{
+				return report_error("tag is too long!", _pendingTagOffset);
+			}
 		}
+		_consumedByteCount += length;
 		return true;
 	}
 
-	bool Shader::create(Renderer& renderer, const char* sourceCode, const ShaderType& shaderType, const char* shaderIdentifier, const char* entryPoint, const char* target, ShaderHeaderSet* const shaderHeaderSet)
+	bool XMLStreamReader::finish()
 	{
-		if (sourceCode == nullptr)
+		if (_error.empty() == false || _is_stopped == true)
 		{
-			MINT_LOG_ERROR("Must exist source code!");
 			return false;
 		}
+		if (_state != State::Text)
+		{
+			return report_error("'>' is missing.", _pendingTagOffset);
+		}
+		if (_openNameHashes.empty() == false)
+		{
+			return report_error("element is not closed!", _consumedByteCount);
+		}
+		return true;
+	}
 
-		if (entryPoint == nullptr)
+	bool XMLStreamReader::process_tag(const std::string_view tag, const uint64 tagOffset)
+	{
+		const auto is_whitespace = [](const char ch) { return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r'; };
+		if (tag.empty() == true)
 		{
-			MINT_LOG_ERROR("Must specify entry point!");
-			return false;
+			return report_error("empty tag!", tagOffset);
+		}
+		// The same limit as for a tag cut by a chunk boundary, so the result does not depend on the chunk size.
+		if (tag.length() > kMaxTagLength)
+		{
+			return report_error("tag is too long!", tagOffset);
+		}
+		if (tag[0] == '?' || tag[0] == '!')
+		{
+			return true;
 		}
 
-		if (target == nullptr)
+		if (tag[0] == '/')
 		{
-			MINT_LOG_ERROR("Must specify target!");
-			return false;
+			size_t nameEnd = 1;
+			while (nameEnd < tag.length() && is_whitespace(tag[nameEnd]) == false)
+			{
+				++nameEnd;
+			}
+			const std::string_view name = tag.substr(1, nameEnd - 1);
+			if (_openNameHashes.empty() == true)
+			{
+				return report_error("closing tag without an open element!", tagOffset);
+			}
+			if (_openNameHashes.back() != compute_hash_FNV1a(name.data(), name.length()))
+			{
+				return report_error("closing tag does not match the open element!", tagOffset);
+			}
+			_openNameHashes.pop_back();
+			return emit(EventType::EndElement, name, std::string_view());
 		}
 
-		_type = shaderType;
+		size_t tagEnd = tag.length();
+		while (tagEnd > 0 && is_whitespace(tag[tagEnd - 1]) == true)
+		{
+			--tagEnd;
+		}
+		const bool is_self_closing = (tagEnd > 0 && tag[tagEnd - 1] == '/');
+		if (is_self_closing == true)
+		{
+			--tagEnd;
+		}
 
-		const UINT debugFlag = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
-		HRESULT result = D3DCompile(sourceCode, ::strlen(sourceCode), shaderIdentifier, nullptr, shaderHeaderSet, entryPoint, target, debugFlag, 0, _shaderBlob.ReleaseAndGetAddressOf(), _errorMessageBlob.ReleaseAndGetAddressOf());
-		if (FAILED(result))
+		size_t at = 0;
+		while (at < tagEnd && is_whitespace(tag[at]) == false)
+		{
+			++at;
+		}
+		const std::string_view name = tag.substr(0, at);
+		if (name.empty() == true)
+		{
+			return report_error("element name is missing!", tagOffset);
+		}
+		if (emit(EventType::StartElement, name, std::string_view()) == false)
 		{
-			std::string errorMessages(reinterpret_cast<char*>(_errorMessageBlob->GetBufferPointer()));
-			MINT_LOG_ERROR("Shader compile failed.");
 			return false;
 		}
 
-		if (shaderType == ShaderType::VertexShader)
+		while (at < tagEnd)
 		{
-			if (FAILED(renderer.get_device()->CreateVertexShader(_shaderBlob->GetBufferPointer(), _shaderBlob->GetBufferSize(), NULL, reinterpret_cast<ID3D11VertexShader**>(_shader.ReleaseAndGetAddressOf()))))
+			if (is_whitespace(tag[at]) == true)
 			{
-				return false;
+				++at;
+				continue;
 			}
-			return true;
-		}
-		else if (shaderType == ShaderType::PixelShader)
-		{
-			if (FAILED(renderer.get_device()->CreatePixelShader(_shaderBlob->GetBufferPointer(), _shaderBlob->GetBufferSize(), NULL, reinterpret_cast<ID3D11PixelShader**>(_shader.ReleaseAndGetAddressOf()))))
+
+			const size_t attributeNameAt = at;
+			while (at < tagEnd && tag[at] != '=')
+			{
+				++at;
+			}
+			if (at + 1 >= tagEnd || tag[at + 1] != '\"')
+			{
+				return report_error("invalid attribute! '=\"' is needed.", tagOffset + at);
+			}
+			const std::string_view attributeName = tag.substr(attributeNameAt, at - attributeNameAt);
+			const size_t valueAt = at + 2;
+			const size_t valueEnd = tag.find('\"', valueAt);
+			if (valueEnd == std::string_view::npos || valueEnd > tagEnd)
+			{
+				return report_error("closing '\"' is missing.", tagOffset + valueAt);
+			}
+			if (emit(EventType::Attribute, attributeName, tag.substr(valueAt, valueEnd - valueAt)) == false)
 			{
 				return false;
 			}
+			at = valueEnd + 1;
+		}
+
+		if (is_self_closing == true)
+		{
+			return emit(EventType::EndElement, name, std::string_view());
+		}
+		_openNameHashes.push_back(compute_hash_FNV1a(name.data(), name.length()));
+		return true;
+	}
+
+	bool XMLStreamReader::emit(const EventType type, const std::string_view name, const std::string_view value)
+	{
+		if (_eventHandler == nullptr)
+		{
 			return true;
 		}
+
+		Event event;
+		event._type = type;
+		event._name = name;
+		event._value = value;
+		// Start and end events are emitted while the element is not on the open stack.
+		event._depth = static_cast<uint32>(_openNameHashes.size());
+		if (_eventHandler(event) == false)
+		{
+			_is_stopped = true;
+			return false;
+		}
+		return true;
+	}
+
+	bool XMLStreamReader::report_error(const char* const error, const uint64 at)
+	{
+		_error = error;
+		_error += " at[";
+		_error += std::to_string(at);
+		_error += "]";
 		return false;
 	}
 
-	bool Resource::create_texture2D(Renderer& renderer, const TextureFormat& format, const void* const resourceContent, const uint32 width, const uint32 height)
+	bool read_XML_stream(const std::string& file_name, XMLStreamReader& reader, const uint32 chunkByteSize)
 	{
-		ComPtr<ID3D11Resource> newResource;
-		D3D11_TEXTURE2D_DESC texture2DDescriptor{};
-		texture2DDescriptor.Width = width;
-		texture2DDescriptor.Height = height;
-		texture2DDescriptor.MipLevels = 1;
-		texture2DDescriptor.ArraySize = 1;
-		texture2DDescriptor.Format = __convert_to_DXGI_FORMAT(format);
-		texture2DDescriptor.SampleDesc.Count = 1;
-		texture2DDescriptor.Usage = D3D11_USAGE::D3D11_USAGE_DEFAULT;
-		texture2DDescriptor.BindFlags = D3D11_BIND_FLAG::D3D11_BIND_SHADER_RESOURCE;
-		texture2DDescriptor.CPUAccessFlags = 0;
-		const uint32 elementStride = __compute_element_stride(format);
-		D3D11_SUBRESOURCE_DATA subResource{};
-		subResource.pSysMem = resourceContent;
-		subResource.SysMemPitch = texture2DDescriptor.Width * elementStride;
-		subResource.SysMemSlicePitch = 0;
-		if (SUCCEEDED(renderer.get_device()->CreateTexture2D(&texture2DDescriptor, &subResource, reinterpret_cast<ID3D11Texture2D**>(newResource.ReleaseAndGetAddressOf()))))
+		std::ifstream ifs;
+		ifs.open(file_name, std::ios_base::binary);
+		if (ifs.is_open() == false)
 		{
-			D3D11_SHADER_RESOURCE_VIEW_DESC shaderResourceViewDescriptor{};
-			shaderResourceViewDescriptor.Format = texture2DDescriptor.Format;
-			shaderResourceViewDescriptor.ViewDimension = D3D11_SRV_DIMENSION::D3D11_SRV_DIMENSION_TEXTURE2D;
-			shaderResourceViewDescriptor.Texture2D.MipLevels = texture2DDescriptor.MipLevels;
-			shaderResourceViewDescriptor.Texture2D.MostDetailedMip = 0;
-			if (SUCCEEDED(renderer.get_device()->CreateShaderResourceView(newResource.Get(), &shaderResourceViewDescriptor, reinterpret_cast<ID3D11ShaderResourceView**>(_view.ReleaseAndGetAddressOf()))))
+			return false;
+		}
+
+		constexpr uint32 kChunkCount = 4;
+		struct Chunk
+		{
+			std::vector<char> _bytes;
+			uint32 _byteCount = 0;
+		};
+		Chunk chunks[kChunkCount];
+		SpscQueue<Chunk*, kChunkCount> freeChunks;
+		SpscQueue<Chunk*, kChunkCount> filledChunks;
+		for (Chunk& chunk : chunks)
+		{
+			chunk._bytes.resize(chunkByteSize);
+			freeChunks.push(&chunk);
+		}
+
+		std::atomic<bool> is_reading_done{ false };
+		std::atomic<bool> is_cancelled{ false };
+		std::thread readThread([&]()
 			{
-				_type = ResourceType::Teture2D;
-				_format = format;
+				for (uint32 spinCount = 0; is_cancelled.load(std::memory_order_acquire) == false;)
+				{
+					Chunk* chunk = nullptr;
+					if (freeChunks.pop(chunk) == false)
+					{
+						wait_with_backoff(spinCount++);
+						continue;
+					}
+					spinCount = 0;
 
-				_elementStride = elementStride;
-				_elementMaxCount = texture2DDescriptor.Width * texture2DDescriptor.Height;
-				//_resourceCapacity = _elementStride * _elementMaxCount;
+					ifs.read(chunk->_bytes.data(), chunkByteSize);
+					chunk->_byteCount = static_cast<uint32>(ifs.gcount());
+					filledChunks.push(chunk);
+					if (chunk->_byteCount < chunkByteSize)
+					{
+						break;
+					}
+				}
+				is_reading_done.store(true, std::memory_order_release);
+			});
 
-				_width = width;
-				//_height = _width / _elementMaxCount;
+		bool result = true;
+		for (uint32 spinCount = 0;;)
+		{
+			Chunk* chunk = nullptr;
+			if (filledChunks.pop(chunk) == false)
+			{
+				// The last chunk may have been pushed between the pop above and this check.
+				if (is_reading_done.load(std::memory_order_acquire) == true && filledChunks.pop(chunk) == false)
+				{
+					break;
+				}
+				if (chunk == nullptr)
+				{
+					wait_with_backoff(spinCount++);
+					continue;
+				}
+			}
+			spinCount = 0;
+
+			if (reader.feed(std::string_view(chunk->_bytes.data(), chunk->_byteCount)) == false)
+			{
+				result = false;
+				break;
+			}
+			freeChunks.push(chunk);
+		}
+		is_cancelled.store(true, std::memory_order_release);
+		readThread.join();
+		return (result == true && reader.finish() == true);
+	}
+
+	// Read-only view of a whole file through the virtual memory system; pages are read on first access.
+	class MappedFile
+	{
+	public:
+		MappedFile() = default;
+		MappedFile(const MappedFile&) = delete;
+		MappedFile(MappedFile&& rhs) noexcept { *this = std::move(rhs); }
+		MappedFile& operator=(const MappedFile&) = delete;
+		MappedFile& operator=(MappedFile&& rhs) noexcept;
+		~MappedFile() { close(); }
+
+	public:
+		bool open(const std::string& file_name);
+		void close();
+		// Faults every page in now, e.g. on a loader thread, instead of on first access.
+		void prefetch() const;
+
+	public:
+		bool is_open() const { return _is_open; }
+		const byte* get_data() const { return _data; }
+		size_t get_byte_size() const { return _byteSize; }
+		std::string_view get_view() const { return std::string_view(reinterpret_cast<const char*>(_data), _byteSize); }
+
+	private:
+		const byte* _data = nullptr;
+		size_t _byteSize = 0;
+		bool _is_open = false;
+#if defined(_WIN32)
+		HANDLE _file = INVALID_HANDLE_VALUE;
+		HANDLE _mapping = nullptr;
+#endif
+	};
+
+	// Compiled form of a shapes XML document, little-endian, used in place after BinaryScene::bind() validated it.
+	// Layout: BinarySceneHeader, BinarySceneShape[_shapeCount], float pointXs[_pointCount], float pointYs[_pointCount],
+	// char names[_namesByteSize]. Every array starts on a kBinarySceneAlignment boundary.
+	constexpr uint32 kBinarySceneAlignment = 16;
+	struct BinarySceneHeader
+	{
+		static constexpr uint32 kMagic = 0x53425253; // "SRBS"
+		static constexpr uint32 kVersion = 1;
+
+		uint32 _magic = kMagic;
+		uint32 _version = kVersion;
+		uint64 _byteSize = 0;
+		uint32 _shapeCount = 0;
+		uint32 _pointCount = 0;
+		uint32 _namesByteSize = 0;
+		uint32 _shapesOffset = 0;
+		uint32 _pointXsOffset = 0;
+		uint32 _pointYsOffset = 0;
+		uint32 _namesOffset = 0;
+		uint32 _reserved = 0;
+	};
+	static_assert(sizeof(BinarySceneHeader) == 48, "BinarySceneHeader is part of the file format!");
+
+	struct BinarySceneShape
+	{
+		float2 _center;
+		uint32 _firstPoint = 0;
+		uint32 _pointCount = 0;
+		uint32 _nameOffset = 0;
+		uint32 _nameLength = 0;
+	};
+	static_assert(sizeof(BinarySceneShape) == 24, "BinarySceneShape is part of the file format!");
+
+	class BinaryScene
+	{
+	public:
+		// Validates the blob and uses it in place, so data must outlive this BinaryScene.
+		bool bind(const void* const data, const size_t byteSize);
+		// Maps the file and binds it.
+		bool load(const std::string& file_name);
+
+	public:
+		uint32 get_shape_count() const { return (_header == nullptr ? 0 : _header->_shapeCount); }
+		const BinarySceneShape& get_shape(const uint32 index) const { return _shapes[index]; }
+		std::string_view get_shape_name(const uint32 index) const { return std::string_view(_names + _shapes[index]._nameOffset, _shapes[index]._nameLength); }
+		// Structure of arrays: the points of shape i are [_firstPoint, _firstPoint + _pointCount) in both arrays.
+		const float* get_point_xs() const { return _pointXs; }
+		const float* get_point_ys() const { return _pointYs; }
+		float2 get_point(const uint32 index) const { return float2(_pointXs[index], _pointYs[index]); }
+		const std::string& get_error() const { return _error; }
+
+	public:
+		// Returns UINT32_MAX if there is no shape with the name.
+		uint32 find_shape(const std::string_view& name) const;
+		// Hashes the center and points of a shape, so a reloaded scene can tell which shapes actually changed.
+		uint64 compute_shape_hash(const uint32 index) const;
+
+	private:
+		bool report_error(const char* const error) { _error = error; _header = nullptr; return false; }
+
+	private:
+		MappedFile _mappedFile;
+		const BinarySceneHeader* _header = nullptr;
+		const BinarySceneShape* _shapes = nullptr;
+		const float* _pointXs = nullptr;
+		const float* _pointYs = nullptr;
+		const char* _names = nullptr;
+		std::string _error;
+	};
+
+	// Compiles <root><shape name=""><center x="" y=""/><points><point x="" y=""/>...</points></shape>...</root>.
+	bool compile_BinaryScene(const XML& xml, std::vector<byte>& outBlob);
+	bool compile_BinaryScene_file(const std::string& xml_file_name, const std::string& binary_file_name);
+
+	// LZ77 block codec in the spirit of LZ4: byte-aligned literal/match sequences and no entropy coding, so decoding runs near memory speed.
+	// Each sequence is a token (literal count << 4 | match length - kLZMinMatchLength, 15 meaning "more length bytes follow"), the literals,
+	// then a 16-bit little-endian offset and the extra match length bytes. The last sequence carries literals only.
+	constexpr uint32 kLZMinMatchLength = 4;
+	inline size_t get_LZ_compress_bound(const size_t byteSize) { return byteSize + byteSize / 255 + 16; }
+	// destination must hold get_LZ_compress_bound(sourceByteSize) bytes. Returns the compressed byte size.
+	size_t compress_LZ(const byte* const source, const size_t sourceByteSize, byte* const destination);
+	// Fails on malformed input instead of reading or writing out of bounds; destinationByteSize must be the exact decompressed size.
+	bool decompress_LZ(const byte* const source, const size_t sourceByteSize, byte* const destination, const size_t destinationByteSize);
+
+	// Pack file: AssetPackHeader, AssetPackEntry[_assetCount] sorted by name hash, AssetPackChunk[_chunkCount], names, then chunk data.
+	// Assets are split into chunks of at most _chunkByteSize bytes that are compressed independently, so one asset can be read
+	// without touching the others and its chunks can be decompressed in parallel. Chunks that do not shrink are stored raw.
+	struct AssetPackHeader
+	{
+		static constexpr uint32 kMagic = 0x50415253; // "SRAP"
+		static constexpr uint32 kVersion = 1;
+
+		uint32 _magic = kMagic;
+		uint32 _version = kVersion;
+		uint64 _byteSize = 0;
+		uint32 _assetCount = 0;
+		uint32 _chunkCount = 0;
+		uint32 _chunkByteSize = 0;
+		uint32 _namesByteSize = 0;
+		uint32 _assetsOffset = 0;
+		uint32 _chunksOffset = 0;
+		uint32 _namesOffset = 0;
+		uint32 _reserved = 0;
+	};
+	static_assert(sizeof(AssetPackHeader) == 48, "AssetPackHeader is part of the file format!");
+
+	struct AssetPackEntry
+	{
+		uint64 _nameHash = 0;
+		uint64 _byteSize = 0;
+		uint32 _nameOffset = 0;
+		uint32 _nameLength = 0;
+		uint32 _firstChunk = 0;
+		uint32 _chunkCount = 0;
+	};
+	static_assert(sizeof(AssetPackEntry) == 32, "AssetPackEntry is part of the file format!");
+
+	struct AssetPackChunk
+	{
+		uint64 _offset = 0;
+		uint32 _storedByteSize = 0; // == _byteSize when stored raw.
+		uint32 _byteSize = 0;
+	};
+	static_assert(sizeof(AssetPackChunk) == 16, "AssetPackChunk is part of the file format!");
+
+	class AssetPackBuilder
+	{
+	public:
+		explicit AssetPackBuilder(const uint32 chunkByteSize = 1 << 16) : _chunkByteSize{ chunkByteSize } { __noop; }
+
+	public:
+		// Uncompressed assets can be viewed in place through AssetPack::get_view().
+		void add(const std::string_view name, const void* const data, const size_t byteSize, const bool compress = true);
+		bool add_file(const std::string_view name, const std::string& file_name, const bool compress = true);
+		// Compresses all chunks in parallel and writes the pack.
+		bool write(const std::string& file_name) const;
+
+	private:
+		struct Asset
+		{
+			std::string _name;
+			std::vector<byte> _data;
+			bool _is_compressed = true;
+		};
+
+	private:
+		uint32 _chunkByteSize;
+		std::vector<Asset> _assets;
+	};
+
+	class AssetPack
+	{
+	public:
+		static constexpr uint32 kInvalidIndex = UINT32_MAX;
+
+	public:
+		// Maps the pack and validates its table of contents. Chunk data is only touched when an asset is read.
+		bool open(const std::string& file_name);
+		void close();
+
+	public:
+		uint32 get_asset_count() const { return (_header == nullptr ? 0 : _header->_assetCount); }
+		uint32 find(const std::string_view name) const;
+		std::string_view get_asset_name(const uint32 index) const { return std::string_view(_names + _entries[index]._nameOffset, _entries[index]._nameLength); }
+		uint64 get_asset_byte_size(const uint32 index) const { return _entries[index]._byteSize; }
+		// Zero-copy access into the mapping; fails when any chunk of the asset is compressed.
+		bool get_view(const uint32 index, std::string_view& outView) const;
+		// Copies raw chunks and decompresses the others on all hardware threads.
+		bool read(const uint32 index, std::vector<byte>& outData) const;
+		bool read(const uint32 index, std::string& outData) const;
+		const std::string& get_error() const { return _error; }
+
+	private:
+		bool read(const uint32 index, byte* const destination) const;
+		bool report_error(const char* const error) { _error = error; _header = nullptr; return false; }
+
+	private:
+		MappedFile _mappedFile;
+		const AssetPackHeader* _header = nullptr;
+		const AssetPackEntry* _entries = nullptr;
+		const AssetPackChunk* _chunks = nullptr;
+		const char* _names = nullptr;
+		std::string _error;
+	};
+
+	// Loads files on worker threads and hands the results back on the thread that calls dispatch_completions(), so a frame
+	// never waits on the disk.
+	class FileLoadQueue
+	{
+	public:
+		struct LoadResult
+		{
+			std::string _fileName;
+			MappedFile _file;
+			bool _is_succeeded = false;
+		};
+		using Work = std::function<void()>;
+		using Completion = std::function<void()>;
+		using LoadCompletion = std::function<void(LoadResult& result)>;
+
+	public:
+		explicit FileLoadQueue(const uint32 workerCount = 2);
+		FileLoadQueue(const FileLoadQueue&) = delete;
+		~FileLoadQueue();
+
+	public:
+		// e.g. Renderer::invalidate, so an on-demand loop that is blocked wakes up to dispatch. Called on worker threads; set it before submitting.
+		void set_completion_notifier(const std::function<void()>& notifier) { _completionNotifier = notifier; }
+		// work runs on a worker thread, then completion runs inside dispatch_completions().
+		void submit(Work work, Completion completion);
+		// Maps the file and faults its pages in on a worker thread.
+		void load(const std::string& file_name, LoadCompletion completion);
+		// Runs every completion that is ready. Returns how many ran.
+		uint32 dispatch_completions();
+		uint32 get_pending_count() const { return _pendingCount.load(std::memory_order_acquire); }
+
+	private:
+		struct Job
+		{
+			Work _work;
+			Completion _completion;
+		};
+
+	private:
+		void run_worker();
+
+	private:
+		std::vector<std::thread> _workers;
+		std::mutex _jobMutex;
+		std::condition_variable _jobCondition;
+		std::deque<Job> _jobs;
+		bool _is_stopping = false;
+		std::mutex _completionMutex;
+		std::vector<Completion> _completions;
+		std::vector<Completion> _dispatchingCompletions;
+		std::function<void()> _completionNotifier;
+		std::atomic<uint32> _pendingCount{ 0 };
+	};
+
+	// Reports watched files whose write time or size changed. A thread sleeps on the OS change notification of their
+	// directories (inotify on Linux, FindFirstChangeNotification on Windows) and only then compares the watched files,
+	// falling back to comparing them periodically if notifications are unavailable.
+	class FileWatcher
+	{
+	public:
+		FileWatcher() = default;
+		FileWatcher(const FileWatcher&) = delete;
+		~FileWatcher() { stop(); }
+
+	public:
+		// Files may not exist yet; creating one counts as a change. Call before start().
+		void watch(const std::string& file_name);
+		// notifier runs on the watcher thread after changes are found, e.g. Renderer::invalidate.
+		bool start(const std::function<void()>& notifier = nullptr);
+		void stop();
+		// Returns false if nothing changed since the last call.
+		bool poll_changes(std::vector<std::string>& outChangedFileNames);
+
+	private:
+		struct WatchedFile
+		{
+			std::string _fileName;
+			std::filesystem::file_time_type _lastWriteTime;
+			uintmax_t _byteSize = 0;
+		};
 
-				std::swap(_resource, newResource);
-				return true;
-			}
-		}
-		return false;
-	}
+	private:
+		static void read_stamp(const std::string& file_name, std::filesystem::file_time_type& outLastWriteTime, uintmax_t& outByteSize);
+		void check_files();
+		void run_watch_thread();
+
+	private:
+		std::vector<WatchedFile> _watchedFiles;
+		std::function<void()> _notifier;
+		std::thread _thread;
+		std::atomic<bool> _is_running{ false };
+		std::mutex _changeMutex;
+		std::vector<std::string> _changedFileNames;
+#if defined(_WIN32)
+		std::vector<HANDLE> _changeHandles;
+#else
+		int _inotify = -1;
+#endif
+	};
 
-	bool Resource::create_buffer(Renderer& renderer, const ResourceType& type, const void* const content, const uint32 elementStride, const uint32 elementCount)
+#if defined(_WIN32)
+	// Recompiles shaders when their source files change. Reading and compiling run on a FileLoadQueue worker, a file that
+	// did not really change is skipped by its content hash, and a failed compile keeps the live shader.
+	// The input signature of a vertex shader must not change, since its ShaderInputLayout is kept.
+	class ShaderReloader
 	{
-		if (type == ResourceType::Teture2D)
-		{
-			MINT_ASSERT(false, "Use create_texture2D() instead!");
-			return false;
-		}
+	public:
+		void push(Shader& shader, const std::string& file_name, const ShaderType& shaderType, const char* shaderIdentifier, const char* entryPoint, const char* target, const ShaderHeaderSet* const shaderHeaderSet = nullptr);
+		// beforeSwap runs on the dispatching thread right before a compiled shader replaces a live one, e.g. to wait for
+		// the render thread. Returns how many shaders use file_name.
+		uint32 reload(Renderer& renderer, FileLoadQueue& fileLoadQueue, const std::string& file_name, const std::function<void()>& beforeSwap);
 
-		ComPtr<ID3D11Resource> newResource;
-		D3D11_BUFFER_DESC bufferDescriptor{};
-		bufferDescriptor.Usage = D3D11_USAGE::D3D11_USAGE_DYNAMIC;
-		bufferDescriptor.ByteWidth = elementStride * elementCount;
-		bufferDescriptor.BindFlags = D3D11_BIND_FLAG(1 << (uint32)type); // !!! CAUTION !!!
-		bufferDescriptor.CPUAccessFlags = D3D11_CPU_ACCESS_FLAG::D3D11_CPU_ACCESS_WRITE;
-		bufferDescriptor.MiscFlags = 0;
-		bufferDescriptor.StructureByteStride = 0;
-		D3D11_SUBRESOURCE_DATA subresourceData{};
-		subresourceData.pSysMem = content;
-		if (SUCCEEDED(renderer.get_device()->CreateBuffer(&bufferDescriptor, (content != nullptr) ? &subresourceData : nullptr, reinterpret_cast<ID3D11Buffer**>(newResource.ReleaseAndGetAddressOf()))))
+	private:
+		struct Entry
 		{
-			_type = type;
-			_byteSize = bufferDescriptor.ByteWidth;
-			_elementStride = elementStride;
-			_elementMaxCount = elementCount;
+			Shader* _shader = nullptr;
+			std::string _fileName;
+			ShaderType _shaderType = ShaderType::VertexShader;
+			std::string _identifier;
+			std::string _entryPoint;
+			std::string _target;
+			const ShaderHeaderSet* _shaderHeaderSet = nullptr;
+			uint64 _sourceHash = 0;
+			uint32 _generation = 0; // Only the latest reload of an entry is applied.
+		};
 
-			std::swap(_resource, newResource);
-			return true;
-		}
-		return false;
-	}
+	private:
+		std::vector<Entry> _entries;
+	};
+#endif
 
-	bool Resource::update(Renderer& renderer, const void* const content, const uint32 elementStride, const uint32 elementCount)
+	bool MappedFile::open(const std::string& file_name)
 	{
-		if (elementCount > _elementMaxCount)
+		close();
+
+#if defined(_WIN32)
+		_file = ::CreateFileA(file_name.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (_file == INVALID_HANDLE_VALUE)
 		{
-			return create_buffer(renderer, _type, content, elementStride, elementCount);
+			return false;
 		}
-
-		class SafeResourceMapper
+		LARGE_INTEGER fileSize{};
+		if (::GetFileSizeEx(_file, &fileSize) == FALSE)
 		{
-		public:
-			SafeResourceMapper(Renderer& renderer, ID3D11Resource* const resource, const uint32 subresource)
-				: _renderer{ renderer }
-				, _resource{ resource }
-				, _subresource{ subresource }
-				, _mappedSubresource{}
-			{
-				if (FAILED(_renderer.get_device_context()->Map(_resource, _subresource, D3D11_MAP::D3D11_MAP_WRITE_DISCARD, 0, &_mappedSubresource)))
-				{
-					_mappedSubresource.pData = nullptr;
-					_mappedSubresource.DepthPitch = 0;
-					_mappedSubresource.RowPitch = 0;
-				}
-			}
-			~SafeResourceMapper()
+			close();
+			return false;
+		}
+		_byteSize = static_cast<size_t>(fileSize.QuadPart);
+		if (_byteSize > 0)
+		{
+			_mapping = ::CreateFileMappingA(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (_mapping == nullptr)
 			{
-				if (isValid() == true)
-				{
-					_renderer.get_device_context()->Unmap(_resource, _subresource);
-				}
+				close();
+				return false;
 			}
-			bool isValid() const noexcept
+			_data = static_cast<const byte*>(::MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+			if (_data == nullptr)
 			{
-				return _mappedSubresource.pData != nullptr;
+				close();
+				return false;
 			}
-			void set(const void* const data, const uint32 size) noexcept
+		}
+#else
+		const int file = ::open(file_name.c_str(), O_RDONLY);
+		if (file < 0)
+		{
+			return false;
+		}
+		struct stat fileStat {};
+		if (::fstat(file, &fileStat) != 0)
+		{
+			::close(file);
+			return false;
+		}
+		_byteSize = static_cast<size_t>(fileStat.st_size);
+		if (_byteSize > 0)
+		{
+			void* const mapped = ::mmap(nullptr, _byteSize, PROT_READ, MAP_PRIVATE, file, 0);
+			if (mapped == MAP_FAILED)
 			{
-				::memcpy(_mappedSubresource.pData, data, size);
+				::close(file);
+				_byteSize = 0;
+				return false;
 			}
-
-		private:
-			Renderer& _renderer;
-			ID3D11Resource* const _resource;
-			const uint32 _subresource;
-			D3D11_MAPPED_SUBRESOURCE _mappedSubresource;
-		};
-
-		SafeResourceMapper safeResourceMapper(renderer, _resource.Get(), 0);
-		if (safeResourceMapper.isValid())
-		{
-			safeResourceMapper.set(content, elementStride * elementCount);
-			return true;
+			_data = static_cast<const byte*>(mapped);
 		}
-		return false;
+		// The mapping keeps its own reference to the file.
+		::close(file);
+#endif
+		_is_open = true;
+		return true;
 	}
 
-	DXGI_FORMAT Resource::__convert_to_DXGI_FORMAT(const TextureFormat& format)
+	MappedFile& MappedFile::operator=(MappedFile&& rhs) noexcept
 	{
-		switch (format)
+		if (this != &rhs)
 		{
-		case TextureFormat::R8_UNORM:
-			return DXGI_FORMAT::DXGI_FORMAT_R8_UNORM;
-		case TextureFormat::R8G8B8A8_UNORM:
-			return DXGI_FORMAT::DXGI_FORMAT_R8G8B8A8_UNORM;
-		default:
-			break;
+			close();
+			std::swap(_data, rhs._data);
+			std::swap(_byteSize, rhs._byteSize);
+			std::swap(_is_open, rhs._is_open);
+#if defined(_WIN32)
+			std::swap(_file, rhs._file);
+			std::swap(_mapping, rhs._mapping);
+#endif
 		}
-		MINT_ASSERT(false, "This texture format is not supported yet!");
-		return DXGI_FORMAT::DXGI_FORMAT_R8G8B8A8_UNORM;
+		return *this;
 	}
 
-	uint32 Resource::__compute_element_stride(const TextureFormat& format)
+	void MappedFile::prefetch() const
 	{
-		switch (format)
+		if (_data == nullptr)
 		{
-		case TextureFormat::R8_UNORM:
-			return 1;
-		case TextureFormat::R8G8B8A8_UNORM:
-			return 4;
-		default:
-			break;
+			return;
+		}
+#if !defined(_WIN32)
+		::madvise(const_cast<byte*>(_data), _byteSize, MADV_WILLNEED);
+#endif
+		constexpr size_t kPageByteSize = 4096;
+		volatile byte sink = 0;
+		for (size_t at = 0; at < _byteSize; at += kPageByteSize)
+		{
+			sink = sink + _data[at];
 		}
-		MINT_ASSERT(false, "This texture format is not supported yet!");
-		return 4;
 	}
 
-	static LRESULT WINAPI windowProcedure(HWND hWnd, UINT Msg, WPARAM wParam, LPARAM lParam)
+	void MappedFile::close()
 	{
-		switch (Msg)
+#if defined(_WIN32)
+		if (_data != nullptr)
 		{
-		case WM_DESTROY:
-			::PostQuitMessage(0);
-			return 0;
+			::UnmapViewOfFile(_data);
 		}
-		return ::DefWindowProc(hWnd, Msg, wParam, lParam);
+		if (_mapping != nullptr)
+		{
+			::CloseHandle(_mapping);
+			_mapping = nullptr;
+		}
+		if (_file != INVALID_HANDLE_VALUE)
+		{
+			::CloseHandle(_file);
+			_file = INVALID_HANDLE_VALUE;
+		}
+#else
+		if (_data != nullptr)
+		{
+			::munmap(const_cast<byte*>(_data), _byteSize);
+		}
+#endif
+		_data = nullptr;
+		_byteSize = 0;
+		_is_open = false;
 	}
 
-	bool Renderer::is_running()
+	bool BinaryScene::bind(const void* const data, const size_t byteSize)
 	{
-		if (!_hWnd) return false;
-
-		_keyboardState.clear();
-		_mouseState.clear();
-
-		MSG msg{};
-		if (::PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE) == false) { return true; }
-		switch (msg.message)
+		_error.clear();
+		_header = nullptr;
+		const byte* const bytes = static_cast<const byte*>(data);
+		if (bytes == nullptr || byteSize < sizeof(BinarySceneHeader) || reinterpret_cast<uintptr_t>(bytes) % kBinarySceneAlignment != 0)
 		{
-		case WM_KEYUP:
-		{
-			if (msg.wParam == VK_RETURN)
-			{
-				_keyboardState._up_key = Key::Enter;
-			}
-			break;
+			return report_error("blob is too small or misaligned!");
 		}
-		case WM_CHAR:
-			_keyboardState._char = (char)msg.wParam;
-			break;
-		case WM_MOUSEMOVE:
+
+		const BinarySceneHeader* const header = reinterpret_cast<const BinarySceneHeader*>(bytes);
+		if (header->_magic != BinarySceneHeader::kMagic)
 		{
-			_mouseState.update_position(msg);
-			break;
+			return report_error("not a binary scene, or written with the other endianness!");
 		}
-		case WM_LBUTTONDOWN:
+		if (header->_version != BinarySceneHeader::kVersion)
 		{
-			_mouseState._is_L_button_pressed = true;
-			_mouseState._is_L_button_down = true;
-			_mouseState.update_position(msg);
-			_mouseState._L_pressed_position = _mouseState._position;
-			break;
+			return report_error("unsupported binary scene version!");
 		}
-		case WM_LBUTTONUP:
+		if (header->_byteSize != byteSize)
 		{
-			_mouseState._is_L_button_released = true;
-			_mouseState._is_L_button_down = false;
-			_mouseState.update_position(msg);
-			break;
+			return report_error("binary scene is truncated!");
 		}
-		case WM_RBUTTONUP:
+
+		// 64-bit arithmetic, so corrupted counts cannot overflow past the checks.
+		const auto is_array_valid = [&](const uint32 offset, const uint64 arrayByteSize)
+			{
+				return offset % kBinarySceneAlignment == 0 && offset >= sizeof(BinarySceneHeader) && uint64(offset) + arrayByteSize <= byteSize;
+			};
+		if (is_array_valid(header->_shapesOffset, uint64(header->_shapeCount) * sizeof(BinarySceneShape)) == false
+			|| is_array_valid(header->_pointXsOffset, uint64(header->_pointCount) * sizeof(float)) == false
+			|| is_array_valid(header->_pointYsOffset, uint64(header->_pointCount) * sizeof(float)) == false
+			|| is_array_valid(header->_namesOffset, header->_namesByteSize) == false)
 		{
-			_mouseState._is_R_button_released = true;
-			_mouseState.update_position(msg);
-			break;
+			return report_error("binary scene array is out of bounds!");
 		}
-		case WM_QUIT:
-			destroy_window();
-			return false;
-		default:
-			break;
+
+		const BinarySceneShape* const shapes = reinterpret_cast<const BinarySceneShape*>(bytes + header->_shapesOffset);
+		for (uint32 shapeIndex = 0; shapeIndex < header->_shapeCount; ++shapeIndex)
+		{
+			const BinarySceneShape& shape = shapes[shapeIndex];
+			if (uint64(shape._firstPoint) + shape._pointCount > header->_pointCount || uint64(shape._nameOffset) + shape._nameLength > header->_namesByteSize)
+			{
+				return report_error("binary scene shape is out of bounds!");
+			}
 		}
-		::DispatchMessage(&msg);
-		::TranslateMessage(&msg);
+
+		_header = header;
+		_shapes = shapes;
+		_pointXs = reinterpret_cast<const float*>(bytes + header->_pointXsOffset);
+		_pointYs = reinterpret_cast<const float*>(bytes + header->_pointYsOffset);
+		_names = reinterpret_cast<const char*>(bytes + header->_namesOffset);
 		return true;
 	}
 
-	void Renderer::bind_ShaderInputLayout(ShaderInputLayout& shaderInputLayout)
+	bool BinaryScene::load(const std::string& file_name)
 	{
-		_is_InputLayout_bound = true;
+		if (_mappedFile.open(file_name) == false)
+		{
+			return report_error("failed to map the file!");
+		}
+		return bind(_mappedFile.get_data(), _mappedFile.get_byte_size());
+	}
 
-		if (shaderInputLayout._inputLayout.Get() != nullptr)
-			_deviceContext->IASetInputLayout(shaderInputLayout._inputLayout.Get());
+	uint32 BinaryScene::find_shape(const std::string_view& name) const
+	{
+		const uint32 shapeCount = get_shape_count();
+		for (uint32 shapeIndex = 0; shapeIndex < shapeCount; ++shapeIndex)
+		{
+			if (get_shape_name(shapeIndex) == name)
+			{
+				return shapeIndex;
+			}
+		}
+		return UINT32_MAX;
 	}
 
-	void Renderer::bind_Shader(Shader& shader)
+	uint64 BinaryScene::compute_shape_hash(const uint32 index) const
 	{
-		if (shader._type == ShaderType::VertexShader)
+		const BinarySceneShape& shape = _shapes[index];
+		uint64 hash = compute_hash_FNV1a(&shape._center, sizeof(shape._center));
+		hash = compute_hash_FNV1a(&shape._pointCount, sizeof(shape._pointCount), hash);
+		hash = compute_hash_FNV1a(_pointXs + shape._firstPoint, sizeof(float) * shape._pointCount, hash);
+		return compute_hash_FNV1a(_pointYs + shape._firstPoint, sizeof(float) * shape._pointCount, hash);
+	}
+
+	bool compile_BinaryScene(const XML& xml, std::vector<byte>& outBlob)
+	{
+		const uint32 nameAtom = xml.find_atom("name");
+		const uint32 centerAtom = xml.find_atom("center");
+		const uint32 pointsAtom = xml.find_atom("points");
+		const uint32 xAtom = xml.find_atom("x");
+		const uint32 yAtom = xml.find_atom("y");
+
+		// A shape without a name attribute gets an empty name.
+		const auto get_shape_name = [nameAtom](const XML::Node& shapeNode)
 		{
-			_is_VS_bound = true;
-			_deviceContext->VSSetShader(static_cast<ID3D11VertexShader*>(shader._shader.Get()), nullptr, 0);
+			const XML::Attribute& nameAttribute = shapeNode.find_attribute(nameAtom);
+			return (nameAttribute.is_valid() == true ? nameAttribute.get_value() : std::string_view());
+		};
+
+		BinarySceneHeader header;
+		const XML::Node& rootNode = xml.get_root_node();
+		for (const XML::Node* shapeNode = &rootNode.get_first_child_node(); shapeNode->is_valid(); shapeNode = &shapeNode->get_next_sibling())
+		{
+			++header._shapeCount;
+			header._namesByteSize += static_cast<uint32>(get_shape_name(*shapeNode).length());
+			for (const XML::Node* childNode = &shapeNode->get_first_child_node(); childNode->is_valid(); childNode = &childNode->get_next_sibling())
+			{
+				if (childNode->get_name_atom() == pointsAtom)
+				{
+					header._pointCount += childNode->get_child_count();
+				}
+			}
 		}
-		else if (shader._type == ShaderType::PixelShader)
+
+		const auto align = [](const uint64 offset) { return (offset + kBinarySceneAlignment - 1) / kBinarySceneAlignment * kBinarySceneAlignment; };
+		const uint64 shapesOffset = align(sizeof(BinarySceneHeader));
+		const uint64 pointXsOffset = align(shapesOffset + uint64(header._shapeCount) * sizeof(BinarySceneShape));
+		const uint64 pointYsOffset = align(pointXsOffset + uint64(header._pointCount) * sizeof(float));
+		const uint64 namesOffset = align(pointYsOffset + uint64(header._pointCount) * sizeof(float));
+		const uint64 byteSize = align(namesOffset + header._namesByteSize);
+		if (byteSize > UINT32_MAX)
 		{
-			_is_PS_bound = true;
-			_deviceContext->PSSetShader(static_cast<ID3D11PixelShader*>(shader._shader.Get()), nullptr, 0);
+			MINT_LOG_ERROR("Binary scene is too big!");
+			return false;
+		}
+		header._shapesOffset = static_cast<uint32>(shapesOffset);
+		header._pointXsOffset = static_cast<uint32>(pointXsOffset);
+		header._pointYsOffset = static_cast<uint32>(pointYsOffset);
+		header._namesOffset = static_cast<uint32>(namesOffset);
+		header._byteSize = byteSize;
+
+		outBlob.assign(static_cast<size_t>(byteSize), 0);
+		byte* const blob = outBlob.data();
+		::memcpy(blob, &header, sizeof(header));
+		BinarySceneShape* const shapes = reinterpret_cast<BinarySceneShape*>(blob + shapesOffset);
+		float* const pointXs = reinterpret_cast<float*>(blob + pointXsOffset);
+		float* const pointYs = reinterpret_cast<float*>(blob + pointYsOffset);
+		char* const names = reinterpret_cast<char*>(blob + namesOffset);
+
+		uint32 shapeIndex = 0;
+		uint32 pointIndex = 0;
+		uint32 nameOffset = 0;
+		for (const XML::Node* shapeNode = &rootNode.get_first_child_node(); shapeNode->is_valid(); shapeNode = &shapeNode->get_next_sibling(), ++shapeIndex)
+		{
+			BinarySceneShape shape;
+			const std::string_view name = get_shape_name(*shapeNode);
+			if (name.empty() == false)
+			{
+				::memcpy(names + nameOffset, name.data(), name.length());
+			}
+			shape._nameOffset = nameOffset;
+			shape._nameLength = static_cast<uint32>(name.length());
+			nameOffset += shape._nameLength;
+
+			shape._firstPoint = pointIndex;
+			for (const XML::Node* childNode = &shapeNode->get_first_child_node(); childNode->is_valid(); childNode = &childNode->get_next_sibling())
+			{
+				if (childNode->get_name_atom() == centerAtom)
+				{
+					shape._center = float2(childNode->find_attribute(xAtom).get_float(), childNode->find_attribute(yAtom).get_float());
+				}
+				else if (childNode->get_name_atom() == pointsAtom)
+				{
+					for (const XML::Node* pointNode = &childNode->get_first_child_node(); pointNode->is_valid(); pointNode = &pointNode->get_next_sibling())
+					{
+						pointXs[pointIndex] = pointNode->find_attribute(xAtom).get_float();
+						pointYs[pointIndex] = pointNode->find_attribute(yAtom).get_float();
+						++pointIndex;
+					}
+				}
+			}
+			shape._pointCount = pointIndex - shape._firstPoint;
+			::memcpy(&shapes[shapeIndex], &shape, sizeof(shape));
 		}
+		return true;
 	}
 
-	void Renderer::bind_input(Resource& resource, const uint32 slot)
+	bool compile_BinaryScene_file(const std::string& xml_file_name, const std::string& binary_file_name)
 	{
-		if (resource._type == ResourceType::VertexBuffer)
+		MappedFile xmlFile;
+		if (xmlFile.open(xml_file_name) == false)
 		{
-			_is_VertexBuffer_bound = true;
+			return false;
+		}
 
-			ID3D11Buffer* buffers[1]{ static_cast<ID3D11Buffer*>(resource.get_resource()) };
-			uint32 strides[1]{ resource._elementStride };
-			uint32 offsets[1]{ 0 };
-			_deviceContext->IASetVertexBuffers(slot, 1, buffers, strides, offsets);
+		XML xml;
+		if (xml.parse_borrowed_parallel(xmlFile.get_view()) == false)
+		{
+			return false;
 		}
-		else if (resource._type == ResourceType::IndexBuffer)
+
+		std::vector<byte> blob;
+		if (compile_BinaryScene(xml, blob) == false)
 		{
-			_is_IndexBuffer_bound = true;
+			return false;
+		}
+
+		std::ofstream ofs;
+		ofs.open(binary_file_name, std::ios_base::binary | std::ios_base::trunc);
+		if (ofs.is_open() == false)
+		{
+			return false;
+		}
+		ofs.write(reinterpret_cast<const char*>(blob.data()), static_cast<std::streamsize>(blob.size()));
+		return ofs.good();
+	}
+
+	size_t compress_LZ(const byte* const source, const size_t sourceByteSize, byte* const destination)
+	{
+		constexpr uint32 kHashBits = 14;
+		constexpr uint32 kMaxOffset = 65535;
+		const auto load_uint32 = [source](const size_t at) { uint32 value; ::memcpy(&value, source + at, sizeof(value)); return value; };
+		const auto write_length = [](byte*& out, size_t length)
+			{
+				for (; length >= 255; length -= 255)
+				{
+					*out++ = 255;
+				}
+				*out++ = static_cast<byte>(length);
+			};
+		const auto write_sequence = [&](byte*& out, const size_t literalStart, const size_t literalCount, const size_t offset, const size_t matchLength)
+			{
+				byte& token = *out++;
+				token = static_cast<byte>((std::min)(literalCount, size_t(15)) << 4);
+				if (literalCount >= 15)
+				{
+					write_length(out, literalCount - 15);
+				}
+				if (literalCount > 0)
+				{
+					::memcpy(out, source + literalStart, literalCount);
+					out += literalCount;
+				}
+				if (matchLength == 0)
+				{
+					return;
+				}
+				out[0] = static_cast<byte>(offset);
+				out[1] = static_cast<byte>(offset >> 8);
+				out += 2;
+				const size_t extraMatchLength = matchLength - kLZMinMatchLength;
+				token |= static_cast<byte>((std::min)(extraMatchLength, size_t(15)));
+				if (extraMatchLength >= 15)
+				{
+					write_length(out, extraMatchLength - 15);
+				}
+			};
 
-			_deviceContext->IASetIndexBuffer(static_cast<ID3D11Buffer*>(resource.get_resource()), Resource::kIndexBufferFormat, 0);
-		}
-		else
+		std::vector<uint32> hashTable(size_t(1) << kHashBits, UINT32_MAX);
+		byte* out = destination;
+		size_t anchor = 0;
+		size_t at = 0;
+		uint32 missCount = 0;
+		while (sourceByteSize >= kLZMinMatchLength && at <= sourceByteSize - kLZMinMatchLength)
 		{
-			MINT_LOG_ERROR("!!!");
+			const uint32 sequence = load_uint32(at);
+			const uint32 hash = (sequence * 2654435761u) >> (32 - kHashBits);
+			const uint32 candidate = hashTable[hash];
+			hashTable[hash] = static_cast<uint32>(at);
+			if (candidate == UINT32_MAX || at - candidate > kMaxOffset || load_uint32(candidate) != sequence)
+			{
+				// Incompressible data is skipped faster and faster, like LZ4's acceleration.
+				at += 1 + (missCount++ >> 6);
+				continue;
+			}
+
+			size_t matchLength = kLZMinMatchLength;
+			while (at + matchLength < sourceByteSize && source[candidate + matchLength] == source[at + matchLength])
+			{
+				++matchLength;
+			}
+			write_sequence(out, anchor, at - anchor, at - candidate, matchLength);
+			at += matchLength;
+			anchor = at;
+			missCount = 0;
 		}
+		write_sequence(out, anchor, sourceByteSize - anchor, 0, 0);
+		return static_cast<size_t>(out - destination);
 	}
 
-	void Renderer::bind_ShaderResource(const ShaderType shaderType, Resource& resource, const uint32 slot)
+	bool decompress_LZ(const byte* const source, const size_t sourceByteSize, byte* const destination, const size_t destinationByteSize)
 	{
-		if (resource._type == ResourceType::ConstantBuffer)
+		const byte* in = source;
+		const byte* const inEnd = source + sourceByteSize;
+		byte* out = destination;
+		byte* const outEnd = destination + destinationByteSize;
+		const auto read_length = [&](size_t& length)
+			{
+				byte value = 255;
+				while (value == 255)
+				{
+					if (in == inEnd)
+					{
+						return false;
+					}
+					value = *in++;
+					length += value;
+				}
+				return true;
+			};
+
+		while (in < inEnd)
 		{
-			ID3D11Buffer* buffers[1]{ static_cast<ID3D11Buffer*>(resource.get_resource()) };
-			if (shaderType == ShaderType::VertexShader)
+			const byte token = *in++;
+			size_t literalCount = token >> 4;
+			if (literalCount == 15 && read_length(literalCount) == false)
 			{
-				_deviceContext->VSSetConstantBuffers(slot, 1, buffers);
+				return false;
 			}
-			else if (shaderType == ShaderType::PixelShader)
+			if (literalCount > size_t(inEnd - in) || literalCount > size_t(outEnd - out))
 			{
-				_deviceContext->PSSetConstantBuffers(slot, 1, buffers);
+				return false;
 			}
-			else
+			if (literalCount <= 16 && inEnd - in >= 16 && outEnd - out >= 16)
 			{
-				MINT_LOG_ERROR("This shader type is not supported yet!");
+				// Short literal runs are the common case; one fixed-size copy beats a variable-length memcpy.
+				::memcpy(out, in, 16);
 			}
-		}
-		else if (resource._type == ResourceType::Teture2D)
-		{
-			ID3D11ShaderResourceView* views[1]{ static_cast<ID3D11ShaderResourceView*>(resource.get_view()) };
-			if (shaderType == ShaderType::VertexShader)
+			else if (literalCount > 0)
 			{
-				_deviceContext->VSSetShaderResources(slot, 1, views);
+				::memcpy(out, in, literalCount);
 			}
-			else if (shaderType == ShaderType::PixelShader)
+			in += literalCount;
+			out += literalCount;
+			if (in == inEnd)
 			{
-				_deviceContext->PSSetShaderResources(slot, 1, views);
+				break;
+			}
+
+			if (inEnd - in < 2)
+			{
+				return false;
+			}
+			const size_t offset = size_t(in[0]) | (size_t(in[1]) << 8);
+			in += 2;
+			size_t matchLength = (token & 15);
+			if (matchLength == 15 && read_length(matchLength) == false)
+			{
+				return false;
+			}
+			matchLength += kLZMinMatchLength;
+			if (offset == 0 || offset > size_t(out - destination) || matchLength > size_t(outEnd - out))
+			{
+				return false;
+			}
+			const byte* match = out - offset;
+			if (offset >= 8 && size_t(outEnd - out) >= matchLength + 8)
+			{
+				// 8-byte steps never read bytes that this match has not written yet once offset >= 8.
+				byte* const matchEnd = out + matchLength;
+				for (byte* copy = out; copy < matchEnd; copy += 8, match += 8)
+				{
+					::memcpy(copy, match, 8);
+				}
+				out = matchEnd;
+			}
+			else if (offset >= matchLength)
+			{
+				::memcpy(out, match, matchLength);
+				out += matchLength;
 			}
 			else
 			{
-				MINT_LOG_ERROR("This shader type is not supported yet!");
+				// Overlapping match, e.g. a run of one repeated byte.
+				for (size_t i = 0; i < matchLength; ++i)
+				{
+					*out++ = *match++;
+				}
 			}
 		}
-		else
-		{
-			MINT_LOG_ERROR("This resource type is not supported yet!");
-		}
-	}
-
-	void Renderer::use_triangle_primitive()
-	{
-		_deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY::D3D10_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+		return (out == outEnd);
 	}
 
-	void Renderer::begin_rendering()
+	void AssetPackBuilder::add(const std::string_view name, const void* const data, const size_t byteSize, const bool compress)
 	{
-		_deviceContext->ClearRenderTargetView(_backBufferRtv.Get(), _clearColor.f);
-		_deviceContext->ClearDepthStencilView(_depthStencilView.Get(), D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
-		use_triangle_primitive();
+		Asset asset;
+		asset._name = name;
+		asset._data.assign(static_cast<const byte*>(data), static_cast<const byte*>(data) + byteSize);
+		asset._is_compressed = compress;
+		_assets.push_back(std::move(asset));
 	}
 
-	void Renderer::draw_indexed(const uint32 indexCount)
+	bool AssetPackBuilder::add_file(const std::string_view name, const std::string& file_name, const bool compress)
 	{
-		if (_is_InputLayout_bound == false)
-		{
-			MINT_LOG_ERROR("You must bind ShaderInputLayout first!");
-			return;
-		}
-		if (_is_VS_bound == false || _is_PS_bound == false)
-		{
-			MINT_LOG_ERROR("You must at least bind VertexShader and PixelShader first!");
-			return;
-		}
-		if (_is_VertexBuffer_bound == false)
+		MappedFile file;
+		if (file.open(file_name) == false)
 		{
-			MINT_LOG_ERROR("You must bind VertexBuffer first!");
-			return;
-		}
-		if (_is_IndexBuffer_bound == false)
-		{
-			MINT_LOG_ERROR("You must bind IndexBuffer first!");
-			return;
+			return false;
 		}
-
-		_deviceContext->DrawIndexed(indexCount, 0, 0);
+		add(name, file.get_data(), file.get_byte_size(), compress);
+		return true;
 	}
 
-	void Renderer::draw_text(const Color& color, const std::string& text, const float2& position)
+	bool AssetPackBuilder::write(const std::string& file_name) const
 	{
-		if (text.empty() == true)
+		struct ChunkSource
 		{
-			return;
-		}
+			const Asset* _asset = nullptr;
+			size_t _at = 0;
+			uint32 _byteSize = 0;
+			std::vector<byte> _compressed;
+		};
 
-		const float unit_x = _defaultFontScale.x * kFontTextureGlyphWidth;
-		const float unit_y = _defaultFontScale.y * kFontTextureGlyphHeight;
-		const float2 sizeUnit = float2(unit_x, unit_y);
-		const float2 positionUnit = float2(unit_x, 0);
-		uint32 chCount = 0;
-		for (const char& ch : text)
+		if (_chunkByteSize == 0)
 		{
-			const DefaultFontGlyphMeta& glyphMeta = _defaultFontData.get_GlyphMeta(ch);
-			const float u0 = glyphMeta._u0;
-			const float u1 = glyphMeta._u1;
-			const float v0 = glyphMeta._v0;
-			const float v1 = glyphMeta._v1;
-			MeshGenerator<DEFAULT_FONT_VS_INPUT>::push_2D_rectangle(color, sizeUnit, position + sizeUnit * 0.5f + positionUnit * (float)chCount, 0.0f, _defaultFontVertices, _defaultFontIndices);
-			_defaultFontVertices[_defaultFontVertices.size() - 4]._texcoord = float2(u0, v0);
-			_defaultFontVertices[_defaultFontVertices.size() - 3]._texcoord = float2(u0, v1);
-			_defaultFontVertices[_defaultFontVertices.size() - 2]._texcoord = float2(u1, v1);
-			_defaultFontVertices[_defaultFontVertices.size() - 1]._texcoord = float2(u1, v0);
-			++chCount;
+			MINT_LOG_ERROR("Chunk byte size must not be 0!");
+			return false;
 		}
-	}
 
-	void Renderer::draw(const uint32 vertexCount)
-	{
-		if (_is_VertexBuffer_bound == false)
+		std::vector<uint32> assetOrder(_assets.size());
+		std::vector<uint64> nameHashes(_assets.size());
+		for (uint32 assetIndex = 0; assetIndex < static_cast<uint32>(_assets.size()); ++assetIndex)
 		{
-			MINT_LOG_ERROR("You must bind VertexBuffer first!");
-			return;
+			assetOrder[assetIndex] = assetIndex;
+			nameHashes[assetIndex] = compute_hash_FNV1a(_assets[assetIndex]._name.data(), _assets[assetIndex]._name.length());
 		}
-
-		_deviceContext->Draw(vertexCount, 0);
-	}
-
-	void Renderer::end_rendering()
-	{
-		if (_defaultFontVertices.empty() == false)
+		std::stable_sort(assetOrder.begin(), assetOrder.end(), [&](const uint32 a, const uint32 b) { return nameHashes[a] < nameHashes[b]; });
+
+		AssetPackHeader header;
+		header._assetCount = static_cast<uint32>(_assets.size());
+		header._chunkByteSize = _chunkByteSize;
+		std::vector<AssetPackEntry> entries(_assets.size());
+		std::vector<ChunkSource> chunkSources;
+		std::string names;
+		for (uint32 entryIndex = 0; entryIndex < header._assetCount; ++entryIndex)
 		{
-			_defaultFontVertexBuffer.update(*this, &_defaultFontVertices[0], sizeof(DEFAULT_FONT_VS_INPUT), (uint32)_defaultFontVertices.size());
-			_defaultFontIndexBuffer.update(*this, &_defaultFontIndices[0], sizeof(uint32), (uint32)_defaultFontIndices.size());
-
-			bind_default_FontData();
-
-			draw_indexed((uint32)_defaultFontIndices.size());
-			_defaultFontVertices.clear();
-			_defaultFontIndices.clear();
+			const Asset& asset = _assets[assetOrder[entryIndex]];
+			AssetPackEntry& entry = entries[entryIndex];
+			entry._nameHash = nameHashes[assetOrder[entryIndex]];
+			entry._byteSize = asset._data.size();
+			entry._nameOffset = static_cast<uint32>(names.length());
+			entry._nameLength = static_cast<uint32>(asset._name.length());
+			entry._firstChunk = static_cast<uint32>(chunkSources.size());
+			names += asset._name;
+			for (size_t at = 0; at < asset._data.size(); at += _chunkByteSize)
+			{
+				ChunkSource chunkSource;
+				chunkSource._asset = &asset;
+				chunkSource._at = at;
+				chunkSource._byteSize = static_cast<uint32>((std::min)(asset._data.size() - at, size_t(_chunkByteSize)));
+				chunkSources.push_back(std::move(chunkSource));
+			}
+			entry._chunkCount = static_cast<uint32>(chunkSources.size()) - entry._firstChunk;
 		}
+		header._chunkCount = static_cast<uint32>(chunkSources.size());
+		header._namesByteSize = static_cast<uint32>(names.length());
 
-		_swapChain->Present(0, 0);
-	}
-
-	bool Renderer::create_window()
-	{
-		_hInstance = ::GetModuleHandle(nullptr);
-		WNDCLASSEX wndClassEx{};
-		wndClassEx.cbSize = sizeof(wndClassEx);
-		wndClassEx.hInstance = _hInstance;
-		wndClassEx.lpszClassName = TEXT("SimpleRenderer Window");
-		wndClassEx.hbrBackground = ::CreateSolidBrush(RGB(255, 255, 255));
-		wndClassEx.style = CS_HREDRAW | CS_VREDRAW | CS_DBLCLKS;
-		wndClassEx.lpfnWndProc = windowProcedure;
-		::RegisterClassEx(&wndClassEx);
-		_hWnd = ::CreateWindowEx(0, wndClassEx.lpszClassName, TEXT("TEST"), WS_OVERLAPPEDWINDOW, CW_USEDEFAULT, CW_USEDEFAULT, (int)_windowSize.x, (int)_windowSize.y, nullptr, nullptr, _hInstance, nullptr);
-		if (_hWnd) ::ShowWindow(_hWnd, SW_SHOWDEFAULT);
-		return (_hWnd != nullptr);
-	}
-
-	void Renderer::destroy_window()
-	{
-		if (!_hWnd) return;
-		::DestroyWindow(_hWnd);
-		_hWnd = nullptr;
-	}
-
-	void Renderer::create_device()
-	{
-		DXGI_SWAP_CHAIN_DESC swapChainDescriptor{};
-		swapChainDescriptor.BufferCount = 1;
-		swapChainDescriptor.BufferDesc.Format = DXGI_FORMAT::DXGI_FORMAT_R8G8B8A8_UNORM;
-		swapChainDescriptor.BufferDesc.Width = static_cast<UINT>(_windowSize.x);
-		swapChainDescriptor.BufferDesc.Height = static_cast<UINT>(_windowSize.y);
-		swapChainDescriptor.BufferDesc.RefreshRate.Denominator = 1;
-		swapChainDescriptor.BufferDesc.RefreshRate.Numerator = 60;
-		swapChainDescriptor.BufferDesc.Scaling = DXGI_MODE_SCALING::DXGI_MODE_SCALING_UNSPECIFIED;
-		swapChainDescriptor.BufferDesc.ScanlineOrdering = DXGI_MODE_SCANLINE_ORDER::DXGI_MODE_SCANLINE_ORDER_UNSPECIFIED;
-		swapChainDescriptor.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
-		swapChainDescriptor.Flags = 0;
-		swapChainDescriptor.OutputWindow = _hWnd;
-		swapChainDescriptor.SampleDesc.Count = 1;
-		swapChainDescriptor.SampleDesc.Quality = 0;
-		swapChainDescriptor.SwapEffect = DXGI_SWAP_EFFECT::DXGI_SWAP_EFFECT_DISCARD;
-		swapChainDescriptor.Windowed = TRUE;
-		if (FAILED(::D3D11CreateDeviceAndSwapChain(nullptr, D3D_DRIVER_TYPE::D3D_DRIVER_TYPE_HARDWARE, nullptr, 0, nullptr, 0, D3D11_SDK_VERSION,
-			&swapChainDescriptor, _swapChain.ReleaseAndGetAddressOf(), _device.ReleaseAndGetAddressOf(), nullptr, _deviceContext.ReleaseAndGetAddressOf())))
+		parallel_for(header._chunkCount, [&](const uint32 chunkIndex)
+			{
+				ChunkSource& chunkSource = chunkSources[chunkIndex];
+				if (chunkSource._asset->_is_compressed == false)
+				{
+					return;
+				}
+				chunkSource._compressed.resize(get_LZ_compress_bound(chunkSource._byteSize));
+				const size_t compressedByteSize = compress_LZ(chunkSource._asset->_data.data() + chunkSource._at, chunkSource._byteSize, chunkSource._compressed.data());
+				chunkSource._compressed.resize((compressedByteSize < chunkSource._byteSize) ? compressedByteSize : 0);
+			});
+
+		const auto align = [](const uint64 offset) { return (offset + 15) / 16 * 16; };
+		header._assetsOffset = static_cast<uint32>(align(sizeof(AssetPackHeader)));
+		header._chunksOffset = static_cast<uint32>(align(header._assetsOffset + uint64(header._assetCount) * sizeof(AssetPackEntry)));
+		header._namesOffset = static_cast<uint32>(align(header._chunksOffset + uint64(header._chunkCount) * sizeof(AssetPackChunk)));
+		uint64 dataOffset = align(header._namesOffset + uint64(header._namesByteSize));
+		std::vector<AssetPackChunk> chunks(header._chunkCount);
+		for (const AssetPackEntry& entry : entries)
 		{
-			MINT_LOG_ERROR("Failed to create Device and SwapChain.");
-			return;
+			// Keeps raw assets aligned, so they can be bound in place (e.g. by BinaryScene) through get_view().
+			dataOffset = align(dataOffset);
+			for (uint32 chunkIndex = entry._firstChunk; chunkIndex < entry._firstChunk + entry._chunkCount; ++chunkIndex)
+			{
+				const ChunkSource& chunkSource = chunkSources[chunkIndex];
+				AssetPackChunk& chunk = chunks[chunkIndex];
+				chunk._offset = dataOffset;
+				chunk._byteSize = chunkSource._byteSize;
+				chunk._storedByteSize = (chunkSource._compressed.empty() ? chunkSource._byteSize : static_cast<uint32>(chunkSource._compressed.size()));
+				dataOffset += chunk._storedByteSize;
+			}
 		}
+		header._byteSize = dataOffset;
 
-		ComPtr<ID3D11Texture2D> backBuffer;
-		_swapChain->GetBuffer(0, __uuidof(ID3D11Texture2D), reinterpret_cast<void**>(backBuffer.ReleaseAndGetAddressOf()));
-		if (FAILED(_device->CreateRenderTargetView(backBuffer.Get(), nullptr, _backBufferRtv.ReleaseAndGetAddressOf())))
+		std::ofstream ofs;
+		ofs.open(file_name, std::ios_base::binary | std::ios_base::trunc);
+		if (ofs.is_open() == false)
 		{
-			MINT_LOG_ERROR("Failed to get BackBuffer.");
-			return;
+			return false;
 		}
-
-		D3D11_TEXTURE2D_DESC depthStencilResourceDescriptor{};
-		depthStencilResourceDescriptor.Width = static_cast<UINT>(_windowSize.x);
-		depthStencilResourceDescriptor.Height = static_cast<UINT>(_windowSize.y);
-		depthStencilResourceDescriptor.MipLevels = 1;
-		depthStencilResourceDescriptor.ArraySize = 1;
-		depthStencilResourceDescriptor.Format = DXGI_FORMAT_D24_UNORM_S8_UINT;
-		depthStencilResourceDescriptor.SampleDesc.Count = swapChainDescriptor.SampleDesc.Count;
-		depthStencilResourceDescriptor.SampleDesc.Quality = swapChainDescriptor.SampleDesc.Quality;
-		depthStencilResourceDescriptor.Usage = D3D11_USAGE_DEFAULT;
-		depthStencilResourceDescriptor.BindFlags = D3D11_BIND_DEPTH_STENCIL;
-		depthStencilResourceDescriptor.CPUAccessFlags = 0;
-		depthStencilResourceDescriptor.MiscFlags = 0;
-		if (FAILED(_device->CreateTexture2D(&depthStencilResourceDescriptor, nullptr, _depthStencilResource.ReleaseAndGetAddressOf())))
+		const auto write_at = [&ofs](const uint64 offset, const void* const data, const size_t byteSize)
+			{
+				static constexpr char kZeros[16]{};
+				ofs.write(kZeros, static_cast<std::streamsize>(offset - static_cast<uint64>(ofs.tellp())));
+				ofs.write(static_cast<const char*>(data), static_cast<std::streamsize>(byteSize));
+			};
+		write_at(0, &header, sizeof(header));
+		write_at(header._assetsOffset, entries.data(), entries.size() * sizeof(AssetPackEntry));
+		write_at(header._chunksOffset, chunks.data(), chunks.size() * sizeof(AssetPackChunk));
+		write_at(header._namesOffset, names.data(), names.length());
+		for (uint32 chunkIndex = 0; chunkIndex < header._chunkCount; ++chunkIndex)
 		{
-			MINT_LOG_ERROR("Failed to create Depth-Stencil texture.");
-			return;
+			const ChunkSource& chunkSource = chunkSources[chunkIndex];
+			if (chunkSource._compressed.empty() == true)
+			{
+				write_at(chunks[chunkIndex]._offset, chunkSource._asset->_data.data() + chunkSource._at, chunkSource._byteSize);
+			}
+			else
+			{
+				write_at(chunks[chunkIndex]._offset, chunkSource._compressed.data(), chunkSource._compressed.size());
+			}
 		}
-		if (FAILED(_device->CreateDepthStencilView(_depthStencilResource.Get(), nullptr, _depthStencilView.ReleaseAndGetAddressOf())))
+		return ofs.good();
+	}
+
+	bool AssetPack::open(const std::string& file_name)
+	{
+		close();
+		if (_mappedFile.open(file_name) == false)
 		{
-			MINT_LOG_ERROR("Failed to create Depth-Stencil view.");
-			return;
+			return report_error("failed to map the file!");
 		}
 
+		const byte* const bytes = _mappedFile.get_data();
+		const uint64 byteSize = _mappedFile.get_byte_size();
+		if (byteSize < sizeof(AssetPackHeader))
 		{
-			D3D11_RASTERIZER_DESC rasterizerDescriptor{};
-			rasterizerDescriptor.AntialiasedLineEnable = FALSE;
-			rasterizerDescriptor.CullMode = D3D11_CULL_MODE::D3D11_CULL_BACK;
-			rasterizerDescriptor.DepthBias = 0;
-			rasterizerDescriptor.DepthBiasClamp = 0.0f;
-			rasterizerDescriptor.DepthClipEnable = TRUE;
-			rasterizerDescriptor.FillMode = D3D11_FILL_MODE::D3D11_FILL_SOLID;
-			rasterizerDescriptor.FrontCounterClockwise = TRUE;
-			rasterizerDescriptor.MultisampleEnable = TRUE;
-			rasterizerDescriptor.ScissorEnable = FALSE;
-			rasterizerDescriptor.SlopeScaledDepthBias = 0.0f;
-			_device->CreateRasterizerState(&rasterizerDescriptor, _defaultRasterizerState.ReleaseAndGetAddressOf());
-			_deviceContext->RSSetState(_defaultRasterizerState.Get());
+			return report_error("not an asset pack!");
 		}
-
+		const AssetPackHeader* const header = reinterpret_cast<const AssetPackHeader*>(bytes);
+		if (header->_magic != AssetPackHeader::kMagic || header->_version != AssetPackHeader::kVersion)
 		{
-			D3D11_DEPTH_STENCIL_DESC depthStencilDescriptor{};
-			depthStencilDescriptor.DepthEnable = TRUE;
-			depthStencilDescriptor.DepthFunc = D3D11_COMPARISON_FUNC::D3D11_COMPARISON_LESS_EQUAL;
-			depthStencilDescriptor.DepthWriteMask = D3D11_DEPTH_WRITE_MASK::D3D11_DEPTH_WRITE_MASK_ALL;
-			depthStencilDescriptor.StencilEnable = FALSE;
-			if (FAILED(_device->CreateDepthStencilState(&depthStencilDescriptor, _defaultDepthStencilState.ReleaseAndGetAddressOf())))
-			{
-				MINT_LOG_ERROR("Failed to create Depth-Stencil state.");
-				return;
-			}
+			return report_error("not an asset pack, or an unsupported version!");
 		}
-
+		if (header->_byteSize != byteSize)
 		{
-			D3D11_VIEWPORT viewport{};
-			viewport.Width = _windowSize.x;
-			viewport.Height = _windowSize.y;
-			viewport.MinDepth = 0.0f;
-			viewport.MaxDepth = 1.0f;
-			_deviceContext->RSSetViewports(1, &viewport);
+			return report_error("asset pack is truncated!");
 		}
 
+		const auto is_array_valid = [&](const uint32 offset, const uint64 arrayByteSize)
+			{
+				return offset % 16 == 0 && offset >= sizeof(AssetPackHeader) && uint64(offset) + arrayByteSize <= byteSize;
+			};
+		if (is_array_valid(header->_assetsOffset, uint64(header->_assetCount) * sizeof(AssetPackEntry)) == false
+			|| is_array_valid(header->_chunksOffset, uint64(header->_chunkCount) * sizeof(AssetPackChunk)) == false
+			|| is_array_valid(header->_namesOffset, header->_namesByteSize) == false)
 		{
-			D3D11_SAMPLER_DESC samplerDescriptor{};
-			samplerDescriptor.Filter = D3D11_FILTER::D3D11_FILTER_MIN_MAG_MIP_POINT;
-			samplerDescriptor.AddressU = D3D11_TEXTURE_ADDRESS_MODE::D3D11_TEXTURE_ADDRESS_CLAMP;
-			samplerDescriptor.AddressV = D3D11_TEXTURE_ADDRESS_MODE::D3D11_TEXTURE_ADDRESS_CLAMP;
-			samplerDescriptor.AddressW = D3D11_TEXTURE_ADDRESS_MODE::D3D11_TEXTURE_ADDRESS_CLAMP;
-			samplerDescriptor.MipLODBias = 0.0f;
-			samplerDescriptor.ComparisonFunc = D3D11_COMPARISON_FUNC::D3D11_COMPARISON_ALWAYS;
-			samplerDescriptor.MinLOD = 0.0f;
-			samplerDescriptor.MaxLOD = 0.0f;
-			_device->CreateSamplerState(&samplerDescriptor, _defaultSamplerState.ReleaseAndGetAddressOf());
-			_deviceContext->PSSetSamplers(0, 1, _defaultSamplerState.GetAddressOf());
+			return report_error("asset pack table is out of bounds!");
 		}
 
+		const AssetPackEntry* const entries = reinterpret_cast<const AssetPackEntry*>(bytes + header->_assetsOffset);
+		const AssetPackChunk* const chunks = reinterpret_cast<const AssetPackChunk*>(bytes + header->_chunksOffset);
+		for (uint32 chunkIndex = 0; chunkIndex < header->_chunkCount; ++chunkIndex)
 		{
-			D3D11_BLEND_DESC blendDescriptor{};
-			blendDescriptor.AlphaToCoverageEnable = false;
-			blendDescriptor.RenderTarget[0].BlendEnable = true;
-			blendDescriptor.RenderTarget[0].SrcBlend = D3D11_BLEND::D3D11_BLEND_SRC_ALPHA;
-			blendDescriptor.RenderTarget[0].DestBlend = D3D11_BLEND::D3D11_BLEND_INV_SRC_ALPHA;
-			blendDescriptor.RenderTarget[0].BlendOp = D3D11_BLEND_OP::D3D11_BLEND_OP_ADD;
-			blendDescriptor.RenderTarget[0].SrcBlendAlpha = D3D11_BLEND::D3D11_BLEND_INV_SRC_ALPHA;
-			blendDescriptor.RenderTarget[0].DestBlendAlpha = D3D11_BLEND::D3D11_BLEND_ZERO;
-			blendDescriptor.RenderTarget[0].BlendOpAlpha = D3D11_BLEND_OP::D3D11_BLEND_OP_ADD;
-			blendDescriptor.RenderTarget[0].RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE::D3D11_COLOR_WRITE_ENABLE_ALL;
-			_device->CreateBlendState(&blendDescriptor, _defaultBlendState.ReleaseAndGetAddressOf());
-
-			const float kBlendFactor[4]{ 0, 0, 0, 0 };
-			_deviceContext->OMSetBlendState(_defaultBlendState.Get(), kBlendFactor, 0xFFFFFFFF);
+			const AssetPackChunk& chunk = chunks[chunkIndex];
+			// Written so that a corrupt _offset near UINT64_MAX cannot wrap around.
+			if (chunk._byteSize > header->_chunkByteSize || chunk._storedByteSize > chunk._byteSize
+				|| chunk._offset > byteSize || chunk._storedByteSize > byteSize - chunk._offset)
+			{
+				return report_error("asset pack chunk is out of bounds!");
+			}
+		}
+		for (uint32 entryIndex = 0; entryIndex < header->_assetCount; ++entryIndex)
+		{
+			const AssetPackEntry& entry = entries[entryIndex];
+			if (uint64(entry._nameOffset) + entry._nameLength > header->_namesByteSize || uint64(entry._firstChunk) + entry._chunkCount > header->_chunkCount
+				|| (entryIndex > 0 && entries[entryIndex - 1]._nameHash > entry._nameHash))
+			{
+				return report_error("asset pack entry is out of bounds!");
+			}
+			// Every chunk but the last is full, which is what lets read() place chunks without a prefix sum.
+			if (entry._byteSize != (entry._chunkCount == 0 ? 0 : uint64(entry._chunkCount - 1) * header->_chunkByteSize + chunks[entry._firstChunk + entry._chunkCount - 1]._byteSize))
+			{
+				return report_error("asset pack entry size does not match its chunks!");
+			}
+			for (uint32 chunkIndex = entry._firstChunk; chunkIndex + 1 < entry._firstChunk + entry._chunkCount; ++chunkIndex)
+			{
+				if (chunks[chunkIndex]._byteSize != header->_chunkByteSize)
+				{
+					return report_error("asset pack chunk is not full!");
+				}
+			}
 		}
 
-		_deviceContext->OMSetRenderTargets(1, _backBufferRtv.GetAddressOf(), _depthStencilView.Get());
-		_deviceContext->OMSetDepthStencilState(_defaultDepthStencilState.Get(), 0);
+		_header = header;
+		_entries = entries;
+		_chunks = chunks;
+		_names = reinterpret_cast<const char*>(bytes + header->_namesOffset);
+		_error.clear();
+		return true;
+	}
 
-		create_device_create_default_FontData();
+	void AssetPack::close()
+	{
+		_mappedFile.close();
+		_header = nullptr;
+		_entries = nullptr;
+		_chunks = nullptr;
+		_names = nullptr;
 	}
 
-	void Renderer::create_device_create_default_FontData_push_glyphRow(const uint32 rowIndex, const byte(&ch)[kFontTextureGlyphCountInRow])
+	uint32 AssetPack::find(const std::string_view name) const
 	{
-		const float glyphTextureWidth = (float)kFontTextureGlyphWidth;
-		const float glyphTextureHeight = (float)kFontTextureGlyphHeight;
-		const float glyphTextureUnit_U = glyphTextureWidth / kFontTextureWidth;
-		const float glyphTextureUnit_V = glyphTextureHeight / kFontTextureHeight;
-		const float v0 = glyphTextureUnit_V * rowIndex;
-		const float v1 = v0 + glyphTextureUnit_V;
-		for (uint32 iter = 0; iter < kFontTextureGlyphCountInRow; ++iter)
+		const uint64 nameHash = compute_hash_FNV1a(name.data(), name.length());
+		const AssetPackEntry* const entriesEnd = _entries + get_asset_count();
+		const AssetPackEntry* entry = std::lower_bound(_entries, entriesEnd, nameHash, [](const AssetPackEntry& entry, const uint64 hash) { return entry._nameHash < hash; });
+		for (; entry != entriesEnd && entry->_nameHash == nameHash; ++entry)
 		{
-			_defaultFontData.push_glyph(DefaultFontGlyphMeta(ch[iter], glyphTextureUnit_U * iter, v0, glyphTextureUnit_U * (iter + 1), v1));
+			const uint32 index = static_cast<uint32>(entry - _entries);
+			if (get_asset_name(index) == name)
+			{
+				return index;
+			}
 		}
+		return kInvalidIndex;
 	}
 
-	void Renderer::create_device_create_default_FontData()
+	bool AssetPack::get_view(const uint32 index, std::string_view& outView) const
 	{
-		Renderer& renderer = *this;
-
-		_defaultFontShaderHeaderSet.push_shader_header("DefaultFontShaderHeader", kDefaultFontShaderHeaderCode);
-
-		_defaultFontVertexShader.create(renderer, kDefaultFontVertexShaderCode, ShaderType::VertexShader, "DefaultFontVertexShader", "main", "vs_5_0", &_defaultFontShaderHeaderSet);
-
-		_defaultFontShaderInputLayout.push_InputElement(ShaderInputLayout::create_InputElement_float4("POSITION", 0));
-		_defaultFontShaderInputLayout.push_InputElement(ShaderInputLayout::create_InputElement_float4("COLOR", 0));
-		_defaultFontShaderInputLayout.push_InputElement(ShaderInputLayout::create_InputElement_float2("TEXCOORD", 0));
-		_defaultFontShaderInputLayout.create(renderer, _defaultFontVertexShader);
-
-		_defaultFontPixelShader.create(renderer, kDefaultFontPixelShaderCode, ShaderType::PixelShader, "DefaultFontPixelShader", "main", "ps_5_0", &_defaultFontShaderHeaderSet);
-
-		DEFAULT_FONT_CB_MATRICES default_font_cb_matrices;
-		default_font_cb_matrices._projectionMatrix.make_pixel_coordinates_projection_matrix(_windowSize);
-		_defaultFontCBMatrices.create_buffer(renderer, ResourceType::ConstantBuffer, &default_font_cb_matrices, sizeof(default_font_cb_matrices), 1);
-
-		byte bytes[kFontTextureByteCount]{};
-		for (uint32 iter = 0; iter < kFontTextureByteCount; ++iter)
+		const AssetPackEntry& entry = _entries[index];
+		const byte* const bytes = _mappedFile.get_data();
+		for (uint32 chunkIndex = entry._firstChunk; chunkIndex < entry._firstChunk + entry._chunkCount; ++chunkIndex)
 		{
-			const uint32 bitAt = iter % 8;
-			const uint32 byteAt = iter / 8;
-			const byte byte_ = (kFontTextureRawBitData[byteAt] >> (7 - bitAt)) & 1;
-			bytes[iter] = byte_ * 255;
+			const AssetPackChunk& chunk = _chunks[chunkIndex];
+			if (chunk._storedByteSize != chunk._byteSize || (chunkIndex > entry._firstChunk && _chunks[chunkIndex - 1]._offset + _chunks[chunkIndex - 1]._byteSize != chunk._offset))
+			{
+				return false;
+			}
 		}
-		_defaultFontTexture.create_texture2D(renderer, TextureFormat::R8_UNORM, bytes, kFontTextureWidth, kFontTextureHeight);
-
-		MeshGenerator<DEFAULT_FONT_VS_INPUT>::push_2D_rectangle(Color(), float2(512, 480), float2(256, 240), 0.0f, _defaultFontVertices, _defaultFontIndices);
-		_defaultFontVertices[0]._texcoord = float2(0, 0);
-		_defaultFontVertices[1]._texcoord = float2(1, 0);
-		_defaultFontVertices[2]._texcoord = float2(0, 1);
-		_defaultFontVertices[3]._texcoord = float2(1, 1);
-		_defaultFontVertexBuffer.create_buffer(renderer, ResourceType::VertexBuffer, &_defaultFontVertices[0], sizeof(DEFAULT_FONT_VS_INPUT), (uint32)_defaultFontVertices.size());
-		_defaultFontIndexBuffer.create_buffer(renderer, ResourceType::IndexBuffer, &_defaultFontIndices[0], sizeof(uint32), (uint32)_defaultFontIndices.size());
-
-		byte row0[kFontTextureGlyphCountInRow]{ ' ','!','\"','$','#','%','&','\'','(',')','*','+',',','-','.','/' };
-		create_device_create_default_FontData_push_glyphRow(0, row0);
-
-		byte row1[kFontTextureGlyphCountInRow]{ '0','1','2','3','4','5','6','7','8','9',':',';','<','=','>','?' };
-		create_device_create_default_FontData_push_glyphRow(1, row1);
-
-		byte row2[kFontTextureGlyphCountInRow]{ '@','A','B','C','D','E','F','G','H','I','J','K','L','M','N','O' };
-		create_device_create_default_FontData_push_glyphRow(2, row2);
-
-		byte row3[kFontTextureGlyphCountInRow]{ 'P','Q','R','S','T','U','V','W','X','Y','Z','[','\\',']','^','_' };
-		create_device_create_default_FontData_push_glyphRow(3, row3);
-
-		byte row4[kFontTextureGlyphCountInRow]{ '`','a','b','c','d','e','f','g','h','i','j','k','l','m','n','o' };
-		create_device_create_default_FontData_push_glyphRow(4, row4);
+		outView = (entry._chunkCount == 0) ? std::string_view() : std::string_view(reinterpret_cast<const char*>(bytes + _chunks[entry._firstChunk]._offset), static_cast<size_t>(entry._byteSize));
+		return true;
+	}
 
-		byte row5[kFontTextureGlyphCountInRow]{ 'p','q','r','s','t','u','v','w','x','y','z','(','|',')','~', 0 };
-		create_device_create_default_FontData_push_glyphRow(5, row5);
+	bool AssetPack::read(const uint32 index, std::vector<byte>& outData) const
+	{
+		outData.resize(static_cast<size_t>(_entries[index]._byteSize));
+		return read(index, outData.data());
 	}
 
-	void Renderer::bind_default_FontData()
+	bool AssetPack::read(const uint32 index, std::string& outData) const
 	{
-		bind_Shader(_defaultFontVertexShader);
-		bind_Shader(_defaultFontPixelShader);
-		bind_ShaderInputLayout(_defaultFontShaderInputLayout);
-		bind_ShaderResource(ShaderType::VertexShader, _defaultFontCBMatrices, 0);
-		bind_ShaderResource(ShaderType::PixelShader, _defaultFontTexture, 0);
+		outData.resize(static_cast<size_t>(_entries[index]._byteSize));
+		return read(index, reinterpret_cast<byte*>(outData.data()));
+	}
 
-		bind_input(_defaultFontVertexBuffer, 0);
-		bind_input(_defaultFontIndexBuffer, 0);
+	bool AssetPack::read(const uint32 index, byte* const destination) const
+	{
+		const AssetPackEntry& entry = _entries[index];
+		const byte* const bytes = _mappedFile.get_data();
+		std::atomic<bool> is_succeeded{ true };
+		const auto read_chunk = [&](const uint32 chunkIndexInEntry)
+			{
+				const AssetPackChunk& chunk = _chunks[entry._firstChunk + chunkIndexInEntry];
+				byte* const chunkDestination = destination + size_t(chunkIndexInEntry) * _header->_chunkByteSize;
+				if (chunk._storedByteSize == chunk._byteSize)
+				{
+					::memcpy(chunkDestination, bytes + chunk._offset, chunk._byteSize);
+				}
+				else if (decompress_LZ(bytes + chunk._offset, chunk._storedByteSize, chunkDestination, chunk._byteSize) == false)
+				{
+					is_succeeded.store(false, std::memory_order_relaxed);
+				}
+			};
+		if (entry._chunkCount == 1)
+		{
+			read_chunk(0);
+		}
+		else if (entry._chunkCount > 1)
+		{
+			parallel_for(entry._chunkCount, read_chunk);
+		}
+		return is_succeeded.load();
 	}
 
 	bool read_file(const std::string& file_name, std::string& out_content)
 	{
-		out_content.clear();
-
-		std::ifstream ifs;
-		ifs.open(file_name, std::ios_base::ate);
-		if (ifs.is_open() == false)
+		// Binary and sized from the mapping: text mode shrank CRLF files below the size tellg() reported and left garbage at the end.
+		MappedFile file;
+		if (file.open(file_name) == false)
 		{
+			out_content.clear();
 			return false;
 		}
-
-		const std::streampos length = ifs.tellg();
-		ifs.seekg(std::ios_base::beg);
-		out_content.resize(length);
-		ifs.read(&out_content[0], length);
+		out_content.assign(file.get_view());
 		return true;
 	}
 
-	struct XML
+	FileLoadQueue::FileLoadQueue(const uint32 workerCount)
 	{
-		struct Attribute;
-		struct Node;
-		static constexpr size_t INVALID_ID = size_t(-1);
+		for (uint32 workerIndex = 0; workerIndex < (std::max)(workerCount, 1u); ++workerIndex)
+		{
+			_workers.emplace_back([this]() { run_worker(); });
+		}
+	}
 
-		struct Attribute
+	FileLoadQueue::~FileLoadQueue()
+	{
 		{
-			friend XML;
+			std::lock_guard<std::mutex> lock(_jobMutex);
+			_is_stopping = true;
+		}
+		_jobCondition.notify_all();
+		for (std::thread& worker : _workers)
+		{
+			worker.join();
+		}
+	}
 
-			size_t _ID = 0;
-			size_t _node_ID = 0;
-			size_t _index_in_node = 0;
-			size_t _name_at = 0;
-			size_t _name_length = 0;
-			size_t _value_at = 0;
-			size_t _value_length = 0;
+	void FileLoadQueue::submit(Work work, Completion completion)
+	{
+		_pendingCount.fetch_add(1, std::memory_order_acq_rel);
+		{
+			std::lock_guard<std::mutex> lock(_jobMutex);
+			_jobs.push_back(Job{ std::move(work), std::move(completion) });
+		}
+		_jobCondition.notify_one();
+	}
 
-			//std::string _debug_name;
-			//std::string _debug_value;
+	void FileLoadQueue::load(const std::string& file_name, LoadCompletion completion)
+	{
+		// std::function needs copyable captures and MappedFile is move-only.
+		std::shared_ptr<LoadResult> result = std::make_shared<LoadResult>();
+		result->_fileName = file_name;
+		submit([result]()
+			{
+				result->_is_succeeded = result->_file.open(result->_fileName);
+				result->_file.prefetch();
+			},
+			[result, completion = std::move(completion)]()
+			{
+				completion(*result);
+			});
+	}
 
-			bool is_valid() const { return _name_length > 0; }
-			std::string get_name() const { return _XML->_text.substr(_name_at, _name_length); }
-			std::string get_value() const { return _XML->_text.substr(_value_at, _value_length); }
-			Attribute get_next_attribute() const { return get_node().get_attribute(_index_in_node + 1); }
+	uint32 FileLoadQueue::dispatch_completions()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_completionMutex);
+			_dispatchingCompletions.swap(_completions);
+		}
+		// Completions may submit more work, which lands in _completions and runs on the next dispatch.
+		const uint32 completionCount = static_cast<uint32>(_dispatchingCompletions.size());
+		for (Completion& completion : _dispatchingCompletions)
+		{
+			if (completion)
+			{
+				completion();
+			}
+		}
+		_dispatchingCompletions.clear();
+		_pendingCount.fetch_sub(completionCount, std::memory_order_acq_rel);
+		return completionCount;
+	}
 
-		private:
-			const Node& get_node() const { return _XML->get_node(_node_ID); }
-			const XML* _XML = nullptr;
-		};
-		struct Node
+	void FileLoadQueue::run_worker()
+	{
+		while (true)
 		{
-			friend XML;
+			Job job;
+			{
+				std::unique_lock<std::mutex> lock(_jobMutex);
+				_jobCondition.wait(lock, [this]() { return _is_stopping == true || _jobs.empty() == false; });
+				if (_is_stopping == true)
+				{
+					return;
+				}
+				job = std::move(_jobs.front());
+				_jobs.pop_front();
+			}
 
-			size_t _ID = 0;
-			size_t _parent_ID = 0;
-			size_t _index_in_parent_node = 0;
-			size_t _name_at = 0;
-			size_t _name_length = 0;
-			std::vector<size_t> _attribute_IDs;
-			std::vector<size_t> _child_node_IDs;
+			if (job._work)
+			{
+				job._work();
+			}
 
-			//std::string _debug_name;
+			{
+				std::lock_guard<std::mutex> lock(_completionMutex);
+				_completions.push_back(std::move(job._completion));
+			}
+			if (_completionNotifier)
+			{
+				_completionNotifier();
+			}
+		}
+	}
 
-			bool is_valid() const { return _name_length > 0; }
-			std::string get_name() const { return _XML->_text.substr(_name_at, _name_length); }
-			const Attribute& get_attribute(const size_t index) const { return _XML->get_attribute((index >= _attribute_IDs.size() ? INVALID_ID : _attribute_IDs[index])); }
-			const Node& get_child_node(const size_t index) const { return _XML->get_node((index >= _child_node_IDs.size() ? INVALID_ID : _child_node_IDs[index])); }
-			const Node& get_next_sibling() const { return _XML->get_node(_parent_ID).get_child_node(_index_in_parent_node + 1); }
+	void FileWatcher::watch(const std::string& file_name)
+	{
+		WatchedFile watchedFile;
+		watchedFile._fileName = file_name;
+		read_stamp(file_name, watchedFile._lastWriteTime, watchedFile._byteSize);
+		_watchedFiles.push_back(std::move(watchedFile));
+	}
 
-		private:
-			bool has_name() const { return _name_length > 0; }
-			const XML* _XML = nullptr;
-		};
-		bool parse(const std::string& text)
+	bool FileWatcher::start(const std::function<void()>& notifier)
+	{
+		if (_thread.joinable() == true)
 		{
-			_text = text;
-			if (check_validity() == false)
+			return false;
+		}
+
+		_notifier = notifier;
+		std::vector<std::string> directories;
+		for (const WatchedFile& watchedFile : _watchedFiles)
+		{
+			std::string directory = std::filesystem::path(watchedFile._fileName).parent_path().string();
+			if (directory.empty() == true)
 			{
-				return false;
+				directory = ".";
+			}
+			if (std::find(directories.begin(), directories.end(), directory) == directories.end())
+			{
+				directories.push_back(std::move(directory));
 			}
-
-			_at = 0;
-			_line = 1;
-			return parse_node(INVALID_ID);
 		}
-		const Node& get_root_node() const { return _nodes[0]; }
-		const Node& get_node(const size_t ID) const { return (ID >= _nodes.size() ? INVALID_NODE : _nodes[ID]); }
-		const Attribute& get_attribute(const size_t ID) const { return (ID >= _attributes.size() ? INVALID_ATTRIBUTE : _attributes[ID]); }
 
-	private:
-		bool advance_to_find(const char ch)
+#if defined(_WIN32)
+		for (const std::string& directory : directories)
 		{
-			const size_t length = _text.length();
-			while (_at < length && _text[_at] != ch)
+			const HANDLE changeHandle = ::FindFirstChangeNotificationA(directory.c_str(), FALSE, FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME);
+			if (changeHandle != INVALID_HANDLE_VALUE)
 			{
-				++_at;
+				_changeHandles.push_back(changeHandle);
 			}
-			return _text[_at] == ch;
 		}
-		bool parse_node(const size_t parent_node_ID)
+#else
+		_inotify = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		for (const std::string& directory : directories)
 		{
-			const size_t length = _text.length();
-			if (advance_to_find('<') == false)
+			if (_inotify >= 0)
 			{
-				return (_at == length);
+				::inotify_add_watch(_inotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
 			}
+		}
+#endif
 
-			if (_at + 1 < length && _text[_at + 1] == '/')
-			{
-				if (advance_to_find('>') == false)
-				{
-					return false;
-				}
+		_is_running.store(true, std::memory_order_release);
+		_thread = std::thread([this]() { run_watch_thread(); });
+		return true;
+	}
 
-				return parse_node(_nodes[parent_node_ID]._parent_ID);
-			}
+	void FileWatcher::stop()
+	{
+		if (_thread.joinable() == false)
+		{
+			return;
+		}
+
+		_is_running.store(false, std::memory_order_release);
+		_thread.join();
+#if defined(_WIN32)
+		for (const HANDLE changeHandle : _changeHandles)
+		{
+			::FindCloseChangeNotification(changeHandle);
+		}
+		_changeHandles.clear();
+#else
+		if (_inotify >= 0)
+		{
+			::close(_inotify);
+			_inotify = -1;
+		}
+#endif
+	}
+
+	bool FileWatcher::poll_changes(std::vector<std::string>& outChangedFileNames)
+	{
+		outChangedFileNames.clear();
+		std::lock_guard<std::mutex> lock(_changeMutex);
+		outChangedFileNames.swap(_changedFileNames);
+		return (outChangedFileNames.empty() == false);
+	}
+
+	void FileWatcher::read_stamp(const std::string& file_name, std::filesystem::file_time_type& outLastWriteTime, uintmax_t& outByteSize)
+	{
+		// A missing file gets a stamp no existing file has, so creating it is a change.
+		std::error_code errorCode;
+		outLastWriteTime = std::filesystem::last_write_time(file_name, errorCode);
+		if (errorCode)
+		{
+			outLastWriteTime = std::filesystem::file_time_type::min();
+		}
+		outByteSize = std::filesystem::file_size(file_name, errorCode);
+		if (errorCode)
+		{
+			outByteSize = UINTMAX_MAX;
+		}
+	}
 
-			const size_t node_name_at = _at + 1;
-			if (advance_to_find('>') == false)
+	void FileWatcher::check_files()
+	{
+		bool is_changed = false;
+		for (WatchedFile& watchedFile : _watchedFiles)
+		{
+			std::filesystem::file_time_type lastWriteTime;
+			uintmax_t byteSize = 0;
+			read_stamp(watchedFile._fileName, lastWriteTime, byteSize);
+			if (lastWriteTime == watchedFile._lastWriteTime && byteSize == watchedFile._byteSize)
 			{
-				return false;
+				continue;
 			}
 
-			const bool is_open_close_node = (_text[_at - 1] == '/');
-			const size_t node_ID = _nodes.size();
-			_nodes.push_back(Node());
-			_nodes.back()._XML = this;
-			_nodes.back()._ID = node_ID;
-			if (parent_node_ID != INVALID_ID)
+			watchedFile._lastWriteTime = lastWriteTime;
+			watchedFile._byteSize = byteSize;
+			if (byteSize == UINTMAX_MAX)
 			{
-				_nodes[parent_node_ID]._child_node_IDs.push_back(_nodes[node_ID]._ID);
-				_nodes[node_ID]._index_in_parent_node = _nodes[parent_node_ID]._child_node_IDs.size() - 1;
+				// Deleted, or replaced and not there yet; reported once it exists again.
+				continue;
 			}
-			_nodes[node_ID]._parent_ID = parent_node_ID;
-			_nodes[node_ID]._name_at = node_name_at;
 
-			for (size_t at = node_name_at; at < length; ++at)
+			std::lock_guard<std::mutex> lock(_changeMutex);
+			if (std::find(_changedFileNames.begin(), _changedFileNames.end(), watchedFile._fileName) == _changedFileNames.end())
 			{
-				if (_text[at] != ' ' && _text[at] != '/' && _text[at] != '>')
-				{
-					continue;
-				}
-
-				if (_nodes[node_ID].has_name() == false)
-				{
-					_nodes[node_ID]._name_length = at - node_name_at;
-
-					//_nodes[node_ID]._debug_name = _text.substr(node_name_at, _nodes[node_ID]._name_length);
-				}
-
-				if ((_text[at] == '/' && at + 1 < length && _text[at + 1] == '>') || _text[at] == '>')
-				{
-					// end
-					_at = at + 1;
-					return parse_node((is_open_close_node ? parent_node_ID : _nodes[node_ID]._ID));
-				}
-				else
-				{
-					// attributes
-					_at = at + 1;
-					parse_attribute(_nodes[node_ID]);
-				}
+				_changedFileNames.push_back(watchedFile._fileName);
 			}
-			return true;
+			is_changed = true;
 		}
-		bool parse_attribute(Node& node)
+		if (is_changed == true && _notifier)
 		{
-			_attributes.push_back(Attribute());
-
-			Attribute& attribute = _attributes.back();
-			attribute._XML = this;
-			attribute._ID = _attributes.size() - 1;
-			attribute._name_at = _at;
-
-			node._attribute_IDs.push_back(attribute._ID);
-			attribute._node_ID = node._ID;
-			attribute._index_in_node = node._attribute_IDs.size() - 1;
+			_notifier();
+		}
+	}
 
-			if (advance_to_find('=') == false)
+	void FileWatcher::run_watch_thread()
+	{
+		// Bounds how long stop() waits, and how often files are compared without notifications.
+		constexpr uint32 kWaitMs = 100;
+		while (_is_running.load(std::memory_order_acquire) == true)
+		{
+#if defined(_WIN32)
+			if (_changeHandles.empty() == true)
 			{
-				report_error("invalid attribute! '=' is needed.");
-				return false;
+				std::this_thread::sleep_for(std::chrono::milliseconds(kWaitMs));
+				check_files();
+				continue;
 			}
 
-			attribute._name_length = _at - attribute._name_at;
-			//attribute._debug_name = _text.substr(attribute._name_at, attribute._name_length);
-
-			if (_text[_at + 1] != '\"')
+			const DWORD handleCount = static_cast<DWORD>(_changeHandles.size());
+			const DWORD waitResult = ::WaitForMultipleObjects(handleCount, _changeHandles.data(), FALSE, kWaitMs);
+			if (waitResult >= WAIT_OBJECT_0 && waitResult < WAIT_OBJECT_0 + handleCount)
 			{
-				report_error("'\"' must be followed by '='.");
-				return false;
+				::FindNextChangeNotification(_changeHandles[waitResult - WAIT_OBJECT_0]);
+				check_files();
+			}
+#else
+			if (_inotify < 0)
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(kWaitMs));
+				check_files();
+				continue;
 			}
-			_at += 2;
-			attribute._value_at = _at;
 
-			if (advance_to_find('\"') == false)
+			pollfd pollFD{};
+			pollFD.fd = _inotify;
+			pollFD.events = POLLIN;
+			if (::poll(&pollFD, 1, kWaitMs) > 0)
 			{
-				report_error("closing '\"' is missing.");
-				return false;
+				// The events only say that something in the directories changed; the stamps say what.
+				char events[4096];
+				while (::read(_inotify, events, sizeof(events)) > 0) { __noop; }
+				check_files();
 			}
-			attribute._value_length = _at - attribute._value_at;
-			//attribute._debug_value = _text.substr(attribute._value_at, attribute._value_length);
-			return true;
+#endif
 		}
+	}
 
-	private:
-		bool check_validity() const
+#if defined(_WIN32)
+	void ShaderReloader::push(Shader& shader, const std::string& file_name, const ShaderType& shaderType, const char* shaderIdentifier, const char* entryPoint, const char* target, const ShaderHeaderSet* const shaderHeaderSet)
+	{
+		Entry entry;
+		entry._shader = &shader;
+		entry._fileName = file_name;
+		entry._shaderType = shaderType;
+		entry._identifier = (shaderIdentifier == nullptr ? "" : shaderIdentifier);
+		entry._entryPoint = (entryPoint == nullptr ? "" : entryPoint);
+		entry._target = (target == nullptr ? "" : target);
+		entry._shaderHeaderSet = shaderHeaderSet;
+		_entries.push_back(std::move(entry));
+	}
+
+	uint32 ShaderReloader::reload(Renderer& renderer, FileLoadQueue& fileLoadQueue, const std::string& file_name, const std::function<void()>& beforeSwap)
+	{
+		struct Job
+		{
+			std::string _identifier;
+			std::string _entryPoint;
+			std::string _target;
+			std::string _sourceCode;
+			uint64 _sourceHash = 0;
+			bool _is_unchanged = false;
+			ShaderCompileResult _result;
+		};
+
+		uint32 reloadCount = 0;
+		for (uint32 entryIndex = 0; entryIndex < static_cast<uint32>(_entries.size()); ++entryIndex)
 		{
-			constexpr size_t CMP_COUNT = 4;
-			const char cmps[CMP_COUNT] = { ' ', '<', '>', '/' };
-			const size_t length = _text.length();
-			char message[] = "character[ ] is repeated!";
-			for (size_t at = 0; at < length; ++at)
+			Entry& entry = _entries[entryIndex];
+			if (entry._fileName != file_name)
 			{
-				for (size_t cmp_index = 0; cmp_index < CMP_COUNT; cmp_index++)
+				continue;
+			}
+
+			const uint32 generation = ++entry._generation;
+			const uint64 liveSourceHash = entry._sourceHash;
+			const ShaderHeaderSet* const shaderHeaderSet = entry._shaderHeaderSet;
+			std::shared_ptr<Job> job = std::make_shared<Job>();
+			job->_identifier = entry._identifier;
+			job->_entryPoint = entry._entryPoint;
+			job->_target = entry._target;
+			fileLoadQueue.submit([job, shaderHeaderSet, liveSourceHash, file_name, &renderer]()
 				{
-					if (_text[at] == cmps[cmp_index])
+					if (read_file(file_name, job->_sourceCode) == false)
 					{
-						if (at + 1 < length && _text[at + 1] == cmps[cmp_index])
-						{
-							message[10] = cmps[cmp_index];
-							report_error(message, at);
-							return false;
-						}
+						job->_is_unchanged = true;
+						return;
+					}
+					job->_sourceHash = compute_hash_FNV1a(job->_sourceCode.data(), job->_sourceCode.length());
+					job->_is_unchanged = (job->_sourceHash == liveSourceHash);
+					if (job->_is_unchanged == false)
+					{
+						ShaderCompileRequest request;
+						request._sourceCode = job->_sourceCode.c_str();
+						request._identifier = job->_identifier.c_str();
+						request._entryPoint = job->_entryPoint.c_str();
+						request._target = job->_target.c_str();
+						request._flags = kShaderCompileFlags;
+						request._shaderHeaderSet = shaderHeaderSet;
+						compile_shaders(renderer.get_ShaderCompiler(), &renderer.get_ShaderCache(), &request, &job->_result, 1);
+					}
+				},
+				[this, job, entryIndex, generation, beforeSwap, &renderer]()
+				{
+					Entry& entry = _entries[entryIndex];
+					if (job->_is_unchanged == true || entry._generation != generation)
+					{
+						return;
+					}
+					if (job->_result._is_succeeded == false)
+					{
+						// Expected while editing, so this does not break into the debugger like MINT_LOG_ERROR.
+						std::cout << "Shader reload failed: " << entry._identifier << std::endl << job->_result._errorMessage << std::endl;
+						return;
 					}
-				}
-			}
-			return true;
-		}
-		void report_error(const std::string& error) const { _error = error; __report_where(_at); }
-		void report_error(const std::string& error, const size_t at) const { _error = error; __report_where(at); }
-		void __report_where(const size_t at) const { _error += " at["; _error += std::to_string(at); _error += "] line["; _error += std::to_string(_line); _error += "]"; }
-
-	private:
-		std::string _text;
-		std::vector<Node> _nodes;
-		std::vector<Attribute> _attributes;
-		mutable std::string _error;
-		size_t _at = 0;
-		size_t _line = 0;
 
-	private:
-		const Node INVALID_NODE;
-		const Attribute INVALID_ATTRIBUTE;
-	};
+					Shader reloadedShader;
+					if (reloadedShader.create_from_bytecode(renderer, entry._shaderType, job->_result._bytecode) == false)
+					{
+						return;
+					}
+					if (beforeSwap)
+					{
+						beforeSwap();
+					}
+					*entry._shader = std::move(reloadedShader);
+					entry._sourceHash = job->_sourceHash;
+				});
+			++reloadCount;
+		}
+		return reloadCount;
+	}
+#endif
 #pragma endregion
 
 
 #pragma region Sample Code
+#if defined(_WIN32)
 	const char kSampleShaderHeaderCode_StreamData[] =
 		R"(
 		struct SAMPLE_VS_INPUT
@@ -2114,5 +9263,6 @@ namespace SimpleRenderer
 		}
 		return 0;
 	}
+#endif
 #pragma endregion
 }
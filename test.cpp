@@ -446,12 +446,19 @@ int main()
 	constexpr float2 kScreenSize = float2(800, 600);
 
 	Renderer renderer{ Renderer(kScreenSize, Color(0, 0.5f, 1, 1)) };
+	// Only draw when input arrives; otherwise block, redrawing at least once a second.
+	renderer.set_on_demand_rendering(true);
+	renderer.set_max_idle_interval_us(1000000);
 
 	ShaderHeaderSet shaderHeaderSet;
 	shaderHeaderSet.push_shader_header("StreamData", kShaderHeaderCode_StreamData);
 
 	Shader vertexShader0;
-	vertexShader0.create(renderer, kVertexShaderCode, ShaderType::VertexShader, "VertexShader0", "main", "vs_5_0", &shaderHeaderSet);
+	Shader pixelShader0;
+	ShaderCompileBatch shaderCompileBatch;
+	shaderCompileBatch.push(vertexShader0, kVertexShaderCode, ShaderType::VertexShader, "VertexShader0", "main", "vs_5_0", &shaderHeaderSet);
+	shaderCompileBatch.push(pixelShader0, kPixelShaderCode, ShaderType::PixelShader, "PixelShader0", "main", "ps_5_0", &shaderHeaderSet);
+	shaderCompileBatch.compile(renderer);
 
 	ShaderInputLayout shaderInputLayout;
 	shaderInputLayout.push_InputElement(ShaderInputLayout::create_InputElement_float4("POSITION", 0));
@@ -459,16 +466,56 @@ int main()
 	shaderInputLayout.push_InputElement(ShaderInputLayout::create_InputElement_float2("TEXCOORD", 0));
 	shaderInputLayout.create(renderer, vertexShader0);
 
-	Shader pixelShader0;
-	pixelShader0.create(renderer, kPixelShaderCode, ShaderType::PixelShader, "PixelShader0", "main", "ps_5_0", &shaderHeaderSet);
-
 	Resource vscbMatrices;
 	CB_MATRICES cb_matrices;
 	cb_matrices._projectionMatrix.make_pixel_coordinates_projection_matrix(kScreenSize);
 	//cb_matrices._projectionMatrix.make_perspective_projection_matrix(kPi * 0.25f, 0.001f, 1000.0f, kScreenSize.x / kScreenSize.y);
 	vscbMatrices.create_buffer(renderer, ResourceType::ConstantBuffer, &cb_matrices, sizeof(CB_MATRICES), 1);
 
+	// Sprite benchmark: a disc and a ring packed into one atlas, drawn as 100k sprites.
+	constexpr uint32 kBenchmarkSpriteCount = 100000;
+	constexpr uint32 kBenchmarkSpriteColumnCount = 400;
+	constexpr uint32 kSpriteImageSize = 32;
+	TextureAtlas sprite_atlas;
+	sprite_atlas.init(TextureFormat::R8G8B8A8_UNORM, 128, 128);
+	const AtlasRegion sprite_regions[2]{ sprite_atlas.allocate(kSpriteImageSize, kSpriteImageSize), sprite_atlas.allocate(kSpriteImageSize, kSpriteImageSize) };
+	for (uint32 region_index = 0; region_index < 2; ++region_index)
+	{
+		uint32 texels[kSpriteImageSize * kSpriteImageSize]{};
+		for (uint32 y = 0; y < kSpriteImageSize; ++y)
+		{
+			for (uint32 x = 0; x < kSpriteImageSize; ++x)
+			{
+				const float2 offset = float2(x + 0.5f, y + 0.5f) - float2(kSpriteImageSize * 0.5f);
+				const float distance = offset.length() / (kSpriteImageSize * 0.5f);
+				const bool is_inside = (region_index == 0 ? distance <= 1.0f : (distance <= 1.0f && distance >= 0.6f));
+				texels[y * kSpriteImageSize + x] = (is_inside ? 0xFFFFFFFF : 0x00FFFFFF);
+			}
+		}
+		sprite_atlas.write(sprite_regions[region_index], texels);
+	}
+	sprite_atlas.flush(renderer);
+	std::vector<Sprite> benchmark_sprites(kBenchmarkSpriteCount);
+	for (uint32 sprite_index = 0; sprite_index < kBenchmarkSpriteCount; ++sprite_index)
+	{
+		Sprite& sprite = benchmark_sprites[sprite_index];
+		sprite._position = float2((sprite_index % kBenchmarkSpriteColumnCount) * 2.0f, (sprite_index / kBenchmarkSpriteColumnCount) * 2.4f);
+		sprite._size = float2(6.0f);
+		sprite._color = Color((sprite_index % 7) / 7.0f, (sprite_index % 11) / 11.0f, 1.0f, 0.25f);
+		sprite.set_AtlasRegion(sprite_regions[sprite_index % 2]);
+	}
+	bool is_sprite_benchmark_enabled = false;
+
+	// Labels are retained; update_TextRun() only rebuilds the ones whose text, color or position changed.
+	TextRun text_runs[16];
+	for (TextRun& text_run : text_runs)
+	{
+		text_run = renderer.create_TextRun(32);
+	}
+
 	bool is_shapes_loaded = false;
+	std::string shape_names[2];
+	uint64 shape_hashes[2]{};
 	float2 positions_source[2]{};
 	float2 positions[2]{};
 	float2 positions_prev[2]{};
@@ -477,12 +524,28 @@ int main()
 	GJK::Shape2D shape_sources[2];
 	GJK::Shape2D shapes[2];
 	GJK::Shape2D shape_Minkowski;
-	Resource vertexBuffer;
-	vertexBuffer._type = ResourceType::VertexBuffer;
-	Resource indexBuffer;
-	indexBuffer._type = ResourceType::IndexBuffer;
-	std::vector<VS_INPUT> vertices;
-	std::vector<uint32> indices;
+	bool is_shapes_loading = false;
+	FileLoadQueue file_load_queue;
+	file_load_queue.set_completion_notifier([&renderer]() { renderer.invalidate(); });
+	// Editing shapes.txt, or dropping VertexShader0.hlsl / PixelShader0.hlsl next to the executable, applies while running.
+	bool is_shapes_changed = false;
+	ShaderReloader shader_reloader;
+	shader_reloader.push(vertexShader0, "VertexShader0.hlsl", ShaderType::VertexShader, "VertexShader0", "main", "vs_5_0", &shaderHeaderSet);
+	shader_reloader.push(pixelShader0, "PixelShader0.hlsl", ShaderType::PixelShader, "PixelShader0", "main", "ps_5_0", &shaderHeaderSet);
+	FileWatcher file_watcher;
+	file_watcher.watch("shapes.txt");
+	file_watcher.watch("VertexShader0.hlsl");
+	file_watcher.watch("PixelShader0.hlsl");
+	file_watcher.start([&renderer]() { renderer.invalidate(); });
+	std::vector<std::string> changed_file_names;
+	// With the render thread, frame N is drawn and presented while frame N + 1 is being simulated.
+	constexpr bool kUseRenderThread = true;
+	FramePacketPipeline<VS_INPUT> frame_packet_pipeline;
+	if (kUseRenderThread)
+	{
+		frame_packet_pipeline.start([&renderer](const FramePacket<VS_INPUT>& packet) { renderer.execute_FramePacket(packet); });
+	}
+	FramePacket<VS_INPUT> immediate_frame_packet;
 	uint32 mode = 0;
 	uint32 selection = 0;
 	float2 initial_direction = float2(1, 0);
@@ -495,107 +558,145 @@ int main()
 	const float2 minkowski_shape_offset = kScreenSize * 0.5f + float2(100, 100);
 	while (renderer.is_running())
 	{
-		if (renderer.get_keyboard_char() == 'w')
+		if (renderer.is_frame_needed() == false)
 		{
-			++GJK::g_max_step;
+			continue;
 		}
-		else if (renderer.get_keyboard_char() == 'q')
+
+		file_load_queue.dispatch_completions();
+
+		if (file_watcher.poll_changes(changed_file_names))
 		{
-			if (GJK::g_max_step > 0)
+			for (const std::string& changed_file_name : changed_file_names)
 			{
-				--GJK::g_max_step;
+				if (changed_file_name == "shapes.txt")
+				{
+					is_shapes_changed = true;
+					continue;
+				}
+
+				// Packets still in flight on the render thread refer to the live shader.
+				shader_reloader.reload(renderer, file_load_queue, changed_file_name, [&]()
+					{
+						if (kUseRenderThread)
+						{
+							frame_packet_pipeline.wait_until_idle();
+						}
+					});
 			}
 		}
-		else if (renderer.get_keyboard_char() == 'e')
-		{
-			mode = 0;
-		}
-		else if (renderer.get_keyboard_char() == 'r')
-		{
-			mode = 1;
-		}
-		else if (renderer.get_keyboard_char() == '1')
-		{
-			selection = 0;
-		}
-		else if (renderer.get_keyboard_char() == '2')
-		{
-			selection = 1;
-		}
-		else if (renderer.get_keyboard_char() == '3')
-		{
-			selection = 2;
-		}
-		else if (renderer.get_keyboard_char() == '0')
+
+		for (uint32 char_index = 0; char_index < renderer.get_keyboard_char_count(); ++char_index)
 		{
-			if (mode == 0)
+			const char ch = renderer.get_keyboard_chars()[char_index];
+			if (ch == 'w')
 			{
-				if (selection <= 1)
+				++GJK::g_max_step;
+			}
+			else if (ch == 'q')
+			{
+				if (GJK::g_max_step > 0)
 				{
-					positions[selection] = positions_prev[selection] = positions_source[selection];
+					--GJK::g_max_step;
 				}
 			}
-			else
+			else if (ch == 'e')
+			{
+				mode = 0;
+			}
+			else if (ch == 'r')
+			{
+				mode = 1;
+			}
+			else if (ch == 'b')
+			{
+				is_sprite_benchmark_enabled = (is_sprite_benchmark_enabled == false);
+			}
+			else if (ch == '1')
 			{
-				thetas[selection] = thetas_prev[selection] = 0.0f;
+				selection = 0;
+			}
+			else if (ch == '2')
+			{
+				selection = 1;
+			}
+			else if (ch == '3')
+			{
+				selection = 2;
+			}
+			else if (ch == '0')
+			{
+				if (mode == 0)
+				{
+					if (selection <= 1)
+					{
+						positions[selection] = positions_prev[selection] = positions_source[selection];
+					}
+				}
+				else
+				{
+					thetas[selection] = thetas_prev[selection] = 0.0f;
+				}
 			}
 		}
 
-		if (renderer.get_keyboard_up_key() == Renderer::Key::Enter || is_shapes_loaded == false)
+		const bool is_full_reload = (renderer.get_keyboard_up_key() == Renderer::Key::Enter || is_shapes_loaded == false);
+		if ((is_full_reload || is_shapes_changed) && is_shapes_loading == false)
 		{
-			std::string shapes_content;
-			read_file("shapes.txt", shapes_content);
-
-			XML xml;
-			if (xml.parse(shapes_content) == true)
-			{
-				uint32 shape_index = 0;
-				const XML::Node& root_node = xml.get_root_node();
-				for (const auto& root_child_node_ID : root_node._child_node_IDs)
+			// Compiling and mapping happen on a loader thread; frames keep going with the current shapes until the completion runs.
+			is_shapes_loading = true;
+			is_shapes_changed = false;
+			std::shared_ptr<BinaryScene> scene = std::make_shared<BinaryScene>();
+			file_load_queue.submit([scene]()
+				{
+					// shapes.txt stays the authoring format; it is compiled into shapes.bin whenever it is newer.
+					std::error_code error_code;
+					const std::filesystem::file_time_type source_time = std::filesystem::last_write_time("shapes.txt", error_code);
+					const std::filesystem::file_time_type binary_time = std::filesystem::last_write_time("shapes.bin", error_code);
+					if (error_code || binary_time < source_time)
+					{
+						compile_BinaryScene_file("shapes.txt", "shapes.bin");
+					}
+					scene->load("shapes.bin");
+				},
+				[&, scene, is_full_reload]()
 				{
-					const XML::Node& shape_node = xml.get_node(root_child_node_ID);
-					for (const auto& shape_child_node_ID : shape_node._child_node_IDs)
+					// Enter reloads everything by index. A file change only rebuilds the slots whose shape, found by name,
+					// hashes differently, so the other shape keeps its position and rotation.
+					const uint32 shape_count = (std::min)(scene->get_shape_count(), 2u);
+					for (uint32 slot_index = 0; slot_index < shape_count; ++slot_index)
 					{
-						const XML::Node& shape_child_node = xml.get_node(shape_child_node_ID);
-						if (shape_child_node.get_name() == "center")
+						const uint32 shape_index = (is_full_reload ? slot_index : scene->find_shape(shape_names[slot_index]));
+						if (shape_index == UINT32_MAX)
 						{
-							XML::Attribute attribute = shape_child_node.get_attribute(0);
-							const float x = std::stof(attribute.get_value());
-							attribute = attribute.get_next_attribute();
-							const float y = std::stof(attribute.get_value());
-
-							positions_source[shape_index] = float2(x, y);
+							continue;
 						}
-						else if (shape_child_node.get_name() == "points")
-						{
-							shape_sources[shape_index]._points.clear();
-
-							for (XML::Node point_node = shape_child_node.get_child_node(0); point_node.is_valid(); point_node = point_node.get_next_sibling())
-							{
-								XML::Attribute attribute = point_node.get_attribute(0);
-								const float x = std::stof(attribute.get_value());
-								attribute = attribute.get_next_attribute();
-								const float y = std::stof(attribute.get_value());
 
-								shape_sources[shape_index]._points.push_back(float2(x, y));
-							}
+						const uint64 shape_hash = scene->compute_shape_hash(shape_index);
+						if (is_full_reload == false && shape_hash == shape_hashes[slot_index])
+						{
+							continue;
 						}
-					}
 
-					++shape_index;
-				}
-			}
-
-			positions[0] = positions_prev[0] = positions_source[0];
-			positions[1] = positions_prev[1] = positions_source[1];
+						const BinarySceneShape& shape = scene->get_shape(shape_index);
+						shape_names[slot_index] = scene->get_shape_name(shape_index);
+						shape_hashes[slot_index] = shape_hash;
+						positions_source[slot_index] = shape._center;
 
-			shape_sources[0]._center = positions[0];
-			shape_sources[1]._center = positions[1];
+						shape_sources[slot_index]._points.clear();
+						for (uint32 point_index = shape._firstPoint; point_index < shape._firstPoint + shape._pointCount; ++point_index)
+						{
+							shape_sources[slot_index]._points.push_back(scene->get_point(point_index));
+						}
 
-			shapes[0] = shape_sources[0];
-			shapes[1] = shape_sources[1];
+						positions[slot_index] = positions_prev[slot_index] = positions_source[slot_index];
+						shape_sources[slot_index]._center = positions[slot_index];
+						shapes[slot_index] = shape_sources[slot_index];
+					}
 
-			is_shapes_loaded = true;
+					is_shapes_loading = false;
+					is_shapes_loaded = true;
+				});
 		}
 
 		if (renderer.is_mouse_L_button_pressed())
@@ -648,11 +749,12 @@ int main()
 		shape_Minkowski.make_Minkowski_difference_shape(shapes[0], shapes[1]);
 		shape_Minkowski._center = minkowski_space_origin + minkowski_shape_center_in_minkowski_space;
 
-		renderer.begin_rendering();
+		FramePacket<VS_INPUT>& frame_packet = (kUseRenderThread ? frame_packet_pipeline.acquire_packet() : immediate_frame_packet);
+		frame_packet.clear();
 		{
 			{
-				vertices.clear();
-				indices.clear();
+				std::vector<VS_INPUT>& vertices = frame_packet._vertices;
+				std::vector<uint32>& indices = frame_packet._indices;
 
 				GJK::DebugData debugData;
 				const bool intersected = GJK::intersects(shapes[0], shapes[1], initial_direction, &debugData);
@@ -694,31 +796,53 @@ int main()
 					MeshGenerator<VS_INPUT>::push_2D_arrow(white_color, minkowski_space_origin + float2(0, 200), minkowski_space_origin - float2(0, 200), 1.0f, 0.0625f, 4.0f, vertices, indices);
 				}
 
-				vertexBuffer.update(renderer, &vertices[0], sizeof(VS_INPUT), (uint32)vertices.size());
-				indexBuffer.update(renderer, &indices[0], sizeof(uint32), (uint32)indices.size());
+				frame_packet.push_draw(shaderInputLayout, vertexShader0, pixelShader0, &vscbMatrices);
 			}
 
-			renderer.bind_Shader(vertexShader0);
-			renderer.bind_ShaderInputLayout(shaderInputLayout);
-			renderer.bind_Shader(pixelShader0);
-			renderer.bind_input(vertexBuffer, 0);
-			renderer.bind_input(indexBuffer, 0);
-			renderer.bind_ShaderResource(ShaderType::VertexShader, vscbMatrices, 0);
-			renderer.draw_indexed((uint32)indices.size());
-
-			renderer.draw_text(Color(0, 1, 1, 1), "GJK Algorithm Test", float2(10, 10));
-			renderer.draw_text((selection == 0 ? yellow_color : white_color), "1: shape A", float2(10, 40));
-			renderer.draw_text((selection == 1 ? yellow_color : white_color), "2: shape B", float2(10, 60));
-			renderer.draw_text((selection == 2 ? yellow_color : white_color), "3: initial direction", float2(10, 80));
-			renderer.draw_text((selection == 2 ? yellow_color : white_color), "0: reset", float2(10, 100));
-
-			renderer.draw_text((mode == 0 ? yellow_color : white_color), "e: translate", float2(10, 140));
-			renderer.draw_text((mode == 1 ? yellow_color : white_color), "r: rotate", float2(10, 160));
-			renderer.draw_text(white_color, "current gjk_max_step: " + std::to_string(GJK::g_max_step), float2(10, 180));
-			renderer.draw_text(white_color, "q: --gjk_max_step", float2(10, 200));
-			renderer.draw_text(white_color, "w: ++gjk_max_step", float2(10, 220));
+			if (is_sprite_benchmark_enabled)
+			{
+				const float time_s = static_cast<float>(get_time_us() % 60000000) * 0.000001f;
+				for (uint32 sprite_index = 0; sprite_index < kBenchmarkSpriteCount; ++sprite_index)
+				{
+					benchmark_sprites[sprite_index]._rotationAngle = time_s + sprite_index * 0.001f;
+				}
+				renderer.draw_sprites(sprite_atlas.get_texture(), &benchmark_sprites[0], kBenchmarkSpriteCount, BlendMode::Additive);
+				// Keep frames coming while benchmarking, even in on-demand mode.
+				renderer.invalidate();
+			}
+			renderer.move_sprites_to(frame_packet);
+
+			renderer.update_TextRun(text_runs[0], Color(0, 1, 1, 1), "GJK Algorithm Test", float2(10, 10));
+			renderer.update_TextRun(text_runs[1], (selection == 0 ? yellow_color : white_color), "1: shape A", float2(10, 40));
+			renderer.update_TextRun(text_runs[2], (selection == 1 ? yellow_color : white_color), "2: shape B", float2(10, 60));
+			renderer.update_TextRun(text_runs[3], (selection == 2 ? yellow_color : white_color), "3: initial direction", float2(10, 80));
+			renderer.update_TextRun(text_runs[4], (selection == 2 ? yellow_color : white_color), "0: reset", float2(10, 100));
+
+			renderer.update_TextRun(text_runs[5], (mode == 0 ? yellow_color : white_color), "e: translate", float2(10, 140));
+			renderer.update_TextRun(text_runs[6], (mode == 1 ? yellow_color : white_color), "r: rotate", float2(10, 160));
+			renderer.update_TextRun_format(text_runs[7], white_color, float2(10, 180), "current gjk_max_step: ", GJK::g_max_step);
+			renderer.update_TextRun(text_runs[8], white_color, "q: --gjk_max_step", float2(10, 200));
+			renderer.update_TextRun(text_runs[9], white_color, "w: ++gjk_max_step", float2(10, 220));
+
+			renderer.update_TextRun(text_runs[10], white_color, "ENTER: load shapes from file", float2(10, 260));
+			renderer.update_TextRun(text_runs[11], (is_sprite_benchmark_enabled ? yellow_color : white_color), "b: sprite benchmark", float2(10, 280));
+			if (is_sprite_benchmark_enabled)
+			{
+				renderer.update_TextRun_format(text_runs[12], dark_gray_color, float2(10, 500), "sprites: ", frame_packet._spriteBatch.get_instances().size(), " draw calls: ", frame_packet._spriteBatch.get_runs().size());
+			}
+			else
+			{
+				renderer.update_TextRun(text_runs[12], dark_gray_color, "", float2(10, 500));
+			}
 
-			renderer.draw_text(white_color, "ENTER: load shapes from file", float2(10, 260));
+			const FrameSchedulerStatistics& scheduler_statistics = renderer.get_FrameScheduler_statistics();
+			renderer.update_TextRun_format(text_runs[13], dark_gray_color, float2(10, 520), "frames drawn: ", scheduler_statistics._renderedFrameCount, " skipped: ", scheduler_statistics._skippedFrameCount, " cpu: ", static_cast<int>(scheduler_statistics._lastIntervalCpuUsage * 100.0f), "%");
+			if (kUseRenderThread)
+			{
+				const FramePipelineStatistics pipeline_statistics = frame_packet_pipeline.get_statistics();
+				renderer.update_TextRun_format(text_runs[14], dark_gray_color, float2(10, 540), "render queue depth: ", pipeline_statistics._queueDepth, " / max ", pipeline_statistics._maxQueueDepth);
+				renderer.update_TextRun_format(text_runs[15], dark_gray_color, float2(10, 560), "wait us game: ", pipeline_statistics._lastGameThreadWaitUs, " render: ", pipeline_statistics._lastRenderThreadWaitUs);
+			}
 
 			//char buffer[8]{};
 			//for (size_t i = 0; i < shapeMinkowski._points.size(); ++i)
@@ -728,7 +852,16 @@ int main()
 			//    renderer.draw_text(buffer, shapeMinkowski._center + point);
 			//}
 		}
-		renderer.end_rendering();
+		renderer.move_text_to(frame_packet);
+		if (kUseRenderThread)
+		{
+			frame_packet_pipeline.submit_packet(frame_packet);
+		}
+		else
+		{
+			renderer.execute_FramePacket(frame_packet);
+		}
 	}
+	frame_packet_pipeline.stop();
 	return 0;
 }
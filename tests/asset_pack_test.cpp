@@ -0,0 +1,313 @@
+#include "test_common.h"
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+using namespace SimpleRenderer;
+
+namespace
+{
+	std::vector<byte> make_random_bytes(const size_t byteSize, const uint32 seed)
+	{
+		std::mt19937 random(seed);
+		std::vector<byte> bytes(byteSize);
+		for (byte& value : bytes)
+		{
+			value = static_cast<byte>(random());
+		}
+		return bytes;
+	}
+
+	std::vector<byte> make_text_bytes(const size_t byteSize)
+	{
+		std::string text;
+		for (uint32 index = 0; text.length() < byteSize; ++index)
+		{
+			text += "<shape name=\"s" + std::to_string(index) + "\"><center x=\"" + std::to_string(index % 97) + "\" y=\"2\"/></shape>\n";
+		}
+		return std::vector<byte>(text.begin(), text.begin() + byteSize);
+	}
+
+	size_t check_round_trip(const std::vector<byte>& data)
+	{
+		std::vector<byte> compressed(get_LZ_compress_bound(data.size()));
+		const size_t compressedByteSize = compress_LZ(data.data(), data.size(), compressed.data());
+		TEST_CHECK(compressedByteSize <= compressed.size());
+
+		std::vector<byte> decompressed(data.size());
+		TEST_CHECK(decompress_LZ(compressed.data(), compressedByteSize, decompressed.data(), decompressed.size()) == true);
+		TEST_CHECK(decompressed == data);
+
+		// The decompressed size is part of the contract: one byte more or less is an error, not a partial result.
+		decompressed.resize(data.size() + 1);
+		TEST_CHECK(decompress_LZ(compressed.data(), compressedByteSize, decompressed.data(), decompressed.size()) == false);
+		if (data.empty() == false)
+		{
+			decompressed.resize(data.size() - 1);
+			TEST_CHECK(decompress_LZ(compressed.data(), compressedByteSize, decompressed.data(), decompressed.size()) == false);
+		}
+		return compressedByteSize;
+	}
+
+	void test_codec()
+	{
+		TEST_CHECK(check_round_trip({}) == 1);
+		TEST_CHECK(check_round_trip({ 7 }) == 2);
+		check_round_trip({ 1, 2, 3 });
+		check_round_trip({ 1, 2, 3, 4, 1, 2, 3, 4 });
+
+		const size_t kByteSize = 1 << 20;
+		const std::vector<byte> random_bytes = make_random_bytes(kByteSize, 1);
+		const size_t random_byte_size = check_round_trip(random_bytes);
+		TEST_CHECK(random_byte_size <= get_LZ_compress_bound(kByteSize));
+
+		const size_t zero_byte_size = check_round_trip(std::vector<byte>(kByteSize, 0));
+		TEST_CHECK(zero_byte_size < kByteSize / 200);
+
+		std::vector<byte> pattern(kByteSize);
+		for (size_t at = 0; at < kByteSize; ++at)
+		{
+			pattern[at] = static_cast<byte>("abcdefg"[at % 7]);
+		}
+		TEST_CHECK(check_round_trip(pattern) < kByteSize / 200);
+
+		const size_t text_byte_size = check_round_trip(make_text_bytes(kByteSize));
+		TEST_CHECK(text_byte_size < kByteSize / 2);
+
+		// Matches longer than the 64 KB window and literal runs longer than 255 bytes, side by side.
+		std::vector<byte> mixed = make_random_bytes(70000, 2);
+		mixed.insert(mixed.end(), 70000, 0xAB);
+		mixed.insert(mixed.end(), mixed.begin(), mixed.begin() + 1000);
+		check_round_trip(mixed);
+		std::printf("codec: 1 MB of random bytes -> %zu, zeros -> %zu, text -> %zu\n", random_byte_size, zero_byte_size, text_byte_size);
+	}
+
+	void test_codec_corruption(const uint32 iteration_count)
+	{
+		const std::vector<byte> data = make_text_bytes(4096);
+		std::vector<byte> compressed(get_LZ_compress_bound(data.size()));
+		compressed.resize(compress_LZ(data.data(), data.size(), compressed.data()));
+
+		// A truncated stream fails, unless only the empty final sequence is cut off, which leaves the data complete.
+		std::vector<byte> decompressed(data.size());
+		uint32 decoded_count = 0;
+		for (size_t byteSize = 0; byteSize < compressed.size(); ++byteSize)
+		{
+			if (decompress_LZ(compressed.data(), byteSize, decompressed.data(), decompressed.size()) == true)
+			{
+				TEST_CHECK(decompressed == data);
+				++decoded_count;
+			}
+		}
+		TEST_CHECK(decoded_count <= 1);
+
+		// Corrupt streams may decode to garbage, but must never touch memory outside the buffers (run with SANITIZE=1).
+		std::mt19937 random(3);
+		for (uint32 iteration = 0; iteration < iteration_count; ++iteration)
+		{
+			std::vector<byte> corrupted = compressed;
+			const uint32 flip_count = 1 + random() % 4;
+			for (uint32 flip = 0; flip < flip_count; ++flip)
+			{
+				corrupted[random() % corrupted.size()] = static_cast<byte>(random());
+			}
+			decompress_LZ(corrupted.data(), corrupted.size(), decompressed.data(), decompressed.size());
+		}
+	}
+
+	struct TestAsset
+	{
+		std::string _name;
+		std::vector<byte> _data;
+		bool _compress = true;
+	};
+
+	std::vector<TestAsset> make_test_assets()
+	{
+		std::vector<TestAsset> assets;
+		assets.push_back(TestAsset{ "text", make_text_bytes(10000), true });
+		assets.push_back(TestAsset{ "raw", make_text_bytes(5000), false });
+		assets.push_back(TestAsset{ "random", make_random_bytes(3000, 4), true });
+		assets.push_back(TestAsset{ "empty", {}, true });
+		assets.push_back(TestAsset{ "chunk", make_text_bytes(1024), true });
+		assets.push_back(TestAsset{ "scenes/level1.bin", std::vector<byte>(20000, 3), true });
+		return assets;
+	}
+
+	bool write_bytes(const std::string& file_name, const std::string& bytes)
+	{
+		std::ofstream ofs(file_name, std::ios_base::binary | std::ios_base::trunc);
+		ofs.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+		return ofs.good();
+	}
+
+	void test_pack(const std::string& file_name)
+	{
+		const std::vector<TestAsset> assets = make_test_assets();
+		AssetPackBuilder builder(1024);
+		for (const TestAsset& asset : assets)
+		{
+			builder.add(asset._name, asset._data.data(), asset._data.size(), asset._compress);
+		}
+		TEST_CHECK(builder.write(file_name) == true);
+
+		AssetPack assetPack;
+		TEST_CHECK(assetPack.open(file_name) == true);
+		TEST_CHECK(assetPack.get_asset_count() == assets.size());
+		TEST_CHECK(assetPack.find("missing") == AssetPack::kInvalidIndex);
+		TEST_CHECK(assetPack.find("tex") == AssetPack::kInvalidIndex);
+		for (const TestAsset& asset : assets)
+		{
+			const uint32 index = assetPack.find(asset._name);
+			TEST_CHECK(index != AssetPack::kInvalidIndex);
+			TEST_CHECK(assetPack.get_asset_name(index) == asset._name);
+			TEST_CHECK(assetPack.get_asset_byte_size(index) == asset._data.size());
+
+			std::vector<byte> data;
+			TEST_CHECK(assetPack.read(index, data) == true);
+			TEST_CHECK(data == asset._data);
+
+			// Uncompressed assets, and assets none of whose chunks shrank, can be viewed in place, aligned.
+			std::string_view view;
+			const bool is_viewable = assetPack.get_view(index, view);
+			TEST_CHECK(is_viewable == (asset._compress == false || asset._name == "random" || asset._name == "empty"));
+			if (is_viewable == true)
+			{
+				TEST_CHECK(view == std::string_view(reinterpret_cast<const char*>(asset._data.data()), asset._data.size()));
+				TEST_CHECK(view.empty() == true || reinterpret_cast<uintptr_t>(view.data()) % 16 == 0);
+			}
+		}
+
+		// A pack without assets is valid too.
+		AssetPackBuilder emptyBuilder;
+		TEST_CHECK(emptyBuilder.write(file_name + ".empty") == true);
+		TEST_CHECK(assetPack.open(file_name + ".empty") == true);
+		TEST_CHECK(assetPack.get_asset_count() == 0);
+		TEST_CHECK(assetPack.find("text") == AssetPack::kInvalidIndex);
+		assetPack.close();
+	}
+
+	template<typename T>
+	T* at(std::string& bytes, const uint64 offset)
+	{
+		return reinterpret_cast<T*>(&bytes[static_cast<size_t>(offset)]);
+	}
+
+	void check_rejected(const std::string& file_name, const std::string& bytes, const char* const expected_error)
+	{
+		TEST_CHECK(write_bytes(file_name, bytes) == true);
+		AssetPack assetPack;
+		TEST_CHECK(assetPack.open(file_name) == false);
+		if (assetPack.get_error() != expected_error)
+		{
+			std::printf("expected '%s', got '%s'\n", expected_error, assetPack.get_error().c_str());
+		}
+		TEST_CHECK(assetPack.get_error() == expected_error);
+		TEST_CHECK(assetPack.get_asset_count() == 0);
+	}
+
+	void test_rejection(const std::string& file_name)
+	{
+		std::string pack;
+		TEST_CHECK(read_file(file_name, pack) == true);
+		const AssetPackHeader header = *at<AssetPackHeader>(pack, 0);
+		const std::string corrupt_file_name = file_name + ".corrupt";
+
+		check_rejected(corrupt_file_name, pack.substr(0, pack.size() - 1), "asset pack is truncated!");
+		check_rejected(corrupt_file_name, pack.substr(0, sizeof(AssetPackHeader) - 1), "not an asset pack!");
+		check_rejected(corrupt_file_name, pack + '\0', "asset pack is truncated!");
+
+		std::string bytes = pack;
+		at<AssetPackHeader>(bytes, 0)->_magic = 0;
+		check_rejected(corrupt_file_name, bytes, "not an asset pack, or an unsupported version!");
+		bytes = pack;
+		at<AssetPackHeader>(bytes, 0)->_version = AssetPackHeader::kVersion + 1;
+		check_rejected(corrupt_file_name, bytes, "not an asset pack, or an unsupported version!");
+
+		bytes = pack;
+		at<AssetPackHeader>(bytes, 0)->_assetsOffset = header._assetsOffset + 1;
+		check_rejected(corrupt_file_name, bytes, "asset pack table is out of bounds!");
+		bytes = pack;
+		at<AssetPackHeader>(bytes, 0)->_chunkCount = UINT32_MAX;
+		check_rejected(corrupt_file_name, bytes, "asset pack table is out of bounds!");
+		bytes = pack;
+		at<AssetPackHeader>(bytes, 0)->_namesByteSize = static_cast<uint32>(pack.size());
+		check_rejected(corrupt_file_name, bytes, "asset pack table is out of bounds!");
+
+		// Chunk offsets past the end, and offsets that would wrap around when the stored size is added.
+		const uint64 kBadOffsets[] = { pack.size(), pack.size() - 1, UINT64_MAX - 10, UINT64_MAX };
+		for (const uint64 bad_offset : kBadOffsets)
+		{
+			bytes = pack;
+			at<AssetPackChunk>(bytes, header._chunksOffset)->_offset = bad_offset;
+			check_rejected(corrupt_file_name, bytes, "asset pack chunk is out of bounds!");
+		}
+		bytes = pack;
+		at<AssetPackChunk>(bytes, header._chunksOffset)->_byteSize = header._chunkByteSize + 1;
+		check_rejected(corrupt_file_name, bytes, "asset pack chunk is out of bounds!");
+		bytes = pack;
+		AssetPackChunk* const chunk = at<AssetPackChunk>(bytes, header._chunksOffset);
+		chunk->_storedByteSize = chunk->_byteSize + 1;
+		check_rejected(corrupt_file_name, bytes, "asset pack chunk is out of bounds!");
+
+		bytes = pack;
+		at<AssetPackEntry>(bytes, header._assetsOffset)->_nameOffset = header._namesByteSize;
+		check_rejected(corrupt_file_name, bytes, "asset pack entry is out of bounds!");
+		bytes = pack;
+		at<AssetPackEntry>(bytes, header._assetsOffset)->_firstChunk = header._chunkCount;
+		check_rejected(corrupt_file_name, bytes, "asset pack entry is out of bounds!");
+		bytes = pack;
+		at<AssetPackEntry>(bytes, header._assetsOffset)->_nameHash = UINT64_MAX;
+		check_rejected(corrupt_file_name, bytes, "asset pack entry is out of bounds!");
+		bytes = pack;
+		at<AssetPackEntry>(bytes, header._assetsOffset + sizeof(AssetPackEntry))->_byteSize += 1;
+		check_rejected(corrupt_file_name, bytes, "asset pack entry size does not match its chunks!");
+
+		// Random damage anywhere: open() may accept it, but nothing may read out of bounds (run with SANITIZE=1).
+		std::mt19937 random(5);
+		uint32 opened_count = 0;
+		for (uint32 iteration = 0; iteration < 2000; ++iteration)
+		{
+			bytes = pack;
+			const uint32 flip_count = 1 + random() % 8;
+			for (uint32 flip = 0; flip < flip_count; ++flip)
+			{
+				bytes[random() % bytes.size()] = static_cast<char>(random());
+			}
+			TEST_CHECK(write_bytes(corrupt_file_name, bytes) == true);
+
+			AssetPack assetPack;
+			if (assetPack.open(corrupt_file_name) == false)
+			{
+				continue;
+			}
+			++opened_count;
+			std::vector<byte> data;
+			std::string_view view;
+			for (uint32 index = 0; index < assetPack.get_asset_count(); ++index)
+			{
+				assetPack.find(assetPack.get_asset_name(index));
+				assetPack.read(index, data);
+				assetPack.get_view(index, view);
+			}
+		}
+		std::printf("pack: 2000 damaged packs, %u still opened\n", opened_count);
+	}
+}
+
+int main()
+{
+	const std::filesystem::path directory = std::filesystem::temp_directory_path() / ("simple_renderer_asset_pack_test_" + std::to_string(get_time_us()));
+	std::filesystem::create_directories(directory);
+	const std::string file_name = (directory / "test.pack").string();
+
+	test_codec();
+	test_codec_corruption(20000);
+	test_pack(file_name);
+	test_rejection(file_name);
+
+	std::filesystem::remove_all(directory);
+	std::printf("asset_pack_test passed\n");
+	return 0;
+}
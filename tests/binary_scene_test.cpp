@@ -0,0 +1,274 @@
+#include "test_common.h"
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+
+using namespace SimpleRenderer;
+
+namespace
+{
+	const char* const kSceneText =
+		"<shapes>"
+		"<shape name=\"triangle\"><center x=\"400\" y=\"150\"/><points><point x=\"-20\" y=\"-45\"/><point x=\"30\" y=\"20\"/><point x=\"-10\" y=\"25.5\"/></points></shape>"
+		"<shape name=\"empty\"><center x=\"1\" y=\"2\"/><points/></shape>"
+		"<shape><center x=\"-3\" y=\"0.25\"/><points><point x=\"7\" y=\"8\"/></points></shape>"
+		"</shapes>";
+
+	// bind() requires kBinarySceneAlignment, which std::vector<byte> does not promise.
+	struct alignas(kBinarySceneAlignment) AlignedBlock
+	{
+		byte _bytes[kBinarySceneAlignment];
+	};
+	class AlignedBlob
+	{
+	public:
+		explicit AlignedBlob(const std::vector<byte>& bytes, const size_t byteSize)
+			: _blocks((byteSize + kBinarySceneAlignment - 1) / kBinarySceneAlignment)
+			, _byteSize(byteSize)
+		{
+			if (byteSize > 0)
+			{
+				::memcpy(_blocks.data(), bytes.data(), (std::min)(bytes.size(), byteSize));
+			}
+		}
+
+		byte* get_data() { return reinterpret_cast<byte*>(_blocks.data()); }
+		size_t get_byte_size() const { return _byteSize; }
+		BinarySceneHeader& get_header() { return *reinterpret_cast<BinarySceneHeader*>(get_data()); }
+		BinarySceneShape& get_shape(const uint32 index) { return reinterpret_cast<BinarySceneShape*>(get_data() + get_header()._shapesOffset)[index]; }
+
+	private:
+		std::vector<AlignedBlock> _blocks;
+		size_t _byteSize = 0;
+	};
+
+	std::vector<byte> compile_scene()
+	{
+		XML xml;
+		TEST_CHECK(xml.parse(kSceneText) == true);
+		std::vector<byte> blob;
+		TEST_CHECK(compile_BinaryScene(xml, blob) == true);
+		TEST_CHECK(blob.size() % kBinarySceneAlignment == 0);
+		return blob;
+	}
+
+	// Touches everything a bound scene exposes, so under the sanitizers an accepted blob must be in bounds.
+	void read_everything(const BinaryScene& scene)
+	{
+		float sum = 0.0f;
+		for (uint32 shapeIndex = 0; shapeIndex < scene.get_shape_count(); ++shapeIndex)
+		{
+			const BinarySceneShape& shape = scene.get_shape(shapeIndex);
+			const std::string_view name = scene.get_shape_name(shapeIndex);
+			sum += static_cast<float>(std::count(name.begin(), name.end(), 'a'));
+			for (uint32 pointIndex = shape._firstPoint; pointIndex < shape._firstPoint + shape._pointCount; ++pointIndex)
+			{
+				sum += scene.get_point(pointIndex).x + scene.get_point(pointIndex).y;
+			}
+			scene.compute_shape_hash(shapeIndex);
+		}
+		volatile float sink = sum;
+		(void)sink;
+	}
+
+	void test_bind()
+	{
+		const std::vector<byte> bytes = compile_scene();
+		AlignedBlob blob(bytes, bytes.size());
+		BinaryScene scene;
+		TEST_CHECK(scene.bind(blob.get_data(), blob.get_byte_size()) == true);
+		TEST_CHECK(scene.get_error().empty() == true);
+		TEST_CHECK(scene.get_shape_count() == 3);
+
+		const uint32 triangleIndex = scene.find_shape("triangle");
+		TEST_CHECK(triangleIndex == 0);
+		const BinarySceneShape& triangle = scene.get_shape(triangleIndex);
+		TEST_CHECK(triangle._center.x == 400.0f && triangle._center.y == 150.0f);
+		TEST_CHECK(triangle._firstPoint == 0 && triangle._pointCount == 3);
+		TEST_CHECK(scene.get_point(0).x == -20.0f && scene.get_point(0).y == -45.0f);
+		TEST_CHECK(scene.get_point(1).x == 30.0f && scene.get_point(1).y == 20.0f);
+		TEST_CHECK(scene.get_point(2).x == -10.0f && scene.get_point(2).y == 25.5f);
+
+		const BinarySceneShape& empty = scene.get_shape(scene.find_shape("empty"));
+		TEST_CHECK(empty._center.x == 1.0f && empty._center.y == 2.0f);
+		TEST_CHECK(empty._pointCount == 0);
+
+		// A shape without a name attribute gets an empty name.
+		TEST_CHECK(scene.get_shape_name(2).empty() == true);
+		TEST_CHECK(scene.find_shape("") == 2);
+		const BinarySceneShape& unnamed = scene.get_shape(2);
+		TEST_CHECK(unnamed._center.x == -3.0f && unnamed._center.y == 0.25f);
+		TEST_CHECK(unnamed._firstPoint == 3 && unnamed._pointCount == 1);
+		TEST_CHECK(scene.get_point(3).x == 7.0f && scene.get_point(3).y == 8.0f);
+		TEST_CHECK(scene.find_shape("missing") == UINT32_MAX);
+
+		// The arrays are aligned in the blob itself, not only in this buffer.
+		TEST_CHECK(reinterpret_cast<uintptr_t>(scene.get_point_xs()) % kBinarySceneAlignment == 0);
+		TEST_CHECK(reinterpret_cast<uintptr_t>(scene.get_point_ys()) % kBinarySceneAlignment == 0);
+
+		// The hash follows the points, so a reloaded scene can tell which shapes changed.
+		TEST_CHECK(scene.compute_shape_hash(0) != scene.compute_shape_hash(2));
+		const uint64 hash = scene.compute_shape_hash(0);
+		reinterpret_cast<float*>(blob.get_data() + blob.get_header()._pointXsOffset)[1] = 31.0f;
+		TEST_CHECK(scene.compute_shape_hash(0) != hash);
+	}
+
+	void check_rejected(AlignedBlob& blob, const char* const error)
+	{
+		BinaryScene scene;
+		TEST_CHECK(scene.bind(blob.get_data(), blob.get_byte_size()) == false);
+		TEST_CHECK(scene.get_error() == error);
+		TEST_CHECK(scene.get_shape_count() == 0);
+	}
+
+	void test_rejected()
+	{
+		const std::vector<byte> bytes = compile_scene();
+
+		BinaryScene scene;
+		TEST_CHECK(scene.bind(nullptr, bytes.size()) == false);
+		TEST_CHECK(scene.get_error() == "blob is too small or misaligned!");
+		for (size_t byteSize = 0; byteSize < bytes.size(); ++byteSize)
+		{
+			AlignedBlob truncated(bytes, byteSize);
+			check_rejected(truncated, (byteSize < sizeof(BinarySceneHeader) ? "blob is too small or misaligned!" : "binary scene is truncated!"));
+		}
+		{
+			// The same bytes one float off the alignment.
+			std::vector<byte> shifted(4, 0);
+			shifted.insert(shifted.end(), bytes.begin(), bytes.end());
+			AlignedBlob blob(shifted, shifted.size());
+			TEST_CHECK(scene.bind(blob.get_data() + 4, bytes.size()) == false);
+			TEST_CHECK(scene.get_error() == "blob is too small or misaligned!");
+		}
+
+		const auto make_blob = [&bytes]() { return AlignedBlob(bytes, bytes.size()); };
+		{
+			AlignedBlob blob = make_blob();
+			blob.get_header()._magic ^= 1;
+			check_rejected(blob, "not a binary scene, or written with the other endianness!");
+		}
+		{
+			AlignedBlob blob = make_blob();
+			blob.get_header()._version += 1;
+			check_rejected(blob, "unsupported binary scene version!");
+		}
+		{
+			AlignedBlob blob = make_blob();
+			blob.get_header()._byteSize += kBinarySceneAlignment;
+			check_rejected(blob, "binary scene is truncated!");
+		}
+		{
+			AlignedBlob blob = make_blob();
+			blob.get_header()._shapeCount = UINT32_MAX;
+			check_rejected(blob, "binary scene array is out of bounds!");
+		}
+		{
+			AlignedBlob blob = make_blob();
+			blob.get_header()._pointCount = 0x40000000;
+			check_rejected(blob, "binary scene array is out of bounds!");
+		}
+		{
+			AlignedBlob blob = make_blob();
+			blob.get_header()._namesByteSize = UINT32_MAX;
+			check_rejected(blob, "binary scene array is out of bounds!");
+		}
+		{
+			AlignedBlob blob = make_blob();
+			blob.get_header()._pointYsOffset += 4;
+			check_rejected(blob, "binary scene array is out of bounds!");
+		}
+		{
+			AlignedBlob blob = make_blob();
+			blob.get_header()._shapesOffset = 0;
+			check_rejected(blob, "binary scene array is out of bounds!");
+		}
+		{
+			AlignedBlob blob = make_blob();
+			blob.get_header()._namesOffset = UINT32_MAX - kBinarySceneAlignment + 1;
+			check_rejected(blob, "binary scene array is out of bounds!");
+		}
+		{
+			AlignedBlob blob = make_blob();
+			blob.get_shape(2)._firstPoint = UINT32_MAX;
+			check_rejected(blob, "binary scene shape is out of bounds!");
+		}
+		{
+			AlignedBlob blob = make_blob();
+			blob.get_shape(0)._pointCount = 5;
+			check_rejected(blob, "binary scene shape is out of bounds!");
+		}
+		{
+			AlignedBlob blob = make_blob();
+			blob.get_shape(1)._nameOffset = blob.get_header()._namesByteSize;
+			check_rejected(blob, "binary scene shape is out of bounds!");
+		}
+		{
+			AlignedBlob blob = make_blob();
+			blob.get_shape(0)._nameLength = UINT32_MAX;
+			check_rejected(blob, "binary scene shape is out of bounds!");
+		}
+
+		// A failed bind leaves the scene empty, even if it was bound before.
+		AlignedBlob blob = make_blob();
+		TEST_CHECK(scene.bind(blob.get_data(), blob.get_byte_size()) == true);
+		blob.get_header()._version = 0;
+		TEST_CHECK(scene.bind(blob.get_data(), blob.get_byte_size()) == false);
+		TEST_CHECK(scene.get_shape_count() == 0);
+	}
+
+	// Randomly damaged blobs are either rejected or safe to read in full.
+	void test_damage(const uint32 iteration_count)
+	{
+		const std::vector<byte> bytes = compile_scene();
+		const size_t arrays_at = reinterpret_cast<const BinarySceneHeader*>(bytes.data())->_pointXsOffset;
+		std::mt19937 random(2024);
+		uint32 bound_count = 0;
+		for (uint32 iteration = 0; iteration < iteration_count; ++iteration)
+		{
+			AlignedBlob blob(bytes, bytes.size());
+			const uint32 damage_count = 1 + random() % 4;
+			for (uint32 damage = 0; damage < damage_count; ++damage)
+			{
+				// Mostly the header and shapes, where the offsets and counts live.
+				const size_t range = (random() % 2 == 0 ? bytes.size() : arrays_at);
+				const size_t at = random() % range;
+				blob.get_data()[at] = static_cast<byte>(random() % 4 == 0 ? 0xFF : random());
+			}
+
+			BinaryScene scene;
+			if (scene.bind(blob.get_data(), blob.get_byte_size()) == true)
+			{
+				read_everything(scene);
+				++bound_count;
+			}
+			else
+			{
+				TEST_CHECK(scene.get_error().empty() == false);
+			}
+		}
+		std::printf("damage: %u blobs, %u bound\n", iteration_count, bound_count);
+	}
+
+	void test_invalid_node()
+	{
+		XML xml;
+		TEST_CHECK(xml.parse(kSceneText) == true);
+		const XML::Node& invalidNode = xml.get_node(XML::INVALID_ID);
+		TEST_CHECK(invalidNode.is_valid() == false);
+		TEST_CHECK(invalidNode.get_name().empty() == true);
+		TEST_CHECK(invalidNode.get_attribute(0).get_name().empty() == true);
+		TEST_CHECK(xml.get_root_node().get_child_node(100).get_name().empty() == true);
+	}
+}
+
+int main()
+{
+	test_bind();
+	test_rejected();
+	test_damage(20000);
+	test_invalid_node();
+	std::printf("binary_scene_test passed\n");
+	return 0;
+}
@@ -0,0 +1,199 @@
+#include "test_common.h"
+
+#include <random>
+
+using namespace SimpleRenderer;
+
+namespace
+{
+	constexpr uint32 kMissingCodepoint = 0;
+
+	// Glyphs are square and solid; the size is in the upper bits of the code point (8 texels if none), and spaces are blank.
+	uint32 g_rasterize_count = 0;
+	bool rasterize_mock_glyph(const uint32 codepoint, GlyphBitmap& outBitmap)
+	{
+		++g_rasterize_count;
+		if (codepoint == kMissingCodepoint)
+		{
+			return false;
+		}
+
+		const uint32 size = ((codepoint >> 16) == 0 ? 8 : (codepoint >> 16));
+		outBitmap._width = size;
+		outBitmap._height = size;
+		outBitmap._offset = float2(0, 0);
+		outBitmap._advance = static_cast<float>(size);
+		outBitmap._coverage.assign(size_t(size) * size, (codepoint == ' ' ? 0 : 255));
+		return true;
+	}
+
+	uint32 make_codepoint(const uint32 size, const uint32 id)
+	{
+		return (size << 16) | (id + 1);
+	}
+
+	// A 64x64 atlas with 1 texel of padding holds 6x6 glyphs of 8x8.
+	constexpr uint32 kAtlasSize = 64;
+	constexpr uint32 kFullGlyphCount = 36;
+
+	void fill(GlyphCache& glyphCache)
+	{
+		for (uint32 id = 0; id < kFullGlyphCount; ++id)
+		{
+			TEST_CHECK(glyphCache.find_or_add(make_codepoint(8, id)) != nullptr);
+		}
+		TEST_CHECK(glyphCache.get_statistics()._glyphCount == kFullGlyphCount);
+		TEST_CHECK(glyphCache.get_statistics()._evictionCount == 0);
+	}
+
+	bool is_cached(GlyphCache& glyphCache, const uint32 codepoint)
+	{
+		const uint32 rasterize_count = g_rasterize_count;
+		glyphCache.find_or_add(codepoint);
+		return g_rasterize_count == rasterize_count;
+	}
+
+	void test_hit_and_miss()
+	{
+		GlyphCache glyphCache;
+		glyphCache.init(kAtlasSize, kAtlasSize, rasterize_mock_glyph, kMissingCodepoint);
+		g_rasterize_count = 0;
+
+		const CachedGlyph* const glyph = glyphCache.find_or_add('A');
+		TEST_CHECK(glyph != nullptr);
+		TEST_CHECK(glyph->_region.is_valid() == true);
+		TEST_CHECK(glyph->_size.x == 8.0f && glyph->_advance == 8.0f);
+		TEST_CHECK(glyphCache.find_or_add('A') == glyph);
+		TEST_CHECK(g_rasterize_count == 1);
+
+		const CachedGlyph* const space = glyphCache.find_or_add(' ');
+		TEST_CHECK(space != nullptr && space->_region.is_valid() == false);
+		TEST_CHECK(glyphCache.get_atlas().get_packer().get_used_area() == 10 * 10);
+
+		TEST_CHECK(glyphCache.find_or_add(kMissingCodepoint) == nullptr);
+
+		const GlyphCacheStatistics& statistics = glyphCache.get_statistics();
+		TEST_CHECK(statistics._hitCount == 1);
+		TEST_CHECK(statistics._missCount == 3);
+		TEST_CHECK(statistics._failureCount == 1);
+		TEST_CHECK(statistics._glyphCount == 2);
+
+		std::vector<Sprite> sprites;
+		const float2 pen = glyphCache.write_sprites(Color(1, 1, 1, 1), "A A", float2(0, 0), 2.0f, sprites);
+		TEST_CHECK(sprites.size() == 2);
+		TEST_CHECK(pen.x == 48.0f);
+		TEST_CHECK(g_rasterize_count == 3);
+	}
+
+	void test_least_recently_used_order()
+	{
+		GlyphCache glyphCache;
+		glyphCache.init(kAtlasSize, kAtlasSize, rasterize_mock_glyph, kMissingCodepoint);
+		fill(glyphCache);
+		glyphCache.advance_frame();
+
+		// Glyph 0 is the oldest but used again, so glyph 1 is the least recently used.
+		TEST_CHECK(glyphCache.find_or_add(make_codepoint(8, 0)) != nullptr);
+		glyphCache.advance_frame();
+		TEST_CHECK(glyphCache.find_or_add(make_codepoint(8, 100)) != nullptr);
+		TEST_CHECK(glyphCache.get_statistics()._evictionCount == 1);
+		TEST_CHECK(is_cached(glyphCache, make_codepoint(8, 0)) == true);
+		TEST_CHECK(is_cached(glyphCache, make_codepoint(8, 2)) == true);
+		TEST_CHECK(is_cached(glyphCache, make_codepoint(8, 100)) == true);
+		TEST_CHECK(is_cached(glyphCache, make_codepoint(8, 1)) == false);
+		// Bringing glyph 1 back evicted glyph 3, the least recently used one by then.
+		TEST_CHECK(glyphCache.get_statistics()._evictionCount == 2);
+		TEST_CHECK(is_cached(glyphCache, make_codepoint(8, 4)) == true);
+		TEST_CHECK(is_cached(glyphCache, make_codepoint(8, 3)) == false);
+	}
+
+	void test_pinned_glyphs()
+	{
+		GlyphCache glyphCache;
+		glyphCache.init(kAtlasSize, kAtlasSize, rasterize_mock_glyph, kMissingCodepoint);
+		fill(glyphCache);
+
+		// Every glyph was used this frame, so none can be evicted.
+		TEST_CHECK(glyphCache.find_or_add(make_codepoint(8, 100)) == nullptr);
+		TEST_CHECK(glyphCache.get_statistics()._evictionCount == 0);
+		TEST_CHECK(glyphCache.get_statistics()._glyphCount == kFullGlyphCount);
+
+		// Glyphs used in the new frame stay pinned as well.
+		glyphCache.advance_frame();
+		for (uint32 id = 0; id < kFullGlyphCount; ++id)
+		{
+			TEST_CHECK(is_cached(glyphCache, make_codepoint(8, id)) == true);
+		}
+		TEST_CHECK(glyphCache.find_or_add(make_codepoint(8, 100)) == nullptr);
+		TEST_CHECK(glyphCache.get_statistics()._evictionCount == 0);
+
+		glyphCache.advance_frame();
+		TEST_CHECK(glyphCache.find_or_add(make_codepoint(8, 0)) != nullptr);
+		TEST_CHECK(glyphCache.find_or_add(make_codepoint(8, 100)) != nullptr);
+		TEST_CHECK(glyphCache.get_statistics()._evictionCount == 1);
+	}
+
+	void test_mixed_sizes()
+	{
+		GlyphCache glyphCache;
+		glyphCache.init(kAtlasSize, kAtlasSize, rasterize_mock_glyph, kMissingCodepoint);
+		fill(glyphCache);
+		glyphCache.advance_frame();
+		glyphCache.advance_frame();
+
+		// A 20x20 glyph needs 22x22 texels: the 3x3 block of the oldest 8x8 glyphs, not the whole cache.
+		const CachedGlyph* const big_glyph = glyphCache.find_or_add(make_codepoint(20, 0));
+		TEST_CHECK(big_glyph != nullptr && big_glyph->_region.is_valid() == true);
+		const GlyphCacheStatistics& statistics = glyphCache.get_statistics();
+		std::printf("mixed sizes: a 20x20 glyph evicted %u of %u 8x8 glyphs\n", static_cast<uint32>(statistics._evictionCount), kFullGlyphCount);
+		TEST_CHECK(statistics._evictionCount == 9);
+		TEST_CHECK(statistics._glyphCount == kFullGlyphCount - statistics._evictionCount + 1);
+		TEST_CHECK(is_cached(glyphCache, make_codepoint(8, kFullGlyphCount - 1)) == true);
+
+		// A glyph larger than the atlas must not evict anything.
+		const uint64 eviction_count = statistics._evictionCount;
+		TEST_CHECK(glyphCache.find_or_add(make_codepoint(kAtlasSize, 0)) == nullptr);
+		TEST_CHECK(statistics._evictionCount == eviction_count);
+
+		// With everything released the whole atlas is usable again.
+		glyphCache.advance_frame();
+		glyphCache.advance_frame();
+		const CachedGlyph* const huge_glyph = glyphCache.find_or_add(make_codepoint(kAtlasSize - 2, 0));
+		TEST_CHECK(huge_glyph != nullptr && huge_glyph->_region.is_valid() == true);
+		TEST_CHECK(statistics._glyphCount == 1);
+	}
+
+	void test_churn(const uint32 frame_count)
+	{
+		GlyphCache glyphCache;
+		glyphCache.init(128, 128, rasterize_mock_glyph, kMissingCodepoint);
+		std::mt19937 random(7);
+		const uint32 kSizes[] = { 6, 8, 8, 8, 10, 12, 16 };
+		for (uint32 frame = 0; frame < frame_count; ++frame)
+		{
+			// Each frame draws a few dozen glyphs out of a set much larger than the atlas holds.
+			for (uint32 glyph = 0; glyph < 40; ++glyph)
+			{
+				const uint32 id = random() % 400;
+				const uint32 size = kSizes[id % (sizeof(kSizes) / sizeof(kSizes[0]))];
+				TEST_CHECK(glyphCache.find_or_add(make_codepoint(size, id)) != nullptr);
+			}
+			glyphCache.advance_frame();
+		}
+		const GlyphCacheStatistics& statistics = glyphCache.get_statistics();
+		std::printf("churn: %u frames, hit rate %.2f, %u evictions, %u glyphs cached\n", frame_count, statistics.get_hit_rate(), static_cast<uint32>(statistics._evictionCount), statistics._glyphCount);
+		TEST_CHECK(statistics._failureCount == 0);
+		TEST_CHECK(statistics._glyphCount >= 60);
+	}
+}
+
+int main()
+{
+	test_hit_and_miss();
+	test_least_recently_used_order();
+	test_pinned_glyphs();
+	test_mixed_sizes();
+	test_churn(3000);
+	std::printf("glyph_cache_test passed\n");
+	return 0;
+}
@@ -0,0 +1,116 @@
+#include "test_common.h"
+
+#include <new>
+
+using namespace SimpleRenderer;
+
+namespace
+{
+	std::atomic<uint64> g_allocation_count{ 0 };
+}
+
+#if defined(__GNUC__) && defined(__clang__) == false
+// The replacements below pair malloc with free, which GCC cannot see through.
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+// Counts every heap allocation made through new; the frames under test must not make any.
+void* operator new(const size_t byteSize)
+{
+	g_allocation_count.fetch_add(1, std::memory_order_relaxed);
+	void* const pointer = std::malloc(byteSize == 0 ? 1 : byteSize);
+	if (pointer == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+	return pointer;
+}
+void* operator new[](const size_t byteSize) { return operator new(byteSize); }
+void operator delete(void* const pointer) noexcept { std::free(pointer); }
+void operator delete[](void* const pointer) noexcept { std::free(pointer); }
+void operator delete(void* const pointer, const size_t) noexcept { std::free(pointer); }
+void operator delete[](void* const pointer, const size_t) noexcept { std::free(pointer); }
+
+namespace
+{
+	struct Hud
+	{
+		TextRunBuffer _textRunBuffer;
+		TextRun _textRuns[16];
+		TextRunUpdate _textRunUpdate;
+		std::vector<DEFAULT_FONT_GLYPH_INSTANCE> _glyphInstances;
+	};
+
+	template<typename... Args>
+	void update_format(Hud& hud, const uint32 index, const Color& color, const float2& position, const Args&... args)
+	{
+		TextFormatter textFormatter;
+		(textFormatter << ... << args);
+		hud._textRunBuffer.update(hud._textRuns[index], color, textFormatter.get_view(), position, float2(1, 1));
+	}
+
+	// Mirrors the labels of the sample HUD in test.cpp, with numbers that change every frame.
+	void build_frame(Hud& hud, const uint32 frame_index)
+	{
+		const Color white_color = Color(1, 1, 1, 1);
+		const Color yellow_color = Color(1, 1, 0, 1);
+		const float2 scale = float2(1, 1);
+		const uint32 selection = frame_index % 3;
+		hud._textRunBuffer.update(hud._textRuns[0], Color(0, 1, 1, 1), "GJK Algorithm Test", float2(10, 10), scale);
+		hud._textRunBuffer.update(hud._textRuns[1], (selection == 0 ? yellow_color : white_color), "1: shape A", float2(10, 40), scale);
+		hud._textRunBuffer.update(hud._textRuns[2], (selection == 1 ? yellow_color : white_color), "2: shape B", float2(10, 60), scale);
+		hud._textRunBuffer.update(hud._textRuns[3], (selection == 2 ? yellow_color : white_color), "3: initial direction", float2(10, 80), scale);
+		update_format(hud, 4, white_color, float2(10, 180), "current gjk_max_step: ", frame_index % 40);
+		update_format(hud, 5, white_color, float2(10, 500), "sprites: ", frame_index * 1000u, " draw calls: ", frame_index % 7);
+		update_format(hud, 6, white_color, float2(10, 520), "frames drawn: ", uint64(frame_index) * 3, " skipped: ", frame_index / 2, " cpu: ", static_cast<int>(frame_index % 100), "%");
+		update_format(hud, 7, white_color, float2(10, 540), "render queue depth: ", frame_index % 3, " / max ", 3u);
+		update_format(hud, 8, white_color, float2(10, 560), "wait us game: ", frame_index * 17u, " render: ", frame_index * 13u, " frame time ms: ", frame_index * 0.016);
+		for (uint32 index = 9; index < 16; ++index)
+		{
+			// Counters gain digits over the measured frames, so these labels outgrow the short string buffer they start in.
+			update_format(hud, index, white_color, float2(400, 20.0f * index), "label ", index, ": ", uint64(frame_index) * frame_index * frame_index * frame_index);
+		}
+		hud._textRunBuffer.collect_updates(hud._textRunUpdate);
+
+		// Immediate text, as draw_text() and draw_text_format() queue it.
+		hud._glyphInstances.clear();
+		TextLayout layout;
+		layout._position = float2(10, 600);
+		layout._wrapWidth = 200.0f;
+		TextFormatter textFormatter;
+		textFormatter << "mouse: " << int32(frame_index % 800) << ", " << int32(frame_index % 600) << " latency ms: " << frame_index * 0.25;
+		layout_text(textFormatter.get_view(), layout, float2(8, 10), pack_color_RGBA8(white_color), hud._glyphInstances);
+	}
+}
+
+int main()
+{
+	Hud hud;
+	for (TextRun& textRun : hud._textRuns)
+	{
+		textRun = hud._textRunBuffer.create(32);
+	}
+
+	const uint64 allocation_count_before_check = g_allocation_count.load();
+	std::vector<int> check_vector(16);
+	TEST_CHECK(g_allocation_count.load() > allocation_count_before_check);
+
+	// The first frames may grow buffers; after that the same HUD must not touch the heap.
+	constexpr uint32 kWarmUpFrameCount = 8;
+	for (uint32 frame_index = 0; frame_index < kWarmUpFrameCount; ++frame_index)
+	{
+		build_frame(hud, frame_index);
+	}
+
+	const uint64 allocation_count_before = g_allocation_count.load();
+	for (uint32 frame_index = kWarmUpFrameCount; frame_index < kWarmUpFrameCount + 1000; ++frame_index)
+	{
+		build_frame(hud, frame_index);
+	}
+	const uint64 allocation_count = g_allocation_count.load() - allocation_count_before;
+	std::printf("hud: %llu heap allocations in 1000 frames\n", static_cast<unsigned long long>(allocation_count));
+	TEST_CHECK(allocation_count == 0);
+	TEST_CHECK(hud._glyphInstances.empty() == false);
+	std::printf("hud_allocation_test passed\n");
+	return 0;
+}
@@ -0,0 +1,194 @@
+#include "test_common.h"
+
+#include <deque>
+
+using namespace SimpleRenderer;
+
+namespace
+{
+	// Hands out a script of events; every event carries its index in the script in _position.x.
+	class ScriptedInputEventSource final : public InputEventSource
+	{
+	public:
+		void push(const InputEvent::Type type, const char ch = 0)
+		{
+			InputEvent event;
+			event._type = type;
+			event._key = (type == InputEvent::Type::KeyUp ? InputKey::Enter : InputKey::NONE);
+			event._char = ch;
+			event._position = float2(static_cast<float>(_pushedEventCount), 0.0f);
+			event._timestamp = get_time_us();
+			_events.push_back(event);
+			++_pushedEventCount;
+		}
+
+		bool poll_event(InputEvent& outEvent) override
+		{
+			if (_events.empty() == true)
+			{
+				return false;
+			}
+			outEvent = _events.front();
+			_events.pop_front();
+			return true;
+		}
+		void wait_for_event(const uint64) override {}
+
+		bool is_empty() const { return _events.empty(); }
+		uint32 get_pushed_event_count() const { return _pushedEventCount; }
+
+	private:
+		std::deque<InputEvent> _events;
+		uint32 _pushedEventCount = 0;
+	};
+
+	uint32 get_index(const InputEvent& event)
+	{
+		return static_cast<uint32>(event._position.x);
+	}
+
+	// Pumps until nothing is pending and checks that the events arrive in script order, each exactly once.
+	uint32 pump_all(InputSystem& inputSystem, ScriptedInputEventSource& source, uint32& inoutNextIndex)
+	{
+		uint32 frame_count = 0;
+		do
+		{
+			inputSystem.pump(source);
+			++frame_count;
+			for (uint32 i = 0; i < inputSystem.get_frame_event_count(); ++i)
+			{
+				TEST_CHECK(get_index(inputSystem.get_frame_event(i)) == inoutNextIndex);
+				++inoutNextIndex;
+			}
+			TEST_CHECK(frame_count < 1000);
+		} while (inputSystem.has_pending_events() == true);
+		TEST_CHECK(source.is_empty() == true);
+		return frame_count;
+	}
+
+	void test_order_across_frames()
+	{
+		InputSystem inputSystem;
+		ScriptedInputEventSource source;
+		uint32 next_index = 0;
+		for (uint32 frame = 0; frame < 20; ++frame)
+		{
+			for (uint32 i = 0; i < frame * 7; ++i)
+			{
+				source.push((i % 3 == 0 ? InputEvent::Type::MouseLButtonDown : InputEvent::Type::MouseLButtonUp));
+			}
+			pump_all(inputSystem, source, next_index);
+		}
+		TEST_CHECK(next_index == source.get_pushed_event_count());
+	}
+
+	void test_no_loss_when_backlogged()
+	{
+		InputSystem inputSystem;
+		ScriptedInputEventSource source;
+		const uint32 event_count = InputEventQueue::kCapacity * 4 + 17;
+		for (uint32 i = 0; i < event_count; ++i)
+		{
+			source.push((i % 2 == 0 ? InputEvent::Type::MouseLButtonDown : InputEvent::Type::MouseRButtonUp));
+		}
+
+		// The source holds more than the queue does: the rest must stay in the source, not be taken and dropped.
+		inputSystem.pump(source);
+		TEST_CHECK(inputSystem.get_frame_event_count() == InputEventQueue::kCapacity);
+		TEST_CHECK(inputSystem.has_pending_events() == true);
+		TEST_CHECK(source.is_empty() == false);
+
+		uint32 next_index = InputEventQueue::kCapacity;
+		const uint32 frame_count = pump_all(inputSystem, source, next_index);
+		TEST_CHECK(frame_count == 4);
+		TEST_CHECK(next_index == event_count);
+		TEST_CHECK(inputSystem.get_statistics()._droppedEventCount == 0);
+		TEST_CHECK(inputSystem.get_statistics()._processedEventCount == event_count);
+
+		inputSystem.pump(source);
+		TEST_CHECK(inputSystem.get_frame_event_count() == 0);
+		TEST_CHECK(inputSystem.has_pending_events() == false);
+	}
+
+	void test_key_up()
+	{
+		InputSystem inputSystem;
+		ScriptedInputEventSource source;
+		source.push(InputEvent::Type::Char, 'a');
+		source.push(InputEvent::Type::KeyUp);
+		source.push(InputEvent::Type::Char, 'b');
+		source.push(InputEvent::Type::KeyUp);
+		source.push(InputEvent::Type::Char, 'c');
+
+		// One key up per frame; the second and everything after it waits, so the order of chars and keys is kept.
+		inputSystem.pump(source);
+		TEST_CHECK(inputSystem.get_keyboard_up_key() == InputKey::Enter);
+		TEST_CHECK(std::string(inputSystem.get_keyboard_chars()) == "ab");
+		TEST_CHECK(inputSystem.has_pending_events() == true);
+
+		inputSystem.pump(source);
+		TEST_CHECK(inputSystem.get_keyboard_up_key() == InputKey::Enter);
+		TEST_CHECK(std::string(inputSystem.get_keyboard_chars()) == "c");
+		TEST_CHECK(inputSystem.has_pending_events() == false);
+
+		inputSystem.pump(source);
+		TEST_CHECK(inputSystem.get_keyboard_up_key() == InputKey::NONE);
+		TEST_CHECK(inputSystem.get_keyboard_char_count() == 0);
+	}
+
+	void test_char_overflow()
+	{
+		InputSystem inputSystem;
+		ScriptedInputEventSource source;
+		const uint32 char_count = InputSystem::kMaxCharCountPerFrame * 2 + 5;
+		std::string typed;
+		for (uint32 i = 0; i < char_count; ++i)
+		{
+			typed += static_cast<char>('a' + i % 26);
+			source.push(InputEvent::Type::Char, typed.back());
+		}
+
+		std::string received;
+		uint32 next_index = 0;
+		do
+		{
+			inputSystem.pump(source);
+			TEST_CHECK(inputSystem.get_keyboard_char_count() <= InputSystem::kMaxCharCountPerFrame);
+			received += inputSystem.get_keyboard_chars();
+			next_index += inputSystem.get_frame_event_count();
+		} while (inputSystem.has_pending_events() == true);
+		TEST_CHECK(received == typed);
+		TEST_CHECK(next_index == char_count);
+	}
+
+	void test_mouse_move_coalescing()
+	{
+		InputSystem inputSystem;
+		ScriptedInputEventSource source;
+		source.push(InputEvent::Type::MouseMove);
+		source.push(InputEvent::Type::MouseMove);
+		source.push(InputEvent::Type::MouseMove);
+		source.push(InputEvent::Type::MouseLButtonDown);
+		source.push(InputEvent::Type::MouseMove);
+
+		inputSystem.pump(source);
+		TEST_CHECK(inputSystem.get_frame_event_count() == 3);
+		TEST_CHECK(get_index(inputSystem.get_frame_event(0)) == 2);
+		TEST_CHECK(get_index(inputSystem.get_frame_event(1)) == 3);
+		TEST_CHECK(get_index(inputSystem.get_frame_event(2)) == 4);
+		TEST_CHECK(inputSystem.get_statistics()._coalescedEventCount == 2);
+		TEST_CHECK(inputSystem.is_mouse_L_button_pressed() == true);
+		TEST_CHECK(inputSystem.get_mouse_position().x == 4.0f);
+	}
+}
+
+int main()
+{
+	test_order_across_frames();
+	test_no_loss_when_backlogged();
+	test_key_up();
+	test_char_overflow();
+	test_mouse_move_coalescing();
+	std::printf("input_test passed\n");
+	return 0;
+}
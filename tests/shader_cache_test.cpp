@@ -0,0 +1,196 @@
+#include "test_common.h"
+
+#include <filesystem>
+
+using namespace SimpleRenderer;
+
+namespace
+{
+	// "Compiles" by copying the source into the bytecode; sources containing "error" fail.
+	class MockShaderCompiler final : public ShaderCompiler
+	{
+	public:
+		bool compile(const ShaderCompileRequest& request, std::vector<byte>& outBytecode, std::string& outErrorMessage) override
+		{
+			_compileCount.fetch_add(1, std::memory_order_relaxed);
+			const std::string source = request._sourceCode;
+			if (source.find("error") != std::string::npos)
+			{
+				outBytecode.clear();
+				outErrorMessage = "mock error";
+				return false;
+			}
+			outBytecode.assign(source.begin(), source.end());
+			return true;
+		}
+
+		uint32 get_compile_count() const { return _compileCount.load(std::memory_order_relaxed); }
+
+	private:
+		std::atomic<uint32> _compileCount{ 0 };
+	};
+
+	ShaderCompileRequest make_request(const char* const sourceCode, const ShaderHeaderSet* const shaderHeaderSet = nullptr)
+	{
+		ShaderCompileRequest request;
+		request._sourceCode = sourceCode;
+		request._identifier = "Test";
+		request._entryPoint = "main";
+		request._target = "ps_5_0";
+		request._shaderHeaderSet = shaderHeaderSet;
+		return request;
+	}
+
+	uint32 count_cache_files(const std::string& directory)
+	{
+		uint32 file_count = 0;
+		std::error_code errorCode;
+		for (std::filesystem::directory_iterator it(directory, errorCode), end; errorCode.value() == 0 && it != end; it.increment(errorCode))
+		{
+			++file_count;
+		}
+		return file_count;
+	}
+
+	void test_miss_then_hit(const std::string& directory)
+	{
+		ShaderCache shaderCache(directory);
+		MockShaderCompiler compiler;
+		const ShaderCompileRequest request = make_request("float4 main() : SV_Target { return 1; }");
+
+		ShaderCompileResult result;
+		compile_shaders(compiler, &shaderCache, &request, &result, 1);
+		TEST_CHECK(result._is_succeeded == true && result._is_from_cache == false);
+		TEST_CHECK(compiler.get_compile_count() == 1);
+		TEST_CHECK(shaderCache.get_miss_count() == 1 && shaderCache.get_hit_count() == 0);
+		TEST_CHECK(count_cache_files(directory) == 1);
+
+		ShaderCompileResult cachedResult;
+		compile_shaders(compiler, &shaderCache, &request, &cachedResult, 1);
+		TEST_CHECK(cachedResult._is_succeeded == true && cachedResult._is_from_cache == true);
+		TEST_CHECK(cachedResult._bytecode == result._bytecode);
+		TEST_CHECK(compiler.get_compile_count() == 1);
+		TEST_CHECK(shaderCache.get_hit_count() == 1);
+
+		// A torn or foreign file is a miss, not garbage bytecode.
+		const uint64 key = ShaderCache::compute_key(request);
+		for (const auto& entry : std::filesystem::directory_iterator(directory))
+		{
+			std::filesystem::resize_file(entry.path(), 10);
+		}
+		std::vector<byte> bytecode;
+		TEST_CHECK(shaderCache.load(key, bytecode) == false && bytecode.empty() == true);
+		compile_shaders(compiler, &shaderCache, &request, &result, 1);
+		TEST_CHECK(result._is_succeeded == true && result._is_from_cache == false);
+		TEST_CHECK(compiler.get_compile_count() == 2);
+		TEST_CHECK(shaderCache.load(key, bytecode) == true && bytecode == cachedResult._bytecode);
+	}
+
+	void test_key()
+	{
+		ShaderHeaderSet shaderHeaderSet;
+		shaderHeaderSet.push_shader_header("Outer", "#include \"Inner\"\n#define OUTER 1");
+		shaderHeaderSet.push_shader_header("Inner", "#define INNER 1");
+		const char* const source = "#include \"Outer\"\nfloat4 main() : SV_Target { return OUTER + INNER; }";
+		const ShaderCompileRequest request = make_request(source, &shaderHeaderSet);
+		const uint64 key = ShaderCache::compute_key(request);
+		TEST_CHECK(ShaderCache::compute_key(request) == key);
+
+		ShaderCompileRequest changed = request;
+		changed._flags = 1;
+		TEST_CHECK(ShaderCache::compute_key(changed) != key);
+		changed = request;
+		changed._entryPoint = "main2";
+		TEST_CHECK(ShaderCache::compute_key(changed) != key);
+		changed = request;
+		changed._target = "ps_5_1";
+		TEST_CHECK(ShaderCache::compute_key(changed) != key);
+		changed = request;
+		changed._sourceCode = "#include \"Outer\"\nfloat4 main() : SV_Target { return OUTER - INNER; }";
+		TEST_CHECK(ShaderCache::compute_key(changed) != key);
+
+		// Header content counts, including headers included by headers.
+		ShaderHeaderSet changedOuter;
+		changedOuter.push_shader_header("Outer", "#include \"Inner\"\n#define OUTER 2");
+		changedOuter.push_shader_header("Inner", "#define INNER 1");
+		TEST_CHECK(ShaderCache::compute_key(make_request(source, &changedOuter)) != key);
+		ShaderHeaderSet changedInner;
+		changedInner.push_shader_header("Outer", "#include \"Inner\"\n#define OUTER 1");
+		changedInner.push_shader_header("Inner", "#define INNER 2");
+		TEST_CHECK(ShaderCache::compute_key(make_request(source, &changedInner)) != key);
+		ShaderHeaderSet sameContent;
+		sameContent.push_shader_header("Inner", "#define INNER 1");
+		sameContent.push_shader_header("Outer", "#include \"Inner\"\n#define OUTER 1");
+		TEST_CHECK(ShaderCache::compute_key(make_request(source, &sameContent)) == key);
+
+		// Headers that include each other must not recurse forever.
+		ShaderHeaderSet cyclic;
+		cyclic.push_shader_header("Outer", "#include \"Inner\"");
+		cyclic.push_shader_header("Inner", "#include \"Outer\"");
+		TEST_CHECK(ShaderCache::compute_key(make_request(source, &cyclic)) != key);
+	}
+
+	void test_failure_not_cached(const std::string& directory)
+	{
+		ShaderCache shaderCache(directory);
+		MockShaderCompiler compiler;
+		const ShaderCompileRequest request = make_request("float4 main() : SV_Target { error }");
+		for (uint32 attempt = 1; attempt <= 2; ++attempt)
+		{
+			ShaderCompileResult result;
+			compile_shaders(compiler, &shaderCache, &request, &result, 1);
+			TEST_CHECK(result._is_succeeded == false && result._is_from_cache == false);
+			TEST_CHECK(result._errorMessage == "mock error");
+			TEST_CHECK(compiler.get_compile_count() == attempt);
+		}
+		TEST_CHECK(count_cache_files(directory) == 0);
+		TEST_CHECK(shaderCache.get_hit_count() == 0);
+	}
+
+	void test_parallel_batch(const std::string& directory)
+	{
+		ShaderCache shaderCache(directory);
+		MockShaderCompiler compiler;
+		constexpr uint32 kRequestCount = 64;
+		std::vector<std::string> sources;
+		std::vector<ShaderCompileRequest> requests;
+		for (uint32 index = 0; index < kRequestCount; ++index)
+		{
+			sources.push_back("float4 main() : SV_Target { return " + std::to_string(index) + (index % 8 == 7 ? "; error }" : "; }"));
+		}
+		for (const std::string& source : sources)
+		{
+			requests.push_back(make_request(source.c_str()));
+		}
+
+		for (uint32 pass = 0; pass < 2; ++pass)
+		{
+			std::vector<ShaderCompileResult> results(kRequestCount);
+			compile_shaders(compiler, &shaderCache, requests.data(), results.data(), kRequestCount);
+			for (uint32 index = 0; index < kRequestCount; ++index)
+			{
+				const bool is_failing = (index % 8 == 7);
+				TEST_CHECK(results[index]._is_succeeded == (is_failing == false));
+				TEST_CHECK(results[index]._is_from_cache == (pass == 1 && is_failing == false));
+				TEST_CHECK(std::string(results[index]._bytecode.begin(), results[index]._bytecode.end()) == (is_failing ? "" : sources[index]));
+			}
+		}
+		// Successes compile once, failures every time.
+		TEST_CHECK(compiler.get_compile_count() == kRequestCount + kRequestCount / 8);
+	}
+}
+
+int main()
+{
+	const std::filesystem::path root = std::filesystem::temp_directory_path() / ("simple_renderer_shader_cache_test_" + std::to_string(get_time_us()));
+	const auto make_directory = [&root](const char* const name) { return (root / name).string(); };
+
+	test_miss_then_hit(make_directory("miss_then_hit"));
+	test_key();
+	test_failure_not_cached(make_directory("failure"));
+	test_parallel_batch(make_directory("batch"));
+
+	std::filesystem::remove_all(root);
+	std::printf("shader_cache_test passed\n");
+	return 0;
+}
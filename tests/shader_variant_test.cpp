@@ -0,0 +1,160 @@
+#include "test_common.h"
+
+#include <filesystem>
+
+using namespace SimpleRenderer;
+
+namespace
+{
+	// "Compiles" by copying the source into the bytecode; a variant with FAULTY enabled fails.
+	class MockShaderCompiler final : public ShaderCompiler
+	{
+	public:
+		bool compile(const ShaderCompileRequest& request, std::vector<byte>& outBytecode, std::string& outErrorMessage) override
+		{
+			_compileCount.fetch_add(1, std::memory_order_relaxed);
+			const std::string source = request._sourceCode;
+			if (source.find("#define FAULTY 1") != std::string::npos)
+			{
+				outBytecode.clear();
+				outErrorMessage = "mock error";
+				return false;
+			}
+			outBytecode.assign(source.begin(), source.end());
+			return true;
+		}
+
+		uint32 get_compile_count() const { return _compileCount.load(std::memory_order_relaxed); }
+
+	private:
+		std::atomic<uint32> _compileCount{ 0 };
+	};
+
+	const char* const kSourceCode = "float4 main() : SV_Target { return 1; }";
+
+	void create_table(ShaderVariantTable& variantTable)
+	{
+		variantTable.create(kSourceCode, "Test", "main", "ps_5_0", 0, nullptr, { "FOG", "SHADOW", "FAULTY" });
+	}
+
+	bool compile(ShaderVariantTable& variantTable, MockShaderCompiler& compiler, const ShaderCache* const shaderCache, const std::vector<uint64>& keys, std::vector<ShaderVariantCompileResult>& outResults)
+	{
+		outResults.clear();
+		return variantTable.compile_variants(compiler, shaderCache, keys.data(), static_cast<uint32>(keys.size()), outResults);
+	}
+
+	void test_variant_sources()
+	{
+		ShaderVariantTable variantTable;
+		create_table(variantTable);
+		MockShaderCompiler compiler;
+		const uint64 fog = variantTable.make_key({ "FOG" });
+		const uint64 fog_shadow = variantTable.make_key({ "SHADOW", "FOG" });
+		TEST_CHECK(fog == 1 && fog_shadow == 3 && variantTable.make_key({}) == 0);
+
+		std::vector<ShaderVariantCompileResult> results;
+		TEST_CHECK(compile(variantTable, compiler, nullptr, { 0, fog, fog_shadow }, results) == true);
+		TEST_CHECK(results.size() == 3);
+		const auto get_source = [](const ShaderVariantCompileResult& result) { return std::string(result._result._bytecode.begin(), result._result._bytecode.end()); };
+		TEST_CHECK(results[0]._key == 0 && get_source(results[0]) == kSourceCode);
+		TEST_CHECK(results[1]._key == fog && get_source(results[1]) == std::string("#define FOG 1\n#line 1\n") + kSourceCode);
+		TEST_CHECK(results[2]._key == fog_shadow && get_source(results[2]) == std::string("#define FOG 1\n#define SHADOW 1\n#line 1\n") + kSourceCode);
+		TEST_CHECK(variantTable.is_compiled(fog_shadow) == true && variantTable.is_failed(fog_shadow) == false);
+	}
+
+	void test_compiled_once()
+	{
+		ShaderVariantTable variantTable;
+		create_table(variantTable);
+		MockShaderCompiler compiler;
+		const uint64 fog = variantTable.make_key({ "FOG" });
+
+		// Repeated keys in one request and keys compiled before are compiled once.
+		std::vector<ShaderVariantCompileResult> results;
+		TEST_CHECK(compile(variantTable, compiler, nullptr, { fog, fog, 0, fog }, results) == true);
+		TEST_CHECK(results.size() == 2 && compiler.get_compile_count() == 2);
+		TEST_CHECK(compile(variantTable, compiler, nullptr, { 0, fog }, results) == true);
+		TEST_CHECK(results.empty() == true && compiler.get_compile_count() == 2);
+
+		// create() starts over.
+		create_table(variantTable);
+		TEST_CHECK(variantTable.is_compiled(fog) == false);
+		TEST_CHECK(compile(variantTable, compiler, nullptr, { fog }, results) == true);
+		TEST_CHECK(results.size() == 1 && compiler.get_compile_count() == 3);
+	}
+
+	void test_failure_remembered()
+	{
+		ShaderVariantTable variantTable;
+		create_table(variantTable);
+		MockShaderCompiler compiler;
+		const uint64 fog = variantTable.make_key({ "FOG" });
+		const uint64 faulty = variantTable.make_key({ "FAULTY" });
+		const uint64 fog_faulty = variantTable.make_key({ "FOG", "FAULTY" });
+
+		// The failures are reported with their errors, and the variants that compiled are kept.
+		std::vector<ShaderVariantCompileResult> results;
+		TEST_CHECK(compile(variantTable, compiler, nullptr, { fog, faulty, fog_faulty }, results) == false);
+		TEST_CHECK(results.size() == 3 && compiler.get_compile_count() == 3);
+		TEST_CHECK(results[0]._result._is_succeeded == true);
+		TEST_CHECK(results[1]._result._is_succeeded == false && results[1]._result._errorMessage == "mock error");
+		TEST_CHECK(results[2]._result._is_succeeded == false);
+		TEST_CHECK(variantTable.is_compiled(fog) == true);
+		TEST_CHECK(variantTable.is_failed(faulty) == true && variantTable.is_compiled(faulty) == false);
+
+		// Asking again still fails, but compiles and reports nothing.
+		for (uint32 attempt = 0; attempt < 3; ++attempt)
+		{
+			TEST_CHECK(compile(variantTable, compiler, nullptr, { faulty }, results) == false);
+			TEST_CHECK(results.empty() == true);
+			TEST_CHECK(compile(variantTable, compiler, nullptr, { fog, fog_faulty }, results) == false);
+			TEST_CHECK(results.empty() == true);
+			TEST_CHECK(compiler.get_compile_count() == 3);
+		}
+
+		// A variant the device rejects is remembered the same way.
+		variantTable.mark_failed(fog);
+		TEST_CHECK(variantTable.is_compiled(fog) == false && variantTable.is_failed(fog) == true);
+		TEST_CHECK(compile(variantTable, compiler, nullptr, { fog }, results) == false);
+		TEST_CHECK(results.empty() == true && compiler.get_compile_count() == 3);
+	}
+
+	void test_cache(const std::string& directory)
+	{
+		ShaderCache shaderCache(directory);
+		MockShaderCompiler compiler;
+		std::vector<ShaderVariantCompileResult> results;
+		const std::vector<uint64> keys = { 0, 1, 2, 3, 4 };
+		{
+			ShaderVariantTable variantTable;
+			create_table(variantTable);
+			TEST_CHECK(compile(variantTable, compiler, &shaderCache, keys, results) == false);
+			TEST_CHECK(compiler.get_compile_count() == 5);
+		}
+
+		// A new table, e.g. in the next run, loads the variants that compiled from the cache, and compiles the failed one again.
+		ShaderVariantTable variantTable;
+		create_table(variantTable);
+		TEST_CHECK(compile(variantTable, compiler, &shaderCache, keys, results) == false);
+		TEST_CHECK(compiler.get_compile_count() == 6);
+		for (const ShaderVariantCompileResult& result : results)
+		{
+			TEST_CHECK(result._result._is_from_cache == (result._key != 4));
+		}
+		TEST_CHECK(shaderCache.get_hit_count() == 4);
+	}
+}
+
+int main()
+{
+	const std::filesystem::path directory = std::filesystem::temp_directory_path() / ("simple_renderer_shader_variant_test_" + std::to_string(get_time_us()));
+
+	test_variant_sources();
+	test_compiled_once();
+	test_failure_remembered();
+	test_cache(directory.string());
+
+	std::filesystem::remove_all(directory);
+	std::printf("shader_variant_test passed\n");
+	return 0;
+}
@@ -0,0 +1,187 @@
+#include "test_common.h"
+
+#include <algorithm>
+#include <random>
+
+using namespace SimpleRenderer;
+
+namespace
+{
+	bool overlaps(const AtlasRect& a, const AtlasRect& b)
+	{
+		return a._x < b._x + b._width && b._x < a._x + a._width && a._y < b._y + b._height && b._y < a._y + a._height;
+	}
+
+	void check_rects(const SkylinePacker& packer, const std::vector<AtlasRect>& rects)
+	{
+		uint64 area = 0;
+		for (size_t i = 0; i < rects.size(); ++i)
+		{
+			TEST_CHECK(rects[i]._x + rects[i]._width <= packer.get_width());
+			TEST_CHECK(rects[i]._y + rects[i]._height <= packer.get_height());
+			for (size_t j = i + 1; j < rects.size(); ++j)
+			{
+				TEST_CHECK(overlaps(rects[i], rects[j]) == false);
+			}
+			area += uint64(rects[i]._width) * rects[i]._height;
+		}
+		TEST_CHECK(packer.get_used_area() == area);
+	}
+
+	void test_release_all()
+	{
+		SkylinePacker packer;
+		packer.init(256, 256);
+		std::vector<AtlasRect> rects(256);
+		for (AtlasRect& rect : rects)
+		{
+			TEST_CHECK(packer.allocate(16, 16, rect) == true);
+		}
+		check_rects(packer, rects);
+		AtlasRect rect;
+		TEST_CHECK(packer.allocate(16, 16, rect) == false);
+
+		for (const AtlasRect& released : rects)
+		{
+			packer.release(released);
+		}
+		TEST_CHECK(packer.get_used_area() == 0);
+		TEST_CHECK(packer.allocate(32, 32, rect) == true);
+		TEST_CHECK(packer.allocate(256, 224, rect) == true);
+	}
+
+	void test_release_block()
+	{
+		SkylinePacker packer;
+		packer.init(64, 64);
+		std::vector<AtlasRect> rects(16);
+		for (AtlasRect& rect : rects)
+		{
+			TEST_CHECK(packer.allocate(16, 16, rect) == true);
+		}
+
+		// Free a 2x2 block of tiles in the middle of the full atlas; its pieces must merge back into one 32x32 rectangle.
+		std::vector<AtlasRect> kept;
+		for (const AtlasRect& rect : rects)
+		{
+			if (rect._x >= 16 && rect._x < 48 && rect._y >= 16 && rect._y < 48)
+			{
+				packer.release(rect);
+			}
+			else
+			{
+				kept.push_back(rect);
+			}
+		}
+		TEST_CHECK(kept.size() == 12);
+
+		AtlasRect rect;
+		TEST_CHECK(packer.allocate(32, 32, rect) == true);
+		TEST_CHECK(rect._x == 16 && rect._y == 16);
+		kept.push_back(rect);
+		check_rects(packer, kept);
+	}
+
+	void test_release_top_row()
+	{
+		SkylinePacker packer;
+		packer.init(64, 64);
+		std::vector<AtlasRect> rects(8);
+		for (AtlasRect& rect : rects)
+		{
+			TEST_CHECK(packer.allocate(16, 16, rect) == true);
+		}
+
+		// The second row is under the skyline; releasing it gives the space back to the skyline.
+		std::vector<AtlasRect> kept;
+		for (const AtlasRect& rect : rects)
+		{
+			if (rect._y == 16)
+			{
+				packer.release(rect);
+			}
+			else
+			{
+				kept.push_back(rect);
+			}
+		}
+
+		AtlasRect rect;
+		TEST_CHECK(packer.allocate(64, 48, rect) == true);
+		TEST_CHECK(rect._y == 16);
+		kept.push_back(rect);
+		check_rects(packer, kept);
+	}
+
+	void test_churn(const uint32 iteration_count)
+	{
+		SkylinePacker packer;
+		packer.init(256, 256);
+		std::vector<AtlasRect> rects;
+		std::mt19937 random(42);
+		uint32 failure_count = 0;
+		uint32 low_usage_failure_count = 0;
+		for (uint32 iteration = 0; iteration < iteration_count; ++iteration)
+		{
+			if (rects.empty() == false && random() % 3 == 0)
+			{
+				const size_t index = random() % rects.size();
+				packer.release(rects[index]);
+				rects[index] = rects.back();
+				rects.pop_back();
+				continue;
+			}
+
+			const uint32 width = 1 + random() % 32;
+			const uint32 height = 1 + random() % 32;
+			AtlasRect rect;
+			if (random() % 4 == 0)
+			{
+				// Any position not overlapping an allocated rectangle must be allocatable, wherever the free space is tracked.
+				rect = AtlasRect{ static_cast<uint32>(random() % (257 - width)), static_cast<uint32>(random() % (257 - height)), width, height };
+				if (std::none_of(rects.begin(), rects.end(), [&rect](const AtlasRect& allocated) { return overlaps(rect, allocated); }) == true)
+				{
+					TEST_CHECK(packer.allocate_at(rect) == true);
+					rects.push_back(rect);
+				}
+				continue;
+			}
+			if (packer.allocate(width, height, rect) == false)
+			{
+				++failure_count;
+				// A small rectangle not fitting into a mostly empty atlas means the free space fragmented.
+				if (packer.get_used_area() * 4 < uint64(256) * 256)
+				{
+					++low_usage_failure_count;
+				}
+				continue;
+			}
+			rects.push_back(rect);
+
+			if (iteration % 1024 == 0)
+			{
+				check_rects(packer, rects);
+			}
+		}
+		check_rects(packer, rects);
+		std::printf("churn: %u allocations failed, %u of them with less than a quarter of the atlas used\n", failure_count, low_usage_failure_count);
+		TEST_CHECK(low_usage_failure_count == 0);
+
+		for (const AtlasRect& rect : rects)
+		{
+			packer.release(rect);
+		}
+		AtlasRect rect;
+		TEST_CHECK(packer.allocate(256, 256, rect) == true);
+	}
+}
+
+int main()
+{
+	test_release_all();
+	test_release_block();
+	test_release_top_row();
+	test_churn(200000);
+	std::printf("skyline_packer_test passed\n");
+	return 0;
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+// Host-side tests of the portable parts of SimpleRenderer.h; see tests/Makefile.
+
+#include "../SimpleRenderer.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+#define TEST_CHECK(condition) do { if ((condition) == false) { std::printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); std::exit(1); } } while (false)
@@ -0,0 +1,198 @@
+#include "test_common.h"
+
+#include <random>
+
+using namespace SimpleRenderer;
+
+namespace
+{
+	bool is_equal(const float2& a, const float2& b)
+	{
+		return a.x == b.x && a.y == b.y;
+	}
+
+	std::vector<std::string> break_lines(const std::string_view text, const uint32 maxCharCount)
+	{
+		std::vector<std::string> lines;
+		TextLineBreaker textLineBreaker(text, maxCharCount);
+		TextLine textLine;
+		while (textLineBreaker.next(textLine) == true)
+		{
+			TEST_CHECK(uint64(textLine._offset) + textLine._length <= text.length());
+			lines.emplace_back(text.substr(textLine._offset, textLine._length));
+			TEST_CHECK(lines.size() <= text.length() + 1);
+		}
+		return lines;
+	}
+
+	void test_width_wrapping()
+	{
+		using Lines = std::vector<std::string>;
+		TEST_CHECK(break_lines("the quick brown fox", 0) == Lines({ "the quick brown fox" }));
+		TEST_CHECK(break_lines("the quick brown fox", 10) == Lines({ "the quick", "brown fox" }));
+		TEST_CHECK(break_lines("the quick brown fox", 9) == Lines({ "the quick", "brown fox" }));
+		TEST_CHECK(break_lines("the quick brown fox", 8) == Lines({ "the", "quick", "brown", "fox" }));
+		// Spaces at the wrap point are dropped, however many there are.
+		TEST_CHECK(break_lines("ab    cd", 3) == Lines({ "ab", "cd" }));
+		TEST_CHECK(break_lines("ab cd   ", 2) == Lines({ "ab", "cd" }));
+		// Words longer than a line are broken.
+		TEST_CHECK(break_lines("abcdefghij", 4) == Lines({ "abcd", "efgh", "ij" }));
+		TEST_CHECK(break_lines("a abcdefgh", 4) == Lines({ "a", "abcd", "efgh" }));
+		TEST_CHECK(break_lines("abc", 1) == Lines({ "a", "b", "c" }));
+		TEST_CHECK(break_lines("", 4).empty() == true);
+	}
+
+	void test_leading_spaces()
+	{
+		using Lines = std::vector<std::string>;
+		// Leading spaces before a wrap used to make an empty first line.
+		TEST_CHECK(break_lines("   hello world", 5) == Lines({ "hello", "world" }));
+		TEST_CHECK(break_lines(" helloworld", 5) == Lines({ "hello", "world" }));
+		TEST_CHECK(break_lines("ab\n      cd ef", 4) == Lines({ "ab", "cd", "ef" }));
+		// Indentation stays where the first word fits after it, or where the line does not wrap at all.
+		TEST_CHECK(break_lines("  ab cdefgh", 5) == Lines({ "  ab", "cdefg", "h" }));
+		TEST_CHECK(break_lines("  ab", 5) == Lines({ "  ab" }));
+		// A line of only spaces is still a line.
+		TEST_CHECK(break_lines("ab\n        \ncd", 4) == Lines({ "ab", "", "cd" }));
+
+		// Every line fits, and nothing but spaces and line breaks is lost.
+		std::mt19937 random(5);
+		for (uint32 iteration = 0; iteration < 20000; ++iteration)
+		{
+			std::string text;
+			const uint32 length = random() % 40;
+			for (uint32 i = 0; i < length; ++i)
+			{
+				text += "  \nab"[random() % 5];
+			}
+			const uint32 maxCharCount = 1 + random() % 8;
+			const std::vector<std::string> lines = break_lines(text, maxCharCount);
+			std::string expected_characters;
+			std::string characters;
+			for (const char ch : text)
+			{
+				expected_characters += (ch == 'a' || ch == 'b' ? std::string(1, ch) : std::string());
+			}
+			for (const std::string& line : lines)
+			{
+				if (line.find_first_not_of(' ') == std::string::npos)
+				{
+					continue;
+				}
+				TEST_CHECK(line.length() <= maxCharCount);
+				for (const char ch : line)
+				{
+					characters += (ch == ' ' ? std::string() : std::string(1, ch));
+				}
+			}
+			TEST_CHECK(characters == expected_characters);
+		}
+	}
+
+	void test_explicit_newlines()
+	{
+		using Lines = std::vector<std::string>;
+		TEST_CHECK(break_lines("a\nb", 0) == Lines({ "a", "b" }));
+		TEST_CHECK(break_lines("a\n\nb", 0) == Lines({ "a", "", "b" }));
+		TEST_CHECK(break_lines("a\n", 0) == Lines({ "a" }));
+		TEST_CHECK(break_lines("\n", 0) == Lines({ "" }));
+		TEST_CHECK(break_lines("abc def\ngh", 4) == Lines({ "abc", "def", "gh" }));
+		// Spaces left before the '\n' after a wrap do not make an empty line.
+		TEST_CHECK(break_lines("abc   \nde", 3) == Lines({ "abc", "de" }));
+
+		const float2 glyphSize(8.0f, 16.0f);
+		TEST_CHECK(is_equal(measure_text("", glyphSize), float2(0, 0)));
+		const float2 size = measure_text("abc\n\nabcdef", glyphSize, 0.0f, 2.0f);
+		TEST_CHECK(size.x == 48.0f && size.y == 3 * 16.0f + 2 * 2.0f);
+		const float2 wrapped_size = measure_text("   hello world", glyphSize, 40.0f);
+		TEST_CHECK(wrapped_size.x == 40.0f && wrapped_size.y == 32.0f);
+	}
+
+	std::vector<DEFAULT_FONT_GLYPH_INSTANCE> layout(const std::string_view text, const TextLayout& textLayout)
+	{
+		std::vector<DEFAULT_FONT_GLYPH_INSTANCE> glyphInstances;
+		layout_text(text, textLayout, float2(8.0f, 16.0f), 0x11223344, glyphInstances);
+		for (const DEFAULT_FONT_GLYPH_INSTANCE& glyphInstance : glyphInstances)
+		{
+			TEST_CHECK(glyphInstance._glyph != ' ' && glyphInstance._color == 0x11223344);
+		}
+		return glyphInstances;
+	}
+
+	void test_layout()
+	{
+		TextLayout textLayout;
+		textLayout._position = float2(100.0f, 50.0f);
+		textLayout._lineSpacing = 4.0f;
+		std::vector<DEFAULT_FONT_GLYPH_INSTANCE> glyphInstances = layout("ab c\nd", textLayout);
+		TEST_CHECK(glyphInstances.size() == 4);
+		TEST_CHECK(glyphInstances[0]._glyph == 'a' && is_equal(glyphInstances[0]._position, float2(100.0f, 50.0f)));
+		TEST_CHECK(glyphInstances[1]._glyph == 'b' && is_equal(glyphInstances[1]._position, float2(108.0f, 50.0f)));
+		TEST_CHECK(glyphInstances[2]._glyph == 'c' && is_equal(glyphInstances[2]._position, float2(124.0f, 50.0f)));
+		TEST_CHECK(glyphInstances[3]._glyph == 'd' && is_equal(glyphInstances[3]._position, float2(100.0f, 70.0f)));
+
+		// Wrapped at 5 characters, a leading run of spaces moves nothing down a line.
+		textLayout._wrapWidth = 40.0f;
+		glyphInstances = layout("   hello world", textLayout);
+		TEST_CHECK(glyphInstances.size() == 10);
+		TEST_CHECK(glyphInstances[0]._glyph == 'h' && is_equal(glyphInstances[0]._position, float2(100.0f, 50.0f)));
+		TEST_CHECK(glyphInstances[5]._glyph == 'w' && is_equal(glyphInstances[5]._position, float2(100.0f, 70.0f)));
+
+		textLayout._alignment = TextAlignment::Right;
+		glyphInstances = layout("ab", textLayout);
+		TEST_CHECK(is_equal(glyphInstances[1]._position, float2(132.0f, 50.0f)));
+		textLayout._alignment = TextAlignment::Center;
+		glyphInstances = layout("ab", textLayout);
+		TEST_CHECK(is_equal(glyphInstances[0]._position, float2(112.0f, 50.0f)));
+	}
+
+	void test_clipping()
+	{
+		// 100 lines of 10 characters, 20 pixels apart.
+		std::string text;
+		for (uint32 line = 0; line < 100; ++line)
+		{
+			text += std::string(10, static_cast<char>('0' + line % 10));
+			text += '\n';
+		}
+		TextLayout textLayout;
+		textLayout._position = float2(0.0f, 0.0f);
+		textLayout._lineSpacing = 4.0f;
+		TEST_CHECK(layout(text, textLayout).size() == 1000);
+
+		// Lines 5 to 9 touch [110, 200); lines entirely above or below it are culled, and glyphs crossing an edge are kept whole.
+		textLayout._is_clipped = true;
+		textLayout._clipMin = float2(-100.0f, 110.0f);
+		textLayout._clipMax = float2(1000.0f, 200.0f);
+		std::vector<DEFAULT_FONT_GLYPH_INSTANCE> glyphInstances = layout(text, textLayout);
+		TEST_CHECK(glyphInstances.size() == 50);
+		TEST_CHECK(glyphInstances.front()._position.y == 100.0f && glyphInstances.front()._glyph == '5');
+		TEST_CHECK(glyphInstances.back()._position.y == 180.0f && glyphInstances.back()._glyph == '9');
+
+		// Horizontally, only the characters crossing [20, 44) are emitted.
+		textLayout._clipMin.x = 20.0f;
+		textLayout._clipMax.x = 44.0f;
+		glyphInstances = layout(text, textLayout);
+		TEST_CHECK(glyphInstances.size() == 5 * 4);
+		TEST_CHECK(glyphInstances[0]._position.x == 16.0f && glyphInstances[3]._position.x == 40.0f);
+
+		// Entirely to the side, or with the clip rectangle above the text, nothing is emitted.
+		textLayout._clipMin.x = 200.0f;
+		textLayout._clipMax.x = 300.0f;
+		TEST_CHECK(layout(text, textLayout).empty() == true);
+		textLayout._clipMin = float2(-100.0f, -100.0f);
+		textLayout._clipMax = float2(1000.0f, -1.0f);
+		TEST_CHECK(layout(text, textLayout).empty() == true);
+	}
+}
+
+int main()
+{
+	test_width_wrapping();
+	test_leading_spaces();
+	test_explicit_newlines();
+	test_layout();
+	test_clipping();
+	std::printf("text_layout_test passed\n");
+	return 0;
+}
@@ -0,0 +1,402 @@
+#include "test_common.h"
+
+#include <cmath>
+#include <random>
+
+using namespace SimpleRenderer;
+
+namespace
+{
+	TextureData make_texture(const TextureFormat& format, const uint32 width, const uint32 height, const std::vector<byte>& bytes)
+	{
+		TextureData textureData;
+		textureData._format = format;
+		textureData._mipLevels.resize(1);
+		textureData._mipLevels[0]._width = width;
+		textureData._mipLevels[0]._height = height;
+		textureData._mipLevels[0]._bytes = bytes;
+		TEST_CHECK(bytes.size() == compute_texture_byte_size(format, width, height));
+		return textureData;
+	}
+
+	double compute_mean(const TextureMipLevel& level, const uint32 channelCount, const uint32 channel)
+	{
+		double sum = 0.0;
+		const size_t texelCount = size_t(level._width) * level._height;
+		for (size_t texelIndex = 0; texelIndex < texelCount; ++texelIndex)
+		{
+			sum += level._bytes[texelIndex * channelCount + channel];
+		}
+		return sum / texelCount;
+	}
+
+	void test_mip_dimensions()
+	{
+		const uint32 kSizes[][2] = { { 7, 5 }, { 1, 9 }, { 13, 1 }, { 16, 3 }, { 1, 1 }, { 255, 129 } };
+		for (const auto& size : kSizes)
+		{
+			TextureData textureData = make_texture(TextureFormat::R8G8B8A8_UNORM, size[0], size[1], std::vector<byte>(size_t(size[0]) * size[1] * 4, 77));
+			TEST_CHECK(generate_mipmaps(textureData, MipFilter::Box, true) == true);
+			uint32 width = size[0];
+			uint32 height = size[1];
+			for (size_t levelIndex = 1; levelIndex < textureData._mipLevels.size(); ++levelIndex)
+			{
+				width = (std::max)(width / 2, 1u);
+				height = (std::max)(height / 2, 1u);
+				const TextureMipLevel& level = textureData._mipLevels[levelIndex];
+				TEST_CHECK(level._width == width && level._height == height);
+				TEST_CHECK(level._bytes.size() == size_t(width) * height * 4);
+				// The weights of every texel sum to 1, so a constant stays constant.
+				for (const byte value : level._bytes)
+				{
+					TEST_CHECK(value == 77);
+				}
+			}
+			TEST_CHECK(width == 1 && height == 1);
+		}
+	}
+
+	void test_odd_box()
+	{
+		// Box filtering 3 texels to 1 used to read only the first 2, so the bright last column was lost.
+		TextureData line = make_texture(TextureFormat::R8_UNORM, 3, 1, { 0, 0, 255 });
+		TEST_CHECK(generate_mipmaps(line, MipFilter::Box, false) == true);
+		TEST_CHECK(line._mipLevels.size() == 2 && line._mipLevels[1]._bytes[0] == 85);
+
+		// 5 texels to 2: the middle one is split between both.
+		TextureData split = make_texture(TextureFormat::R8_UNORM, 1, 5, { 250, 0, 100, 0, 0 });
+		TEST_CHECK(generate_mipmaps(split, MipFilter::Box, false) == true);
+		TEST_CHECK(split._mipLevels[1]._height == 2);
+		TEST_CHECK(split._mipLevels[1]._bytes[0] == 120 && split._mipLevels[1]._bytes[1] == 20);
+
+		// Without gamma, a box keeps the mean of every level, whatever the sizes.
+		std::mt19937 random(3);
+		const uint32 kSizes[][2] = { { 7, 5 }, { 9, 9 }, { 31, 17 }, { 101, 3 } };
+		for (const auto& size : kSizes)
+		{
+			std::vector<byte> bytes(size_t(size[0]) * size[1] * 4);
+			for (byte& value : bytes)
+			{
+				value = static_cast<byte>(random());
+			}
+			TextureData textureData = make_texture(TextureFormat::R8G8B8A8_UNORM, size[0], size[1], bytes);
+			TEST_CHECK(generate_mipmaps(textureData, MipFilter::Box, false) == true);
+			for (uint32 channel = 0; channel < 4; ++channel)
+			{
+				const double baseMean = compute_mean(textureData._mipLevels[0], 4, channel);
+				for (size_t levelIndex = 1; levelIndex < textureData._mipLevels.size(); ++levelIndex)
+				{
+					// Each level rounds to 8 bits once, which moves the mean by at most half a step.
+					TEST_CHECK(std::fabs(compute_mean(textureData._mipLevels[levelIndex], 4, channel) - baseMean) <= 0.5 * levelIndex + 1e-3);
+				}
+			}
+		}
+
+		// The Kaiser filter also reaches the last row and column.
+		TextureData kaiser = make_texture(TextureFormat::R8_UNORM, 3, 3, { 0, 0, 0, 0, 0, 0, 0, 0, 255 });
+		TEST_CHECK(generate_mipmaps(kaiser, MipFilter::Kaiser, false) == true);
+		TEST_CHECK(kaiser._mipLevels[1]._bytes[0] > 0);
+	}
+
+	// Reference decoders, written from the format specifications rather than from the encoders.
+	void expand_565(const uint32 color, int32 (&outColor)[3])
+	{
+		const uint32 r = (color >> 11) & 31;
+		const uint32 g = (color >> 5) & 63;
+		const uint32 b = color & 31;
+		outColor[0] = static_cast<int32>((r << 3) | (r >> 2));
+		outColor[1] = static_cast<int32>((g << 2) | (g >> 4));
+		outColor[2] = static_cast<int32>((b << 3) | (b >> 2));
+	}
+
+	void decode_BC1_block(const byte* const block, byte (&outTexels)[16][4])
+	{
+		const uint32 color0 = block[0] | (block[1] << 8);
+		const uint32 color1 = block[2] | (block[3] << 8);
+		int32 palette[4][3]{};
+		expand_565(color0, palette[0]);
+		expand_565(color1, palette[1]);
+		for (uint32 channel = 0; channel < 3; ++channel)
+		{
+			if (color0 > color1)
+			{
+				palette[2][channel] = (2 * palette[0][channel] + palette[1][channel]) / 3;
+				palette[3][channel] = (palette[0][channel] + 2 * palette[1][channel]) / 3;
+			}
+			else
+			{
+				palette[2][channel] = (palette[0][channel] + palette[1][channel]) / 2;
+				palette[3][channel] = 0;
+			}
+		}
+		const uint32 indices = block[4] | (block[5] << 8) | (block[6] << 16) | (uint32(block[7]) << 24);
+		for (uint32 texelIndex = 0; texelIndex < 16; ++texelIndex)
+		{
+			const uint32 index = (indices >> (texelIndex * 2)) & 3;
+			for (uint32 channel = 0; channel < 3; ++channel)
+			{
+				outTexels[texelIndex][channel] = static_cast<byte>(palette[index][channel]);
+			}
+			outTexels[texelIndex][3] = (color0 <= color1 && index == 3 ? 0 : 255);
+		}
+	}
+
+	void decode_BC4_block(const byte* const block, const uint32 channel, byte (&outTexels)[16][4])
+	{
+		const int32 value0 = block[0];
+		const int32 value1 = block[1];
+		int32 palette[8]{ value0, value1 };
+		for (int32 code = 2; code < 8; ++code)
+		{
+			palette[code] = (value0 > value1 ? ((8 - code) * value0 + (code - 1) * value1) / 7 : (code < 6 ? ((6 - code) * value0 + (code - 1) * value1) / 5 : (code == 6 ? 0 : 255)));
+		}
+		uint64 indices = 0;
+		for (uint32 byteIndex = 0; byteIndex < 6; ++byteIndex)
+		{
+			indices |= uint64(block[2 + byteIndex]) << (byteIndex * 8);
+		}
+		for (uint32 texelIndex = 0; texelIndex < 16; ++texelIndex)
+		{
+			outTexels[texelIndex][channel] = static_cast<byte>(palette[(indices >> (texelIndex * 3)) & 7]);
+		}
+	}
+
+	// Mode 6 only, which is all the encoder writes; any other mode fails the test.
+	void decode_BC7_block(const byte* const block, byte (&outTexels)[16][4])
+	{
+		uint32 bitOffset = 0;
+		const auto read_bits = [&](const uint32 bitCount)
+			{
+				uint32 value = 0;
+				for (uint32 bit = 0; bit < bitCount; ++bit, ++bitOffset)
+				{
+					value |= ((block[bitOffset / 8] >> (bitOffset % 8)) & 1) << bit;
+				}
+				return value;
+			};
+		TEST_CHECK(read_bits(7) == (1 << 6));
+		uint32 endpoints[2][4]{};
+		for (uint32 channel = 0; channel < 4; ++channel)
+		{
+			endpoints[0][channel] = read_bits(7);
+			endpoints[1][channel] = read_bits(7);
+		}
+		const uint32 pBit0 = read_bits(1);
+		const uint32 pBit1 = read_bits(1);
+		for (uint32 channel = 0; channel < 4; ++channel)
+		{
+			endpoints[0][channel] = (endpoints[0][channel] << 1) | pBit0;
+			endpoints[1][channel] = (endpoints[1][channel] << 1) | pBit1;
+		}
+		const uint32 kWeights[16]{ 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+		for (uint32 texelIndex = 0; texelIndex < 16; ++texelIndex)
+		{
+			const uint32 index = read_bits(texelIndex == 0 ? 3 : 4);
+			for (uint32 channel = 0; channel < 4; ++channel)
+			{
+				outTexels[texelIndex][channel] = static_cast<byte>(((64 - kWeights[index]) * endpoints[0][channel] + kWeights[index] * endpoints[1][channel] + 32) >> 6);
+			}
+		}
+		TEST_CHECK(bitOffset == 128);
+	}
+
+	struct DecodeError
+	{
+		double _rootMeanSquare = 0.0;
+		int32 _max = 0;
+	};
+
+	// Compresses a texture with every mip level and decodes it again. Returns the error of level 0, over the channels the
+	// format keeps. On every level, each decoded texel must stay within the bounding box of its block, widened by slack
+	// for the endpoint precision, so blocks crossing the edge of small levels are checked as well.
+	DecodeError measure_round_trip(const TextureData& source, const TextureFormat& blockFormat, const int32 slack)
+	{
+		TextureData compressed;
+		TEST_CHECK(compress_texture(source, blockFormat, compressed) == true);
+		TEST_CHECK(compressed._format == blockFormat && compressed._mipLevels.size() == source._mipLevels.size());
+
+		const uint32 sourceStride = (source._format == TextureFormat::R8_UNORM ? 1 : 4);
+		const uint32 channelCount = (blockFormat == TextureFormat::BC1_UNORM ? 3 : sourceStride);
+		const uint32 blockByteSize = (blockFormat == TextureFormat::BC1_UNORM || blockFormat == TextureFormat::BC4_UNORM ? 8 : 16);
+		double squaredErrorSum = 0.0;
+		uint64 sampleCount = 0;
+		DecodeError error;
+		for (size_t levelIndex = 0; levelIndex < source._mipLevels.size(); ++levelIndex)
+		{
+			const TextureMipLevel& sourceLevel = source._mipLevels[levelIndex];
+			const TextureMipLevel& compressedLevel = compressed._mipLevels[levelIndex];
+			const uint32 blockCountX = (sourceLevel._width + 3) / 4;
+			const uint32 blockCountY = (sourceLevel._height + 3) / 4;
+			TEST_CHECK(compressedLevel._width == sourceLevel._width && compressedLevel._height == sourceLevel._height);
+			TEST_CHECK(compressedLevel._bytes.size() == size_t(blockCountX) * blockCountY * blockByteSize);
+			for (uint32 blockY = 0; blockY < blockCountY; ++blockY)
+			{
+				for (uint32 blockX = 0; blockX < blockCountX; ++blockX)
+				{
+					const byte* const block = &compressedLevel._bytes[(size_t(blockY) * blockCountX + blockX) * blockByteSize];
+					byte texels[16][4]{};
+					switch (blockFormat)
+					{
+					case TextureFormat::BC1_UNORM:
+						decode_BC1_block(block, texels);
+						break;
+					case TextureFormat::BC3_UNORM:
+						decode_BC1_block(block + 8, texels);
+						decode_BC4_block(block, 3, texels);
+						break;
+					case TextureFormat::BC4_UNORM:
+						decode_BC4_block(block, 0, texels);
+						break;
+					default:
+						decode_BC7_block(block, texels);
+						break;
+					}
+
+					// Texels past the edge of a level only exist in the block.
+					const byte* sourceTexels[16]{};
+					int32 minValues[4]{ 255, 255, 255, 255 };
+					int32 maxValues[4]{};
+					for (uint32 texelIndex = 0; texelIndex < 16; ++texelIndex)
+					{
+						const uint32 x = blockX * 4 + texelIndex % 4;
+						const uint32 y = blockY * 4 + texelIndex / 4;
+						if (x >= sourceLevel._width || y >= sourceLevel._height)
+						{
+							continue;
+						}
+						sourceTexels[texelIndex] = &sourceLevel._bytes[(size_t(y) * sourceLevel._width + x) * sourceStride];
+						for (uint32 channel = 0; channel < channelCount; ++channel)
+						{
+							minValues[channel] = (std::min)(minValues[channel], static_cast<int32>(sourceTexels[texelIndex][channel]));
+							maxValues[channel] = (std::max)(maxValues[channel], static_cast<int32>(sourceTexels[texelIndex][channel]));
+						}
+					}
+
+					for (uint32 texelIndex = 0; texelIndex < 16; ++texelIndex)
+					{
+						if (sourceTexels[texelIndex] == nullptr)
+						{
+							continue;
+						}
+						for (uint32 channel = 0; channel < channelCount; ++channel)
+						{
+							const int32 decoded = texels[texelIndex][channel];
+							TEST_CHECK(decoded >= minValues[channel] - slack && decoded <= maxValues[channel] + slack);
+							if (levelIndex == 0)
+							{
+								const int32 difference = decoded - static_cast<int32>(sourceTexels[texelIndex][channel]);
+								squaredErrorSum += double(difference) * difference;
+								error._max = (std::max)(error._max, std::abs(difference));
+								++sampleCount;
+							}
+						}
+					}
+				}
+			}
+		}
+		error._rootMeanSquare = std::sqrt(squaredErrorSum / sampleCount);
+		return error;
+	}
+
+	// Smooth in both directions, with blue falling as red rises.
+	TextureData make_gradient(const uint32 width, const uint32 height)
+	{
+		std::vector<byte> bytes(size_t(width) * height * 4);
+		for (uint32 y = 0; y < height; ++y)
+		{
+			for (uint32 x = 0; x < width; ++x)
+			{
+				byte* const texel = &bytes[(size_t(y) * width + x) * 4];
+				texel[0] = static_cast<byte>(x * 255 / (width - 1));
+				texel[1] = static_cast<byte>(y * 255 / (height - 1));
+				texel[2] = static_cast<byte>(255 - texel[0] / 2);
+				texel[3] = static_cast<byte>(128 + texel[1] / 4);
+			}
+		}
+		TextureData textureData = make_texture(TextureFormat::R8G8B8A8_UNORM, width, height, bytes);
+		TEST_CHECK(generate_mipmaps(textureData, MipFilter::Box, false) == true);
+		return textureData;
+	}
+
+	void test_round_trip()
+	{
+		// Odd sizes, so blocks cross the edge of every level and the smallest levels are under a block.
+		const TextureData gradient = make_gradient(67, 45);
+		const struct
+		{
+			TextureFormat _format;
+			int32 _slack;
+			double _maxRootMeanSquare;
+			int32 _maxError;
+		} kCases[] = {
+			{ TextureFormat::BC1_UNORM, 5, 4.5, 16 },
+			{ TextureFormat::BC3_UNORM, 5, 4.5, 16 },
+			{ TextureFormat::BC7_UNORM, 1, 3.5, 12 },
+		};
+		for (const auto& testCase : kCases)
+		{
+			const DecodeError error = measure_round_trip(gradient, testCase._format, testCase._slack);
+			std::printf("gradient: format %u, RMSE %.3f, max error %d\n", static_cast<uint32>(testCase._format), error._rootMeanSquare, error._max);
+			TEST_CHECK(error._rootMeanSquare <= testCase._maxRootMeanSquare);
+			TEST_CHECK(error._max <= testCase._maxError);
+		}
+
+		// Red and alpha rise while green falls: the endpoints must follow that line, not the bounding box diagonal.
+		std::vector<byte> crossing(size_t(16) * 4 * 4);
+		for (size_t texelIndex = 0; texelIndex < crossing.size() / 4; ++texelIndex)
+		{
+			const byte value = static_cast<byte>(texelIndex % 16 * 17);
+			crossing[texelIndex * 4 + 0] = value;
+			crossing[texelIndex * 4 + 1] = static_cast<byte>(255 - value);
+			crossing[texelIndex * 4 + 2] = 128;
+			crossing[texelIndex * 4 + 3] = value;
+		}
+		const TextureData crossingTexture = make_texture(TextureFormat::R8G8B8A8_UNORM, 16, 4, crossing);
+		for (const auto& testCase : kCases)
+		{
+			const DecodeError error = measure_round_trip(crossingTexture, testCase._format, testCase._slack);
+			std::printf("crossing: format %u, RMSE %.3f, max error %d\n", static_cast<uint32>(testCase._format), error._rootMeanSquare, error._max);
+			TEST_CHECK(error._max <= testCase._maxError);
+		}
+
+		// A single channel is one line, so BC4 is off by at most half of one of its 7 steps between the block's extremes.
+		std::vector<byte> singleChannel(size_t(33) * 19);
+		for (size_t index = 0; index < singleChannel.size(); ++index)
+		{
+			singleChannel[index] = static_cast<byte>(index * 7 % 256);
+		}
+		TextureData singleChannelTexture = make_texture(TextureFormat::R8_UNORM, 33, 19, singleChannel);
+		TEST_CHECK(generate_mipmaps(singleChannelTexture, MipFilter::Kaiser, false) == true);
+		const DecodeError singleChannelError = measure_round_trip(singleChannelTexture, TextureFormat::BC4_UNORM, 0);
+		std::printf("single channel: BC4 RMSE %.3f, max error %d\n", singleChannelError._rootMeanSquare, singleChannelError._max);
+		TEST_CHECK(singleChannelError._max <= (255 / 7 + 1) / 2 + 1);
+
+		// Constant blocks come back within the endpoint precision of each format.
+		const TextureData constant = make_texture(TextureFormat::R8G8B8A8_UNORM, 6, 6, std::vector<byte>(6 * 6 * 4, 201));
+		TEST_CHECK(measure_round_trip(constant, TextureFormat::BC1_UNORM, 5)._max <= 4);
+		TEST_CHECK(measure_round_trip(constant, TextureFormat::BC3_UNORM, 5)._max <= 4);
+		TEST_CHECK(measure_round_trip(constant, TextureFormat::BC7_UNORM, 1)._max <= 1);
+
+		// Noise is the worst case; it is only checked to stay inside each block's range.
+		std::mt19937 random(11);
+		std::vector<byte> noise(size_t(17) * 13 * 4);
+		for (byte& value : noise)
+		{
+			value = static_cast<byte>(random());
+		}
+		TextureData noiseTexture = make_texture(TextureFormat::R8G8B8A8_UNORM, 17, 13, noise);
+		TEST_CHECK(generate_mipmaps(noiseTexture, MipFilter::Box, true) == true);
+		measure_round_trip(noiseTexture, TextureFormat::BC1_UNORM, 5);
+		measure_round_trip(noiseTexture, TextureFormat::BC3_UNORM, 5);
+		measure_round_trip(noiseTexture, TextureFormat::BC7_UNORM, 1);
+	}
+}
+
+int main()
+{
+	test_mip_dimensions();
+	test_odd_box();
+	test_round_trip();
+	std::printf("texture_test passed\n");
+	return 0;
+}
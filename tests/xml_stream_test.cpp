@@ -0,0 +1,240 @@
+#include "test_common.h"
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+using namespace SimpleRenderer;
+
+namespace
+{
+	// Everything the reader reports, as text: the events, then the result and the error.
+	struct StreamResult
+	{
+		std::vector<std::string> _events;
+		bool _is_succeeded = false;
+		std::string _error;
+	};
+
+	XMLStreamReader::EventHandler make_recorder(StreamResult& outResult, const uint32 stopAfter = UINT32_MAX)
+	{
+		return [&outResult, stopAfter](const XMLStreamReader::Event& event)
+			{
+				const char* const kTypeNames[] = { "start", "attribute", "end" };
+				std::string text = kTypeNames[static_cast<uint32>(event._type)];
+				text += ' ';
+				text += std::to_string(event._depth);
+				text += ' ';
+				text.append(event._name.data(), event._name.length());
+				if (event._type == XMLStreamReader::EventType::Attribute)
+				{
+					text += '=';
+					text.append(event._value.data(), event._value.length());
+				}
+				outResult._events.push_back(std::move(text));
+				return outResult._events.size() < stopAfter;
+			};
+	}
+
+	// chunkByteSize 0 feeds the whole document at once.
+	StreamResult read_in_chunks(const std::string& text, const size_t chunkByteSize, const uint32 stopAfter = UINT32_MAX)
+	{
+		StreamResult result;
+		XMLStreamReader reader;
+		reader.begin(make_recorder(result, stopAfter));
+		const size_t step = (chunkByteSize == 0 ? (std::max)(text.length(), size_t(1)) : chunkByteSize);
+		bool is_fed = true;
+		for (size_t at = 0; at < text.length() && is_fed == true; at += step)
+		{
+			// Each chunk is a separate copy, so no view may outlive the chunk it points into.
+			const std::string chunk = text.substr(at, step);
+			is_fed = reader.feed(chunk);
+		}
+		result._is_succeeded = (is_fed == true && reader.finish() == true);
+		result._error = reader.get_error();
+		if (result._is_succeeded == true)
+		{
+			TEST_CHECK(reader.get_consumed_byte_count() == text.length());
+		}
+		return result;
+	}
+
+	const size_t kChunkByteSizes[] = { 1, 2, 3, 7, 13, 31, 101, 4093, 0 };
+
+	StreamResult check_chunk_independent(const std::string& text)
+	{
+		const StreamResult expected = read_in_chunks(text, 0);
+		for (const size_t chunkByteSize : kChunkByteSizes)
+		{
+			const StreamResult result = read_in_chunks(text, chunkByteSize);
+			TEST_CHECK(result._events == expected._events);
+			TEST_CHECK(result._is_succeeded == expected._is_succeeded);
+			TEST_CHECK(result._error == expected._error);
+		}
+		return expected;
+	}
+
+	std::string make_document(const uint32 shapeCount)
+	{
+		std::string text = "<?xml version=\"1.0\"?>\n<!DOCTYPE shapes>\n<shapes count=\"" + std::to_string(shapeCount) + "\">\n";
+		for (uint32 shapeIndex = 0; shapeIndex < shapeCount; ++shapeIndex)
+		{
+			// Quoted '>' and '<' must not end the tag, and text content is skipped.
+			text += "\t<shape name=\"shape" + std::to_string(shapeIndex) + "\" note=\"a > b, c < d\">text " + std::to_string(shapeIndex) + "\n";
+			text += "\t\t<center x=\"" + std::to_string(shapeIndex * 3) + "\" y=\"-1.5\"/>\n\t\t<points>";
+			for (uint32 pointIndex = 0; pointIndex < shapeIndex % 5; ++pointIndex)
+			{
+				text += "<point\tx=\"" + std::to_string(pointIndex) + "\"\ny=\"\" />";
+			}
+			text += "</points>\n\t</shape >\n";
+		}
+		text += "</shapes>\n";
+		return text;
+	}
+
+	void test_chunk_sizes()
+	{
+		const std::string text = make_document(50);
+		const StreamResult result = check_chunk_independent(text);
+		TEST_CHECK(result._is_succeeded == true);
+		TEST_CHECK(result._events.front() == "start 0 shapes");
+		TEST_CHECK(result._events[1] == "attribute 0 count=50");
+		TEST_CHECK(result._events[2] == "start 1 shape");
+		TEST_CHECK(result._events[3] == "attribute 1 name=shape0");
+		TEST_CHECK(result._events[4] == "attribute 1 note=a > b, c < d");
+		TEST_CHECK(result._events[5] == "start 2 center");
+		TEST_CHECK(result._events[8] == "end 2 center");
+		TEST_CHECK(result._events.back() == "end 0 shapes");
+
+		// The XML parser, which has no prolog support, finds the same elements and attributes.
+		XML xml;
+		TEST_CHECK(xml.parse(text.substr(text.find("<shapes"))) == true);
+		TEST_CHECK(result._events.size() == xml.get_node_count() * 2 + xml.get_attribute_count());
+	}
+
+	void test_malformed()
+	{
+		const char* const kTexts[] = {
+			"<a><b></a>",
+			"<a></a></b>",
+			"<a><b x=\"1\"></b>",
+			"<a x=1/>",
+			"<a x=\"1/>",
+			"<a><b x=\"1\" y=\"2\"",
+			"<a><></a>",
+			"<a>< b/></a>",
+			"<a/><b/>text<c x=\"&gt;\" />",
+		};
+		for (const char* const text : kTexts)
+		{
+			const StreamResult result = check_chunk_independent(text);
+			TEST_CHECK(result._is_succeeded == (text == kTexts[8]));
+			TEST_CHECK(result._is_succeeded == true || result._error.empty() == false);
+		}
+
+		// Random damage anywhere gives the same events and the same error at every chunk size.
+		const std::string seed_text = make_document(4);
+		std::mt19937 random(99);
+		uint32 succeeded_count = 0;
+		for (uint32 iteration = 0; iteration < 300; ++iteration)
+		{
+			std::string text = seed_text;
+			const uint32 damage_count = 1 + random() % 3;
+			for (uint32 damage = 0; damage < damage_count; ++damage)
+			{
+				const size_t at = random() % text.size();
+				text[at] = "<>/=\" ax"[random() % 8];
+			}
+			succeeded_count += (check_chunk_independent(text)._is_succeeded == true ? 1 : 0);
+		}
+		std::printf("malformed: %u of 300 damaged documents still read\n", succeeded_count);
+	}
+
+	void test_tag_length()
+	{
+		// The tag is everything between '<' and '>'.
+		const auto make_text = [](const size_t tagLength)
+			{
+				const std::string prefix = "a x=\"";
+				const std::string suffix = "\"/";
+				return "<root>text<" + prefix + std::string(tagLength - prefix.length() - suffix.length(), 'v') + suffix + "></root>";
+			};
+
+		const std::string longest = make_text(XMLStreamReader::kMaxTagLength);
+		for (const size_t chunkByteSize : { size_t(1), size_t(4093), size_t(0) })
+		{
+			const StreamResult result = read_in_chunks(longest, chunkByteSize);
+			TEST_CHECK(result._is_succeeded == true);
+			TEST_CHECK(result._events.size() == 5);
+		}
+
+		const std::string too_long = make_text(XMLStreamReader::kMaxTagLength + 1);
+		for (const size_t chunkByteSize : { size_t(1), size_t(4093), size_t(0) })
+		{
+			const StreamResult result = read_in_chunks(too_long, chunkByteSize);
+			TEST_CHECK(result._is_succeeded == false);
+			TEST_CHECK(result._error == "tag is too long! at[11]");
+			TEST_CHECK(result._events.size() == 1);
+		}
+
+		// An unterminated tag is rejected as soon as it is too long, not at the end of the document.
+		XMLStreamReader reader;
+		reader.begin(nullptr);
+		TEST_CHECK(reader.feed("<root x=\"") == true);
+		const std::string chunk(4096, 'v');
+		uint64 fed_byte_count = 0;
+		while (reader.feed(chunk) == true)
+		{
+			fed_byte_count += chunk.length();
+			TEST_CHECK(fed_byte_count <= XMLStreamReader::kMaxTagLength);
+		}
+		TEST_CHECK(reader.get_error() == "tag is too long! at[1]");
+	}
+
+	void test_stop()
+	{
+		const std::string text = make_document(10);
+		const StreamResult full = read_in_chunks(text, 0);
+		for (const size_t chunkByteSize : kChunkByteSizes)
+		{
+			// The handler returning false stops reading without an error, and nothing more is reported.
+			const StreamResult result = read_in_chunks(text, chunkByteSize, 7);
+			TEST_CHECK(result._is_succeeded == false);
+			TEST_CHECK(result._error.empty() == true);
+			TEST_CHECK(result._events.size() == 7);
+			TEST_CHECK(std::equal(result._events.begin(), result._events.end(), full._events.begin()));
+		}
+	}
+
+	void test_file()
+	{
+		const std::string text = make_document(200);
+		const std::string file_name = (std::filesystem::temp_directory_path() / ("simple_renderer_xml_stream_test_" + std::to_string(get_time_us()) + ".xml")).string();
+		{
+			std::ofstream ofs(file_name, std::ios_base::binary | std::ios_base::trunc);
+			ofs.write(text.data(), static_cast<std::streamsize>(text.length()));
+		}
+
+		const StreamResult expected = read_in_chunks(text, 0);
+		for (const uint32 chunkByteSize : { 1u, 61u, 1u << 20 })
+		{
+			StreamResult result;
+			XMLStreamReader reader;
+			reader.begin(make_recorder(result));
+			TEST_CHECK(read_XML_stream(file_name, reader, chunkByteSize) == true);
+			TEST_CHECK(result._events == expected._events);
+		}
+		std::filesystem::remove(file_name);
+	}
+}
+
+int main()
+{
+	test_chunk_sizes();
+	test_malformed();
+	test_tag_length();
+	test_stop();
+	test_file();
+	std::printf("xml_stream_test passed\n");
+	return 0;
+}
@@ -0,0 +1,248 @@
+#include "test_common.h"
+
+#include <random>
+
+using namespace SimpleRenderer;
+
+namespace
+{
+	// Every node's links must stay inside the document and agree with each other, whatever the input was.
+	void check_structure(const XML& xml)
+	{
+		const uint32 node_count = xml.get_node_count();
+		for (uint32 node_ID = 0; node_ID < node_count; ++node_ID)
+		{
+			const XML::Node& node = xml.get_node(node_ID);
+			TEST_CHECK(node._ID == node_ID);
+			TEST_CHECK(node._parent_ID == XML::INVALID_ID || node._parent_ID < node_ID);
+			TEST_CHECK(uint64(node._first_attribute_ID) + node._attribute_count <= xml.get_attribute_count() || node._attribute_count == 0);
+
+			uint32 child_count = 0;
+			for (const XML::Node* child = &node.get_first_child_node(); child->is_valid(); child = &child->get_next_sibling())
+			{
+				TEST_CHECK(child->_parent_ID == node_ID);
+				TEST_CHECK(child->_ID > node_ID);
+				++child_count;
+			}
+			TEST_CHECK(child_count == node._child_count);
+		}
+	}
+
+	// The parallel parse must produce exactly what the serial parse does, down to every ID and atom.
+	void check_same(const XML& xml, const XML& expected)
+	{
+		TEST_CHECK(xml.get_node_count() == expected.get_node_count());
+		TEST_CHECK(xml.get_attribute_count() == expected.get_attribute_count());
+		TEST_CHECK(xml.get_atom_count() == expected.get_atom_count());
+		for (uint32 atom = 0; atom < expected.get_atom_count(); ++atom)
+		{
+			TEST_CHECK(xml.get_atom_name(atom) == expected.get_atom_name(atom));
+		}
+		for (uint32 node_ID = 0; node_ID < expected.get_node_count(); ++node_ID)
+		{
+			const XML::Node& node = xml.get_node(node_ID);
+			const XML::Node& expected_node = expected.get_node(node_ID);
+			TEST_CHECK(node._ID == expected_node._ID);
+			TEST_CHECK(node._parent_ID == expected_node._parent_ID);
+			TEST_CHECK(node._index_in_parent_node == expected_node._index_in_parent_node);
+			TEST_CHECK(node._name_at == expected_node._name_at && node._name_length == expected_node._name_length);
+			TEST_CHECK(node._first_attribute_ID == expected_node._first_attribute_ID);
+			TEST_CHECK(node._attribute_count == expected_node._attribute_count);
+			TEST_CHECK(node._first_child_ID == expected_node._first_child_ID);
+			TEST_CHECK(node._last_child_ID == expected_node._last_child_ID);
+			TEST_CHECK(node._next_sibling_ID == expected_node._next_sibling_ID);
+			TEST_CHECK(node._child_count == expected_node._child_count);
+			TEST_CHECK(node._name_atom == expected_node._name_atom);
+			TEST_CHECK(node.get_name() == expected_node.get_name());
+		}
+		for (uint32 attribute_ID = 0; attribute_ID < expected.get_attribute_count(); ++attribute_ID)
+		{
+			const XML::Attribute& attribute = xml.get_attribute(attribute_ID);
+			const XML::Attribute& expected_attribute = expected.get_attribute(attribute_ID);
+			TEST_CHECK(attribute._ID == expected_attribute._ID);
+			TEST_CHECK(attribute._node_ID == expected_attribute._node_ID);
+			TEST_CHECK(attribute._index_in_node == expected_attribute._index_in_node);
+			TEST_CHECK(attribute._name_at == expected_attribute._name_at && attribute._name_length == expected_attribute._name_length);
+			TEST_CHECK(attribute._value_at == expected_attribute._value_at && attribute._value_length == expected_attribute._value_length);
+			TEST_CHECK(attribute._name_atom == expected_attribute._name_atom);
+			TEST_CHECK(attribute.get_value() == expected_attribute.get_value());
+		}
+	}
+
+	void test_scale(const uint32 shape_count)
+	{
+		std::string text = "<shapes>";
+		text.reserve(size_t(shape_count) * 128);
+		for (uint32 shape_index = 0; shape_index < shape_count; ++shape_index)
+		{
+			text += "<shape name=\"s";
+			text += std::to_string(shape_index);
+			text += "\"><center x=\"1\" y=\"2\"/><points><point x=\"0\" y=\"0\"/><point x=\"1\" y=\"0\"/></points></shape>";
+		}
+		text += "</shapes>";
+
+		XML xml;
+		TEST_CHECK(xml.parse_borrowed(text) == true);
+		TEST_CHECK(xml.get_node_count() == 1 + shape_count * 5);
+		TEST_CHECK(xml.get_attribute_count() == shape_count * 7);
+		TEST_CHECK(xml.get_root_node().get_child_count() == shape_count);
+		const XML::Node& last_shape = xml.get_node(xml.get_node_count() - 5);
+		TEST_CHECK(last_shape.find_attribute(xml.find_atom("name")).get_value() == "s" + std::to_string(shape_count - 1));
+
+		// The range count is given, so the text is split and merged even on a single hardware thread.
+		XML xml_parallel;
+		TEST_CHECK(xml_parallel.parse_borrowed_parallel(text, 1 << 16, 64) == true);
+		check_same(xml_parallel, xml);
+		std::printf("scale: %u shapes, %u nodes\n", shape_count, xml.get_node_count());
+	}
+
+	void test_depth(const uint32 depth)
+	{
+		std::string text;
+		text.reserve(size_t(depth) * 8);
+		for (uint32 level = 0; level < depth; ++level)
+		{
+			text += "<n a=\"1\">";
+		}
+		for (uint32 level = 0; level < depth; ++level)
+		{
+			text += "</n>";
+		}
+
+		XML xml;
+		TEST_CHECK(xml.parse_borrowed(text) == true);
+		TEST_CHECK(xml.get_node_count() == depth);
+		uint32 level = 1;
+		for (const XML::Node* node = &xml.get_root_node(); node->get_child_count() > 0; node = &node->get_first_child_node())
+		{
+			TEST_CHECK(node->get_child_count() == 1);
+			++level;
+		}
+		TEST_CHECK(level == depth);
+		std::printf("depth: %u levels\n", depth);
+	}
+
+	void test_parallel(const uint32 iteration_count)
+	{
+		std::string text = "<scene name=\"parallel\">";
+		for (uint32 index = 0; index < 400; ++index)
+		{
+			const std::string id = std::to_string(index);
+			switch (index % 4)
+			{
+			case 0:
+				text += "<shape name=\"s" + id + "\" kind=\"box\"><center x=\"" + id + "\" y=\"2\"/><points><point x=\"0\" y=\"0\"/></points></shape>";
+				break;
+			case 1:
+				text += "<light a" + id + "=\"1 > 0\" b=\"<\"/>";
+				break;
+			case 2:
+				text += "<group><group><shape/></group><empty></empty></group>\n";
+				break;
+			default:
+				text += "<text value=\"a/b\">loose text</text>";
+				break;
+			}
+		}
+		text += "</scene>\n";
+
+		XML expected;
+		TEST_CHECK(expected.parse_borrowed(text) == true);
+		const uint32 kRangeCounts[] = { 2, 3, 7, 64, 1000 };
+		for (const uint32 range_count : kRangeCounts)
+		{
+			XML xml;
+			TEST_CHECK(xml.parse_borrowed_parallel(text, 1, range_count) == true);
+			check_same(xml, expected);
+		}
+
+		// Malformed input: the result and the error must be those of the serial parse.
+		const char kAlphabet[] = "<>/=\"' !-?abcxyz";
+		std::mt19937 random(777);
+		uint32 parsed_count = 0;
+		for (uint32 iteration = 0; iteration < iteration_count; ++iteration)
+		{
+			std::string mutated = text;
+			const uint32 mutation_count = 1 + random() % 4;
+			for (uint32 mutation = 0; mutation < mutation_count; ++mutation)
+			{
+				const size_t at = random() % mutated.size();
+				if (random() % 2 == 0)
+				{
+					mutated[at] = kAlphabet[random() % (sizeof(kAlphabet) - 1)];
+				}
+				else
+				{
+					mutated.erase(at, 1 + random() % 16);
+				}
+			}
+
+			XML serial;
+			XML parallel;
+			const bool is_parsed = serial.parse_borrowed(mutated);
+			TEST_CHECK(parallel.parse_borrowed_parallel(mutated, 1, 2 + random() % 32) == is_parsed);
+			TEST_CHECK(parallel.get_error() == serial.get_error());
+			if (is_parsed == true)
+			{
+				check_same(parallel, serial);
+				++parsed_count;
+			}
+		}
+		std::printf("parallel: %u mutated inputs, %u parsed\n", iteration_count, parsed_count);
+	}
+
+	void test_mutations(const uint32 iteration_count)
+	{
+		const std::string seed_text =
+			"<shapes><shape name=\"a\"><center x=\"400\" y=\"150\"/><points><point x=\"-20\" y=\"-45\"/><point x=\"30\" y=\"20\"/></points></shape>"
+			"<shape name='b'><!-- comment --><center x=\"1\" y=\"2\"/><points/></shape></shapes>";
+		const char kAlphabet[] = "<>/=\"' !-?abcxyz";
+
+		std::mt19937 random(12345);
+		uint32 parsed_count = 0;
+		for (uint32 iteration = 0; iteration < iteration_count; ++iteration)
+		{
+			std::string text = seed_text;
+			const uint32 mutation_count = 1 + random() % 8;
+			for (uint32 mutation = 0; mutation < mutation_count && text.empty() == false; ++mutation)
+			{
+				const size_t at = random() % text.size();
+				switch (random() % 4)
+				{
+				case 0:
+					text[at] = kAlphabet[random() % (sizeof(kAlphabet) - 1)];
+					break;
+				case 1:
+					text.erase(at, 1 + random() % 8);
+					break;
+				case 2:
+					text.insert(at, 1, kAlphabet[random() % (sizeof(kAlphabet) - 1)]);
+					break;
+				default:
+					text.resize(at);
+					break;
+				}
+			}
+
+			XML xml;
+			if (xml.parse_borrowed(text) == true)
+			{
+				check_structure(xml);
+				++parsed_count;
+			}
+		}
+		std::printf("mutations: %u inputs, %u parsed\n", iteration_count, parsed_count);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	// A smaller shape count can be given for quick runs; the default is the million-element case.
+	const uint32 shape_count = (argc > 1 ? static_cast<uint32>(std::strtoul(argv[1], nullptr, 10)) : 1000000);
+	test_scale(shape_count);
+	test_parallel(2000);
+	test_depth(100000);
+	test_mutations(200000);
+	std::printf("xml_test passed\n");
+	return 0;
+}